@@ -0,0 +1,82 @@
+#include "BracketIndex.h"
+#include <algorithm>
+
+namespace RText
+{
+    BracketIndex::BracketIndex() : _open(-1)
+    {
+    }
+
+    void BracketIndex::Invalidate(int position)
+    {
+        auto aFirstObsolete = std::lower_bound(_brackets.begin(), _brackets.end(), position, [](Bracket const & b, int p) { return b.position < p; });
+        _brackets.erase(aFirstObsolete, _brackets.end());
+        if (_brackets.empty())
+        {
+            _open = -1;
+            return;
+        }
+        //everything after the last kept bracket is gone, so the brackets open after it are the last one, if it opens, and its ancestors
+        int const aLast = Count() - 1;
+        _open           = IsOpening(_brackets[aLast].ch) ? aLast : _brackets[aLast].parent;
+        for (int i = _open; i >= 0; i = _brackets[i].parent)
+        {
+            _brackets[i].match = -1;
+        }
+    }
+
+    void BracketIndex::Add(int position, char ch)
+    {
+        Bracket aBracket = { position, -1, _open, ch };
+        int const aIndex = Count();
+        if (IsOpening(ch))
+        {
+            _brackets.push_back(aBracket);
+            _open = aIndex;
+            return;
+        }
+        //closing bracket pairs with the innermost open bracket of the same kind, otherwise it is unmatched and ignored
+        char const aOpening = (ch == '}') ? '{' : '[';
+        if (_open >= 0 && _brackets[_open].ch == aOpening)
+        {
+            aBracket.match            = _open;
+            aBracket.parent           = _brackets[_open].parent;
+            _brackets[_open].match    = aIndex;
+            _open                     = _brackets[_open].parent;
+        }
+        _brackets.push_back(aBracket);
+    }
+
+    int BracketIndex::FindMatch(int position) const
+    {
+        int const aIndex = FindIndex(position);
+        if (aIndex < 0 || _brackets[aIndex].position != position || _brackets[aIndex].match < 0)
+        {
+            return -1;
+        }
+        return _brackets[_brackets[aIndex].match].position;
+    }
+
+    int BracketIndex::FindEnclosing(int position) const
+    {
+        int const aIndex = FindIndex(position - 1);
+        if (aIndex < 0)
+        {
+            return -1;
+        }
+        Bracket const & aBracket = _brackets[aIndex];
+        //no bracket between aBracket and position, so position is either inside aBracket or a sibling of it
+        if (IsOpening(aBracket.ch) && (aBracket.match < 0 || _brackets[aBracket.match].position >= position))
+        {
+            return aBracket.position;
+        }
+        return (aBracket.parent >= 0) ? _brackets[aBracket.parent].position : -1;
+    }
+
+    int BracketIndex::FindIndex(int position) const
+    {
+        //last bracket at or before position
+        auto aNext = std::upper_bound(_brackets.begin(), _brackets.end(), position, [](int p, Bracket const & b) { return p < b.position; });
+        return static_cast<int>(aNext - _brackets.begin()) - 1;
+    }
+} // namespace RText
@@ -0,0 +1,85 @@
+#ifndef RTEXTLEXER_BRACKETINDEX_H__
+#define RTEXTLEXER_BRACKETINDEX_H__
+
+#include <vector>
+
+namespace RText
+{
+    /**
+     * \brief   Per document index of the structural brackets, i.e. '{', '}', '[' and ']' styled as TokenType_Other.
+     *
+     *          Brackets are recorded by the lexer in document order and paired with a stack, brackets inside strings,
+     *          comments and templates are never recorded. Every bracket also knows its enclosing opening bracket, so
+     *          the brackets which are still open at some position are found by following that chain. This is used to
+     *          resume pairing when the document is relexed from some position.
+     */
+    class BracketIndex
+    {
+    public:
+        BracketIndex();
+
+        /**
+         * \brief   Removes all brackets at or after position and reopens the brackets closed after it.
+         *
+         * \param   position    The start position of the lexed range.
+         */
+        void Invalidate(int position);
+
+        /**
+         * \brief   Adds a bracket found by the lexer. Brackets must be added in document order.
+         *
+         * \param   position    The position of the bracket.
+         * \param   ch          The bracket character.
+         */
+        void Add(int position, char ch);
+
+        /**
+         * \brief   Gets the number of brackets.
+         */
+        int Count() const;
+
+        /**
+         * \brief   Finds the bracket matching the bracket at position.
+         *
+         * \param   position    The position of a bracket.
+         *
+         * \return  The position of the matching bracket, -1 if there is no bracket at position or it is unmatched.
+         */
+        int FindMatch(int position) const;
+
+        /**
+         * \brief   Finds the innermost opening bracket which encloses position.
+         *
+         * \param   position    The document position.
+         *
+         * \return  The position of the opening bracket, -1 if position is at top level.
+         */
+        int FindEnclosing(int position) const;
+    private:
+        struct Bracket
+        {
+            int position;   //!< Document position of the bracket.
+            int match;      //!< Index of the matching bracket, -1 if unmatched or still open.
+            int parent;     //!< Index of the enclosing opening bracket, -1 at top level.
+            char ch;        //!< The bracket character.
+        };
+
+        std::vector<Bracket> _brackets; //!< Brackets ordered by position.
+        int _open;                      //!< Index of the innermost open bracket, -1 at top level.
+
+        int FindIndex(int position) const;
+
+        static bool IsOpening(char ch);
+    };
+
+    inline int BracketIndex::Count() const
+    {
+        return static_cast<int>(_brackets.size());
+    }
+
+    inline bool BracketIndex::IsOpening(char ch)
+    {
+        return (ch == '{' || ch == '[');
+    }
+} // namespace RText
+#endif // ifndef RTEXTLEXER_BRACKETINDEX_H__
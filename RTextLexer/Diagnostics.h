@@ -0,0 +1,118 @@
+#ifndef RTEXTLEXER_DIAGNOSTICS_H__
+#define RTEXTLEXER_DIAGNOSTICS_H__
+
+#include <vector>
+#include <algorithm>
+
+namespace RText
+{
+    /**
+     * \brief   Kinds of local syntax problems the lexer is able to detect without the backend.
+     *
+     * \remarks Values are shared with the plug-in, see RTextNppPlugin.Scintilla.LexerDiagnosticKind.
+     */
+    enum DiagnosticKind
+    {
+        DiagnosticKind_InvalidCharacter,        //!< Character which cannot start any RText token.
+        DiagnosticKind_UnterminatedString,      //!< Quoted string without closing delimiter on the same line.
+        DiagnosticKind_UnterminatedTemplate,    //!< Template which is not closed with '>' till the end of the document.
+        DiagnosticKind_UnmatchedBracket,        //!< '}' or ']' without a preceding opening bracket.
+        DiagnosticKind_UnclosedBracket          //!< '{' or '[' which is never closed.
+    };
+
+    /**
+     * \brief   A single local syntax diagnostic. Layout is shared with the plug-in.
+     */
+    struct Diagnostic
+    {
+        int position;   //!< Document position of the first offending character.
+        int length;     //!< Length of the offending range.
+        int kind;       //!< One of DiagnosticKind.
+    };
+
+    /**
+     * \brief   Per document list of diagnostics, ordered by position.
+     *
+     *          Scintilla always (re)lexes a document contiguously from some start position, so all diagnostics
+     *          located after the start of the lexed range are obsolete and dropped. Unclosed brackets depend on the
+     *          whole document, they are kept until the document is folded till its end and they are reported anew.
+     */
+    class DiagnosticList
+    {
+    public:
+        /**
+         * \brief   Removes all diagnostics which may be affected by lexing from position onwards.
+         *
+         * \param   position    The start position of the lexed range.
+         */
+        void Invalidate(int position);
+
+        /**
+         * \brief   Removes all diagnostics of a kind.
+         *
+         * \param   kind    The kind.
+         */
+        void Remove(DiagnosticKind kind);
+
+        /**
+         * \brief   Adds a diagnostic, keeping the list ordered by position.
+         *
+         * \param   position    The position.
+         * \param   length      The length.
+         * \param   kind        The kind.
+         */
+        void Add(int position, int length, DiagnosticKind kind);
+
+        /**
+         * \brief   Gets the number of diagnostics.
+         */
+        int Count() const;
+
+        /**
+         * \brief   Copies diagnostics to a caller supplied buffer.
+         *
+         * \param [out] buffer  The buffer.
+         * \param   capacity    The capacity of the buffer in number of diagnostics.
+         *
+         * \return  The number of copied diagnostics.
+         */
+        int CopyTo(Diagnostic* buffer, int capacity) const;
+    private:
+        std::vector<Diagnostic> _diagnostics;   //!< Diagnostics ordered by position.
+    };
+
+    inline void DiagnosticList::Invalidate(int position)
+    {
+        auto aFirstObsolete = std::lower_bound(_diagnostics.begin(), _diagnostics.end(), position, [](Diagnostic const & d, int p) { return d.position < p; });
+        _diagnostics.erase(aFirstObsolete, _diagnostics.end());
+    }
+
+    inline void DiagnosticList::Remove(DiagnosticKind kind)
+    {
+        _diagnostics.erase(std::remove_if(_diagnostics.begin(), _diagnostics.end(), [kind](Diagnostic const & d) { return d.kind == kind; }), _diagnostics.end());
+    }
+
+    inline void DiagnosticList::Add(int position, int length, DiagnosticKind kind)
+    {
+        Diagnostic const aDiagnostic = { position, length, kind };
+        //lexer adds in order, folding may add some before the last lexed diagnostics
+        auto aWhere = std::upper_bound(_diagnostics.begin(), _diagnostics.end(), position, [](int p, Diagnostic const & d) { return p < d.position; });
+        _diagnostics.insert(aWhere, aDiagnostic);
+    }
+
+    inline int DiagnosticList::Count() const
+    {
+        return static_cast<int>(_diagnostics.size());
+    }
+
+    inline int DiagnosticList::CopyTo(Diagnostic* buffer, int capacity) const
+    {
+        int const aCount = (std::min)(capacity, Count());
+        if (buffer != nullptr && aCount > 0)
+        {
+            std::copy(_diagnostics.begin(), _diagnostics.begin() + aCount, buffer);
+        }
+        return (buffer != nullptr) ? aCount : 0;
+    }
+} // namespace RText
+#endif // ifndef RTEXTLEXER_DIAGNOSTICS_H__
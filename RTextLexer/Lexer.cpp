@@ -1,5 +1,6 @@
 #include "Lexer.h"
 #include <string>
+#include <cstdint>
 #include <tchar.h>
 #include "atltrace.h"
 
@@ -101,6 +102,10 @@ namespace RText
             {
                 ++aCurrentPos;
                 //if string doesn't end till EOF this is an error
+                if (static_cast<int>(aCurrentPos) >= accessor.Length())
+                {
+                    return false;
+                }
                 if (((accessor[aCurrentPos] != delimiter) || (accessor[aCurrentPos - 1] == '\\')) && (accessor[aCurrentPos] != '\n'))
                 {
                     ++length;
@@ -126,14 +131,15 @@ namespace RText
             ++length;
             ++aCurrentPos;
         }
-        //skip whitespace
-        while (::iswspace(accessor[aCurrentPos]))
+        //skip whitespace, label must end in the same line
+        unsigned int const aNameEnd = aCurrentPos;
+        while (accessor[aCurrentPos] == ' ' || accessor[aCurrentPos] == '\t')
         {
             ++aCurrentPos;
         }
         if (accessor[aCurrentPos] == ':' && (length > 0))
         {
-            ++length;
+            length += (aCurrentPos - aNameEnd) + 1;
             return true;
         }
         return false;
@@ -261,13 +267,133 @@ namespace RText
         }
         return false;
     }
+
+    int RTextLexer::LengthTillEndOfLine(Accessor & accessor, int position)const
+    {
+        int aEnd = position;
+        while (aEnd < accessor.Length() && accessor[aEnd] != '\r' && accessor[aEnd] != '\n')
+        {
+            ++aEnd;
+        }
+        return aEnd - position;
+    }
+
+    int RTextLexer::FindTemplateStart(Accessor & accessor, int position)const
+    {
+        while (position > 0 && MaskActive(accessor.StyleAt(position - 1)) == TokenType_Template)
+        {
+            --position;
+        }
+        return position;
+    }
+
+    void RTextLexer::ReportUnclosedBrackets(LexAccessor & styler, int unclosedCount)
+    {
+        //closing brackets seen so far, which still need to be matched with an opening one
+        int aPendingClosings = 0;
+        for (int i = styler.Length() - 1; (i >= 0) && (unclosedCount > 0); --i)
+        {
+            if (MaskActive(styler.StyleAt(i)) == TokenType_Other)
+            {
+                char const ch = styler[i];
+                if (ch == '}' || ch == ']')
+                {
+                    ++aPendingClosings;
+                }
+                else if (ch == '{' || ch == '[')
+                {
+                    if (aPendingClosings > 0)
+                    {
+                        --aPendingClosings;
+                    }
+                    else
+                    {
+                        _diagnostics.Add(i, 1, DiagnosticKind_UnclosedBracket);
+                        --unclosedCount;
+                    }
+                }
+            }
+        }
+    }
+
+    void* SCI_METHOD RTextLexer::PrivateCall(int operation, void* pointer)
+    {
+        switch (operation)
+        {
+        case PrivateCall_GetDiagnosticsCount:
+            return reinterpret_cast<void*>(static_cast<intptr_t>(_diagnostics.Count()));
+        case PrivateCall_GetDiagnostics:
+            return reinterpret_cast<void*>(static_cast<intptr_t>(_diagnostics.CopyTo(static_cast<Diagnostic*>(pointer), _diagnostics.Count())));
+        case PrivateCall_GetSyntaxNodeCount:
+            return reinterpret_cast<void*>(static_cast<intptr_t>(_syntaxTree.Count()));
+        case PrivateCall_GetSyntaxNodes:
+            return (pointer != nullptr) ? reinterpret_cast<void*>(static_cast<intptr_t>(_syntaxTree.CopyTo(*static_cast<SyntaxNodeRange*>(pointer)))) : nullptr;
+        case PrivateCall_FindSyntaxNode:
+            return reinterpret_cast<void*>(static_cast<intptr_t>(_syntaxTree.FindNode(static_cast<int>(reinterpret_cast<intptr_t>(pointer)))));
+        case PrivateCall_GetOutlineCount:
+            return reinterpret_cast<void*>(static_cast<intptr_t>(_outline.Count()));
+        case PrivateCall_GetOutline:
+            return (pointer != nullptr) ? reinterpret_cast<void*>(static_cast<intptr_t>(_outline.CopyTo(*static_cast<OutlineRange*>(pointer), _syntaxTree))) : nullptr;
+        case PrivateCall_FindOutlineEntry:
+            return reinterpret_cast<void*>(static_cast<intptr_t>(_outline.FindEntry(static_cast<int>(reinterpret_cast<intptr_t>(pointer)), _syntaxTree)));
+        case PrivateCall_FindMatchingBracket:
+            return reinterpret_cast<void*>(static_cast<intptr_t>(_brackets.FindMatch(static_cast<int>(reinterpret_cast<intptr_t>(pointer)))));
+        case PrivateCall_FindEnclosingBracket:
+            return reinterpret_cast<void*>(static_cast<intptr_t>(_brackets.FindEnclosing(static_cast<int>(reinterpret_cast<intptr_t>(pointer)))));
+        case PrivateCall_FindTopLevelSyntaxNode:
+            return reinterpret_cast<void*>(static_cast<intptr_t>(_syntaxTree.FindTopLevelNode(static_cast<int>(reinterpret_cast<intptr_t>(pointer)))));
+        default:
+            return nullptr;
+        }
+    }
     
+    void RTextLexer::CollectOutline(IDocument* pAccess, std::vector<OutlineEntry> & entries, std::vector<OutlineReference> & references)
+    {
+        RTextLexer aLexer;
+        aLexer.Lex(0, pAccess->Length(), TokenType_Default, pAccess);
+        entries.resize(aLexer._outline.Count());
+        OutlineRange const aRange = { 0, aLexer._outline.Count(), entries.empty() ? nullptr : &entries[0] };
+        aLexer._outline.CopyTo(aRange, aLexer._syntaxTree);
+        references.clear();
+        for (int i = 0; i < aLexer._syntaxTree.Count(); ++i)
+        {
+            SyntaxNode const & aNode = aLexer._syntaxTree.Node(i);
+            if (aNode.kind == SyntaxNodeKind_Reference)
+            {
+                OutlineReference const aReference = { aNode.position, aNode.length, pAccess->LineFromPosition(aNode.position), aLexer._outline.FindEntry(aNode.position, aLexer._syntaxTree) };
+                references.push_back(aReference);
+            }
+        }
+    }
+
+    void RTextLexer::CollectDiagnostics(IDocument* pAccess, std::vector<std::pair<int, int>> const & ranges, std::vector<Diagnostic> & diagnostics)
+    {
+        RTextLexer aLexer;
+        aLexer.Lex(0, pAccess->Length(), TokenType_Default, pAccess);
+        aLexer.Fold(0, pAccess->Length(), TokenType_Default, pAccess);
+        for (auto const & aRange : ranges)
+        {
+            int const aStart     = pAccess->LineStart(pAccess->LineFromPosition(aRange.first));
+            int const aLength    = (std::min)(aRange.second, pAccess->Length()) - aStart;
+            int const aInitStyle = (aStart > 0) ? pAccess->StyleAt(aStart - 1) : static_cast<int>(TokenType_Default);
+            aLexer.Lex(aStart, aLength, aInitStyle, pAccess);
+            aLexer.Fold(aStart, aLength, aInitStyle, pAccess);
+        }
+        diagnostics.resize(aLexer._diagnostics.Count());
+        aLexer._diagnostics.CopyTo(diagnostics.empty() ? nullptr : &diagnostics[0], aLexer._diagnostics.Count());
+    }
+
     void SCI_METHOD RTextLexer::Lex(unsigned int startPos, int length, int initStyle, IDocument* pAccess)
     {
         Accessor styler(pAccess, nullptr);
         StyleContext context(startPos, length, initStyle, styler);
         unsigned int aTokenLength = 0;
         _firstTokenInLine = true;
+        bool const isDocumentEnd = (static_cast<int>(startPos) + length >= styler.Length());
+        //a template may continue from the previously lexed range, its diagnostic is reported at its start
+        int aTemplateStart = (MaskActive(initStyle) == TokenType_Template) ? FindTemplateStart(styler, startPos) : static_cast<int>(startPos);
+        _diagnostics.Invalidate((std::min)(static_cast<int>(startPos), aTemplateStart));
+        _brackets.Invalidate(startPos);
         while(context.More())
         {
             switch (context.state)
@@ -306,6 +432,7 @@ namespace RText
                 }
                 else if (context.Match('<'))
                 {
+                    aTemplateStart = context.currentPos;
                     context.SetState(TokenType_Template);
                 }
                 else if (IdentifyFloat(styler, context, aTokenLength))
@@ -346,11 +473,23 @@ namespace RText
                 else if (context.Match(',') || context.Match('{') || context.Match('}') || context.Match('[') || context.Match(']') || context.Match('\\'))
                 {
                     context.SetState(TokenType_Other);
+                    if (!context.Match(',') && !context.Match('\\'))
+                    {
+                        _brackets.Add(context.currentPos, static_cast<char>(context.ch));
+                    }
                     context.Forward();
                     context.SetState(TokenType_Default);
                 }
                 else
                 {
+                    if (context.Match('\'') || context.Match('\"'))
+                    {
+                        _diagnostics.Add(context.currentPos, LengthTillEndOfLine(styler, context.currentPos), DiagnosticKind_UnterminatedString);
+                    }
+                    else
+                    {
+                        _diagnostics.Add(context.currentPos, 1, DiagnosticKind_InvalidCharacter);
+                    }
                     context.SetState(TokenType_Error);
                     //don't care about this char/token
                     context.Forward();
@@ -379,12 +518,16 @@ namespace RText
                 context.SetState(TokenType_Default);
                 break;
             case TokenType_Template:
-                while (context.ch != '>')
+                while (context.More() && context.ch != '>')
                 {
                     context.Forward();
                 }
-                context.Forward();
-                context.SetState(TokenType_Default);
+                if (context.More())
+                {
+                    context.Forward();
+                    context.SetState(TokenType_Default);
+                }
+                //otherwise template continues in the next lexed range or is reported below
                 break;
             case TokenType_Notation:
             case TokenType_Comment:
@@ -399,7 +542,14 @@ namespace RText
                 break;
             }
         }
+        //checked after the loop, a range which is empty or starts at the end of the document skips the loop
+        if (context.state == TokenType_Template && isDocumentEnd)
+        {
+            _diagnostics.Add(aTemplateStart, context.currentPos - aTemplateStart, DiagnosticKind_UnterminatedTemplate);
+        }
         context.Complete();
+        _syntaxTree.Update(pAccess, startPos, startPos + length);
+        _outline.Update(pAccess, _syntaxTree);
     }
     
     void SCI_METHOD RTextLexer::Fold(unsigned int startPos, int length, int initStyle, IDocument* pAccess)
@@ -474,7 +624,14 @@ namespace RText
                 }
                 else if (ch == '}' || ch == ']')
                 {
-                    levelNext--;
+                    if (levelNext > SC_FOLDLEVELBASE)
+                    {
+                        levelNext--;
+                    }
+                    else
+                    {
+                        _diagnostics.Add(i, 1, DiagnosticKind_UnmatchedBracket);
+                    }
                 }
             }
 
@@ -503,6 +660,14 @@ namespace RText
                 }
             }
         }
+        if (static_cast<int>(endPos) >= styler.Length())
+        {
+            _diagnostics.Remove(DiagnosticKind_UnclosedBracket);
+            if (levelNext > SC_FOLDLEVELBASE)
+            {
+                ReportUnclosedBrackets(styler, levelNext - SC_FOLDLEVELBASE);
+            }
+        }
     }
 
 }    // namespace RText
@@ -9,13 +9,37 @@
 #include "LexerModule.h"
 #include "StyleContext.h"
 #include "CharacterSet.h"
+#include "Diagnostics.h"
+#include "TokenType.h"
+#include "SyntaxTree.h"
+#include "Outline.h"
+#include "BracketIndex.h"
 #include <string>
+#include <utility>
 
 namespace RText
 {
     class RTextLexer final : public ILexer
     {
     public:
+        /**
+         * \brief   Operations supported by PrivateCall, i.e. SCI_PRIVATELEXERCALL.
+         */
+        enum PrivateCallOperation
+        {
+            PrivateCall_GetDiagnosticsCount,    //!< Returns the number of local syntax diagnostics of the document.
+            PrivateCall_GetDiagnostics,         //!< Copies the diagnostics to the Diagnostic buffer pointed by the argument, which must hold at least GetDiagnosticsCount elements. Returns the number of copied diagnostics.
+            PrivateCall_GetSyntaxNodeCount,     //!< Returns the number of syntax tree nodes.
+            PrivateCall_GetSyntaxNodes,         //!< Copies the nodes requested by the SyntaxNodeRange pointed by the argument. Returns the number of copied nodes.
+            PrivateCall_FindSyntaxNode,         //!< Returns the index of the innermost syntax node containing the position passed as argument.
+            PrivateCall_GetOutlineCount,        //!< Returns the number of elements in the document outline.
+            PrivateCall_GetOutline,             //!< Copies the outline entries requested by the OutlineRange pointed by the argument. Returns the number of copied entries.
+            PrivateCall_FindOutlineEntry,       //!< Returns the index of the outline entry of the innermost element containing the position passed as argument.
+            PrivateCall_FindMatchingBracket,    //!< Returns the position of the bracket matching the bracket at the position passed as argument, -1 if there is none.
+            PrivateCall_FindEnclosingBracket,   //!< Returns the position of the innermost opening bracket enclosing the position passed as argument, -1 if there is none.
+            PrivateCall_FindTopLevelSyntaxNode  //!< Returns the index of the top level syntax node starting last at or before the position passed as argument, -1 if there is none.
+        };
+
         virtual ~RTextLexer();
         
         /**
@@ -24,6 +48,26 @@ namespace RText
          * \return  null if it fails, else an ILexer*.
          */
         static ILexer* LexerFactory();
+
+        /**
+         * \brief   Lexes a complete document which is not shown in scintilla, e.g. a workspace file, and collects its outline
+         *          and all references.
+         *
+         * \param [in,out]  pAccess     The document.
+         * \param [out]     entries     The outline of the document, in document order.
+         * \param [out]     references  The references of the document, in document order.
+         */
+        static void CollectOutline(IDocument* pAccess, std::vector<OutlineEntry> & entries, std::vector<OutlineReference> & references);
+
+        /**
+         * \brief   Lexes a complete document, then lexes and folds it again from the start of the line of each given
+         *          range till the end of that range, the way scintilla does after edits, and collects the diagnostics.
+         *
+         * \param [in,out]  pAccess     The document.
+         * \param   ranges              Start and end positions of the ranges lexed again, in the order they are lexed.
+         * \param [out]     diagnostics The diagnostics, ordered by position.
+         */
+        static void CollectDiagnostics(IDocument* pAccess, std::vector<std::pair<int, int>> const & ranges, std::vector<Diagnostic> & diagnostics);
         
         virtual void SCI_METHOD Release();
         
@@ -53,27 +97,12 @@ namespace RText
     private:
         static const std::string BOOLEAN_TRUE;        
         static const std::string BOOLEAN_FALSE;
-        
-        enum TokenType
-        {
-            TokenType_Default,
-            TokenType_Comment,
-            TokenType_Notation,
-            TokenType_Reference,
-            TokenType_Float,
-            TokenType_Integer,
-            TokenType_Quoted_string,
-            TokenType_Boolean,
-            TokenType_Label,
-            TokenType_Command,
-            TokenType_Identifier,
-            TokenType_Template,
-            TokenType_Space,
-            TokenType_Other,
-            TokenType_Error
-        };
 
         bool _firstTokenInLine;
+        DiagnosticList _diagnostics;    //!< Local syntax diagnostics of the lexed document.
+        SyntaxTree _syntaxTree;         //!< Syntax tree of the lexed part of the document.
+        Outline _outline;               //!< Element outline of the lexed part of the document.
+        BracketIndex _brackets;         //!< Structural brackets of the lexed part of the document.
         
         /**
          * \brief   Query if end of line is reached.
@@ -165,6 +194,34 @@ namespace RText
         void IgnoreWhitespace(int startPos, char const * const buffer)const;
     
         int MaskActive(int const style)const;
+
+        /**
+         * \brief   Gets the length of the range starting at position till the end of its line.
+         *
+         * \param [in,out]  accessor    The accessor.
+         * \param   position            The start position.
+         *
+         * \return  The length, excluding line end characters.
+         */
+        int LengthTillEndOfLine(Accessor & accessor, int position)const;
+
+        /**
+         * \brief   Finds the start of a template which continues from a previously lexed range.
+         *
+         * \param [in,out]  accessor    The accessor.
+         * \param   position            The position from which the template continues.
+         *
+         * \return  The position of the template opening character.
+         */
+        int FindTemplateStart(Accessor & accessor, int position)const;
+
+        /**
+         * \brief   Reports the opening brackets which are never closed, scanning backwards from the end of the document.
+         *
+         * \param [in,out]  styler  The styler.
+         * \param   unclosedCount   The number of unclosed brackets at the end of the document.
+         */
+        void ReportUnclosedBrackets(LexAccessor & styler, int unclosedCount);
     };
 
     inline bool RTextLexer::IsHex(int c)const
@@ -224,11 +281,6 @@ namespace RText
         return new RTextLexer();
     }
 
-    inline void* SCI_METHOD RTextLexer::PrivateCall(int, void*)
-    {
-        return nullptr;
-    }
-
     inline bool RTextLexer::IsWhitespace(StyleContext const & context)const
     {
         return (!context.atLineEnd && context.Match(' ') || context.Match('\t'));
@@ -0,0 +1,74 @@
+#include "Outline.h"
+#include <algorithm>
+
+namespace RText
+{
+    void Outline::Update(IDocument* pAccess, SyntaxTree const & tree)
+    {
+        int const aFirstChanged = tree.FirstChangedNode();
+        auto aFirstObsolete     = std::lower_bound(_entries.begin(), _entries.end(), aFirstChanged, [](OutlineEntry const & e, int n) { return e.node < n; });
+        _entries.erase(aFirstObsolete, _entries.end());
+        for (int i = aFirstChanged; i < tree.Count(); ++i)
+        {
+            SyntaxNode const & aNode = tree.Node(i);
+            if (aNode.kind != SyntaxNodeKind_Element)
+            {
+                continue;
+            }
+            OutlineEntry aEntry  = { aNode.position, -1, 0, -1, 0, pAccess->LineFromPosition(aNode.position), 0, -1, i };
+            //command and name are the first children of an element, see SyntaxTree::ParseElement
+            if (i + 1 < tree.Count() && tree.Node(i + 1).kind == SyntaxNodeKind_Command && tree.Node(i + 1).parent == i)
+            {
+                aEntry.commandLength = tree.Node(i + 1).length;
+            }
+            if (i + 2 < tree.Count() && tree.Node(i + 2).kind == SyntaxNodeKind_Name && tree.Node(i + 2).parent == i)
+            {
+                aEntry.namePosition = tree.Node(i + 2).position;
+                aEntry.nameLength   = tree.Node(i + 2).length;
+            }
+            //enclosing element, if any, precedes this one and is already in the outline
+            int aParent = aNode.parent;
+            while (aParent > 0 && tree.Node(aParent).kind != SyntaxNodeKind_Element)
+            {
+                aParent = tree.Node(aParent).parent;
+            }
+            if (aParent > 0)
+            {
+                aEntry.parent = FindEntryOfNode(aParent);
+                aEntry.depth  = (aEntry.parent >= 0) ? _entries[aEntry.parent].depth + 1 : 0;
+            }
+            _entries.push_back(aEntry);
+        }
+    }
+
+    int Outline::CopyTo(OutlineRange const & range, SyntaxTree const & tree) const
+    {
+        if (range.buffer == nullptr || range.first < 0 || range.first >= Count() || range.count <= 0)
+        {
+            return 0;
+        }
+        int const aCount = (std::min)(range.count, Count() - range.first);
+        for (int i = 0; i < aCount; ++i)
+        {
+            range.buffer[i]        = _entries[range.first + i];
+            range.buffer[i].length = tree.Node(range.buffer[i].node).length;
+        }
+        return aCount;
+    }
+
+    int Outline::FindEntry(int position, SyntaxTree const & tree) const
+    {
+        int aNode = tree.FindNode(position);
+        while (aNode > 0 && tree.Node(aNode).kind != SyntaxNodeKind_Element)
+        {
+            aNode = tree.Node(aNode).parent;
+        }
+        return (aNode > 0) ? FindEntryOfNode(aNode) : -1;
+    }
+
+    int Outline::FindEntryOfNode(int node) const
+    {
+        auto aEntry = std::lower_bound(_entries.begin(), _entries.end(), node, [](OutlineEntry const & e, int n) { return e.node < n; });
+        return (aEntry != _entries.end() && aEntry->node == node) ? static_cast<int>(aEntry - _entries.begin()) : -1;
+    }
+} // namespace RText
@@ -0,0 +1,99 @@
+#ifndef RTEXTLEXER_OUTLINE_H__
+#define RTEXTLEXER_OUTLINE_H__
+
+#include "SyntaxTree.h"
+#include <vector>
+
+namespace RText
+{
+    /**
+     * \brief   An element of the document outline. Layout is shared with the plug-in, see RTextNppPlugin.Scintilla.OutlineEntry.
+     */
+    struct OutlineEntry
+    {
+        int position;           //!< Document position of the element, i.e. of its command.
+        int length;             //!< Length of the element including its child block, -1 if the element is not closed yet.
+        int commandLength;      //!< Length of the command.
+        int namePosition;       //!< Document position of the element name, -1 if the element has no name.
+        int nameLength;         //!< Length of the element name, including quotes for quoted names.
+        int line;               //!< Zero based line of the element.
+        int depth;              //!< Nesting depth, 0 for top level elements.
+        int parent;             //!< Index of the enclosing outline entry, -1 for top level elements.
+        int node;               //!< Index of the element in the syntax tree.
+    };
+
+    /**
+     * \brief   A reference of a document which is not shown in scintilla, see RTextLexer::CollectOutline.
+     */
+    struct OutlineReference
+    {
+        int position;           //!< Document position of the reference.
+        int length;             //!< Length of the reference.
+        int line;               //!< Zero based line of the reference.
+        int entry;              //!< Index of the innermost outline entry containing the reference, -1 if there is none.
+    };
+
+    /**
+     * \brief   Arguments of an outline range query.
+     */
+    struct OutlineRange
+    {
+        int first;              //!< Index of the first requested entry.
+        int count;              //!< Number of requested entries, i.e. capacity of buffer.
+        OutlineEntry* buffer;   //!< Caller supplied buffer.
+    };
+
+    /**
+     * \brief   Flat outline of the elements of an RText document, in document order.
+     *
+     *          The outline follows the syntax tree. Entries of nodes which were kept by the last tree update are kept as
+     *          well, entries are only created for new element nodes. Element lengths change while the tree is being
+     *          completed, so they are read from the tree on every query.
+     */
+    class Outline
+    {
+    public:
+        /**
+         * \brief   Updates the outline after the syntax tree was updated.
+         *
+         * \param [in,out]  pAccess     The document.
+         * \param   tree                The updated syntax tree.
+         */
+        void Update(IDocument* pAccess, SyntaxTree const & tree);
+
+        /**
+         * \brief   Gets the number of entries.
+         */
+        int Count() const;
+
+        /**
+         * \brief   Copies a range of entries into a caller supplied buffer.
+         *
+         * \param   range   The requested range.
+         * \param   tree    The syntax tree the outline was built from.
+         *
+         * \return  The number of copied entries.
+         */
+        int CopyTo(OutlineRange const & range, SyntaxTree const & tree) const;
+
+        /**
+         * \brief   Finds the innermost element containing a position.
+         *
+         * \param   position    The document position.
+         * \param   tree        The syntax tree the outline was built from.
+         *
+         * \return  The index of the entry, -1 if position is not inside any element.
+         */
+        int FindEntry(int position, SyntaxTree const & tree) const;
+    private:
+        std::vector<OutlineEntry> _entries; //!< Entries ordered by position, hence by syntax tree node.
+
+        int FindEntryOfNode(int node) const;
+    };
+
+    inline int Outline::Count() const
+    {
+        return static_cast<int>(_entries.size());
+    }
+} // namespace RText
+#endif // ifndef RTEXTLEXER_OUTLINE_H__
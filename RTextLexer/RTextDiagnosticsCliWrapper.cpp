@@ -0,0 +1,32 @@
+#include "RTextDiagnosticsCliWrapper.h"
+#include "TextDocument.h"
+namespace RTextNppPlugin
+{
+    array<RTextLexerDiagnostic>^ RTextDiagnosticsCliWrapper::GetDiagnostics(array<Byte>^ content, array<int>^ relexFrom, array<int>^ relexTo)
+    {
+        if (relexFrom->Length != relexTo->Length)
+        {
+            throw gcnew ArgumentException("Every relexed range needs a start and an end position.", "relexTo");
+        }
+        std::vector<Diagnostic> aDiagnostics;
+        if (content->Length > 0)
+        {
+            std::vector<std::pair<int, int>> aRanges;
+            for (int i = 0; i < relexFrom->Length; ++i)
+            {
+                aRanges.push_back(std::make_pair(relexFrom[i], relexTo[i]));
+            }
+            pin_ptr<Byte> aPinned = &content[0];
+            TextDocument aDocument(reinterpret_cast<char const *>(aPinned), content->Length);
+            RTextLexer::CollectDiagnostics(&aDocument, aRanges, aDiagnostics);
+        }
+        auto aResult = gcnew array<RTextLexerDiagnostic>(static_cast<int>(aDiagnostics.size()));
+        for (int i = 0; i < aResult->Length; ++i)
+        {
+            aResult[i].Position = aDiagnostics[i].position;
+            aResult[i].Length   = aDiagnostics[i].length;
+            aResult[i].Kind     = aDiagnostics[i].kind;
+        }
+        return aResult;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "Lexer.h"
+namespace RTextNppPlugin
+{
+    using namespace RText;
+    using namespace System;
+
+    /**
+     * \brief   A local syntax diagnostic of the RText lexer, see RText::Diagnostic.
+     */
+    public value struct RTextLexerDiagnostic
+    {
+        int Position;   //!< Document position of the first offending character.
+        int Length;     //!< Length of the offending range.
+        int Kind;       //!< One of RText::DiagnosticKind.
+    };
+
+    /**
+     * \brief   Lexes RText content outside of scintilla and relexes parts of it the way scintilla does after edits, so
+     *          that the diagnostics of incremental lexing can be compared with those of lexing the whole content.
+     */
+    public ref class RTextDiagnosticsCliWrapper abstract sealed
+    {
+    public:
+        /**
+         * \brief   Gets the diagnostics of the content after it was lexed and some of its ranges were lexed again.
+         *
+         * \param   content     The UTF-8 encoded content.
+         * \param   relexFrom   Start positions of the ranges lexed again, each range starts at the start of its line.
+         * \param   relexTo     End positions of the ranges lexed again.
+         *
+         * \return  The diagnostics, ordered by position.
+         */
+        static array<RTextLexerDiagnostic>^ GetDiagnostics(array<Byte>^ content, array<int>^ relexFrom, array<int>^ relexTo);
+    };
+}
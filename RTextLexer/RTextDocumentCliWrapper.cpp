@@ -0,0 +1,134 @@
+#include "RTextDocumentCliWrapper.h"
+namespace RTextNppPlugin
+{
+    RTextDocumentCliWrapper::RTextDocumentCliWrapper(array<Byte>^ content)
+    {
+        _lexer    = RTextLexer::LexerFactory();
+        _text     = new std::vector<char>(content->Length);
+        if (content->Length > 0)
+        {
+            Runtime::InteropServices::Marshal::Copy(content, 0, IntPtr(&(*_text)[0]), content->Length);
+        }
+        _document = new TextDocument(_text->empty() ? nullptr : &(*_text)[0], static_cast<int>(_text->size()));
+    }
+
+    RTextDocumentCliWrapper::~RTextDocumentCliWrapper()
+    {
+        this->!RTextDocumentCliWrapper();
+    }
+
+    RTextDocumentCliWrapper::!RTextDocumentCliWrapper()
+    {
+        if (_lexer != nullptr)
+        {
+            _lexer->Release();
+            _lexer = nullptr;
+        }
+        delete _document;
+        _document = nullptr;
+        delete _text;
+        _text = nullptr;
+    }
+
+    void RTextDocumentCliWrapper::Lex(int startPos, int endPos)
+    {
+        int const aStart     = _document->LineStart(_document->LineFromPosition(startPos));
+        int const aLength    = (std::min)(endPos, _document->Length()) - aStart;
+        int const aInitStyle = (aStart > 0) ? _document->StyleAt(aStart - 1) : static_cast<int>(TokenType_Default);
+        _lexer->Lex(aStart, aLength, aInitStyle, _document);
+        _lexer->Fold(aStart, aLength, aInitStyle, _document);
+    }
+
+    void RTextDocumentCliWrapper::Edit(array<Byte>^ content, int position)
+    {
+        auto aText = new std::vector<char>(content->Length);
+        if (content->Length > 0)
+        {
+            Runtime::InteropServices::Marshal::Copy(content, 0, IntPtr(&(*aText)[0]), content->Length);
+        }
+        auto aDocument   = new TextDocument(aText->empty() ? nullptr : &(*aText)[0], static_cast<int>(aText->size()));
+        int const aLine  = aDocument->LineFromPosition(position);
+        int const aStart = aDocument->LineStart(aLine);
+        std::vector<char> aStyles(aStart);
+        for (int i = 0; i < aStart; ++i)
+        {
+            aStyles[i] = _document->StyleAt(i);
+        }
+        aDocument->StartStyling(0, static_cast<char>(0xff));
+        aDocument->SetStyles(aStart, aStyles.empty() ? nullptr : &aStyles[0]);
+        for (int i = 0; i < aLine; ++i)
+        {
+            aDocument->SetLevel(i, _document->GetLevel(i));
+        }
+        delete _document;
+        delete _text;
+        _document = aDocument;
+        _text     = aText;
+    }
+
+    array<RTextLexerSyntaxNode>^ RTextDocumentCliWrapper::GetSyntaxNodes()
+    {
+        std::vector<SyntaxNode> aNodes(PrivateCall(RTextLexer::PrivateCall_GetSyntaxNodeCount, nullptr));
+        SyntaxNodeRange aRange = { 0, static_cast<int>(aNodes.size()), aNodes.empty() ? nullptr : &aNodes[0] };
+        aNodes.resize(PrivateCall(RTextLexer::PrivateCall_GetSyntaxNodes, &aRange));
+        auto aResult = gcnew array<RTextLexerSyntaxNode>(static_cast<int>(aNodes.size()));
+        for (int i = 0; i < aResult->Length; ++i)
+        {
+            aResult[i].Kind     = aNodes[i].kind;
+            aResult[i].Parent   = aNodes[i].parent;
+            aResult[i].Position = aNodes[i].position;
+            aResult[i].Length   = aNodes[i].length;
+            aResult[i].End      = aNodes[i].end;
+        }
+        return aResult;
+    }
+
+    int RTextDocumentCliWrapper::FindSyntaxNode(int position)
+    {
+        return PrivateCall(RTextLexer::PrivateCall_FindSyntaxNode, reinterpret_cast<void*>(static_cast<intptr_t>(position)));
+    }
+
+    int RTextDocumentCliWrapper::FindTopLevelSyntaxNode(int position)
+    {
+        return PrivateCall(RTextLexer::PrivateCall_FindTopLevelSyntaxNode, reinterpret_cast<void*>(static_cast<intptr_t>(position)));
+    }
+
+    array<RTextLexerOutlineEntry>^ RTextDocumentCliWrapper::GetOutline()
+    {
+        std::vector<OutlineEntry> aEntries(PrivateCall(RTextLexer::PrivateCall_GetOutlineCount, nullptr));
+        OutlineRange aRange = { 0, static_cast<int>(aEntries.size()), aEntries.empty() ? nullptr : &aEntries[0] };
+        aEntries.resize(PrivateCall(RTextLexer::PrivateCall_GetOutline, &aRange));
+        auto aResult = gcnew array<RTextLexerOutlineEntry>(static_cast<int>(aEntries.size()));
+        for (int i = 0; i < aResult->Length; ++i)
+        {
+            aResult[i].Position     = aEntries[i].position;
+            aResult[i].Length       = aEntries[i].length;
+            aResult[i].NamePosition = aEntries[i].namePosition;
+            aResult[i].NameLength   = aEntries[i].nameLength;
+            aResult[i].Line         = aEntries[i].line;
+            aResult[i].Depth        = aEntries[i].depth;
+            aResult[i].Parent       = aEntries[i].parent;
+        }
+        return aResult;
+    }
+
+    int RTextDocumentCliWrapper::FindOutlineEntry(int position)
+    {
+        return PrivateCall(RTextLexer::PrivateCall_FindOutlineEntry, reinterpret_cast<void*>(static_cast<intptr_t>(position)));
+    }
+
+    int RTextDocumentCliWrapper::FindMatchingBracket(int position)
+    {
+        return PrivateCall(RTextLexer::PrivateCall_FindMatchingBracket, reinterpret_cast<void*>(static_cast<intptr_t>(position)));
+    }
+
+    int RTextDocumentCliWrapper::FindEnclosingBracket(int position)
+    {
+        return PrivateCall(RTextLexer::PrivateCall_FindEnclosingBracket, reinterpret_cast<void*>(static_cast<intptr_t>(position)));
+    }
+
+    int RTextDocumentCliWrapper::PrivateCall(int operation, void* pointer)
+    {
+        return static_cast<int>(reinterpret_cast<intptr_t>(_lexer->PrivateCall(operation, pointer)));
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include "Lexer.h"
+#include "TextDocument.h"
+namespace RTextNppPlugin
+{
+    using namespace RText;
+    using namespace System;
+
+    /**
+     * \brief   A node of the syntax tree of the RText lexer, see RText::SyntaxNode.
+     */
+    public value struct RTextLexerSyntaxNode
+    {
+        int Kind;       //!< One of RText::SyntaxNodeKind.
+        int Parent;     //!< Index of the parent node, -1 for the document node.
+        int Position;   //!< Document position of the first token of the node.
+        int Length;     //!< Length of the node, -1 if the node is not closed yet.
+        int End;        //!< Index after the last descendant of the node, -1 if the node is not closed yet.
+    };
+
+    /**
+     * \brief   An entry of the outline of the RText lexer, see RText::OutlineEntry.
+     */
+    public value struct RTextLexerOutlineEntry
+    {
+        int Position;       //!< Document position of the element, i.e. of its command.
+        int Length;         //!< Length of the element including its child block, -1 if the element is not closed yet.
+        int NamePosition;   //!< Document position of the element name, -1 if the element has no name.
+        int NameLength;     //!< Length of the element name, including quotes for quoted names.
+        int Line;           //!< Zero based line of the element.
+        int Depth;          //!< Nesting depth, 0 for top level elements.
+        int Parent;         //!< Index of the enclosing entry, -1 for top level elements.
+    };
+
+    /**
+     * \brief   RText content which is lexed outside of scintilla the way scintilla lexes it: every range is lexed from the
+     *          start of its line, and edits keep the styles and fold levels before the edited line. The lexer is queried
+     *          through its private calls, like the plug-in does, so that the state of incremental lexing can be compared
+     *          with the state of lexing the whole content.
+     */
+    public ref class RTextDocumentCliWrapper
+    {
+    public:
+        /**
+         * \brief   Constructor. Nothing is lexed yet.
+         *
+         * \param   content The UTF-8 encoded content.
+         */
+        RTextDocumentCliWrapper(array<Byte>^ content);
+
+        ~RTextDocumentCliWrapper();
+
+        !RTextDocumentCliWrapper();
+
+        /**
+         * \brief   Lexes and folds a range of the content.
+         *
+         * \param   startPos    The start of the range, lexing starts at the start of its line.
+         * \param   endPos      The end of the range.
+         */
+        void Lex(int startPos, int endPos);
+
+        /**
+         * \brief   Replaces the content after an edit. The styles and fold levels before the line of the edit are kept,
+         *          the rest is lexed again by the next call of Lex.
+         *
+         * \param   content     The UTF-8 encoded content after the edit.
+         * \param   position    The position of the edit.
+         */
+        void Edit(array<Byte>^ content, int position);
+
+        /**
+         * \brief   Gets the nodes of the syntax tree, in preorder.
+         */
+        array<RTextLexerSyntaxNode>^ GetSyntaxNodes();
+
+        /**
+         * \brief   Finds the innermost syntax tree node containing a position.
+         *
+         * \return  The index of the node, -1 if nothing was lexed.
+         */
+        int FindSyntaxNode(int position);
+
+        /**
+         * \brief   Finds the top level syntax tree node starting last at or before a position.
+         *
+         * \return  The index of the node, -1 if there is none.
+         */
+        int FindTopLevelSyntaxNode(int position);
+
+        /**
+         * \brief   Gets the outline of the lexed part of the content, in document order.
+         */
+        array<RTextLexerOutlineEntry>^ GetOutline();
+
+        /**
+         * \brief   Finds the outline entry of the innermost element containing a position.
+         *
+         * \return  The index of the entry, -1 if position is not inside any element.
+         */
+        int FindOutlineEntry(int position);
+
+        /**
+         * \brief   Finds the structural bracket matching the bracket at a position.
+         *
+         * \return  The position of the matching bracket, -1 if there is no bracket at position or it is unmatched.
+         */
+        int FindMatchingBracket(int position);
+
+        /**
+         * \brief   Finds the innermost structural opening bracket enclosing a position.
+         *
+         * \return  The position of the opening bracket, -1 if position is at top level.
+         */
+        int FindEnclosingBracket(int position);
+    private:
+        ILexer* _lexer;             //!< The lexer, holds the state of the lexed content.
+        std::vector<char>* _text;   //!< The content.
+        TextDocument* _document;    //!< Document of the content, holds its styles and fold levels.
+
+        int PrivateCall(int operation, void* pointer);
+    };
+}
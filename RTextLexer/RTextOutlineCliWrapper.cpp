@@ -0,0 +1,63 @@
+#include "RTextOutlineCliWrapper.h"
+#include "TextDocument.h"
+namespace RTextNppPlugin
+{
+    array<RTextOutlineElement>^ RTextOutlineCliWrapper::GetOutline(array<Byte>^ content)
+    {
+        array<RTextOutlineReference>^ aReferences = nullptr;
+        return GetOutline(content, aReferences);
+    }
+
+    array<RTextOutlineElement>^ RTextOutlineCliWrapper::GetOutline(array<Byte>^ content, array<RTextOutlineReference>^% references)
+    {
+        if (content == nullptr || content->Length == 0)
+        {
+            references = gcnew array<RTextOutlineReference>(0);
+            return gcnew array<RTextOutlineElement>(0);
+        }
+        //the lexer would treat an UTF-8 byte order mark as invalid characters
+        int const aOffset = (content->Length >= 3 && content[0] == 0xEF && content[1] == 0xBB && content[2] == 0xBF) ? 3 : 0;
+        std::vector<OutlineEntry> aEntries;
+        std::vector<OutlineReference> aReferences;
+        if (content->Length > aOffset)
+        {
+            pin_ptr<Byte> aPinned = &content[aOffset];
+            TextDocument aDocument(reinterpret_cast<char const *>(aPinned), content->Length - aOffset);
+            RTextLexer::CollectOutline(&aDocument, aEntries, aReferences);
+        }
+        auto aElements = gcnew array<RTextOutlineElement>(static_cast<int>(aEntries.size()));
+        for (int i = 0; i < aElements->Length; ++i)
+        {
+            OutlineEntry const & aEntry = aEntries[i];
+            aElements[i].Command        = GetText(content, aEntry.position + aOffset, aEntry.commandLength);
+            aElements[i].Name           = GetText(content, (aEntry.namePosition < 0) ? -1 : aEntry.namePosition + aOffset, aEntry.nameLength);
+            aElements[i].Line           = aEntry.line;
+            aElements[i].Depth          = aEntry.depth;
+            aElements[i].Parent         = aEntry.parent;
+        }
+        references = gcnew array<RTextOutlineReference>(static_cast<int>(aReferences.size()));
+        for (int i = 0; i < references->Length; ++i)
+        {
+            OutlineReference const & aReference = aReferences[i];
+            references[i].Path                  = System::Text::Encoding::UTF8->GetString(content, aReference.position + aOffset, aReference.length);
+            references[i].Line                  = aReference.line;
+            references[i].Element               = aReference.entry;
+        }
+        return aElements;
+    }
+
+    String^ RTextOutlineCliWrapper::GetText(array<Byte>^ content, int position, int length)
+    {
+        if (position < 0 || length <= 0)
+        {
+            return String::Empty;
+        }
+        //quoted names are indexed without their quotes
+        if (length >= 2 && (content[position] == '"' || content[position] == '\'') && content[position + length - 1] == content[position])
+        {
+            ++position;
+            length -= 2;
+        }
+        return System::Text::Encoding::UTF8->GetString(content, position, length);
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "Lexer.h"
+namespace RTextNppPlugin
+{
+    using namespace RText;
+    using namespace System;
+
+    /**
+     * \brief   An element of the outline of a file which is not opened in scintilla.
+     */
+    public value struct RTextOutlineElement
+    {
+        String^ Command;    //!< The command of the element.
+        String^ Name;       //!< The name of the element without quotes, empty if the element has no name.
+        int Line;           //!< Zero based line of the element.
+        int Depth;          //!< Nesting depth, 0 for top level elements.
+        int Parent;         //!< Index of the enclosing element, -1 for top level elements.
+    };
+
+    /**
+     * \brief   A reference of a file which is not opened in scintilla.
+     */
+    public value struct RTextOutlineReference
+    {
+        String^ Path;       //!< The reference as written, e.g. /P1/UInt8.
+        int Line;           //!< Zero based line of the reference.
+        int Element;        //!< Index of the innermost element containing the reference, -1 if there is none.
+    };
+
+    /**
+     * \brief   Lexes RText files outside of scintilla with the RText lexer, so that the plug-in can index them.
+     *          Every call uses its own lexer instance, so calls may run concurrently.
+     */
+    public ref class RTextOutlineCliWrapper abstract sealed
+    {
+    public:
+        /**
+         * \brief   Gets the outline of the content of an RText file.
+         *
+         * \param   content The UTF-8 encoded content of the file.
+         *
+         * \return  The elements in document order.
+         */
+        static array<RTextOutlineElement>^ GetOutline(array<Byte>^ content);
+
+        /**
+         * \brief   Gets the outline and the references of the content of an RText file.
+         *
+         * \param   content             The UTF-8 encoded content of the file.
+         * \param [out]     references  The references in document order.
+         *
+         * \return  The elements in document order.
+         */
+        static array<RTextOutlineElement>^ GetOutline(array<Byte>^ content, [Runtime::InteropServices::Out] array<RTextOutlineReference>^% references);
+    private:
+        static String^ GetText(array<Byte>^ content, int position, int length);
+    };
+}
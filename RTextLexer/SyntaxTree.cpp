@@ -0,0 +1,461 @@
+#include "SyntaxTree.h"
+#include "TokenType.h"
+#include <algorithm>
+
+namespace RText
+{
+    SyntaxTree::SyntaxTree() : _document(nullptr), _buffer(nullptr), _position(0), _endPosition(0), _lastTokenEnd(0), _firstChangedNode(0), _atLineStart(true), _hasToken(false)
+    {
+    }
+
+    void SyntaxTree::Update(IDocument* pAccess, int startPos, int endPos)
+    {
+        _document    = pAccess;
+        _buffer      = pAccess->BufferPointer();
+        _endPosition = endPos;
+        if (_nodes.empty())
+        {
+            SyntaxNode const aDocument = { SyntaxNodeKind_Document, -1, 0, -1, -1 };
+            _nodes.push_back(aDocument);
+        }
+        //drop restart node and everything after it, reopen its ancestors
+        int const aRestart         = FindRestartNode(startPos);
+        int const aRestartPosition = (aRestart == 0) ? 0 : _nodes[aRestart].position;
+        int const aFirstContainer  = (aRestart == 0) ? 0 : _nodes[aRestart].parent;
+        _nodes.resize((aRestart == 0) ? 1 : aRestart);
+        _firstChangedNode = static_cast<int>(_nodes.size());
+        for (int i = aFirstContainer; i >= 0; i = _nodes[i].parent)
+        {
+            _nodes[i].length = -1;
+            _nodes[i].end    = -1;
+        }
+        _position     = aRestartPosition;
+        _lastTokenEnd = FindPreviousTokenEnd(aRestartPosition);
+        _atLineStart  = true;
+        _hasToken     = false;
+        //resume parsing in the children of each ancestor, innermost first
+        for (int i = aFirstContainer; i >= 0; i = _nodes[i].parent)
+        {
+            if (!ParseChildren(i))
+            {
+                break;
+            }
+        }
+        if (endPos >= pAccess->Length())
+        {
+            //nothing follows, close whatever is still open
+            for (int i = static_cast<int>(_nodes.size()) - 1; i >= 0; i = _nodes[i].parent)
+            {
+                if (_nodes[i].length < 0)
+                {
+                    Close(i, (i == 0) ? pAccess->Length() : _lastTokenEnd);
+                }
+            }
+        }
+        _document = nullptr;
+        _buffer   = nullptr;
+    }
+
+    int SyntaxTree::CopyTo(SyntaxNodeRange const & range) const
+    {
+        if (range.buffer == nullptr || range.first < 0 || range.first >= Count() || range.count <= 0)
+        {
+            return 0;
+        }
+        int const aCount = (std::min)(range.count, Count() - range.first);
+        std::copy(_nodes.begin() + range.first, _nodes.begin() + range.first + aCount, range.buffer);
+        return aCount;
+    }
+
+    int SyntaxTree::FindNode(int position) const
+    {
+        if (_nodes.empty())
+        {
+            return -1;
+        }
+        //last node starting at or before position, then up till a node containing position
+        auto aNext = std::upper_bound(_nodes.begin(), _nodes.end(), position, [](int p, SyntaxNode const & n) { return p < n.position; });
+        int aIndex = static_cast<int>(aNext - _nodes.begin()) - 1;
+        if (aIndex < 0)
+        {
+            return 0;
+        }
+        while (_nodes[aIndex].parent >= 0 && _nodes[aIndex].length >= 0 && position >= _nodes[aIndex].position + _nodes[aIndex].length)
+        {
+            aIndex = _nodes[aIndex].parent;
+        }
+        return aIndex;
+    }
+
+    int SyntaxTree::FindTopLevelNode(int position) const
+    {
+        auto aNext = std::upper_bound(_nodes.begin(), _nodes.end(), position, [](int p, SyntaxNode const & n) { return p < n.position; });
+        int aIndex = static_cast<int>(aNext - _nodes.begin()) - 1;
+        if (aIndex <= 0)
+        {
+            return -1;
+        }
+        //any later top level node would start after position, so the ancestor of the last node starting before is the one
+        while (_nodes[aIndex].parent > 0)
+        {
+            aIndex = _nodes[aIndex].parent;
+        }
+        return aIndex;
+    }
+
+    int SyntaxTree::FindRestartNode(int position) const
+    {
+        auto aNext = std::upper_bound(_nodes.begin(), _nodes.end(), position, [](int p, SyntaxNode const & n) { return p < n.position; });
+        int aIndex = static_cast<int>(aNext - _nodes.begin()) - 1;
+        //last element starting at or before position
+        while (aIndex > 0 && _nodes[aIndex].kind != SyntaxNodeKind_Element)
+        {
+            --aIndex;
+        }
+        if (aIndex <= 0)
+        {
+            return 0;
+        }
+        //an element may follow a child role label in the same line, restart from the label then
+        int const aLine = _document->LineFromPosition(_nodes[aIndex].position);
+        while (_nodes[aIndex].parent > 0)
+        {
+            SyntaxNode const & aParent = _nodes[_nodes[aIndex].parent];
+            if ((aParent.kind == SyntaxNodeKind_ChildRole || aParent.kind == SyntaxNodeKind_ChildRoleList) && _document->LineFromPosition(aParent.position) == aLine)
+            {
+                aIndex = _nodes[aIndex].parent;
+            }
+            else
+            {
+                break;
+            }
+        }
+        return aIndex;
+    }
+
+    int SyntaxTree::FindPreviousTokenEnd(int position) const
+    {
+        while (position > 0 && IsSkipped(StyleAt(position - 1)))
+        {
+            --position;
+        }
+        return position;
+    }
+
+    bool SyntaxTree::IsSkipped(int style) const
+    {
+        return (style == TokenType_Default || style == TokenType_Space || style == TokenType_Comment || style == TokenType_Notation);
+    }
+
+    int SyntaxTree::StyleAt(int position) const
+    {
+        return static_cast<unsigned char>(_document->StyleAt(position)) & ~0x40;
+    }
+
+    bool SyntaxTree::Peek()
+    {
+        if (_hasToken)
+        {
+            return true;
+        }
+        bool aIsFirstInLine = _atLineStart;
+        while (_position < _endPosition)
+        {
+            int const aStyle = StyleAt(_position);
+            char const aChar = _buffer[_position];
+            if (IsSkipped(aStyle))
+            {
+                if (aChar == '\n')
+                {
+                    aIsFirstInLine = true;
+                }
+                ++_position;
+                continue;
+            }
+            _token.position = _position++;
+            //brackets and separators are single character tokens
+            while (aStyle != TokenType_Other && _position < _endPosition && StyleAt(_position) == aStyle)
+            {
+                ++_position;
+            }
+            _token.length        = _position - _token.position;
+            _token.style         = aStyle;
+            _token.ch            = aChar;
+            _token.isFirstInLine = aIsFirstInLine;
+            _atLineStart         = false;
+            _hasToken            = true;
+            return true;
+        }
+        _atLineStart = aIsFirstInLine;
+        return false;
+    }
+
+    void SyntaxTree::Consume()
+    {
+        _lastTokenEnd = _token.position + _token.length;
+        _hasToken     = false;
+    }
+
+    int SyntaxTree::Open(SyntaxNodeKind kind, int parent, int position)
+    {
+        SyntaxNode const aNode = { kind, parent, position, -1, -1 };
+        _nodes.push_back(aNode);
+        return static_cast<int>(_nodes.size()) - 1;
+    }
+
+    void SyntaxTree::Close(int index, int endPosition)
+    {
+        _nodes[index].length = endPosition - _nodes[index].position;
+        _nodes[index].end    = static_cast<int>(_nodes.size());
+    }
+
+    void SyntaxTree::AddLeaf(SyntaxNodeKind kind, int parent)
+    {
+        Close(Open(kind, parent, _token.position), _token.position + _token.length);
+        Consume();
+    }
+
+    SyntaxNodeKind SyntaxTree::ValueKind(int style) const
+    {
+        switch (style)
+        {
+        case TokenType_Reference:
+            return SyntaxNodeKind_Reference;
+        case TokenType_Error:
+        case TokenType_Label:
+        case TokenType_Other:
+            return SyntaxNodeKind_Error;
+        default:
+            return SyntaxNodeKind_Value;
+        }
+    }
+
+    bool SyntaxTree::ParseChildren(int container)
+    {
+        if (_nodes[container].kind == SyntaxNodeKind_ChildRole)
+        {
+            //single child role is complete once its element is
+            Close(container, _lastTokenEnd);
+            return true;
+        }
+        while (Peek())
+        {
+            if (_token.style == TokenType_Other && (_token.ch == '}' || _token.ch == ']'))
+            {
+                int const aKind = _nodes[container].kind;
+                if ((_token.ch == '}' && aKind == SyntaxNodeKind_Element) || (_token.ch == ']' && aKind == SyntaxNodeKind_ChildRoleList))
+                {
+                    Consume();
+                    Close(container, _lastTokenEnd);
+                    return true;
+                }
+                if (_token.ch == '}' && aKind == SyntaxNodeKind_ChildRoleList)
+                {
+                    //missing ']', let the enclosing element consume its '}'
+                    Close(container, _lastTokenEnd);
+                    return true;
+                }
+                ParseErrorLine(container);
+            }
+            else if (!_token.isFirstInLine)
+            {
+                ParseErrorLine(container);
+            }
+            else if (_token.style == TokenType_Command)
+            {
+                if (!ParseElement(container))
+                {
+                    return false;
+                }
+            }
+            else if (_token.style == TokenType_Label)
+            {
+                if (!ParseChildRole(container))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                ParseErrorLine(container);
+            }
+        }
+        return false;
+    }
+
+    bool SyntaxTree::ParseElement(int parent)
+    {
+        int const aElement = Open(SyntaxNodeKind_Element, parent, _token.position);
+        AddLeaf(SyntaxNodeKind_Command, aElement);
+        bool aIsNameExpected = true;
+        bool aIsContinued    = false;
+        while (Peek())
+        {
+            if (_token.isFirstInLine && !aIsContinued)
+            {
+                Close(aElement, _lastTokenEnd);
+                return true;
+            }
+            aIsContinued = false;
+            if (_token.style == TokenType_Other)
+            {
+                switch (_token.ch)
+                {
+                case ',':
+                    aIsNameExpected = false;
+                    aIsContinued    = true;
+                    Consume();
+                    break;
+                case '\\':
+                    aIsContinued = true;
+                    Consume();
+                    break;
+                case '[':
+                    aIsNameExpected = false;
+                    if (!ParseValueList(aElement))
+                    {
+                        return false;
+                    }
+                    break;
+                case '{':
+                    Consume();
+                    return ParseChildren(aElement);
+                default:
+                    //closing bracket of the parent
+                    Close(aElement, _lastTokenEnd);
+                    return true;
+                }
+            }
+            else if (_token.style == TokenType_Label)
+            {
+                aIsNameExpected = false;
+                if (!ParseFeature(aElement))
+                {
+                    return false;
+                }
+            }
+            else if (aIsNameExpected && (_token.style == TokenType_Identifier || _token.style == TokenType_Quoted_string))
+            {
+                aIsNameExpected = false;
+                AddLeaf(SyntaxNodeKind_Name, aElement);
+            }
+            else
+            {
+                aIsNameExpected = false;
+                AddLeaf(ValueKind(_token.style), aElement);
+            }
+        }
+        return false;
+    }
+
+    bool SyntaxTree::ParseFeature(int parent)
+    {
+        int const aFeature = Open(SyntaxNodeKind_Feature, parent, _token.position);
+        AddLeaf(SyntaxNodeKind_Label, aFeature);
+        if (!Peek())
+        {
+            return false;
+        }
+        if (!_token.isFirstInLine)
+        {
+            if (_token.style == TokenType_Other && _token.ch == '[')
+            {
+                if (!ParseValueList(aFeature))
+                {
+                    return false;
+                }
+            }
+            else if (_token.style != TokenType_Other && _token.style != TokenType_Label)
+            {
+                AddLeaf(ValueKind(_token.style), aFeature);
+            }
+        }
+        Close(aFeature, _lastTokenEnd);
+        return true;
+    }
+
+    bool SyntaxTree::ParseValueList(int parent)
+    {
+        int const aList = Open(SyntaxNodeKind_ValueList, parent, _token.position);
+        Consume();
+        while (Peek())
+        {
+            if (_token.style == TokenType_Other)
+            {
+                switch (_token.ch)
+                {
+                case ']':
+                    Consume();
+                    Close(aList, _lastTokenEnd);
+                    return true;
+                case ',':
+                case '\\':
+                    Consume();
+                    break;
+                case '[':
+                    AddLeaf(SyntaxNodeKind_Error, aList);
+                    break;
+                default:
+                    //missing ']'
+                    Close(aList, _lastTokenEnd);
+                    return true;
+                }
+            }
+            else if (_token.isFirstInLine && (_token.style == TokenType_Command || _token.style == TokenType_Label))
+            {
+                //missing ']', next element or child role starts
+                Close(aList, _lastTokenEnd);
+                return true;
+            }
+            else
+            {
+                AddLeaf(ValueKind(_token.style), aList);
+            }
+        }
+        return false;
+    }
+
+    bool SyntaxTree::ParseChildRole(int container)
+    {
+        int const aRole = Open(SyntaxNodeKind_ChildRole, container, _token.position);
+        AddLeaf(SyntaxNodeKind_Label, aRole);
+        if (!Peek())
+        {
+            return false;
+        }
+        if (!_token.isFirstInLine)
+        {
+            if (_token.style == TokenType_Other && _token.ch == '[')
+            {
+                _nodes[aRole].kind = SyntaxNodeKind_ChildRoleList;
+                Consume();
+                return ParseChildren(aRole);
+            }
+            //the lexer styles the command after a label as identifier
+            if (_token.style == TokenType_Command || _token.style == TokenType_Identifier)
+            {
+                if (!ParseElement(aRole))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                ParseErrorLine(aRole);
+            }
+        }
+        Close(aRole, _lastTokenEnd);
+        return true;
+    }
+
+    bool SyntaxTree::ParseErrorLine(int parent)
+    {
+        int const aError = Open(SyntaxNodeKind_Error, parent, _token.position);
+        do
+        {
+            Consume();
+        } while (Peek() && !_token.isFirstInLine);
+        Close(aError, _lastTokenEnd);
+        return _hasToken;
+    }
+} // namespace RText
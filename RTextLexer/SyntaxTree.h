@@ -0,0 +1,186 @@
+#ifndef RTEXTLEXER_SYNTAXTREE_H__
+#define RTEXTLEXER_SYNTAXTREE_H__
+
+#include "ILexer.h"
+#include <vector>
+
+namespace RText
+{
+    /**
+     * \brief   Kinds of syntax tree nodes. Values are shared with the plug-in, see RTextNppPlugin.Scintilla.SyntaxNodeKind.
+     */
+    enum SyntaxNodeKind
+    {
+        SyntaxNodeKind_Document,        //!< The root node, spans the whole document.
+        SyntaxNodeKind_Element,         //!< Command with its arguments and optional child block.
+        SyntaxNodeKind_Command,         //!< The command token of an element.
+        SyntaxNodeKind_Name,            //!< The first unlabelled identifier or string argument of an element.
+        SyntaxNodeKind_Feature,         //!< Labelled argument, i.e. label followed by a value or a value list.
+        SyntaxNodeKind_Label,           //!< The label token of a feature or a child role.
+        SyntaxNodeKind_Value,           //!< Any atomic value except references.
+        SyntaxNodeKind_Reference,       //!< Reference value, e.g. /P1/UInt8.
+        SyntaxNodeKind_ValueList,       //!< Values enclosed in '[' and ']'.
+        SyntaxNodeKind_ChildRole,       //!< Labelled single child element, i.e. label: Command ...
+        SyntaxNodeKind_ChildRoleList,   //!< Labelled list of child elements, i.e. label: [ ... ]
+        SyntaxNodeKind_Error            //!< Tokens which do not fit the RText grammar.
+    };
+
+    /**
+     * \brief   A node of the syntax tree. Layout is shared with the plug-in.
+     */
+    struct SyntaxNode
+    {
+        int kind;       //!< One of SyntaxNodeKind.
+        int parent;     //!< Index of the parent node, -1 for the document node.
+        int position;   //!< Document position of the first token of the node.
+        int length;     //!< Length of the node, -1 if the node is not closed yet, e.g. because the rest of the document isn't lexed.
+        int end;        //!< Index after the last descendant of the node, -1 if the node is not closed yet.
+    };
+
+    /**
+     * \brief   Arguments of a node range query.
+     */
+    struct SyntaxNodeRange
+    {
+        int first;              //!< Index of the first requested node.
+        int count;              //!< Number of requested nodes, i.e. capacity of buffer.
+        SyntaxNode* buffer;     //!< Caller supplied buffer.
+    };
+
+    /**
+     * \brief   Error tolerant, incremental syntax tree of an RText document, built from the styles assigned by the lexer.
+     *
+     *          Nodes are stored in preorder, so node positions are ascending and the subtree of node i is the index range
+     *          [i, end). After the document is lexed from some position, parsing resumes at the start of the last element
+     *          which begins before that position, with its ancestors reopened. Everything before it is kept.
+     */
+    class SyntaxTree
+    {
+    public:
+        SyntaxTree();
+
+        /**
+         * \brief   Updates the tree after the lexer has styled a range.
+         *
+         * \param [in,out]  pAccess     The document.
+         * \param   startPos            The start of the styled range. Must be at the start of a line.
+         * \param   endPos              The end of the styled range.
+         */
+        void Update(IDocument* pAccess, int startPos, int endPos);
+
+        /**
+         * \brief   Gets the number of nodes.
+         */
+        int Count() const;
+
+        /**
+         * \brief   Gets a node.
+         *
+         * \param   index   Zero-based index of the node.
+         */
+        SyntaxNode const & Node(int index) const;
+
+        /**
+         * \brief   Copies a range of nodes into a caller supplied buffer.
+         *
+         * \param   range   The requested range.
+         *
+         * \return  The number of copied nodes.
+         */
+        int CopyTo(SyntaxNodeRange const & range) const;
+
+        /**
+         * \brief   Finds the innermost node containing a position.
+         *
+         * \param   position    The document position.
+         *
+         * \return  The index of the node, -1 if the tree is empty.
+         */
+        int FindNode(int position) const;
+
+        /**
+         * \brief   Finds the top level node, i.e. a child of the document node, which starts last at or before a position.
+         *          It contains the position unless the position follows it, e.g. in a line continuing it.
+         *
+         * \param   position    The document position.
+         *
+         * \return  The index of the node, -1 if no top level node starts at or before position.
+         */
+        int FindTopLevelNode(int position) const;
+
+        /**
+         * \brief   Gets the index of the first node which was added by the last update. All nodes before it were kept,
+         *          although their length may have changed.
+         */
+        int FirstChangedNode() const;
+
+    private:
+        struct Token
+        {
+            int position;
+            int length;
+            int style;
+            char ch;            //!< First character of the token.
+            bool isFirstInLine; //!< Token is the first one in its line.
+        };
+
+        std::vector<SyntaxNode> _nodes;     //!< Nodes in preorder.
+        IDocument* _document;               //!< Document which is currently parsed.
+        char const * _buffer;               //!< Characters of the document.
+        int _position;                      //!< Position of the token reader.
+        int _endPosition;                   //!< End of the styled range.
+        int _lastTokenEnd;                  //!< End of the last consumed token.
+        int _firstChangedNode;              //!< Index of the first node added by the last update.
+        bool _atLineStart;                  //!< No token was read since the last line break.
+        bool _hasToken;                     //!< _token holds a peeked token.
+        Token _token;                       //!< Lookahead token.
+
+        int FindRestartNode(int position) const;
+
+        bool Peek();
+
+        void Consume();
+
+        int StyleAt(int position) const;
+
+        bool IsSkipped(int style) const;
+
+        int FindPreviousTokenEnd(int position) const;
+
+        int Open(SyntaxNodeKind kind, int parent, int position);
+
+        void Close(int index, int endPosition);
+
+        void AddLeaf(SyntaxNodeKind kind, int parent);
+
+        SyntaxNodeKind ValueKind(int style) const;
+
+        bool ParseChildren(int container);
+
+        bool ParseElement(int parent);
+
+        bool ParseFeature(int parent);
+
+        bool ParseValueList(int parent);
+
+        bool ParseChildRole(int container);
+
+        bool ParseErrorLine(int parent);
+    };
+
+    inline int SyntaxTree::Count() const
+    {
+        return static_cast<int>(_nodes.size());
+    }
+
+    inline SyntaxNode const & SyntaxTree::Node(int index) const
+    {
+        return _nodes[index];
+    }
+
+    inline int SyntaxTree::FirstChangedNode() const
+    {
+        return _firstChangedNode;
+    }
+} // namespace RText
+#endif // ifndef RTEXTLEXER_SYNTAXTREE_H__
@@ -0,0 +1,147 @@
+#include "TextDocument.h"
+#include "Scintilla.h"
+#include <algorithm>
+#include <cstring>
+
+namespace RText
+{
+    TextDocument::TextDocument(char const * text, int length) : _text(text), _length(length), _stylingPosition(0), _styles(length, 0)
+    {
+        _lineStarts.push_back(0);
+        for (int i = 0; i < length; ++i)
+        {
+            if (text[i] == '\n')
+            {
+                _lineStarts.push_back(i + 1);
+            }
+        }
+        _levels.assign(_lineStarts.size(), SC_FOLDLEVELBASE);
+        _lineStates.assign(_lineStarts.size(), 0);
+    }
+
+    int SCI_METHOD TextDocument::Version() const
+    {
+        return dvOriginal;
+    }
+
+    void SCI_METHOD TextDocument::SetErrorStatus(int)
+    {
+    }
+
+    int SCI_METHOD TextDocument::Length() const
+    {
+        return _length;
+    }
+
+    void SCI_METHOD TextDocument::GetCharRange(char* buffer, int position, int lengthRetrieve) const
+    {
+        int const aStart = (std::max)(0, (std::min)(position, _length));
+        int const aCount = (std::max)(0, (std::min)(lengthRetrieve, _length - aStart));
+        std::memcpy(buffer, _text + aStart, aCount);
+    }
+
+    char SCI_METHOD TextDocument::StyleAt(int position) const
+    {
+        return (position >= 0 && position < _length) ? _styles[position] : 0;
+    }
+
+    int SCI_METHOD TextDocument::LineFromPosition(int position) const
+    {
+        auto aNext = std::upper_bound(_lineStarts.begin(), _lineStarts.end(), position);
+        return (std::max)(0, static_cast<int>(aNext - _lineStarts.begin()) - 1);
+    }
+
+    int SCI_METHOD TextDocument::LineStart(int line) const
+    {
+        if (line < 0)
+        {
+            return 0;
+        }
+        return (line < static_cast<int>(_lineStarts.size())) ? _lineStarts[line] : _length;
+    }
+
+    int SCI_METHOD TextDocument::GetLevel(int line) const
+    {
+        return (line >= 0 && line < static_cast<int>(_levels.size())) ? _levels[line] : SC_FOLDLEVELBASE;
+    }
+
+    int SCI_METHOD TextDocument::SetLevel(int line, int level)
+    {
+        if (line >= 0 && line < static_cast<int>(_levels.size()))
+        {
+            int const aPrevious = _levels[line];
+            _levels[line]       = level;
+            return aPrevious;
+        }
+        return SC_FOLDLEVELBASE;
+    }
+
+    int SCI_METHOD TextDocument::GetLineState(int line) const
+    {
+        return (line >= 0 && line < static_cast<int>(_lineStates.size())) ? _lineStates[line] : 0;
+    }
+
+    int SCI_METHOD TextDocument::SetLineState(int line, int state)
+    {
+        if (line >= 0 && line < static_cast<int>(_lineStates.size()))
+        {
+            int const aPrevious = _lineStates[line];
+            _lineStates[line]   = state;
+            return aPrevious;
+        }
+        return 0;
+    }
+
+    void SCI_METHOD TextDocument::StartStyling(int position, char)
+    {
+        _stylingPosition = position;
+    }
+
+    bool SCI_METHOD TextDocument::SetStyleFor(int length, char style)
+    {
+        int const aEnd = (std::min)(_stylingPosition + length, _length);
+        std::fill(_styles.begin() + _stylingPosition, _styles.begin() + aEnd, style);
+        _stylingPosition = aEnd;
+        return true;
+    }
+
+    bool SCI_METHOD TextDocument::SetStyles(int length, const char* styles)
+    {
+        int const aEnd = (std::min)(_stylingPosition + length, _length);
+        std::copy(styles, styles + (aEnd - _stylingPosition), _styles.begin() + _stylingPosition);
+        _stylingPosition = aEnd;
+        return true;
+    }
+
+    void SCI_METHOD TextDocument::DecorationSetCurrentIndicator(int)
+    {
+    }
+
+    void SCI_METHOD TextDocument::DecorationFillRange(int, int, int)
+    {
+    }
+
+    void SCI_METHOD TextDocument::ChangeLexerState(int, int)
+    {
+    }
+
+    int SCI_METHOD TextDocument::CodePage() const
+    {
+        return SC_CP_UTF8;
+    }
+
+    bool SCI_METHOD TextDocument::IsDBCSLeadByte(char) const
+    {
+        return false;
+    }
+
+    const char* SCI_METHOD TextDocument::BufferPointer()
+    {
+        return _text;
+    }
+
+    int SCI_METHOD TextDocument::GetLineIndentation(int)
+    {
+        return 0;
+    }
+} // namespace RText
@@ -0,0 +1,77 @@
+#ifndef RTEXTLEXER_TEXTDOCUMENT_H__
+#define RTEXTLEXER_TEXTDOCUMENT_H__
+
+#include "ILexer.h"
+#include <vector>
+
+namespace RText
+{
+    /**
+     * \brief   Minimal in-memory document, used to lex files which are not opened in scintilla, e.g. for indexing.
+     *
+     *          The text is not copied and must outlive the document. Styles and fold levels are kept so the lexer works
+     *          exactly as it does in scintilla, everything else scintilla specific is ignored.
+     */
+    class TextDocument : public IDocument
+    {
+    public:
+        /**
+         * \brief   Constructor.
+         *
+         * \param   text    The text, not necessarily zero terminated.
+         * \param   length  The length of the text.
+         */
+        TextDocument(char const * text, int length);
+
+        virtual int SCI_METHOD Version() const;
+
+        virtual void SCI_METHOD SetErrorStatus(int status);
+
+        virtual int SCI_METHOD Length() const;
+
+        virtual void SCI_METHOD GetCharRange(char* buffer, int position, int lengthRetrieve) const;
+
+        virtual char SCI_METHOD StyleAt(int position) const;
+
+        virtual int SCI_METHOD LineFromPosition(int position) const;
+
+        virtual int SCI_METHOD LineStart(int line) const;
+
+        virtual int SCI_METHOD GetLevel(int line) const;
+
+        virtual int SCI_METHOD SetLevel(int line, int level);
+
+        virtual int SCI_METHOD GetLineState(int line) const;
+
+        virtual int SCI_METHOD SetLineState(int line, int state);
+
+        virtual void SCI_METHOD StartStyling(int position, char mask);
+
+        virtual bool SCI_METHOD SetStyleFor(int length, char style);
+
+        virtual bool SCI_METHOD SetStyles(int length, const char* styles);
+
+        virtual void SCI_METHOD DecorationSetCurrentIndicator(int indicator);
+
+        virtual void SCI_METHOD DecorationFillRange(int position, int value, int fillLength);
+
+        virtual void SCI_METHOD ChangeLexerState(int start, int end);
+
+        virtual int SCI_METHOD CodePage() const;
+
+        virtual bool SCI_METHOD IsDBCSLeadByte(char ch) const;
+
+        virtual const char* SCI_METHOD BufferPointer();
+
+        virtual int SCI_METHOD GetLineIndentation(int line);
+    private:
+        char const * _text;             //!< The text.
+        int _length;                    //!< Length of the text.
+        int _stylingPosition;           //!< Position of the next style set by the lexer.
+        std::vector<char> _styles;      //!< Style of each character.
+        std::vector<int> _lineStarts;   //!< Start position of each line.
+        std::vector<int> _levels;       //!< Fold level of each line.
+        std::vector<int> _lineStates;   //!< Lexer state of each line.
+    };
+} // namespace RText
+#endif // ifndef RTEXTLEXER_TEXTDOCUMENT_H__
@@ -0,0 +1,28 @@
+#ifndef RTEXTLEXER_TOKENTYPE_H__
+#define RTEXTLEXER_TOKENTYPE_H__
+
+namespace RText
+{
+    /**
+     * \brief   Styles assigned by the lexer. Values are shared with the plug-in, see Constants.StyleId.
+     */
+    enum TokenType
+    {
+        TokenType_Default,
+        TokenType_Comment,
+        TokenType_Notation,
+        TokenType_Reference,
+        TokenType_Float,
+        TokenType_Integer,
+        TokenType_Quoted_string,
+        TokenType_Boolean,
+        TokenType_Label,
+        TokenType_Command,
+        TokenType_Identifier,
+        TokenType_Template,
+        TokenType_Space,
+        TokenType_Other,
+        TokenType_Error
+    };
+} // namespace RText
+#endif // ifndef RTEXTLEXER_TOKENTYPE_H__
@@ -1,6 +1,7 @@
 using RTextNppPlugin.DllExport;
 using RTextNppPlugin.Forms;
 using RTextNppPlugin.RText;
+using RTextNppPlugin.RText.Indexing;
 using RTextNppPlugin.RText.Parsing;
 using RTextNppPlugin.Scintilla;
 using RTextNppPlugin.Scintilla.Annotations;
@@ -13,6 +14,7 @@ using System.Collections.Generic;
 using System.Diagnostics;
 using System.Drawing;
 using System.Drawing.Imaging;
+using System.IO;
 using System.Linq;
 using System.Runtime.InteropServices;
 using System.Threading.Tasks;
@@ -49,6 +51,7 @@ namespace RTextNppPlugin
         private bool _hasSecondScintillaFocus                                                  = false; //!< Indicates if the second editor has focus.
         private bool _isMenuLoopInactive                                                       = false; //!< Indicates that npp menu loop is active.
         private LinkTargetsWindow _linkTargetsWindow                                           = null;  //!< Display reference links.
+        private LexerDiagnosticsManager _lexerDiagnosticsManager                               = null;  //!< Displays local syntax diagnostics of the lexer.
         private bool _isAutoCompletionShortcutActive                                           = false; //!< Indicates the Ctrl+Space is pressed. Need this to commit auto completion in case of fuzzy matching.
         private Utilities.DelayedEventHandler<object> _actionAfterUiUpdateHandler              = new DelayedEventHandler<object>(null, 100);
         private NppData _nppData                                                               = default(NppData);
@@ -56,6 +59,7 @@ namespace RTextNppPlugin
         private INativeHelpers _nativeHelpers                                                  = new NativeHelpers();
         private int _previousDwellTimeMain                                                     = (int)SciMsg.SC_TIME_FOREVER;
         private int _previousDwellTimeSub                                                      = (int)SciMsg.SC_TIME_FOREVER;
+        private const string DEPENDENCY_GRAPH_FILE                                             = "dependencies.dot"; //!< Name of the exported dependency graph, written next to the .rtext file.
 
         private enum ShortcutType
         {
@@ -103,6 +107,7 @@ namespace RTextNppPlugin
             _fileObserver            = new FileModificationObserver(_settings, _nppHelper);
             _autoCompletionForm      = new AutoCompletionWindow(_connectorManager, _nppHelper, _nativeHelpers);
             _linkTargetsWindow       = new LinkTargetsWindow(_nppHelper, _settings, _connectorManager);
+            _lexerDiagnosticsManager = new LexerDiagnosticsManager(_settings, _nppHelper, this);
         }
 
         public void PluginCleanUp()
@@ -118,6 +123,7 @@ namespace RTextNppPlugin
             _scintillaSecondMsgInterceptor.MouseWheelMoved       -= OnScintillaMouseWheelMoved;
             _nppMsgInterceptpr.MenuLoopStateChanged              -= OnMenuLoopStateChanged;
             _linkTargetsWindow.IsVisibleChanged                  -= OnLinkTargetsWindowIsVisibleChanged;
+            _lexerDiagnosticsManager.Dispose();
         }
 
         public void CommandMenuInit()
@@ -128,6 +134,11 @@ namespace RTextNppPlugin
             SetCommand((int)Constants.NppMenuCommands.Options, Properties.Resources.RTEXT_SHOW_OPTIONS_WINDOW, ModifyOptions, new ShortcutKey(true, false, true, Keys.R));
             SetCommand((int)Constants.NppMenuCommands.AutoCompletion, Properties.Resources.AUTO_COMPLETION_DESC, StartAutoCompleteSession, Properties.Resources.AUTO_COMPLETION_SHORTCUT);
             SetCommand((int)Constants.NppMenuCommands.AutoCompletion, Properties.Resources.FIND_ALL_REFS_DESC, ShowReferenceLinks, Properties.Resources.FIND_ALL_REFS_SHORTCUT);
+            SetCommand((int)Constants.NppMenuCommands.Outline, Properties.Resources.GO_TO_ENCLOSING_ELEMENT_DESC, GoToEnclosingElement);
+            SetCommand((int)Constants.NppMenuCommands.MatchingBracket, Properties.Resources.GO_TO_MATCHING_BRACKET_DESC, GoToMatchingBracket);
+            SetCommand((int)Constants.NppMenuCommands.FindUsages, Properties.Resources.FIND_USAGES_DESC, FindUsages);
+            SetCommand((int)Constants.NppMenuCommands.Dependencies, Properties.Resources.SHOW_DEPENDENCY_IMPACT_DESC, ShowDependencyImpact);
+            SetCommand((int)Constants.NppMenuCommands.Dependencies, Properties.Resources.EXPORT_DEPENDENCY_GRAPH_DESC, ExportDependencyGraph);
             _connectorManager.Initialize(_nppData);
             foreach(var key in BindInteranalShortcuts())
             {
@@ -183,6 +194,175 @@ namespace RTextNppPlugin
 
         }
 
+        /**
+         * Moves the caret to the element containing it, or to the enclosing element if the caret is on the line of an element.
+         * Uses the outline of the lexer, so it works while the backend is still loading.
+         */
+        void GoToEnclosingElement()
+        {
+            HandleErrors(() =>
+            {
+                if (FileUtilities.IsRTextFile(_settings, _nppHelper))
+                {
+                    IntPtr aScintilla = _nppHelper.CurrentScintilla;
+                    int aPosition     = _nppHelper.GetCaretPosition(aScintilla);
+                    //the outline covers the styled part of the document only
+                    _nppHelper.EnsureStyled(aScintilla, aPosition);
+                    var aOutline      = _nppHelper.GetOutline(aScintilla);
+                    int aEntry        = OutlineNavigation.FindEnclosingEntry(aOutline, _nppHelper.FindOutlineEntry(aScintilla, aPosition), _nppHelper.GetLineNumber(aPosition, aScintilla));
+                    if (aEntry >= 0)
+                    {
+                        _nppHelper.GoToLine(aOutline[aEntry].Line + 1, aScintilla);
+                    }
+                }
+            });
+        }
+
+        /**
+         * Moves the caret to the bracket matching the bracket next to it, or to the opening bracket enclosing it.
+         * Brackets inside strings, comments and templates are skipped.
+         */
+        void GoToMatchingBracket()
+        {
+            HandleErrors(() =>
+            {
+                if (FileUtilities.IsRTextFile(_settings, _nppHelper))
+                {
+                    IntPtr aScintilla = _nppHelper.CurrentScintilla;
+                    //the bracket index covers the styled part of the document only, the matching bracket may follow it
+                    _nppHelper.EnsureStyled(aScintilla, _nppHelper.SendMessage(aScintilla, SciMsg.SCI_GETLENGTH).ToInt32());
+                    int aTarget       = BracketNavigation.FindTarget(_nppHelper.GetCaretPosition(aScintilla),
+                                                                     x => _nppHelper.FindMatchingBracket(aScintilla, x),
+                                                                     x => _nppHelper.FindEnclosingBracket(aScintilla, x));
+                    if (aTarget >= 0)
+                    {
+                        _nppHelper.SendMessage(aScintilla, SciMsg.SCI_GOTOPOS, new IntPtr(aTarget));
+                    }
+                }
+            });
+        }
+
+        /**
+         * Shows the places which reference the reference under the caret, or else the element containing the caret.
+         * Uses the local workspace index, so it works while the backend is still loading.
+         */
+        void FindUsages()
+        {
+            HandleErrors(() =>
+            {
+                var aConnector = _connectorManager.Connector;
+                if (aConnector == null || aConnector.WorkspaceIndex == null)
+                {
+                    return;
+                }
+                IntPtr aScintilla = _nppHelper.CurrentScintilla;
+                int aPosition     = _nppHelper.GetCaretPosition(aScintilla);
+                _nppHelper.EnsureStyled(aScintilla, aPosition);
+                var aToken        = Tokenizer.FindTokenUnderCursor(aPosition, _nppHelper, aScintilla);
+                string aPath      = aToken.Context;
+                if (aToken.Type != RTextTokenTypes.Reference)
+                {
+                    //not on a reference, so the usages of the element containing the caret are shown
+                    aPath = OutlineNavigation.GetQualifiedName(_nppHelper.GetOutline(aScintilla), _nppHelper.FindOutlineEntry(aScintilla, aPosition), (x, y) => _nppHelper.GetTextBetween(x, y));
+                }
+                if (aPath == null)
+                {
+                    return;
+                }
+                var aUsages = aConnector.WorkspaceIndex.FindUsages(aPath);
+                if (aUsages == null)
+                {
+                    Logging.Logger.Instance.Append(Logging.Logger.MessageType.Info, aConnector.LogChannel, "Usages of {0} can be found after the workspace is indexed.", aPath);
+                }
+                else if (aUsages.Count == 0)
+                {
+                    Logging.Logger.Instance.Append(Logging.Logger.MessageType.Info, aConnector.LogChannel, "{0} is not referenced.", aPath);
+                }
+                else
+                {
+                    _linkTargetsWindow.ShowUsages(aToken, aUsages);
+                }
+            });
+        }
+
+        /**
+         * Logs the files which are affected by a change of the current file, and the circular dependency it is part of.
+         * Uses the local workspace index, so it works while the backend is still loading.
+         */
+        void ShowDependencyImpact()
+        {
+            HandleErrors(() =>
+            {
+                var aConnector = _connectorManager.Connector;
+                var aGraph     = GetDependencyGraph(aConnector);
+                if (aGraph == null)
+                {
+                    return;
+                }
+                string aFile   = _nppHelper.GetCurrentFilePath();
+                var aImpact    = aGraph.GetImpact(new[] { aFile });
+                Logging.Logger.Instance.Append(Logging.Logger.MessageType.Info, aConnector.LogChannel, "{0} file(s) are affected by a change of {1}.", aImpact.Count, aFile);
+                foreach (var aAffected in aImpact)
+                {
+                    Logging.Logger.Instance.Append(Logging.Logger.MessageType.Info, aConnector.LogChannel, "  {0}", aAffected);
+                }
+                var aCycle = aGraph.GetCycle(aFile);
+                if (aCycle != null)
+                {
+                    Logging.Logger.Instance.Append(Logging.Logger.MessageType.Warning, aConnector.LogChannel, "{0} is part of a circular dependency: {1}", aFile, String.Join(", ", aCycle));
+                }
+            });
+        }
+
+        /**
+         * Writes the file dependencies of the workspace as graphviz DOT file next to the .rtext file, and logs the circular
+         * dependencies.
+         */
+        void ExportDependencyGraph()
+        {
+            HandleErrors(() =>
+            {
+                var aConnector = _connectorManager.Connector;
+                var aGraph     = GetDependencyGraph(aConnector);
+                if (aGraph == null)
+                {
+                    return;
+                }
+                string aDotFile = Path.Combine(Path.GetDirectoryName(aConnector.WorkspaceIndex.RTextFilePath), DEPENDENCY_GRAPH_FILE);
+                using (var aWriter = new StreamWriter(aDotFile))
+                {
+                    aGraph.Export(aWriter, false);
+                }
+                Logging.Logger.Instance.Append(Logging.Logger.MessageType.Info, aConnector.LogChannel, "Dependency graph written to {0}.", aDotFile);
+                foreach (var aCycle in aGraph.Cycles)
+                {
+                    Logging.Logger.Instance.Append(Logging.Logger.MessageType.Warning, aConnector.LogChannel, "Circular dependency: {0}", String.Join(", ", aCycle));
+                }
+            });
+        }
+
+        /**
+         * Gets the dependency graph of the workspace of the current file.
+         *
+         * \param   connector   The connector of the current file, may be null.
+         *
+         * \return  The graph, null if the workspace is not indexed yet.
+         */
+        DependencyGraph GetDependencyGraph(Connector connector)
+        {
+            if (connector == null || connector.WorkspaceIndex == null)
+            {
+                return null;
+            }
+            var aSnapshot = connector.WorkspaceIndex.Snapshot;
+            if (aSnapshot == null)
+            {
+                Logging.Logger.Instance.Append(Logging.Logger.MessageType.Info, connector.LogChannel, "Dependencies can be shown after the workspace is indexed.");
+                return null;
+            }
+            return aSnapshot.Dependencies;
+        }
+
         /**
          * Shows the automatic completion list.
          */
@@ -199,8 +379,8 @@ namespace RTextNppPlugin
                         {
                             int aLineNumber                    = Npp.Instance.GetLineNumber(_nppHelper.CurrentScintilla);
                             int aStartPos                      = _nppHelper.GetLineStart(aLineNumber, _nppHelper.CurrentScintilla);
-                            //get text from start till current line end
-                            string aContextBlock = Npp.Instance.GetTextBetween(0, _nppHelper.GetLineEnd(_nppHelper.GetCaretPosition(_nppHelper.CurrentScintilla), aLineNumber, _nppHelper.CurrentScintilla));
+                            //get text from the start of the enclosing top level element till current line end
+                            string aContextBlock = Npp.Instance.GetTextBetween(_nppHelper.GetContextStart(_nppHelper.CurrentScintilla, aCurrentPosition), _nppHelper.GetLineEnd(_nppHelper.GetCaretPosition(_nppHelper.CurrentScintilla), aLineNumber, _nppHelper.CurrentScintilla));
                             ContextExtractor aExtractor        = new ContextExtractor(aContextBlock, _nppHelper.GetLengthToEndOfLine(aLineNumber, _nppHelper.GetCaretPosition(_nppHelper.CurrentScintilla)));
 
 
@@ -774,6 +954,7 @@ namespace RTextNppPlugin
                 if (_autoCompletionForm.Completion != null && _autoCompletionForm.Completion.IsSelected)
                 {
                     Npp.Instance.ReplaceWordFromToken(_autoCompletionForm.TriggerPoint, _autoCompletionForm.Completion.InsertionText, _nppHelper.CurrentScintilla);
+                    _autoCompletionForm.OnCompletionCommitted();
                 }
             }
             _autoCompletionForm.Hide();
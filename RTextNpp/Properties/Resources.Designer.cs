@@ -274,6 +274,15 @@ namespace RTextNppPlugin.Properties {
             }
         }
         
+        /// <summary>
+        ///   Looks up a localized string similar to Export dependency graph.
+        /// </summary>
+        internal static string EXPORT_DEPENDENCY_GRAPH_DESC {
+            get {
+                return ResourceManager.GetString("EXPORT_DEPENDENCY_GRAPH_DESC", resourceCulture);
+            }
+        }
+        
         /// <summary>
         ///   Looks up a localized resource of type System.Drawing.Bitmap.
         /// </summary>
@@ -312,6 +321,33 @@ namespace RTextNppPlugin.Properties {
             }
         }
         
+        /// <summary>
+        ///   Looks up a localized string similar to Find usages.
+        /// </summary>
+        internal static string FIND_USAGES_DESC {
+            get {
+                return ResourceManager.GetString("FIND_USAGES_DESC", resourceCulture);
+            }
+        }
+        
+        /// <summary>
+        ///   Looks up a localized string similar to Go to enclosing element.
+        /// </summary>
+        internal static string GO_TO_ENCLOSING_ELEMENT_DESC {
+            get {
+                return ResourceManager.GetString("GO_TO_ENCLOSING_ELEMENT_DESC", resourceCulture);
+            }
+        }
+        
+        /// <summary>
+        ///   Looks up a localized string similar to Go to matching bracket.
+        /// </summary>
+        internal static string GO_TO_MATCHING_BRACKET_DESC {
+            get {
+                return ResourceManager.GetString("GO_TO_MATCHING_BRACKET_DESC", resourceCulture);
+            }
+        }
+        
         /// <summary>
         ///   Looks up a localized resource of type System.Drawing.Bitmap.
         /// </summary>
@@ -417,6 +453,15 @@ namespace RTextNppPlugin.Properties {
             }
         }
         
+        /// <summary>
+        ///   Looks up a localized string similar to Show dependency impact.
+        /// </summary>
+        internal static string SHOW_DEPENDENCY_IMPACT_DESC {
+            get {
+                return ResourceManager.GetString("SHOW_DEPENDENCY_IMPACT_DESC", resourceCulture);
+            }
+        }
+        
         /// <summary>
         ///   Looks up a localized resource of type System.Drawing.Bitmap.
         /// </summary>
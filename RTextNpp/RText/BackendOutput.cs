@@ -0,0 +1,90 @@
+﻿using System;
+using System.Globalization;
+using RTextNppPlugin.Utilities.Threading;
+
+namespace RTextNppPlugin.RText
+{
+    /**
+     * \brief   Output of a back-end process, captured into bounded buffers and passed on at a limited rate.
+     *
+     *          The reader of each stream only adds its lines to a ring buffer, so a back-end which writes faster than the
+     *          console can show is never blocked and memory stays bounded. The lines are drained periodically; when more
+     *          lines are pending than may be passed on per drain, only the most recent ones are kept and the older ones are
+     *          summarised by a single line stating how many were suppressed.
+     */
+    internal sealed class BackendOutput
+    {
+        #region [Data Members]
+        private readonly RingBuffer<string> _standardOutput = null;
+        private readonly RingBuffer<string> _standardError  = null;
+        private readonly int _linesPerDrain                 = 0;    //!< Maximum number of lines of each stream passed on per drain.
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates empty buffers.
+         *
+         * \param   capacity        The maximum number of lines buffered for each stream.
+         * \param   linesPerDrain   The maximum number of lines of each stream passed on per drain.
+         */
+        internal BackendOutput(int capacity, int linesPerDrain)
+        {
+            _standardOutput = new RingBuffer<string>(capacity);
+            _standardError  = new RingBuffer<string>(capacity);
+            _linesPerDrain  = linesPerDrain;
+        }
+
+        /**
+         * \brief   Gets the buffer of the standard output, its reader is the only producer.
+         */
+        internal RingBuffer<string> StandardOutput { get { return _standardOutput; } }
+
+        /**
+         * \brief   Gets the buffer of the standard error, its reader is the only producer.
+         */
+        internal RingBuffer<string> StandardError { get { return _standardError; } }
+
+        /**
+         * \brief   Passes the pending lines on. Must only be called by one thread at a time.
+         *
+         * \param   sink    Receives the lines, and the summaries of the suppressed ones.
+         *
+         * \return  The number of suppressed lines.
+         */
+        internal long Drain(Action<string> sink)
+        {
+            return Drain(_standardOutput, sink) + Drain(_standardError, sink);
+        }
+
+        /**
+         * \brief   Formats the line which summarises suppressed lines.
+         */
+        internal static string Summarize(long suppressed)
+        {
+            return String.Format(CultureInfo.InvariantCulture, "... {0} lines of output suppressed ...", suppressed);
+        }
+        #endregion
+
+        #region [Helpers]
+        private long Drain(RingBuffer<string> buffer, Action<string> sink)
+        {
+            long aSuppressed = buffer.TakeOverwritten();
+            int aPending     = buffer.Count;
+            if (aPending > _linesPerDrain)
+            {
+                aSuppressed += buffer.Discard(aPending - _linesPerDrain);
+            }
+            if (aSuppressed > 0)
+            {
+                sink(Summarize(aSuppressed));
+            }
+            string aLine;
+            for (int i = 0; i < _linesPerDrain && buffer.TryDequeue(out aLine); ++i)
+            {
+                sink(aLine);
+            }
+            return aSuppressed;
+        }
+        #endregion
+    }
+}
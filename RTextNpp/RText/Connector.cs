@@ -1,16 +1,14 @@
 ﻿using System;
+using System.Collections.Generic;
 using System.Diagnostics;
 using System.IO;
 using System.Net;
 using System.Net.Sockets;
-using System.Text;
-using System.Text.RegularExpressions;
 using System.Threading;
 using RTextNppPlugin.RText.Protocol;
 using RTextNppPlugin.RText.StateEngine;
 using RTextNppPlugin.Utilities;
 using System.Threading.Tasks;
-using Newtonsoft.Json;
 namespace RTextNppPlugin.RText
 {
     /**
@@ -22,18 +20,31 @@ namespace RTextNppPlugin.RText
     internal class Connector : IConnector
     {
         #region [Data Members]
-        private ManualResetEvent _receivedResponseEvent                    = new ManualResetEvent(false)                     ;            //!< The received response event
         private int _InvocationId                                          = 0                                               ;            //!< Identifier for the invocation
         private SocketConnection _connection                               = new SocketConnection()                          ;            //!< The receive status, used to store a state between calls of the receive callback
-        private readonly Regex _messageLengthRegex                         = new Regex(@"^(\d+)\{", RegexOptions.Compiled)   ;            //!< The message length regular expression
         private IConnectorState _currentState                                                                                ;            //!< Indicates the current connector state.
         private string _activeCommand                                                                                        ;            //!< Indicates the currently executing command
         private RTextBackendProcess _backendProcess                                                                          ;            //!< Indicates the back-end process
-        private CancellationTokenSource _receivingThreadCancellationSource = null                                            ;            //!< Used to cancel a synchronous receiving thread without waiting for the timeout to complete.
-        private IResponseBase _lastResponse                                = null                                            ;            //!< Holds the last response from the back-end.
         public readonly RequestBase LOAD_COMMAND                           = new RequestBase { command = Constants.Commands.LOAD_MODEL }; //!< Load command.
         private bool _cancelled                                            = false;                                                       //!< Indicates that a pending command was canceled via user request.
         private LoadResponse _currentLoadResponse                          = default(LoadResponse);                                       //!< Indicates last load response.
+        private IResponseParser _responseParser                            = null;                                                        //!< Parses the response being received, null between responses.
+        private ResponseDispatcher _responseDispatcher                     = null;                                                        //!< Routes the tokens of _responseParser to the builder of the request it answers.
+        private readonly RequestTable _requests                            = new RequestTable(MAX_REQUESTS_IN_FLIGHT);                    //!< Requests which wait for their response.
+        private readonly object _requestLock                               = new object();                                                //!< Guards _requests and sending.
+        private int _loadInvocationId                                      = -1;                                                          //!< Invocation id of the load command being executed, -1 if none.
+        private int _lastReceivedAt                                        = 0;                                                           //!< Environment.TickCount when bytes were received last.
+        private readonly RequestScheduler _scheduler                       = null;                                                        //!< Drops superseded keystroke driven requests.
+        private readonly RequestStatistics _statistics                     = new RequestStatistics();                                     //!< Latencies of answered requests by command.
+        private RequestTiming _loadTiming                                  = new RequestTiming();                                         //!< Timing of the load command being executed.
+        private long _responseStartedAt                                    = 0;                                                           //!< Stopwatch timestamp when the response being received started, 0 between responses.
+        private long _responseBytes                                        = 0;                                                           //!< Bytes of the response being received.
+        private long _responseDeserializeTicks                             = 0;                                                           //!< Stopwatch ticks spent parsing the response being received.
+        private const int MAX_REQUESTS_IN_FLIGHT                           = 4;                                                           //!< Maximum number of requests sent to the back-end without response.
+        private ProtocolEncoding _encoding                                 = ProtocolEncoding.Json;                                       //!< Encoding of the messages, negotiated when connecting.
+        private const ProtocolEncoding PREFERRED_ENCODING                  = ProtocolEncoding.MessagePack;                                //!< Encoding asked for when connecting, JSON is the fallback.
+        private List<Error> _receivedProblems                              = new List<Error>();                                           //!< Files with problems which were parsed but not yet reported.
+        private const int PROBLEMS_BATCH_SIZE                              = 64;                                                          //!< Number of files with problems reported at once while a model is loaded.
         #endregion
         
         #region Interface
@@ -54,11 +65,34 @@ namespace RTextNppPlugin.RText
         public string Workspace { get { return _backendProcess.ProcKey; } }
         
         public bool IsCommandCancelled { get { return _cancelled; } }
+
+        internal Indexing.WorkspaceIndex WorkspaceIndex { get { return _backendProcess.WorkspaceIndex; } }
+
+        internal Indexing.CompletionUsage CompletionUsage { get { return _backendProcess.CompletionUsage; } }
+
+        internal RequestScheduler Scheduler { get { return _scheduler; } }
+
+        internal ResponseCache ResponseCache { get { return _backendProcess.ResponseCache; } }
+
+        internal RequestStatistics Statistics { get { return _statistics; } }
         
         public delegate void ProgressUpdatedEvent(object source, ProgressResponseEventArgs e);
         
         public event ProgressUpdatedEvent OnProgressUpdated;
         
+        /**
+         * \brief   Problems of some files, reported while the load response is still being received.
+         */
+        internal struct ProblemsReceivedEventArgs
+        {
+            internal IList<Error> Problems;
+            internal String Workspace;
+        }
+        
+        internal delegate void ProblemsReceivedEvent(object source, ProblemsReceivedEventArgs e);
+        
+        internal event ProblemsReceivedEvent OnProblemsReceived;
+        
         public delegate void StateChangedEvent(object source, StateChangedEventArgs e);
         
         public event StateChangedEvent OnStateChanged;
@@ -168,27 +202,42 @@ namespace RTextNppPlugin.RText
         {
             _backendProcess = proc;
             _currentState   = new Disconnected(this);
+            _scheduler      = new RequestScheduler((x, priority) => ExecuteAsync(x, Constants.SYNCHRONOUS_COMMANDS_TIMEOUT, StateEngine.Command.Execute, priority), Abandon);
             _backendProcess.ProcessExitedEvent += ProcessExitedEvent;
         }
         
         void ProcessExitedEvent(object source, RTextBackendProcess.ProcessExitedEventArgs e)
         {
             //kill any ongoing commands
-            if (IsBusy() && _receivingThreadCancellationSource != null)
-            {
-                _receivingThreadCancellationSource.Cancel();
-            }
+            FailPendingRequests();
             _currentState.ExecuteCommand(StateEngine.Command.Disconnected);
             //reset invocation id counter since the back-end process died or exited after an idle timeout
             _InvocationId = 0;
         }
         
-        public async Task<IResponseBase> ExecuteAsync<Command>(Command command, int timeout, StateEngine.Command cmd) where Command : RequestBase
+        public Task<IResponseBase> ExecuteAsync<Command>(Command command, int timeout, StateEngine.Command cmd) where Command : RequestBase
         {
-            if (!IsBusy())
+            return ExecuteAsync<Command>(command, timeout, cmd, RequestPriority.Normal);
+        }
+        
+        /**
+         * \brief   Executes a command and waits asynchronously for its response. Several commands may be executed at the
+         *          same time, their responses are matched by invocation id.
+         *
+         * \tparam  Command Type of the command.
+         * \param   command     The command.
+         * \param   timeout     The time to wait for the response of this command, in milliseconds.
+         * \param   cmd         The state machine command.
+         * \param   priority    The priority of the command, used when too many commands are in flight.
+         *
+         * \return  The response, null if the command failed, timed out or was cancelled.
+         */
+        internal async Task<IResponseBase> ExecuteAsync<Command>(Command command, int timeout, StateEngine.Command cmd, RequestPriority priority) where Command : RequestBase
+        {
+            if (AcceptsRequests())
             {
                 UpdateFsmAndPendingCommand(command, cmd);
-                return await SendAsync<Command>(command, timeout);
+                return await SendAsync<Command>(command, timeout, priority);
             }
             else
             {
@@ -235,9 +284,45 @@ namespace RTextNppPlugin.RText
         internal void CancelCommand()
         {
             _cancelled = true;
-            if (_receivingThreadCancellationSource != null)
+            FailPendingRequests();
+            FinishIfIdle();
+        }
+        
+        /**
+         * \brief   Answers a pending command with null right away, e.g. because it was superseded.
+         *
+         *          A command which was sent already is still processed by the back-end, so it keeps its slot until its
+         *          response arrives, which is dropped then.
+         *
+         * \param   command The command.
+         */
+        internal void Abandon(RequestBase command)
+        {
+            PendingRequest aRequest = null;
+            lock (_requestLock)
+            {
+                aRequest = _requests.Find(command);
+                if (aRequest == null)
+                {
+                    return;
+                }
+                if (aRequest.IsSent)
+                {
+                    aRequest.IsAbandoned = true;
+                }
+                else
+                {
+                    _requests.Remove(aRequest);
+                }
+            }
+            if (aRequest.IsSent)
             {
-                _receivingThreadCancellationSource.Cancel();
+                aRequest.Completion.TrySetResult(null);
+            }
+            else
+            {
+                Complete(aRequest, null);
+                FinishIfIdle();
             }
         }
         #endregion
@@ -279,6 +364,8 @@ namespace RTextNppPlugin.RText
             try
             {
                 byte[] msg = GetCommandAsByteArray(command);
+                _loadInvocationId = command.invocation_id;
+                _loadTiming       = new RequestTiming { SentAt = Stopwatch.GetTimestamp() };
                 if (_connection.SendRequest(msg) != msg.Length)
                 {
                     Logging.Logger.Instance.Append(Logging.Logger.MessageType.Error,
@@ -312,66 +399,180 @@ namespace RTextNppPlugin.RText
          * Sends a command while waiting asynchronously for a response.
          *
          * \tparam  Command Type of the command.
-         * \param   command The command.
-         * \param   timeout The timeout to wait after which the command will be responded with null.
+         * \param   command     The command.
+         * \param   timeout     The timeout to wait after which the command will be responded with null.
+         * \param   priority    The priority of the command.
          *
          * \return  The response from the back-end.
          */
-        private async Task<IResponseBase> SendAsync<Command>(Command command, int timeout) where Command : RequestBase
+        private Task<IResponseBase> SendAsync<Command>(Command command, int timeout, RequestPriority priority) where Command : RequestBase
         {
-            try
+            var aRequest = new PendingRequest(command, priority);
+            lock (_requestLock)
             {
-                byte[] msg = GetCommandAsByteArray(command);
-                // Send the data through the socket.
-                //wait for manual reset event which indicates that the response has arrived
-                _receivedResponseEvent.Reset();
-                _receivingThreadCancellationSource = new CancellationTokenSource();
-                Task<IResponseBase> errorTask = new Task<IResponseBase>(new Func<IResponseBase>(() =>
+                aRequest.Timeout = new CancellationTokenSource(timeout);
+                _requests.Enqueue(aRequest);
+                aRequest.Timeout.Token.Register(() => OnRequestTimedOut(aRequest, timeout));
+            }
+            //FinishIfIdle may have decided on idle before the request was queued
+            if (_currentState.State == ConnectorStates.Idle)
+            {
+                _currentState.ExecuteCommand(StateEngine.Command.Execute);
+            }
+            SendQueuedRequests();
+            return aRequest.Completion.Task;
+        }
+        
+        /**
+         * \brief   Sends queued requests as long as not too many are in flight.
+         */
+        private void SendQueuedRequests()
+        {
+            bool aHasErrorOccured = false;
+            lock (_requestLock)
+            {
+                PendingRequest aRequest = null;
+                while (!aHasErrorOccured && (aRequest = _requests.Dequeue()) != null)
                 {
-                    while (true)
+                    try
                     {
-                        //wait 0.05 seconds
-                        Thread.Sleep(50);
-                        // Check is task should be ended!
-                        if (_receivingThreadCancellationSource.IsCancellationRequested)
+                        byte[] msg = GetCommandAsByteArray(aRequest.Request);
+                        //register before sending, the response may arrive before SendRequest returns
+                        _requests.Sent(aRequest);
+                        aRequest.WaitingSince  = Environment.TickCount;
+                        aRequest.Timing.SentAt = Stopwatch.GetTimestamp();
+                        if (_connection.SendRequest(msg) != msg.Length)
                         {
-                            break;
+                            Logging.Logger.Instance.Append(Logging.Logger.MessageType.Error,
+                                                            _backendProcess.Workspace,
+                                                            "Could not send request to RTextService."
+                                                          );
+                            aHasErrorOccured = true;
                         }
                     }
-                    return null;
-                }), _receivingThreadCancellationSource.Token);
-                Task<IResponseBase> receiverTask = new Task<IResponseBase>(new Func<IResponseBase>(() =>
-                {
-                    if (!_receivedResponseEvent.WaitOne(timeout))
+                    catch (Exception ex)
                     {
-                        _currentState.ExecuteCommand(StateEngine.Command.Disconnected);
-                        _lastResponse = null;
+                        Logging.Logger.Instance.Append(Logging.Logger.MessageType.Error, _backendProcess.Workspace, "void SendQueuedRequests() - Exception : {0}", ex.Message);
+                        aHasErrorOccured = true;
                     }
-                    return _lastResponse;
-                }));
-                receiverTask.Start();
-                errorTask.Start();
-                if (_connection.SendRequest(msg) != msg.Length)
+                }
+            }
+            if (aHasErrorOccured)
+            {
+                FailPendingRequests();
+                _currentState.ExecuteCommand(StateEngine.Command.Disconnected);
+            }
+        }
+        
+        /**
+         * \brief   Completes a request which didn't receive its response in time with null.
+         *
+         *          If nothing at all was received while the request was waiting, the back-end is considered hung and the
+         *          connection is closed. Otherwise the back-end is just busy with other requests and keeps running. A
+         *          sent request keeps its slot then, it is still processed by the back-end. It is abandoned and waits
+         *          for another timeout, its response is dropped when it arrives.
+         */
+        private void OnRequestTimedOut(PendingRequest request, int timeout)
+        {
+            bool aIsHung      = false;
+            bool aIsAbandoned = false;
+            lock (_requestLock)
+            {
+                if (!_requests.Contains(request))
                 {
-                    Logging.Logger.Instance.Append(Logging.Logger.MessageType.Error,
-                                                    _backendProcess.Workspace,
-                                                    "Could not send request to RTextService."
-                                                  );
-                    _currentState.ExecuteCommand(StateEngine.Command.Disconnected);
-                    return null;
+                    return;
+                }
+                aIsAbandoned = request.IsAbandoned;
+                aIsHung      = request.IsSent && unchecked(_lastReceivedAt - request.WaitingSince) < 0;
+                if (!request.IsSent)
+                {
+                    _requests.Remove(request);
                 }
-                var result = await Task.WhenAny<IResponseBase>(receiverTask, errorTask);
-                if (!_receivingThreadCancellationSource.IsCancellationRequested)
+                else if (!aIsHung)
                 {
-                    _receivingThreadCancellationSource.Cancel();
+                    request.IsAbandoned  = true;
+                    request.WaitingSince = Environment.TickCount;
+                    request.Timeout.Dispose();
+                    request.Timeout      = new CancellationTokenSource(timeout);
+                    request.Timeout.Token.Register(() => OnRequestTimedOut(request, timeout));
                 }
-                return result.Result;
             }
-            catch (ArgumentNullException ex)
+            if (!aIsAbandoned)
+            {
+                Logging.Logger.Instance.Append(Logging.Logger.MessageType.Error,
+                                                _backendProcess.Workspace,
+                                                "Command {0} timed out after {1} ms.",
+                                                request.Request.command,
+                                                timeout);
+            }
+            if (aIsHung)
             {
+                FailPendingRequests();
                 _currentState.ExecuteCommand(StateEngine.Command.Disconnected);
-                Logging.Logger.Instance.Append(Logging.Logger.MessageType.Error, _backendProcess.Workspace, "void send<Command>(ref Command command, ref int invocationId, int timeout) - Exception : {0}", ex.Message);
-                return null;
+            }
+            else if (request.IsSent)
+            {
+                request.Completion.TrySetResult(null);
+            }
+            else
+            {
+                Complete(request, null);
+                FinishIfIdle();
+            }
+        }
+        
+        /**
+         * \brief   Hands out the response of a request which was removed from _requests.
+         */
+        private static void Complete(PendingRequest request, IResponseBase response)
+        {
+            if (request.Timeout != null)
+            {
+                request.Timeout.Dispose();
+            }
+            request.Completion.TrySetResult(response);
+        }
+        
+        /**
+         * \brief   Leaves the busy state once no request waits for its response anymore.
+         *
+         *          The state change notifies listeners, so it isn't done under _requestLock. A request queued meanwhile
+         *          is found by the check after the change; SendAsync checks the state after queuing likewise.
+         */
+        private void FinishIfIdle()
+        {
+            if (HasPendingRequests() || _currentState.State != ConnectorStates.Busy)
+            {
+                return;
+            }
+            _currentState.ExecuteCommand(StateEngine.Command.ExecuteFinished);
+            if (HasPendingRequests() && _currentState.State == ConnectorStates.Idle)
+            {
+                _currentState.ExecuteCommand(StateEngine.Command.Execute);
+            }
+        }
+
+        private bool HasPendingRequests()
+        {
+            lock (_requestLock)
+            {
+                return (_requests.Count > 0);
+            }
+        }
+        
+        /**
+         * \brief   Completes all pending requests with null, e.g. because the connection was closed.
+         */
+        private void FailPendingRequests()
+        {
+            List<PendingRequest> aRequests = null;
+            lock (_requestLock)
+            {
+                aRequests = _requests.RemoveAll();
+            }
+            foreach (var aRequest in aRequests)
+            {
+                Complete(aRequest, null);
             }
         }
         
@@ -406,12 +607,11 @@ namespace RTextNppPlugin.RText
             {
                 // Read data from the remote device.
                 _connection.EndReceive(ar);
+                _lastReceivedAt = Environment.TickCount;
                 if (_connection.BytesToRead > 0)
                 {
-                    // There might be more data, so store the data received so far.
-                    _connection.Append();
-                    // converts string into json objects
-                    TryDeserialize();
+                    // converts complete messages into json objects, the rest stays in the decoder
+                    TryDeserialize(Stopwatch.GetTimestamp());
                     //fall through is connection is terminated
                     if (_connection.Connected)
                     {
@@ -440,110 +640,220 @@ namespace RTextNppPlugin.RText
         }
         
         /**
+         * \brief   Query if commands can be executed, i.e. the model is loaded. Commands may be executed while others are
+         *          pending.
+         */
+        private bool AcceptsRequests()
+        {
+            return _currentState.State == ConnectorStates.Idle || _currentState.State == ConnectorStates.Busy;
+        }
+        
+        /**
+        *
+        * \brief   Deserialize all JSON messages received so far.
         *
-        * \brief   Recursively deserialize JSON messages.
+        *          Responses are parsed while they are received, so large ones never have to be buffered completely. Each
+        *          response is built for the request with its invocation id.
         *
+        * \param   receivedAt  Stopwatch timestamp when the bytes were received.
         */
-        private void TryDeserialize()
+        private void TryDeserialize(long receivedAt)
         {
-            if (_connection.LengthMatched)
+            ArraySegment<byte> aMessage;
+            bool aIsLast = false;
+            while (true)
             {
-                //we know the length but the received stream is not enough
-                if (_connection.RequiredLength <= _connection.ReceivedMessage.Length)
+                if (_responseParser == null)
                 {
-                    OnSufficientResponseLengthAcquired();
+                    _responseDispatcher = new ResponseDispatcher(CreateResponseBuilder);
+                    _responseParser     = (_encoding == ProtocolEncoding.MessagePack) ? (IResponseParser)new MessagePackPushParser(_responseDispatcher)
+                                                                                       : new JsonPushParser(_responseDispatcher);
                 }
-            }
-            else
-            {
-                Match aMatch = _messageLengthRegex.Match(_connection.ReceivedMessage.ToString());
-                if (aMatch.Success)
+                if (!_connection.Frames.TryReadPart(out aMessage, out aIsLast))
+                {
+                    return;
+                }
+                if (_responseStartedAt == 0)
                 {
-                    _connection.LengthMatched   = true;
-                    _connection.JSONLength      = Int32.Parse(aMatch.Groups[1].Value);
-                    _connection.RequiredLength  = _connection.JSONLength.ToString().Length + _connection.JSONLength;
-                    _connection.ReceivedMessage = new StringBuilder(_connection.ReceivedMessage.ToString(), _connection.RequiredLength);
-                    if (_connection.RequiredLength <= _connection.ReceivedMessage.Length)
+                    _responseStartedAt = receivedAt;
+                }
+                long aParseStartedAt = Stopwatch.GetTimestamp();
+                _responseParser.Feed(aMessage.Array, aMessage.Offset, aMessage.Count);
+                _responseDeserializeTicks += Stopwatch.GetTimestamp() - aParseStartedAt;
+                _responseBytes            += aMessage.Count;
+                if (aIsLast)
+                {
+                    if (!_responseParser.IsComplete)
+                    {
+                        throw new InvalidDataException("Response ended within its document.");
+                    }
+                    var aResponse       = _responseDispatcher.Response;
+                    if (!_responseDispatcher.HasInvocationId)
                     {
-                        OnSufficientResponseLengthAcquired();
+                        Logging.Logger.Instance.Append(Logging.Logger.MessageType.Warning, _backendProcess.Workspace, "Dropped a response without a valid invocation id.");
                     }
+                    _responseParser     = null;
+                    _responseDispatcher = null;
+                    RaiseProblemsReceived();
+                    //handle various responses
+                    AnalyzeResponse(aResponse);
+                    ResetResponseTiming();
                 }
             }
         }
         
-        private void OnSufficientResponseLengthAcquired()
-        {
-            _connection.LengthMatched   = false;
-            string aJSONmessage         = _connection.ReceivedMessage.ToString(_connection.JSONLength.ToString().Length, _connection.JSONLength);
-            _connection.ReceivedMessage = new StringBuilder(_connection.ReceivedMessage.ToString(_connection.RequiredLength,
-                                                            _connection.ReceivedMessage.Length - _connection.RequiredLength));
-            //handle various responses
-            AnalyzeResponse(aJSONmessage);
-            TryDeserialize();
-        }
-        
         /**
+         * \brief   Creates the builder of the response with an invocation id.
          *
-         * \brief   Analyzes the last received response.
-         *
-         * \param   response    The response string.
+         * \return  The builder, null if no command waits for the response.
          */
-        private void AnalyzeResponse(string response)
+        private ResponseBuilder CreateResponseBuilder(int invocationId)
         {
-            bool aIsResponceReceived = false;
-            switch (ActiveCommand)
+            if (invocationId == _loadInvocationId)
+            {
+                return CreateResponseBuilder(Constants.Commands.LOAD_MODEL);
+            }
+            lock (_requestLock)
+            {
+                var aRequest = _requests.Find(invocationId);
+                return (aRequest != null) ? CreateResponseBuilder(aRequest.Request.command) : null;
+            }
+        }
+        
+        private ResponseBuilder CreateResponseBuilder(string command)
+        {
+            switch (command)
             {
                 case Constants.Commands.LOAD_MODEL:
-                    _lastResponse = JsonConvert.DeserializeObject<LoadResponse>(response) as IResponseBase;
-                    aIsResponceReceived = IsNotResponseOrErrorMessage();
-                    break;
+                    return new LoadResponseBuilder(OnProblemsParsed);
                 case Constants.Commands.LINK_TARGETS:
-                    _lastResponse = JsonConvert.DeserializeObject<LinkTargetsResponse>(response) as IResponseBase;
-                    aIsResponceReceived = IsNotResponseOrErrorMessage();
-                    break;
-                case Constants.Commands.FIND_ELEMENTS:
-                    _lastResponse = JsonConvert.DeserializeObject<FindRTextElementsResponse>(response) as IResponseBase;
-                    aIsResponceReceived = IsNotResponseOrErrorMessage();
-                    break;
+                    return new LinkTargetsResponseBuilder();
                 case Constants.Commands.CONTENT_COMPLETION:
-                    _lastResponse = JsonConvert.DeserializeObject<AutoCompleteResponse>(response) as IResponseBase;
-                    aIsResponceReceived = IsNotResponseOrErrorMessage();
-                    break;
+                    return new AutoCompleteResponseBuilder();
+                case Constants.Commands.FIND_ELEMENTS:
+                    return new FindElementsResponseBuilder();
                 case Constants.Commands.CONTEXT_INFO:
-                    _lastResponse = JsonConvert.DeserializeObject<ContextInfoResponse>(response) as IResponseBase;
-                    aIsResponceReceived = IsNotResponseOrErrorMessage();
-                    break;
-                case Constants.Commands.STOP:
-                    _lastResponse = JsonConvert.DeserializeObject<ResponseBase>(response) as IResponseBase;
-                    aIsResponceReceived = true;
-                    _connection.CleanUpSocket();
-                    break;
-            }
-            if (aIsResponceReceived)
-            {
-                if (ActiveCommand == Constants.Commands.LOAD_MODEL)
+                    return new ContextInfoResponseBuilder();
+                default:
+                    return new ResponseBaseBuilder();
+            }
+        }
+        
+        /**
+         * \brief   Discards the response being received, e.g. because the connection was closed.
+         */
+        private void ResetResponse()
+        {
+            _responseParser     = null;
+            _responseDispatcher = null;
+            _receivedProblems   = new List<Error>();
+            ResetResponseTiming();
+        }
+        
+        private void ResetResponseTiming()
+        {
+            _responseStartedAt        = 0;
+            _responseBytes            = 0;
+            _responseDeserializeTicks = 0;
+        }
+        
+        /**
+         * \brief   Adds the measurements of the response just received to the timing of the request it answers.
+         */
+        private void AddResponseTiming(RequestTiming timing)
+        {
+            if (timing.FirstByteAt == 0)
+            {
+                timing.FirstByteAt = _responseStartedAt;
+            }
+            timing.Bytes            += _responseBytes;
+            timing.DeserializeTicks += _responseDeserializeTicks;
+        }
+        
+        private void OnProblemsParsed(Error problems)
+        {
+            _receivedProblems.Add(problems);
+            if (_receivedProblems.Count == PROBLEMS_BATCH_SIZE)
+            {
+                RaiseProblemsReceived();
+            }
+        }
+        
+        private void RaiseProblemsReceived()
+        {
+            if (_receivedProblems.Count == 0)
+            {
+                return;
+            }
+            if (OnProblemsReceived != null)
+            {
+                OnProblemsReceived(this, new ProblemsReceivedEventArgs
                 {
-                    ErrorList = (_lastResponse as LoadResponse);
-                }
-                if (_InvocationId - 1 != _lastResponse.invocation_id)
+                    Problems  = _receivedProblems,
+                    Workspace = _backendProcess.ProcKey
+                });
+            }
+            _receivedProblems = new List<Error>();
+        }
+        
+        /**
+         *
+         * \brief   Analyzes the last received response.
+         *
+         * \param   response    The response, null if no command waits for it.
+         */
+        private void AnalyzeResponse(IResponseBase response)
+        {
+            if (response == null)
+            {
+                return;
+            }
+            if (response.invocation_id == _loadInvocationId)
+            {
+                AddResponseTiming(_loadTiming);
+                if (IsNotResponseOrErrorMessage(response, Constants.Commands.LOAD_MODEL))
                 {
-                    Logging.Logger.Instance.Append(Logging.Logger.MessageType.Error,
-                                                    _backendProcess.Workspace,
-                                                    "void AnalyzeResponse(ref string response, ref StateObject state) - Invocation id mismatch : Expected {0} - Received {1}",
-                                                    _InvocationId - 1,
-                                                    _lastResponse.invocation_id);
-                    _lastResponse = null;
-                    _currentState.ExecuteCommand(StateEngine.Command.Disconnected);
+                    _statistics.Record(Constants.Commands.LOAD_MODEL, _loadTiming, Stopwatch.GetTimestamp());
+                    _loadInvocationId = -1;
+                    ErrorList         = (response as LoadResponse);
+                    //responses of the previous model are outdated
+                    _backendProcess.ResponseCache.Invalidate();
+                    _currentState.ExecuteCommand(StateEngine.Command.ExecuteFinished);
                 }
-                else
+                return;
+            }
+            PendingRequest aRequest = null;
+            lock (_requestLock)
+            {
+                aRequest = _requests.Find(response.invocation_id);
+            }
+            if (aRequest == null)
+            {
+                //the connection was closed meanwhile
+                return;
+            }
+            AddResponseTiming(aRequest.Timing);
+            if (aRequest.Request.command == Constants.Commands.STOP)
+            {
+                _connection.CleanUpSocket();
+            }
+            else if (!IsNotResponseOrErrorMessage(response, aRequest.Request.command) && response.type != Constants.Commands.ERROR)
+            {
+                //progress, the response follows
+                return;
+            }
+            lock (_requestLock)
+            {
+                if (!_requests.Remove(aRequest))
                 {
-                    _receivedResponseEvent.Set();
-                    if (ActiveCommand != Constants.Commands.STOP)
-                    {
-                        _currentState.ExecuteCommand(StateEngine.Command.ExecuteFinished);
-                    }
+                    return;
                 }
             }
+            _statistics.Record(aRequest.Request.command, aRequest.Timing, Stopwatch.GetTimestamp());
+            //abandoned requests were answered already, their response is dropped
+            Complete(aRequest, (response.type == Constants.Commands.ERROR) ? null : response);
+            SendQueuedRequests();
+            FinishIfIdle();
         }
         
         /**
@@ -552,21 +862,20 @@ namespace RTextNppPlugin.RText
          *
          * \return  true if this is not a progress message, false otherwise.
          */
-        private bool IsNotResponseOrErrorMessage()
+        private bool IsNotResponseOrErrorMessage(IResponseBase response, string command)
         {
-            switch (_lastResponse.type)
+            switch (response.type)
             {
                 case Constants.Commands.PROGRESS:
                     if (OnProgressUpdated != null)
                     {
                         OnProgressUpdated(this, new ProgressResponseEventArgs
                         {
-                            Response  = (ProgressResponse)_lastResponse,
-                            Command   = ActiveCommand,
+                            Response  = (ProgressResponse)response,
+                            Command   = command,
                             Workspace = _backendProcess.ProcKey
                         });
                     }
-                    _receivedResponseEvent.Reset();
                     return false;
                 case Constants.Commands.ERROR:
                     Logging.Logger.Instance.Append(Logging.Logger.MessageType.Error, _backendProcess.Workspace, "bool UpdateProgress( IResponseBase response ) - Back-end reports unknown command error.");
@@ -576,14 +885,6 @@ namespace RTextNppPlugin.RText
             }
         }
         
-        private byte[] PrepareRequestString( string serializedCommand )
-        {
-            StringBuilder aExtendedString = new StringBuilder(serializedCommand.Length + 10);
-            aExtendedString.Append(serializedCommand.Length);
-            aExtendedString.Append(serializedCommand);
-            return Encoding.ASCII.GetBytes(aExtendedString.ToString());
-        }
-        
         private async Task<bool> RestartService()
         {
             if (_backendProcess.HasExited)
@@ -611,9 +912,28 @@ namespace RTextNppPlugin.RText
         
         private byte[] GetCommandAsByteArray<Command>(Command command) where Command : RequestBase
         {
-            command.invocation_id = _InvocationId++;
-            JsonConvert.SerializeObject(command, Formatting.None);
-            return PrepareRequestString(JsonConvert.SerializeObject(command, Formatting.None));
+            command.invocation_id = Interlocked.Increment(ref _InvocationId) - 1;
+            return RequestEncoder.Encode(command, _encoding);
+        }
+        
+        /**
+         * \brief   Agrees on the encoding of the messages with the back-end, before anything else is exchanged.
+         *
+         * \return  false if the back-end didn't answer.
+         */
+        private bool NegotiateEncoding()
+        {
+            try
+            {
+                _encoding = EncodingNegotiator.Negotiate(_connection, PREFERRED_ENCODING, Interlocked.Increment(ref _InvocationId) - 1, Constants.CONNECT_TIMEOUT);
+                Logging.Logger.Instance.Append("Messages with the back-end are encoded as {0}.", _encoding);
+                return true;
+            }
+            catch (Exception ex)
+            {
+                Logging.Logger.Instance.Append(Logging.Logger.MessageType.Error, _backendProcess.Workspace, "Could not negotiate the encoding with RTextService.\nException : {0}", ex.Message);
+                return false;
+            }
         }
         #endregion
         
@@ -622,9 +942,13 @@ namespace RTextNppPlugin.RText
         public void OnDisconnectedEntry()
         {
             //will be "cleaned" by process exit event, also need to keep connection alive till back-end acknowledges stop command
+            _loadInvocationId = -1;
             if (ActiveCommand != Constants.Commands.STOP)
             {
+                _encoding = ProtocolEncoding.Json;
                 _connection.CleanUpSocket();
+                ResetResponse();
+                FailPendingRequests();
             }
         }
         
@@ -634,7 +958,7 @@ namespace RTextNppPlugin.RText
             {
                 //will throw if something is wrong
                 IAsyncResult aConnectedResult = _connection.BeginConnect("localhost", _backendProcess.Port, ConnectCallback);
-                if (!aConnectedResult.AsyncWaitHandle.WaitOne(Constants.CONNECT_TIMEOUT))
+                if (!aConnectedResult.AsyncWaitHandle.WaitOne(Constants.CONNECT_TIMEOUT) || !NegotiateEncoding())
                 {
                     _currentState.ExecuteCommand(StateEngine.Command.Disconnected);
                 }
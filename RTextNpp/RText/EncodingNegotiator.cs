@@ -0,0 +1,68 @@
+﻿using System;
+using System.IO;
+using RTextNppPlugin.RText.Protocol;
+
+namespace RTextNppPlugin.RText
+{
+    /**
+     * \brief   Agrees on the encoding of the messages with the back-end, right after connecting.
+     *
+     *          The request is sent as JSON and the back-end answers in JSON. If it accepts the encoding, it echoes its
+     *          name and uses it for all messages which follow the response; the client does the same. A back-end which
+     *          doesn't know the command answers with an unknown command error and both sides keep using JSON.
+     */
+    internal static class EncodingNegotiator
+    {
+        #region [Interface]
+        /**
+         * \brief   Asks the back-end to use an encoding. Nothing else may be received while negotiating.
+         *
+         * \param   connection      The connection, it mustn't receive asynchronously yet.
+         * \param   encoding        The preferred encoding.
+         * \param   invocationId    The invocation id of the request.
+         * \param   timeout         The time to wait for the response, in milliseconds.
+         *
+         * \return  The encoding of the following messages.
+         *
+         * \exception   TimeoutException    The back-end didn't answer in time.
+         * \exception   IOException         The connection was closed.
+         */
+        internal static ProtocolEncoding Negotiate(SocketConnection connection, ProtocolEncoding encoding, int invocationId, int timeout)
+        {
+            if (encoding == ProtocolEncoding.Json)
+            {
+                return ProtocolEncoding.Json;
+            }
+            var aRequest = new EncodingRequest
+            {
+                command       = Constants.Commands.SET_ENCODING,
+                invocation_id = invocationId,
+                encoding      = EncodingRequest.MESSAGE_PACK
+            };
+            byte[] aBytes = RequestEncoder.Encode(aRequest);
+            if (connection.SendRequest(aBytes) != aBytes.Length)
+            {
+                throw new IOException("Could not send the encoding request.");
+            }
+            ArraySegment<byte> aMessage;
+            while (!connection.Frames.TryRead(out aMessage))
+            {
+                var aReceived = connection.BeginReceive(null);
+                if (!aReceived.AsyncWaitHandle.WaitOne(timeout))
+                {
+                    throw new TimeoutException("The back-end didn't answer the encoding request.");
+                }
+                connection.EndReceive(aReceived);
+                if (connection.BytesToRead == 0)
+                {
+                    throw new IOException("The back-end closed the connection.");
+                }
+            }
+            var aBuilder = new EncodingResponseBuilder();
+            new JsonPushParser(aBuilder).Feed(aMessage.Array, aMessage.Offset, aMessage.Count);
+            var aResponse = (EncodingResponse)aBuilder.Response;
+            return (aResponse.invocation_id == invocationId && aResponse.encoding == EncodingRequest.MESSAGE_PACK) ? ProtocolEncoding.MessagePack : ProtocolEncoding.Json;
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,268 @@
+﻿using System;
+using System.IO;
+
+namespace RTextNppPlugin.RText
+{
+    /**
+     * \brief   Splits the byte stream received from the back-end into messages.
+     *
+     *          Every message is prefixed by the decimal length of its body, e.g. 13{"type":"x"}. The body is a JSON object
+     *          or, once negotiated, a MessagePack map, whose first byte is no digit either. Received bytes are
+     *          written straight into the buffer of the decoder, so the socket needs no buffer of its own. The length prefix
+     *          is parsed as its bytes arrive and the scan position is kept between chunks, so no byte is looked at twice.
+     *          Once the length of a message is known the buffer is grown to hold all of it, so large messages are received
+     *          in place instead of being copied whenever a chunk arrives. Consumed bytes are only moved to the front of the
+     *          buffer when more space is needed.
+     *
+     *          Alternatively the body of a message can be read in parts as they arrive, e.g. to parse it while it is still
+     *          being received. The buffer then never has to hold the whole message.
+     */
+    internal sealed class FrameDecoder
+    {
+        #region [Data Members]
+        private const int MAX_PREFIX_DIGITS = 9;    //!< Longer prefixes would overflow the message length.
+
+        private byte[] _buffer      = null;     //!< Received bytes, the unconsumed ones are in [_start, _end).
+        private int _start          = 0;        //!< Start of the first unconsumed message.
+        private int _end            = 0;        //!< End of the received bytes.
+        private int _scan           = 0;        //!< Next byte of the length prefix to parse.
+        private int _length         = 0;        //!< Length of the body of the current message, parsed so far.
+        private bool _lengthMatched = false;    //!< Whether the length prefix of the current message is complete.
+        private bool _isPartial     = false;    //!< Whether a part of the body of the current message was read already.
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates a decoder.
+         *
+         * \param   capacity    The initial size of the buffer.
+         */
+        internal FrameDecoder(int capacity)
+        {
+            _buffer = new byte[Math.Max(1, capacity)];
+        }
+
+        /**
+         * \brief   Gets the number of received bytes which are not part of a decoded message yet.
+         */
+        internal int Pending
+        {
+            get
+            {
+                return _end - _start;
+            }
+        }
+
+        /**
+         * \brief   Gets a buffer to receive bytes into. Call Commit with the number of received bytes afterwards.
+         *
+         * \param   minSize The minimum number of free bytes.
+         *
+         * \return  The free part of the buffer, it is at least minSize bytes long.
+         */
+        internal ArraySegment<byte> GetWriteBuffer(int minSize)
+        {
+            Reserve(minSize);
+            return new ArraySegment<byte>(_buffer, _end, _buffer.Length - _end);
+        }
+
+        /**
+         * \brief   Marks bytes received into the buffer returned by GetWriteBuffer as received.
+         *
+         * \param   count   The number of received bytes.
+         */
+        internal void Commit(int count)
+        {
+            if (count < 0 || count > _buffer.Length - _end)
+            {
+                throw new ArgumentOutOfRangeException("count");
+            }
+            _end += count;
+        }
+
+        /**
+         * \brief   Copies received bytes into the buffer.
+         */
+        internal void Append(byte[] bytes, int offset, int count)
+        {
+            var aTarget = GetWriteBuffer(count);
+            Buffer.BlockCopy(bytes, offset, aTarget.Array, aTarget.Offset, count);
+            Commit(count);
+        }
+
+        /**
+         * \brief   Gets the next complete message.
+         *
+         * \param   [out] body  The body of the message, without the length prefix. It refers to the buffer of the
+         *                      decoder and is only valid until the buffer is written to again.
+         *
+         * \return  true if a message was complete, false if more bytes are needed.
+         *
+         * \exception   InvalidDataException        The stream doesn't start with a valid length prefix.
+         * \exception   InvalidOperationException   The current message is being read in parts.
+         */
+        internal bool TryRead(out ArraySegment<byte> body)
+        {
+            body = default(ArraySegment<byte>);
+            if (_isPartial)
+            {
+                throw new InvalidOperationException("The current message is being read in parts.");
+            }
+            if (!_lengthMatched && !ParsePrefix())
+            {
+                return false;
+            }
+            if (_end - _scan < _length)
+            {
+                //make room for the rest of the message, so that it is received in place
+                Reserve(_length - (_end - _scan));
+                return false;
+            }
+            body = new ArraySegment<byte>(_buffer, _scan, _length);
+            Consume(_length);
+            return true;
+        }
+
+        /**
+         * \brief   Gets the received part of the body of the current message, which wasn't read yet.
+         *
+         * \param   [out] part      The next bytes of the body. It refers to the buffer of the decoder and is only valid
+         *                          until the buffer is written to again.
+         * \param   [out] isLast    Whether part ends the message, the next call continues with the following message.
+         *
+         * \return  true if a part was available, false if more bytes are needed.
+         *
+         * \exception   InvalidDataException    The stream doesn't start with a valid length prefix.
+         */
+        internal bool TryReadPart(out ArraySegment<byte> part, out bool isLast)
+        {
+            part   = default(ArraySegment<byte>);
+            isLast = false;
+            if (!_lengthMatched && !ParsePrefix())
+            {
+                return false;
+            }
+            int aCount = Math.Min(_end - _scan, _length);
+            if (aCount == 0 && _length > 0)
+            {
+                return false;
+            }
+            part   = new ArraySegment<byte>(_buffer, _scan, aCount);
+            isLast = (aCount == _length);
+            if (isLast)
+            {
+                Consume(aCount);
+            }
+            else
+            {
+                _isPartial = true;
+                _length   -= aCount;
+                _scan     += aCount;
+                _start     = _scan;
+                if (_start == _end)
+                {
+                    _start = _end = _scan = 0;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * \brief   Discards all received bytes, e.g. after the connection was closed.
+         */
+        internal void Reset()
+        {
+            _start         = 0;
+            _end           = 0;
+            _scan          = 0;
+            _length        = 0;
+            _lengthMatched = false;
+            _isPartial     = false;
+        }
+        #endregion
+
+        #region [Helpers]
+        /**
+         * \brief   Moves past the last count bytes of the current message.
+         */
+        private void Consume(int count)
+        {
+            _start         = _scan + count;
+            _scan          = _start;
+            _length        = 0;
+            _lengthMatched = false;
+            _isPartial     = false;
+            if (_start == _end)
+            {
+                _start = _end = _scan = 0;
+            }
+        }
+
+        /**
+         * \brief   Continues parsing the length prefix where the previous call stopped.
+         *
+         * \return  true if the prefix is complete, i.e. the first byte of the body was reached.
+         */
+        private bool ParsePrefix()
+        {
+            for (; _scan < _end; ++_scan)
+            {
+                byte aByte = _buffer[_scan];
+                if (aByte >= (byte)'0' && aByte <= (byte)'9')
+                {
+                    if (_scan - _start == MAX_PREFIX_DIGITS)
+                    {
+                        throw new InvalidDataException("Length prefix of message is too long.");
+                    }
+                    _length = _length * 10 + (aByte - (byte)'0');
+                }
+                else if (IsBodyStart(aByte) && _scan > _start)
+                {
+                    _lengthMatched = true;
+                    return true;
+                }
+                else
+                {
+                    throw new InvalidDataException(String.Format("Unexpected byte 0x{0:X2} in length prefix of message.", aByte));
+                }
+            }
+            return false;
+        }
+
+        /**
+         * \brief   Query if a byte starts the body of a message, i.e. a JSON object or a MessagePack map.
+         */
+        private static bool IsBodyStart(byte value)
+        {
+            return value == (byte)'{' || (value >= 0x80 && value <= 0x8f) || value == 0xde || value == 0xdf;
+        }
+
+        /**
+         * \brief   Makes sure that at least size bytes can be written after the received ones.
+         */
+        private void Reserve(int size)
+        {
+            if (_buffer.Length - _end >= size)
+            {
+                return;
+            }
+            int aPending = _end - _start;
+            byte[] aTarget = _buffer;
+            if (aPending + size > _buffer.Length)
+            {
+                long aCapacity = _buffer.Length;
+                while (aCapacity < aPending + (long)size)
+                {
+                    aCapacity *= 2;
+                }
+                aTarget = new byte[(int)Math.Min(Int32.MaxValue, aCapacity)];
+            }
+            Buffer.BlockCopy(_buffer, _start, aTarget, 0, aPending);
+            _buffer = aTarget;
+            _scan  -= _start;
+            _end    = aPending;
+            _start  = 0;
+        }
+        #endregion
+    }
+}
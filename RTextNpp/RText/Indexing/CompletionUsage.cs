@@ -0,0 +1,271 @@
+﻿using RTextNppPlugin.Logging;
+using System;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Threading.Tasks;
+
+namespace RTextNppPlugin.RText.Indexing
+{
+    /**
+     * \brief   Persistent frequency and recency of committed completions of a workspace, stored next to the .rtext file.
+     *
+     *          A completion is keyed by the command of the element it was committed in, the label of the feature and the
+     *          inserted text. Keys are stored as 64 bit hashes in a fixed size open addressing table, so a lookup probes a
+     *          few adjacent slots and never allocates. When all slots of a probe window are taken, the least useful one is
+     *          replaced.
+     *
+     *          Layout, all numbers little endian:
+     *          - header    : magic "RTUS", format version, clock, i.e. number of commits, reserved
+     *          - slots     : SLOT_COUNT times key hash, number of commits, clock of the last commit; key 0 marks a free slot
+     *
+     *          The file has a fixed size and is read through a read-only memory mapped view. It is rewritten through a
+     *          temporary file in the background after every commit.
+     */
+    internal sealed class CompletionUsage
+    {
+        #region [Data Members]
+        private const uint MAGIC        = 0x53555452;   //!< "RTUS"
+        private const int VERSION       = 1;            //!< Incremented whenever the layout changes.
+        private const int SLOT_COUNT    = 4096;         //!< Number of slots, a power of two.
+        private const int PROBE_WINDOW  = 8;            //!< Number of adjacent slots a key may be stored in.
+        private const int HEADER_SIZE   = 16;
+        private const int SLOT_SIZE     = 16;
+        private const uint HALF_LIFE    = 64;           //!< Number of commits after which the weight of a commit is halved.
+        private const int MAX_SCORE     = 64;           //!< Upper bound of Score.
+
+        private readonly string _filePath  = null;                      //!< The persistent table, null if it is not persisted.
+        private readonly ulong[] _keys     = new ulong[SLOT_COUNT];     //!< Key hash of every slot, 0 for free slots.
+        private readonly uint[] _counts    = new uint[SLOT_COUNT];      //!< Number of commits of every slot.
+        private readonly uint[] _lastUses  = new uint[SLOT_COUNT];      //!< Clock of the last commit of every slot.
+        private readonly object _lock      = new object();              //!< Guards the table, commits and saving may overlap.
+        private readonly object _saveLock  = new object();              //!< Serializes writing the file.
+        private uint _clock                = 0;                         //!< Number of commits so far.
+        private uint _savedClock           = 0;                         //!< Clock of the last written table.
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Gets the path of the usage table of a workspace.
+         *
+         * \param   rTextFilePath   The .rtext file of the workspace.
+         * \param   extension       The extension of the workspace files.
+         */
+        internal static string GetFilePath(string rTextFilePath, string extension)
+        {
+            return rTextFilePath + extension + ".usage";
+        }
+
+        /**
+         * \brief   Creates a usage table, loading it if it exists.
+         *
+         * \param   filePath    The path of the table, null for a table which is kept in memory only.
+         */
+        internal CompletionUsage(string filePath)
+        {
+            _filePath = filePath;
+            if (_filePath != null)
+            {
+                Load();
+                _savedClock = _clock;
+            }
+        }
+
+        /**
+         * \brief   Records a committed completion and saves the table in the background.
+         *
+         * \param   command     The command of the element the completion was committed in.
+         * \param   label       The label of the feature, empty for unlabelled arguments.
+         * \param   completion  The inserted text.
+         */
+        internal void Record(string command, string label, string completion)
+        {
+            ulong aKey = GetKey(command, label, completion);
+            lock (_lock)
+            {
+                ++_clock;
+                int aSlot = Find(aKey);
+                if (aSlot < 0)
+                {
+                    aSlot          = FindVictim(aKey);
+                    _keys[aSlot]   = aKey;
+                    _counts[aSlot] = 0;
+                }
+                ++_counts[aSlot];
+                _lastUses[aSlot] = _clock;
+            }
+            if (_filePath != null)
+            {
+                Task.Run(() => Save());
+            }
+        }
+
+        /**
+         * \brief   Gets how useful a completion was in the past, i.e. the number of its commits, weighted by their age.
+         *
+         * \param   command     The command of the element the completion would be committed in.
+         * \param   label       The label of the feature, empty for unlabelled arguments.
+         * \param   completion  The text which would be inserted.
+         *
+         * \return  The score between 0 for never committed completions and MAX_SCORE.
+         */
+        internal int Score(string command, string label, string completion)
+        {
+            ulong aKey = GetKey(command, label, completion);
+            lock (_lock)
+            {
+                int aSlot = Find(aKey);
+                return (aSlot < 0) ? 0 : ScoreOf(aSlot);
+            }
+        }
+        #endregion
+
+        #region [Helpers]
+        /**
+         * \brief   FNV-1a hash of the key parts, never 0.
+         */
+        private static ulong GetKey(string command, string label, string completion)
+        {
+            ulong aHash = 14695981039346656037UL;
+            foreach (var aPart in new[] { command, label, completion })
+            {
+                foreach (var c in aPart ?? String.Empty)
+                {
+                    aHash = (aHash ^ c) * 1099511628211UL;
+                }
+                aHash = (aHash ^ 0xFFFF) * 1099511628211UL;
+            }
+            return (aHash == 0) ? 1 : aHash;
+        }
+
+        private int Find(ulong key)
+        {
+            for (int i = 0; i < PROBE_WINDOW; ++i)
+            {
+                int aSlot = (int)((key + (ulong)i) & (SLOT_COUNT - 1));
+                if (_keys[aSlot] == key)
+                {
+                    return aSlot;
+                }
+            }
+            return -1;
+        }
+
+        private int FindVictim(ulong key)
+        {
+            int aVictim = -1;
+            for (int i = 0; i < PROBE_WINDOW; ++i)
+            {
+                int aSlot = (int)((key + (ulong)i) & (SLOT_COUNT - 1));
+                if (_keys[aSlot] == 0)
+                {
+                    return aSlot;
+                }
+                if (aVictim < 0 || ScoreOf(aSlot) < ScoreOf(aVictim) || (ScoreOf(aSlot) == ScoreOf(aVictim) && _lastUses[aSlot] < _lastUses[aVictim]))
+                {
+                    aVictim = aSlot;
+                }
+            }
+            return aVictim;
+        }
+
+        private int ScoreOf(int slot)
+        {
+            ulong aAge = _clock - _lastUses[slot];
+            return (int)Math.Min(MAX_SCORE, (ulong)_counts[slot] * 16UL * HALF_LIFE / (HALF_LIFE + aAge));
+        }
+
+        private void Load()
+        {
+            try
+            {
+                if (!File.Exists(_filePath) || new FileInfo(_filePath).Length != HEADER_SIZE + SLOT_COUNT * SLOT_SIZE)
+                {
+                    return;
+                }
+                using (var aMappedFile = MemoryMappedFile.CreateFromFile(_filePath, FileMode.Open, null, 0, MemoryMappedFileAccess.Read))
+                using (var aView = aMappedFile.CreateViewAccessor(0, 0, MemoryMappedFileAccess.Read))
+                {
+                    if (aView.ReadUInt32(0) != MAGIC || aView.ReadInt32(4) != VERSION)
+                    {
+                        return;
+                    }
+                    _clock = aView.ReadUInt32(8);
+                    for (int i = 0; i < SLOT_COUNT; ++i)
+                    {
+                        long aOffset = HEADER_SIZE + (long)i * SLOT_SIZE;
+                        _keys[i]     = aView.ReadUInt64(aOffset);
+                        _counts[i]   = aView.ReadUInt32(aOffset + 8);
+                        _lastUses[i] = aView.ReadUInt32(aOffset + 12);
+                    }
+                }
+            }
+            catch (Exception ex)
+            {
+                Logger.Instance.Append(Logger.MessageType.Error, Constants.GENERAL_CHANNEL, "CompletionUsage.Load({0}) - Exception : {1}", _filePath, ex.Message);
+                _clock = 0;
+                Array.Clear(_keys, 0, SLOT_COUNT);
+            }
+        }
+
+        private void Save()
+        {
+            var aBytes  = new byte[HEADER_SIZE + SLOT_COUNT * SLOT_SIZE];
+            uint aClock = 0;
+            lock (_lock)
+            {
+                aClock = _clock;
+                Write(aBytes, 0, MAGIC);
+                Write(aBytes, 4, VERSION);
+                Write(aBytes, 8, _clock);
+                for (int i = 0; i < SLOT_COUNT; ++i)
+                {
+                    int aOffset = HEADER_SIZE + i * SLOT_SIZE;
+                    Write(aBytes, aOffset, (uint)_keys[i]);
+                    Write(aBytes, aOffset + 4, (uint)(_keys[i] >> 32));
+                    Write(aBytes, aOffset + 8, _counts[i]);
+                    Write(aBytes, aOffset + 12, _lastUses[i]);
+                }
+            }
+            lock (_saveLock)
+            {
+                //a save of a later commit may have overtaken this one
+                if (aClock <= _savedClock)
+                {
+                    return;
+                }
+                string aTempFile = _filePath + ".tmp";
+                try
+                {
+                    File.WriteAllBytes(aTempFile, aBytes);
+                    if (File.Exists(_filePath))
+                    {
+                        File.Replace(aTempFile, _filePath, null);
+                    }
+                    else
+                    {
+                        File.Move(aTempFile, _filePath);
+                    }
+                    _savedClock = aClock;
+                }
+                catch (Exception ex)
+                {
+                    Logger.Instance.Append(Logger.MessageType.Error, Constants.GENERAL_CHANNEL, "CompletionUsage.Save({0}) - Exception : {1}", _filePath, ex.Message);
+                }
+            }
+        }
+
+        private static void Write(byte[] bytes, int offset, uint value)
+        {
+            bytes[offset]     = (byte)value;
+            bytes[offset + 1] = (byte)(value >> 8);
+            bytes[offset + 2] = (byte)(value >> 16);
+            bytes[offset + 3] = (byte)(value >> 24);
+        }
+
+        private static void Write(byte[] bytes, int offset, int value)
+        {
+            Write(bytes, offset, (uint)value);
+        }
+        #endregion
+    }
+}
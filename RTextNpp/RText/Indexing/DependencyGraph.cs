@@ -0,0 +1,450 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+
+namespace RTextNppPlugin.RText.Indexing
+{
+    /**
+     * \brief   Immutable dependency graph of the workspace files, derived from the resolved references of their elements.
+     *
+     *          Element edges lead from a referencing element to every element the reference resolves to, file edges from a
+     *          file to every other file containing such a target. Updating the graph only resolves the references of the
+     *          given files again. Cycles are kept as the strongly connected components of the file graph, an update only
+     *          searches the part of the graph which is reachable from the changed files.
+     */
+    internal sealed class DependencyGraph
+    {
+        #region [Data Members]
+        private readonly Dictionary<string, Node> _nodes        = null; //!< Outgoing edges by full path of the file.
+        private readonly Dictionary<string, string[]> _incoming = null; //!< Full paths of the dependent files by full path of the file.
+        private readonly List<string[]> _cycles                 = null; //!< Strongly connected components with more than one file.
+        private readonly Dictionary<string, int> _cycleOf       = null; //!< Index into _cycles by full path of the file.
+
+        /**
+         * \brief   An edge from a referencing element to a referenced element.
+         */
+        internal struct ElementEdge
+        {
+            internal int Reference;         //!< Index of the reference, see FileSymbols.References.
+            internal string TargetFile;     //!< Full path of the file of the referenced element.
+            internal int TargetElement;     //!< Index of the referenced element, see FileSymbols.Elements.
+        }
+
+        private sealed class Node
+        {
+            internal FileSymbols File;
+            internal ElementEdge[] Edges;
+            internal string[] Targets;      //!< Distinct target files except the file itself.
+        }
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates the graph of some files.
+         *
+         * \param   files           The files.
+         * \param   collectEdges    Resolves the references of a file to edges.
+         */
+        internal DependencyGraph(IEnumerable<FileSymbols> files, Func<FileSymbols, ElementEdge[]> collectEdges)
+        {
+            _nodes = new Dictionary<string, Node>(StringComparer.OrdinalIgnoreCase);
+            foreach (var aFile in files)
+            {
+                _nodes[aFile.File] = CreateNode(aFile, collectEdges);
+            }
+            _incoming = new Dictionary<string, string[]>(StringComparer.OrdinalIgnoreCase);
+            foreach (var aGroup in _nodes.Values.SelectMany(x => x.Targets.Select(y => new { Source = x.File.File, Target = y })).GroupBy(x => x.Target, StringComparer.OrdinalIgnoreCase))
+            {
+                _incoming.Add(aGroup.Key, aGroup.Select(x => x.Source).ToArray());
+            }
+            _cycles  = new List<string[]>();
+            _cycleOf = new Dictionary<string, int>(StringComparer.OrdinalIgnoreCase);
+            foreach (var aComponent in FindComponents(_nodes.Keys))
+            {
+                AddCycle(aComponent);
+            }
+        }
+
+        /**
+         * \brief   Creates a new graph with the edges of some files replaced or removed. This graph is not modified.
+         *
+         * \param   updated         The new or changed files and all unchanged files which references may resolve differently.
+         * \param   removed         The full paths of removed files.
+         * \param   collectEdges    Resolves the references of a file to edges.
+         *
+         * \return  The new graph.
+         */
+        internal DependencyGraph Update(IEnumerable<FileSymbols> updated, IEnumerable<string> removed, Func<FileSymbols, ElementEdge[]> collectEdges)
+        {
+            var aGraph   = new DependencyGraph(new Dictionary<string, Node>(_nodes, StringComparer.OrdinalIgnoreCase), new Dictionary<string, string[]>(_incoming, StringComparer.OrdinalIgnoreCase));
+            var aChanged = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+            Node aNode   = null;
+            foreach (var aFile in removed)
+            {
+                if (aGraph._nodes.TryGetValue(aFile, out aNode))
+                {
+                    aGraph.SetNode(aFile, aNode, null);
+                    aChanged.Add(aFile);
+                }
+            }
+            foreach (var aFile in updated)
+            {
+                aGraph._nodes.TryGetValue(aFile.File, out aNode);
+                aGraph.SetNode(aFile.File, aNode, CreateNode(aFile, collectEdges));
+                aChanged.Add(aFile.File);
+            }
+            //a cycle appears or breaks only with an edge of a changed file, so every other cycle stays as it is, unless the
+            //new edges merge it into a larger one
+            var aRoots = new HashSet<string>(aChanged.Where(x => aGraph._nodes.ContainsKey(x)), StringComparer.OrdinalIgnoreCase);
+            int aCycle = 0;
+            foreach (var aFile in aChanged)
+            {
+                if (_cycleOf.TryGetValue(aFile, out aCycle))
+                {
+                    aRoots.UnionWith(_cycles[aCycle].Where(x => aGraph._nodes.ContainsKey(x)));
+                }
+            }
+            var aVisited    = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+            var aComponents = FindComponents(aRoots, aGraph._nodes, aVisited);
+            foreach (var aOld in _cycles)
+            {
+                if (!aOld.Any(x => aChanged.Contains(x) || aVisited.Contains(x)))
+                {
+                    aGraph.AddCycle(aOld);
+                }
+            }
+            foreach (var aComponent in aComponents)
+            {
+                aGraph.AddCycle(aComponent);
+            }
+            return aGraph;
+        }
+
+        /**
+         * \brief   Gets the number of edges between different files.
+         */
+        internal int FileEdgeCount
+        {
+            get
+            {
+                return _nodes.Values.Sum(x => x.Targets.Length);
+            }
+        }
+
+        /**
+         * \brief   Gets the files a file depends on directly, i.e. which contain elements it refers to.
+         *
+         * \param   file    The full path of the file.
+         *
+         * \return  The full paths of the files, empty if the file is not indexed.
+         */
+        internal IList<string> GetDependencies(string file)
+        {
+            Node aNode = null;
+            return _nodes.TryGetValue(file, out aNode) ? aNode.Targets : new string[0];
+        }
+
+        /**
+         * \brief   Gets the files which depend on a file directly, i.e. which refer to its elements.
+         *
+         * \param   file    The full path of the file.
+         *
+         * \return  The full paths of the files, empty if there are none.
+         */
+        internal IList<string> GetDependents(string file)
+        {
+            string[] aDependents = null;
+            return _incoming.TryGetValue(file, out aDependents) ? aDependents : new string[0];
+        }
+
+        /**
+         * \brief   Gets the element edges of a file, i.e. the resolved references of its elements.
+         *
+         * \param   file    The full path of the file.
+         *
+         * \return  The edges in document order of the references, empty if the file is not indexed.
+         */
+        internal IList<ElementEdge> GetElementEdges(string file)
+        {
+            Node aNode = null;
+            return _nodes.TryGetValue(file, out aNode) ? aNode.Edges : new ElementEdge[0];
+        }
+
+        /**
+         * \brief   Gets the files which are affected by a change of some files, i.e. which depend on them directly or
+         *          indirectly.
+         *
+         * \param   files   The full paths of the changed files.
+         *
+         * \return  The full paths of the affected files in breadth first order, without the changed files themselves.
+         */
+        internal List<string> GetImpact(IEnumerable<string> files)
+        {
+            return Traverse(files, GetDependents);
+        }
+
+        /**
+         * \brief   Gets all files a file depends on, directly or indirectly, e.g. all files which have to be loaded before it.
+         *
+         * \param   file    The full path of the file.
+         *
+         * \return  The full paths of the files in breadth first order, without the file itself.
+         */
+        internal List<string> GetTransitiveDependencies(string file)
+        {
+            return Traverse(new[] { file }, GetDependencies);
+        }
+
+        /**
+         * \brief   Checks whether a file depends on another file, directly or indirectly.
+         *
+         * \param   from    The full path of the depending file.
+         * \param   to      The full path of the file it may depend on.
+         */
+        internal bool IsReachable(string from, string to)
+        {
+            int aCycle = 0;
+            int aOther = 0;
+            if (_cycleOf.TryGetValue(from, out aCycle) && _cycleOf.TryGetValue(to, out aOther) && aCycle == aOther)
+            {
+                return true;
+            }
+            return Traverse(new[] { from }, GetDependencies).Contains(to, StringComparer.OrdinalIgnoreCase);
+        }
+
+        /**
+         * \brief   Gets the circular dependencies, i.e. the groups of files which depend on each other.
+         */
+        internal IEnumerable<IList<string>> Cycles
+        {
+            get
+            {
+                return _cycles;
+            }
+        }
+
+        /**
+         * \brief   Gets the circular dependency a file is part of.
+         *
+         * \param   file    The full path of the file.
+         *
+         * \return  The full paths of all files of the cycle, null if the file is not part of a cycle.
+         */
+        internal IList<string> GetCycle(string file)
+        {
+            int aCycle = 0;
+            return _cycleOf.TryGetValue(file, out aCycle) ? _cycles[aCycle] : null;
+        }
+
+        /**
+         * \brief   Writes the graph in the DOT language of graphviz.
+         *
+         * \param   writer      The writer.
+         * \param   elements    Whether to write the element graph, otherwise only the file graph is written.
+         */
+        internal void Export(TextWriter writer, bool elements)
+        {
+            writer.WriteLine("digraph workspace {");
+            foreach (var aNode in _nodes.Values.OrderBy(x => x.File.File, StringComparer.OrdinalIgnoreCase))
+            {
+                string aSource = aNode.File.File;
+                if (!elements)
+                {
+                    writer.WriteLine("  {0};", Quote(aSource));
+                    foreach (var aTarget in aNode.Targets)
+                    {
+                        writer.WriteLine("  {0} -> {1};", Quote(aSource), Quote(aTarget));
+                    }
+                    continue;
+                }
+                foreach (var aEdge in aNode.Edges)
+                {
+                    Node aTarget = null;
+                    if (_nodes.TryGetValue(aEdge.TargetFile, out aTarget))
+                    {
+                        int aElement = aNode.File.References[aEdge.Reference].Element;
+                        writer.WriteLine("  {0} -> {1};", Quote(GetElementName(aNode.File, aElement)), Quote(GetElementName(aTarget.File, aEdge.TargetElement)));
+                    }
+                }
+            }
+            writer.WriteLine("}");
+        }
+        #endregion
+
+        #region [Helpers]
+        private DependencyGraph(Dictionary<string, Node> nodes, Dictionary<string, string[]> incoming)
+        {
+            _nodes    = nodes;
+            _incoming = incoming;
+            _cycles   = new List<string[]>();
+            _cycleOf  = new Dictionary<string, int>(StringComparer.OrdinalIgnoreCase);
+        }
+
+        private static Node CreateNode(FileSymbols file, Func<FileSymbols, ElementEdge[]> collectEdges)
+        {
+            var aEdges = collectEdges(file);
+            return new Node
+            {
+                File    = file,
+                Edges   = aEdges,
+                Targets = aEdges.Select(x => x.TargetFile).Where(x => !String.Equals(x, file.File, StringComparison.OrdinalIgnoreCase)).Distinct(StringComparer.OrdinalIgnoreCase).ToArray()
+            };
+        }
+
+        private void SetNode(string file, Node previous, Node node)
+        {
+            var aOld = (previous != null) ? previous.Targets : new string[0];
+            var aNew = (node != null) ? node.Targets : new string[0];
+            foreach (var aTarget in aOld.Except(aNew, StringComparer.OrdinalIgnoreCase))
+            {
+                var aDependents = _incoming[aTarget].Where(x => !String.Equals(x, file, StringComparison.OrdinalIgnoreCase)).ToArray();
+                if (aDependents.Length == 0)
+                {
+                    _incoming.Remove(aTarget);
+                }
+                else
+                {
+                    _incoming[aTarget] = aDependents;
+                }
+            }
+            foreach (var aTarget in aNew.Except(aOld, StringComparer.OrdinalIgnoreCase))
+            {
+                string[] aDependents = null;
+                _incoming[aTarget] = _incoming.TryGetValue(aTarget, out aDependents) ? aDependents.Concat(new[] { file }).ToArray() : new[] { file };
+            }
+            if (node != null)
+            {
+                _nodes[file] = node;
+            }
+            else
+            {
+                _nodes.Remove(file);
+            }
+        }
+
+        private void AddCycle(string[] files)
+        {
+            foreach (var aFile in files)
+            {
+                _cycleOf[aFile] = _cycles.Count;
+            }
+            _cycles.Add(files);
+        }
+
+        private List<string[]> FindComponents(IEnumerable<string> roots)
+        {
+            return FindComponents(roots, _nodes, new HashSet<string>(StringComparer.OrdinalIgnoreCase));
+        }
+
+        /**
+         * \brief   Finds the strongly connected components with more than one file which are reachable from some roots,
+         *          using an iterative version of Tarjan's algorithm.
+         *
+         * \param   roots           The full paths of the files to start from.
+         * \param   nodes           The nodes of the graph.
+         * \param [in,out]  visited The full paths of all reached files.
+         */
+        private static List<string[]> FindComponents(IEnumerable<string> roots, Dictionary<string, Node> nodes, HashSet<string> visited)
+        {
+            var aComponents = new List<string[]>();
+            var aIndex      = new Dictionary<string, int>(StringComparer.OrdinalIgnoreCase);
+            var aLowLink    = new Dictionary<string, int>(StringComparer.OrdinalIgnoreCase);
+            var aStack      = new Stack<string>();
+            var aOnStack    = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+            var aCallStack  = new Stack<KeyValuePair<string, int>>();
+            foreach (var aRoot in roots)
+            {
+                if (!visited.Add(aRoot))
+                {
+                    continue;
+                }
+                aIndex[aRoot] = aLowLink[aRoot] = aIndex.Count;
+                aStack.Push(aRoot);
+                aOnStack.Add(aRoot);
+                aCallStack.Push(new KeyValuePair<string, int>(aRoot, 0));
+                while (aCallStack.Count > 0)
+                {
+                    var aFrame    = aCallStack.Pop();
+                    string aFile  = aFrame.Key;
+                    var aTargets  = nodes[aFile].Targets;
+                    int aNext     = aFrame.Value;
+                    //skip targets which are not indexed, they can't be part of a cycle
+                    while (aNext < aTargets.Length && !nodes.ContainsKey(aTargets[aNext]))
+                    {
+                        ++aNext;
+                    }
+                    if (aNext < aTargets.Length)
+                    {
+                        string aTarget = aTargets[aNext];
+                        aCallStack.Push(new KeyValuePair<string, int>(aFile, aNext + 1));
+                        if (visited.Add(aTarget))
+                        {
+                            aIndex[aTarget] = aLowLink[aTarget] = aIndex.Count;
+                            aStack.Push(aTarget);
+                            aOnStack.Add(aTarget);
+                            aCallStack.Push(new KeyValuePair<string, int>(aTarget, 0));
+                        }
+                        else if (aOnStack.Contains(aTarget))
+                        {
+                            aLowLink[aFile] = Math.Min(aLowLink[aFile], aIndex[aTarget]);
+                        }
+                        continue;
+                    }
+                    if (aLowLink[aFile] == aIndex[aFile])
+                    {
+                        var aComponent = new List<string>();
+                        string aMember = null;
+                        do
+                        {
+                            aMember = aStack.Pop();
+                            aOnStack.Remove(aMember);
+                            aComponent.Add(aMember);
+                        }
+                        while (!String.Equals(aMember, aFile, StringComparison.OrdinalIgnoreCase));
+                        if (aComponent.Count > 1)
+                        {
+                            aComponents.Add(aComponent.ToArray());
+                        }
+                    }
+                    if (aCallStack.Count > 0)
+                    {
+                        string aCaller     = aCallStack.Peek().Key;
+                        aLowLink[aCaller]  = Math.Min(aLowLink[aCaller], aLowLink[aFile]);
+                    }
+                }
+            }
+            return aComponents;
+        }
+
+        private static List<string> Traverse(IEnumerable<string> files, Func<string, IList<string>> next)
+        {
+            var aResult  = new List<string>();
+            var aVisited = new HashSet<string>(files, StringComparer.OrdinalIgnoreCase);
+            var aQueue   = new Queue<string>(aVisited);
+            while (aQueue.Count > 0)
+            {
+                foreach (var aFile in next(aQueue.Dequeue()))
+                {
+                    if (aVisited.Add(aFile))
+                    {
+                        aResult.Add(aFile);
+                        aQueue.Enqueue(aFile);
+                    }
+                }
+            }
+            return aResult;
+        }
+
+        private static string GetElementName(FileSymbols file, int element)
+        {
+            return (element < 0) ? file.File : file.File + "#" + file.GetQualifiedName(element);
+        }
+
+        private static string Quote(string id)
+        {
+            return "\"" + id.Replace("\\", "\\\\").Replace("\"", "\\\"") + "\"";
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,36 @@
+﻿namespace RTextNppPlugin.RText.Indexing
+{
+    /**
+     * \brief   An element of a workspace file, as found by the RText lexer.
+     */
+    internal sealed class ElementSymbol
+    {
+        internal ElementSymbol(string name, string command, int line, int parent)
+        {
+            Name    = name;
+            Command = command;
+            Line    = line;
+            Parent  = parent;
+        }
+
+        /**
+         * \brief   Gets the name of the element, empty if the element has no name.
+         */
+        internal string Name { get; private set; }
+
+        /**
+         * \brief   Gets the command of the element, i.e. its type.
+         */
+        internal string Command { get; private set; }
+
+        /**
+         * \brief   Gets the zero based line of the element.
+         */
+        internal int Line { get; private set; }
+
+        /**
+         * \brief   Gets the index of the enclosing element in the same file, -1 for top level elements.
+         */
+        internal int Parent { get; private set; }
+    }
+}
@@ -0,0 +1,171 @@
+﻿using System.Collections.Generic;
+
+namespace RTextNppPlugin.RText.Indexing
+{
+    /**
+     * \brief   The indexed elements of a single workspace file.
+     */
+    internal sealed class FileSymbols
+    {
+        private NameTree _nameTree = null;  //!< Named children of all elements, built on first use.
+
+        private sealed class NameTree
+        {
+            internal int[] NamedParents;        //!< Nearest named ancestor of each element, -1 for top level elements.
+            internal List<int>[] NamedChildren; //!< Named elements by index of their nearest named ancestor + 1.
+        }
+
+        internal FileSymbols(string file, IList<ElementSymbol> elements, IList<ReferenceSymbol> references, long lastWriteTime, long length, ulong contentHash)
+        {
+            File          = file;
+            Elements      = elements;
+            References    = references;
+            LastWriteTime = lastWriteTime;
+            Length        = length;
+            ContentHash   = contentHash;
+        }
+
+        internal FileSymbols(string file, IList<ElementSymbol> elements)
+            : this(file, elements, new ReferenceSymbol[0], 0, 0, 0)
+        {
+        }
+
+        /**
+         * \brief   Creates a copy of indexed elements for a file which was touched without changing its content.
+         *
+         * \param   lastWriteTime   The new last write time of the file in UTC ticks.
+         */
+        internal FileSymbols WithLastWriteTime(long lastWriteTime)
+        {
+            return new FileSymbols(File, Elements, References, lastWriteTime, Length, ContentHash);
+        }
+
+        /**
+         * \brief   Gets the full path of the file.
+         */
+        internal string File { get; private set; }
+
+        /**
+         * \brief   Gets the elements of the file, in document order.
+         */
+        internal IList<ElementSymbol> Elements { get; private set; }
+
+        /**
+         * \brief   Gets the references of the file, in document order.
+         */
+        internal IList<ReferenceSymbol> References { get; private set; }
+
+        /**
+         * \brief   Gets the last write time of the indexed content in UTC ticks.
+         */
+        internal long LastWriteTime { get; private set; }
+
+        /**
+         * \brief   Gets the length of the indexed content in bytes.
+         */
+        internal long Length { get; private set; }
+
+        /**
+         * \brief   Gets the hash of the indexed content, see ComputeHash.
+         */
+        internal ulong ContentHash { get; private set; }
+
+        /**
+         * \brief   Computes the 64 bit FNV-1a hash of a file content.
+         *
+         * \param   content The content.
+         */
+        internal static ulong ComputeHash(byte[] content)
+        {
+            ulong aHash = 14695981039346656037UL;
+            for (int i = 0; i < content.Length; ++i)
+            {
+                aHash = (aHash ^ content[i]) * 1099511628211UL;
+            }
+            return aHash;
+        }
+
+        /**
+         * \brief   Gets the qualified name of an element, i.e. the names of all named ancestors and of the element itself,
+         *          separated by '/', e.g. /P1/UInt8.
+         *
+         * \param   index   Index of the element.
+         */
+        internal string GetQualifiedName(int index)
+        {
+            var aNames = new List<string>();
+            for (int i = index; i >= 0; i = Elements[i].Parent)
+            {
+                if (!string.IsNullOrEmpty(Elements[i].Name))
+                {
+                    aNames.Add(Elements[i].Name);
+                }
+            }
+            aNames.Reverse();
+            return "/" + string.Join("/", aNames);
+        }
+
+        /**
+         * \brief   Gets the nearest named ancestor of an element, i.e. its parent in terms of qualified names.
+         *
+         * \param   index   Index of the element.
+         *
+         * \return  The index of the ancestor, -1 if the element is a top level element.
+         */
+        internal int GetNamedParent(int index)
+        {
+            return GetNameTree().NamedParents[index];
+        }
+
+        /**
+         * \brief   Finds the named elements with a name, which nearest named ancestor is an element.
+         *
+         * \param   parent  Index of the ancestor, -1 for top level elements.
+         * \param   name    The name, case sensitive like RText references.
+         *
+         * \return  The indexes of the found elements.
+         */
+        internal IEnumerable<int> FindNamedChildren(int parent, string name)
+        {
+            var aChildren = GetNameTree().NamedChildren[parent + 1];
+            if (aChildren == null)
+            {
+                yield break;
+            }
+            foreach (var aChild in aChildren)
+            {
+                if (string.Equals(Elements[aChild].Name, name, System.StringComparison.Ordinal))
+                {
+                    yield return aChild;
+                }
+            }
+        }
+
+        private NameTree GetNameTree()
+        {
+            //snapshots are shared between threads, a concurrent first use just builds the same tree twice
+            var aTree = _nameTree;
+            if (aTree == null)
+            {
+                aTree = new NameTree { NamedParents = new int[Elements.Count], NamedChildren = new List<int>[Elements.Count + 1] };
+                for (int i = 0; i < Elements.Count; ++i)
+                {
+                    int aParent = Elements[i].Parent;
+                    //parents precede their children
+                    aTree.NamedParents[i] = (aParent < 0) ? -1 : (string.IsNullOrEmpty(Elements[aParent].Name) ? aTree.NamedParents[aParent] : aParent);
+                    if (!string.IsNullOrEmpty(Elements[i].Name))
+                    {
+                        int aSlot = aTree.NamedParents[i] + 1;
+                        if (aTree.NamedChildren[aSlot] == null)
+                        {
+                            aTree.NamedChildren[aSlot] = new List<int>();
+                        }
+                        aTree.NamedChildren[aSlot].Add(i);
+                    }
+                }
+                _nameTree = aTree;
+            }
+            return aTree;
+        }
+    }
+}
@@ -0,0 +1,20 @@
+﻿using System.Collections.Generic;
+
+namespace RTextNppPlugin.RText.Indexing
+{
+    /**
+     * \brief   Extracts the elements and references of the content of an RText file.
+     */
+    internal interface IOutlineProvider
+    {
+        /**
+         * \brief   Gets the elements and references of a file.
+         *
+         * \param   content             The raw content of the file.
+         * \param [out]     references  The references in document order.
+         *
+         * \return  The elements in document order.
+         */
+        IList<ElementSymbol> GetElements(byte[] content, out IList<ReferenceSymbol> references);
+    }
+}
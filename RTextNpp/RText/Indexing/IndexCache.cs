@@ -0,0 +1,200 @@
+﻿using RTextNppPlugin.Logging;
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Linq;
+using System.Text;
+
+namespace RTextNppPlugin.RText.Indexing
+{
+    /**
+     * \brief   Persistent cache of a workspace index, stored next to the .rtext file.
+     *
+     *          Layout, all numbers little endian:
+     *          - header    : magic "RTIX", format version, number of strings, number of files
+     *          - strings   : length prefixed UTF-8 strings, i.e. file paths relative to the workspace root, names, commands
+     *                        and references
+     *          - files     : path, last write time, length, content hash, number of elements, followed by the elements,
+     *                        number of references, followed by the references
+     *          - elements  : name, command, line, parent; strings are indices into the string table
+     *          - references: path, line, element
+     *
+     *          The cache is read through a read-only memory mapped view, so loading is a plain sequential decode without
+     *          any lexing. It is written to a temporary file first and then moved over the old cache, so a crash never
+     *          leaves a truncated cache behind. Any mismatch, e.g. an older version, discards the cache.
+     */
+    internal static class IndexCache
+    {
+        #region [Data Members]
+        private const uint MAGIC   = 0x58495452;   //!< "RTIX"
+        private const int VERSION  = 2;            //!< Incremented whenever the layout or the lexer output changes.
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Gets the path of the cache of a workspace.
+         *
+         * \param   rTextFilePath   The .rtext file of the workspace.
+         * \param   extension       The extension of the indexed files.
+         */
+        internal static string GetCacheFilePath(string rTextFilePath, string extension)
+        {
+            return rTextFilePath + extension + ".index";
+        }
+
+        /**
+         * \brief   Loads a cache.
+         *
+         * \param   cacheFilePath   The path of the cache.
+         * \param   workspaceRoot   The directory of the .rtext file, cached paths are relative to it.
+         *
+         * \return  The cached files by full path, empty if there is no valid cache.
+         */
+        internal static Dictionary<string, FileSymbols> Load(string cacheFilePath, string workspaceRoot)
+        {
+            var aFiles = new Dictionary<string, FileSymbols>(StringComparer.OrdinalIgnoreCase);
+            try
+            {
+                if (!File.Exists(cacheFilePath) || new FileInfo(cacheFilePath).Length == 0)
+                {
+                    return aFiles;
+                }
+                using (var aMappedFile = MemoryMappedFile.CreateFromFile(cacheFilePath, FileMode.Open, null, 0, MemoryMappedFileAccess.Read))
+                using (var aView = aMappedFile.CreateViewStream(0, 0, MemoryMappedFileAccess.Read))
+                using (var aReader = new BinaryReader(aView, Encoding.UTF8))
+                {
+                    if (aReader.ReadUInt32() != MAGIC || aReader.ReadInt32() != VERSION)
+                    {
+                        return aFiles;
+                    }
+                    var aStrings = new string[aReader.ReadInt32()];
+                    int aFileCount = aReader.ReadInt32();
+                    for (int i = 0; i < aStrings.Length; ++i)
+                    {
+                        aStrings[i] = aReader.ReadString();
+                    }
+                    for (int i = 0; i < aFileCount; ++i)
+                    {
+                        string aFile       = Path.Combine(workspaceRoot, aStrings[aReader.ReadInt32()]);
+                        long aWriteTime    = aReader.ReadInt64();
+                        long aLength       = aReader.ReadInt64();
+                        ulong aHash        = aReader.ReadUInt64();
+                        var aElements      = new ElementSymbol[aReader.ReadInt32()];
+                        for (int j = 0; j < aElements.Length; ++j)
+                        {
+                            string aName    = aStrings[aReader.ReadInt32()];
+                            string aCommand = aStrings[aReader.ReadInt32()];
+                            aElements[j]    = new ElementSymbol(aName, aCommand, aReader.ReadInt32(), aReader.ReadInt32());
+                        }
+                        var aReferences    = new ReferenceSymbol[aReader.ReadInt32()];
+                        for (int j = 0; j < aReferences.Length; ++j)
+                        {
+                            aReferences[j] = new ReferenceSymbol(aStrings[aReader.ReadInt32()], aReader.ReadInt32(), aReader.ReadInt32());
+                        }
+                        aFiles[aFile] = new FileSymbols(aFile, aElements, aReferences, aWriteTime, aLength, aHash);
+                    }
+                }
+            }
+            catch (Exception ex)
+            {
+                Logger.Instance.Append(Logger.MessageType.Error, Constants.GENERAL_CHANNEL, "IndexCache.Load({0}) - Exception : {1}", cacheFilePath, ex.Message);
+                aFiles.Clear();
+            }
+            return aFiles;
+        }
+
+        /**
+         * \brief   Saves a cache, replacing any previous one.
+         *
+         * \param   cacheFilePath   The path of the cache.
+         * \param   workspaceRoot   The directory of the .rtext file, cached paths are stored relative to it.
+         * \param   files           The indexed files.
+         */
+        internal static void Save(string cacheFilePath, string workspaceRoot, IEnumerable<FileSymbols> files)
+        {
+            string aTempFile = cacheFilePath + ".tmp";
+            try
+            {
+                var aFiles   = files.ToList();
+                var aStrings = new Dictionary<string, int>(StringComparer.Ordinal);
+                var aPaths   = aFiles.Select(x => Intern(aStrings, GetRelativePath(workspaceRoot, x.File))).ToList();
+                foreach (var aElement in aFiles.SelectMany(x => x.Elements))
+                {
+                    Intern(aStrings, aElement.Name);
+                    Intern(aStrings, aElement.Command);
+                }
+                foreach (var aReference in aFiles.SelectMany(x => x.References))
+                {
+                    Intern(aStrings, aReference.Path);
+                }
+                using (var aWriter = new BinaryWriter(new FileStream(aTempFile, FileMode.Create, FileAccess.Write, FileShare.None, 1 << 16), Encoding.UTF8))
+                {
+                    aWriter.Write(MAGIC);
+                    aWriter.Write(VERSION);
+                    aWriter.Write(aStrings.Count);
+                    aWriter.Write(aFiles.Count);
+                    foreach (var aString in aStrings.OrderBy(x => x.Value))
+                    {
+                        aWriter.Write(aString.Key);
+                    }
+                    for (int i = 0; i < aFiles.Count; ++i)
+                    {
+                        aWriter.Write(aPaths[i]);
+                        aWriter.Write(aFiles[i].LastWriteTime);
+                        aWriter.Write(aFiles[i].Length);
+                        aWriter.Write(aFiles[i].ContentHash);
+                        aWriter.Write(aFiles[i].Elements.Count);
+                        foreach (var aElement in aFiles[i].Elements)
+                        {
+                            aWriter.Write(aStrings[aElement.Name ?? String.Empty]);
+                            aWriter.Write(aStrings[aElement.Command ?? String.Empty]);
+                            aWriter.Write(aElement.Line);
+                            aWriter.Write(aElement.Parent);
+                        }
+                        aWriter.Write(aFiles[i].References.Count);
+                        foreach (var aReference in aFiles[i].References)
+                        {
+                            aWriter.Write(aStrings[aReference.Path ?? String.Empty]);
+                            aWriter.Write(aReference.Line);
+                            aWriter.Write(aReference.Element);
+                        }
+                    }
+                }
+                if (File.Exists(cacheFilePath))
+                {
+                    File.Replace(aTempFile, cacheFilePath, null);
+                }
+                else
+                {
+                    File.Move(aTempFile, cacheFilePath);
+                }
+            }
+            catch (Exception ex)
+            {
+                Logger.Instance.Append(Logger.MessageType.Error, Constants.GENERAL_CHANNEL, "IndexCache.Save({0}) - Exception : {1}", cacheFilePath, ex.Message);
+            }
+        }
+        #endregion
+
+        #region [Helpers]
+        private static int Intern(Dictionary<string, int> strings, string value)
+        {
+            value = value ?? String.Empty;
+            int aIndex;
+            if (!strings.TryGetValue(value, out aIndex))
+            {
+                aIndex = strings.Count;
+                strings.Add(value, aIndex);
+            }
+            return aIndex;
+        }
+
+        private static string GetRelativePath(string workspaceRoot, string file)
+        {
+            string aRoot = workspaceRoot.TrimEnd(Path.DirectorySeparatorChar) + Path.DirectorySeparatorChar;
+            return file.StartsWith(aRoot, StringComparison.OrdinalIgnoreCase) ? file.Substring(aRoot.Length) : file;
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,475 @@
+﻿using RTextNppPlugin.RText.Protocol;
+using System;
+using System.Collections.Generic;
+using System.Linq;
+
+namespace RTextNppPlugin.RText.Indexing
+{
+    /**
+     * \brief   Immutable state of a workspace index. A new snapshot is created for every change and published as a whole,
+     *          so readers never need to lock.
+     */
+    internal sealed class IndexSnapshot
+    {
+        #region [Data Members]
+        private readonly Dictionary<string, FileSymbols> _files        = null; //!< Indexed files by full path.
+        private readonly NameEntry[] _names                            = null; //!< Named elements of all files, ordered by name ignoring case.
+        private readonly int _elementCount                             = 0;    //!< Number of elements of all files.
+        private readonly ReferenceIndex _references                    = null; //!< References of all files by referenced path.
+        private Dictionary<string, IList<ReferenceSymbol>> _unresolved = null; //!< Unresolved references by full path of the file, only set while the snapshot is created.
+        private DependencyGraph _dependencies                          = null; //!< Dependencies between files and elements, only set while the snapshot is created.
+        private PathTrie _paths                                        = null; //!< Qualified names of all elements, built on first use.
+
+        private struct NameEntry
+        {
+            internal string Name;
+            internal FileSymbols File;
+            internal int Index;
+        }
+        #endregion
+
+        #region [Interface]
+        internal IndexSnapshot(IEnumerable<FileSymbols> files)
+        {
+            _files = new Dictionary<string, FileSymbols>(StringComparer.OrdinalIgnoreCase);
+            foreach (var aFile in files)
+            {
+                _files[aFile.File] = aFile;
+            }
+            _elementCount = _files.Values.Sum(x => x.Elements.Count);
+            _names        = CollectNames(_files.Values).OrderBy(x => x.Name, StringComparer.OrdinalIgnoreCase).ToArray();
+            _references   = new ReferenceIndex(_files.Values);
+            _unresolved   = new Dictionary<string, IList<ReferenceSymbol>>(StringComparer.OrdinalIgnoreCase);
+            foreach (var aFile in _files.Values)
+            {
+                CheckReferences(aFile, _unresolved);
+            }
+            _dependencies = new DependencyGraph(_files.Values, CollectEdges);
+        }
+
+        /**
+         * \brief   Creates a new snapshot with some files replaced or removed. This snapshot is not modified.
+         *
+         *          Only the names of the changed files are sorted, they are merged with the names of the unchanged files,
+         *          which are already in order. References are checked again for the changed files and for all files
+         *          which references may be affected, i.e. which refer to elements that vanished or appeared. The same
+         *          files get new edges in the dependency graph.
+         *
+         * \param   updated The new or changed files.
+         * \param   removed The full paths of removed files.
+         *
+         * \return  The new snapshot.
+         */
+        internal IndexSnapshot Update(IList<FileSymbols> updated, IEnumerable<string> removed)
+        {
+            var aFiles    = new Dictionary<string, FileSymbols>(_files, StringComparer.OrdinalIgnoreCase);
+            var aObsolete = new HashSet<FileSymbols>();
+            FileSymbols aPrevious = null;
+            foreach (var aFile in removed)
+            {
+                if (aFiles.TryGetValue(aFile, out aPrevious))
+                {
+                    aObsolete.Add(aPrevious);
+                    aFiles.Remove(aFile);
+                }
+            }
+            foreach (var aFile in updated)
+            {
+                if (aFiles.TryGetValue(aFile.File, out aPrevious))
+                {
+                    aObsolete.Add(aPrevious);
+                }
+                aFiles[aFile.File] = aFile;
+            }
+            var aNewNames = CollectNames(updated).OrderBy(x => x.Name, StringComparer.OrdinalIgnoreCase).ToArray();
+            var aNames    = new List<NameEntry>(_names.Length + aNewNames.Length);
+            int aNew      = 0;
+            foreach (var aEntry in _names)
+            {
+                if (aObsolete.Contains(aEntry.File))
+                {
+                    continue;
+                }
+                while (aNew < aNewNames.Length && StringComparer.OrdinalIgnoreCase.Compare(aNewNames[aNew].Name, aEntry.Name) < 0)
+                {
+                    aNames.Add(aNewNames[aNew++]);
+                }
+                aNames.Add(aEntry);
+            }
+            while (aNew < aNewNames.Length)
+            {
+                aNames.Add(aNewNames[aNew++]);
+            }
+            var aSnapshot = new IndexSnapshot(aFiles, aNames.ToArray(), _references.Update(updated, removed));
+            aSnapshot._unresolved   = aSnapshot.UpdateUnresolvedReferences(_unresolved, aObsolete, updated);
+            aSnapshot._dependencies = aSnapshot.UpdateDependencies(_dependencies, aObsolete, updated, removed);
+            return aSnapshot;
+        }
+
+        /**
+         * \brief   Gets the number of indexed files.
+         */
+        internal int FileCount
+        {
+            get
+            {
+                return _files.Count;
+            }
+        }
+
+        /**
+         * \brief   Gets the number of indexed elements.
+         */
+        internal int ElementCount
+        {
+            get
+            {
+                return _elementCount;
+            }
+        }
+
+        /**
+         * \brief   Gets the indexed files.
+         */
+        internal IEnumerable<FileSymbols> Files
+        {
+            get
+            {
+                return _files.Values;
+            }
+        }
+
+        /**
+         * \brief   Gets the elements of a file.
+         *
+         * \param   file    The full path of the file.
+         *
+         * \return  The elements of the file, null if the file is not indexed.
+         */
+        internal FileSymbols GetFile(string file)
+        {
+            FileSymbols aSymbols = null;
+            _files.TryGetValue(file, out aSymbols);
+            return aSymbols;
+        }
+
+        /**
+         * \brief   Finds all elements which names start with a pattern, ignoring case.
+         *
+         * \param   pattern The search pattern.
+         *
+         * \return  The found elements, formatted like the elements of a find_elements response of the backend.
+         */
+        internal List<Element> FindElements(string pattern)
+        {
+            var aElements = new List<Element>();
+            if (string.IsNullOrEmpty(pattern))
+            {
+                return aElements;
+            }
+            for (int i = LowerBound(pattern); i < _names.Length && _names[i].Name.StartsWith(pattern, StringComparison.OrdinalIgnoreCase); ++i)
+            {
+                var aEntry        = _names[i];
+                string aQualified = aEntry.File.GetQualifiedName(aEntry.Index);
+                aElements.Add(new Element
+                {
+                    display = GetDisplayName(aEntry.File, aEntry.Index, aQualified),
+                    file    = aEntry.File.File,
+                    line    = aEntry.File.Elements[aEntry.Index].Line + 1,
+                    desc    = aQualified
+                });
+            }
+            return aElements;
+        }
+
+        /**
+         * \brief   Resolves an absolute reference, e.g. /P1/UInt8, to the elements it refers to.
+         *
+         *          The first segment is looked up in the name table, every further segment among the named children of the
+         *          elements found so far, see FileSymbols.FindNamedChildren.
+         *
+         * \param   reference   The reference. Relative references aren't resolved.
+         *
+         * \return  The targets, formatted like the targets of a link_targets response of the backend.
+         */
+        internal List<Target> ResolveReference(string reference)
+        {
+            var aTargets = new List<Target>();
+            foreach (var aMatch in Resolve(reference))
+            {
+                string aQualified = aMatch.File.GetQualifiedName(aMatch.Index);
+                aTargets.Add(new Target
+                {
+                    display = GetDisplayName(aMatch.File, aMatch.Index, aQualified),
+                    file    = aMatch.File.File,
+                    line    = (aMatch.File.Elements[aMatch.Index].Line + 1).ToString(),
+                    desc    = aQualified
+                });
+            }
+            return aTargets;
+        }
+
+        /**
+         * \brief   Gets the files with absolute references which resolve to no element at all, by full path.
+         *
+         *          Relative references and references which resolve to several elements are left to the backend.
+         */
+        internal IEnumerable<KeyValuePair<string, IList<ReferenceSymbol>>> UnresolvedReferences
+        {
+            get
+            {
+                return _unresolved;
+            }
+        }
+
+        /**
+         * \brief   Gets the unresolved references of a file, see UnresolvedReferences.
+         *
+         * \param   file    The full path of the file.
+         *
+         * \return  The unresolved references in document order, empty if there are none or the file is not indexed.
+         */
+        internal IList<ReferenceSymbol> GetUnresolvedReferences(string file)
+        {
+            IList<ReferenceSymbol> aReferences = null;
+            return _unresolved.TryGetValue(file, out aReferences) ? aReferences : new ReferenceSymbol[0];
+        }
+
+        /**
+         * \brief   Completes a reference path, e.g. /P1/U to /P1/UInt8, see PathTrie.Complete.
+         *
+         * \param   prefix      The path prefix.
+         * \param   maxResults  The maximum number of completions.
+         *
+         * \return  The completions, formatted like the options of a content_complete response of the backend.
+         */
+        internal List<Option> CompleteReference(string prefix, int maxResults)
+        {
+            var aPaths = _paths;
+            if (aPaths == null)
+            {
+                //no lock needed, concurrent readers would build the same tree
+                _paths = aPaths = new PathTrie(_files.Values.SelectMany(x => Enumerable.Range(0, x.Elements.Count).Where(i => !string.IsNullOrEmpty(x.Elements[i].Name)).Select(i => new KeyValuePair<string, string>(x.GetQualifiedName(i), x.Elements[i].Command))));
+            }
+            return aPaths.Complete(prefix, maxResults).Select(x => new Option
+            {
+                display = x.HasChildren ? x.Path + "/" : x.Path,
+                insert  = x.Path,
+                desc    = x.Command
+            }).ToList();
+        }
+
+        /**
+         * \brief   Gets the dependencies between the indexed files and elements.
+         */
+        internal DependencyGraph Dependencies
+        {
+            get
+            {
+                return _dependencies;
+            }
+        }
+
+        /**
+         * \brief   Finds all places a path is referenced from.
+         *
+         * \param   reference   The referenced path, e.g. /P1/UInt8.
+         *
+         * \return  The referencing elements, formatted like the elements of a find_elements response of the backend. The
+         *          line is the line of the reference, the description the reference as written.
+         */
+        internal List<Element> FindUsages(string reference)
+        {
+            var aUsages = new List<Element>();
+            foreach (var aPosting in _references.Find(reference))
+            {
+                var aReference = aPosting.File.References[aPosting.Reference];
+                aUsages.Add(new Element
+                {
+                    display = (aReference.Element < 0) ? System.IO.Path.GetFileName(aPosting.File.File) : GetDisplayName(aPosting.File, aReference.Element, aPosting.File.GetQualifiedName(aReference.Element)),
+                    file    = aPosting.File.File,
+                    line    = aReference.Line + 1,
+                    desc    = aReference.Path
+                });
+            }
+            return aUsages;
+        }
+        #endregion
+
+        #region [Helpers]
+        private IndexSnapshot(Dictionary<string, FileSymbols> files, NameEntry[] names, ReferenceIndex references)
+        {
+            _files        = files;
+            _names        = names;
+            _references   = references;
+            _elementCount = _files.Values.Sum(x => x.Elements.Count);
+        }
+
+        private struct ElementRef
+        {
+            internal FileSymbols File;
+            internal int Index;
+        }
+
+        private IEnumerable<ElementRef> Resolve(string reference)
+        {
+            if (string.IsNullOrEmpty(reference) || reference[0] != '/')
+            {
+                yield break;
+            }
+            var aSegments = reference.Substring(1).Split('/');
+            if (aSegments.Any(x => x.Length == 0))
+            {
+                yield break;
+            }
+            for (int i = LowerBound(aSegments[0]); i < _names.Length && String.Equals(_names[i].Name, aSegments[0], StringComparison.OrdinalIgnoreCase); ++i)
+            {
+                var aEntry = _names[i];
+                if (aEntry.File.GetNamedParent(aEntry.Index) != -1 || !String.Equals(aEntry.Name, aSegments[0], StringComparison.Ordinal))
+                {
+                    continue;
+                }
+                IEnumerable<int> aMatches = new[] { aEntry.Index };
+                for (int j = 1; j < aSegments.Length; ++j)
+                {
+                    string aSegment = aSegments[j];
+                    aMatches = aMatches.SelectMany(x => aEntry.File.FindNamedChildren(x, aSegment)).ToList();
+                }
+                foreach (var aMatch in aMatches)
+                {
+                    yield return new ElementRef { File = aEntry.File, Index = aMatch };
+                }
+            }
+        }
+
+        private void CheckReferences(FileSymbols file, Dictionary<string, IList<ReferenceSymbol>> unresolved)
+        {
+            var aUnresolved = file.References.Where(x => x.Path.StartsWith("/", StringComparison.Ordinal) && !Resolve(ReferenceIndex.Normalize(x.Path)).Any()).ToList();
+            if (aUnresolved.Count > 0)
+            {
+                unresolved[file.File] = aUnresolved;
+            }
+            else
+            {
+                unresolved.Remove(file.File);
+            }
+        }
+
+        private Dictionary<string, IList<ReferenceSymbol>> UpdateUnresolvedReferences(Dictionary<string, IList<ReferenceSymbol>> previous, ICollection<FileSymbols> obsolete, IList<FileSymbols> updated)
+        {
+            var aUnresolved = new Dictionary<string, IList<ReferenceSymbol>>(previous, StringComparer.OrdinalIgnoreCase);
+            var aOldNames   = new HashSet<string>(obsolete.SelectMany(GetQualifiedNames), StringComparer.Ordinal);
+            var aNewNames   = new HashSet<string>(updated.SelectMany(GetQualifiedNames), StringComparer.Ordinal);
+            var aAffected   = new HashSet<FileSymbols>(updated);
+            foreach (var aFile in obsolete)
+            {
+                aUnresolved.Remove(aFile.File);
+            }
+            //references to vanished elements may break now
+            foreach (var aName in aOldNames.Where(x => !aNewNames.Contains(x)))
+            {
+                aAffected.UnionWith(_references.Find(aName).Select(x => x.File));
+            }
+            //unresolved references to new elements may resolve now
+            foreach (var aEntry in previous)
+            {
+                if (aEntry.Value.Any(x => aNewNames.Contains(ReferenceIndex.Normalize(x.Path))))
+                {
+                    var aFile = GetFile(aEntry.Key);
+                    if (aFile != null)
+                    {
+                        aAffected.Add(aFile);
+                    }
+                }
+            }
+            foreach (var aFile in aAffected)
+            {
+                CheckReferences(aFile, aUnresolved);
+            }
+            return aUnresolved;
+        }
+
+        private DependencyGraph.ElementEdge[] CollectEdges(FileSymbols file)
+        {
+            var aEdges = new List<DependencyGraph.ElementEdge>();
+            for (int i = 0; i < file.References.Count; ++i)
+            {
+                foreach (var aTarget in Resolve(ReferenceIndex.Normalize(file.References[i].Path)))
+                {
+                    aEdges.Add(new DependencyGraph.ElementEdge { Reference = i, TargetFile = aTarget.File.File, TargetElement = aTarget.Index });
+                }
+            }
+            return aEdges.ToArray();
+        }
+
+        private DependencyGraph UpdateDependencies(DependencyGraph previous, ICollection<FileSymbols> obsolete, IList<FileSymbols> updated, IEnumerable<string> removed)
+        {
+            var aAffected = new Dictionary<string, FileSymbols>(StringComparer.OrdinalIgnoreCase);
+            foreach (var aFile in updated)
+            {
+                aAffected[aFile.File] = aFile;
+            }
+            //references to any element of a changed file may resolve differently, even if its name is unchanged
+            foreach (var aName in new HashSet<string>(obsolete.Concat(updated).SelectMany(GetQualifiedNames), StringComparer.Ordinal))
+            {
+                foreach (var aPosting in _references.Find(aName))
+                {
+                    aAffected[aPosting.File.File] = aPosting.File;
+                }
+            }
+            return previous.Update(aAffected.Values, removed, CollectEdges);
+        }
+
+        private static IEnumerable<string> GetQualifiedNames(FileSymbols file)
+        {
+            for (int i = 0; i < file.Elements.Count; ++i)
+            {
+                if (!string.IsNullOrEmpty(file.Elements[i].Name))
+                {
+                    yield return file.GetQualifiedName(i);
+                }
+            }
+        }
+
+        private static IEnumerable<NameEntry> CollectNames(IEnumerable<FileSymbols> files)
+        {
+            foreach (var aFile in files)
+            {
+                for (int i = 0; i < aFile.Elements.Count; ++i)
+                {
+                    if (!string.IsNullOrEmpty(aFile.Elements[i].Name))
+                    {
+                        yield return new NameEntry { Name = aFile.Elements[i].Name, File = aFile, Index = i };
+                    }
+                }
+            }
+        }
+
+        private static string GetDisplayName(FileSymbols file, int index, string qualifiedName)
+        {
+            var aSymbol   = file.Elements[index];
+            string aScope = qualifiedName.Substring(0, qualifiedName.Length - aSymbol.Name.Length - 1);
+            return String.IsNullOrEmpty(aScope) ? String.Format("{0} [{1}]", aSymbol.Name, aSymbol.Command) : String.Format("{0} [{1}] - {2}", aSymbol.Name, aSymbol.Command, aScope);
+        }
+
+        private int LowerBound(string name)
+        {
+            int aLow  = 0;
+            int aHigh = _names.Length;
+            while (aLow < aHigh)
+            {
+                int aMiddle = aLow + (aHigh - aLow) / 2;
+                if (StringComparer.OrdinalIgnoreCase.Compare(_names[aMiddle].Name, name) < 0)
+                {
+                    aLow = aMiddle + 1;
+                }
+                else
+                {
+                    aHigh = aMiddle;
+                }
+            }
+            return aLow;
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,28 @@
+﻿using System.Collections.Generic;
+
+namespace RTextNppPlugin.RText.Indexing
+{
+    /**
+     * \brief   Extracts elements with the native RText lexer, i.e. exactly as they are lexed in the editor.
+     */
+    internal sealed class NativeOutlineProvider : IOutlineProvider
+    {
+        public IList<ElementSymbol> GetElements(byte[] content, out IList<ReferenceSymbol> references)
+        {
+            RTextOutlineReference[] aReferences = null;
+            var aOutline    = RTextOutlineCliWrapper.GetOutline(content, out aReferences);
+            var aElements   = new ElementSymbol[aOutline.Length];
+            var aReferenced = new ReferenceSymbol[aReferences.Length];
+            for (int i = 0; i < aOutline.Length; ++i)
+            {
+                aElements[i] = new ElementSymbol(aOutline[i].Name, aOutline[i].Command, aOutline[i].Line, aOutline[i].Parent);
+            }
+            for (int i = 0; i < aReferences.Length; ++i)
+            {
+                aReferenced[i] = new ReferenceSymbol(aReferences[i].Path, aReferences[i].Line, aReferences[i].Element);
+            }
+            references = aReferenced;
+            return aElements;
+        }
+    }
+}
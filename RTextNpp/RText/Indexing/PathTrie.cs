@@ -0,0 +1,183 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+
+namespace RTextNppPlugin.RText.Indexing
+{
+    /**
+     * \brief   Immutable radix tree over the segments of qualified names, e.g. /P1/UInt8 is stored as P1 -> UInt8.
+     *
+     *          Chains of unnamed path prefixes with a single continuation are compressed into one edge, so a lookup only
+     *          visits the branching points. Children are ordered by their first segment ignoring case, which allows a
+     *          binary search for the children matching a segment prefix.
+     */
+    internal sealed class PathTrie
+    {
+        #region [Data Members]
+        private static readonly Node[] NO_CHILDREN = new Node[0];
+        private readonly Node _root                = null; //!< Root node, its label is empty.
+        private readonly int _count                = 0;    //!< Number of distinct paths.
+
+        private sealed class Node
+        {
+            internal string[] Label;    //!< Segments of the edge leading to this node.
+            internal Node[] Children;   //!< Child nodes, ordered by the first segment of their label ignoring case.
+            internal string Command;    //!< Command of the first element with this path, null if the path is only a prefix.
+        }
+
+        private sealed class BuildNode
+        {
+            internal readonly Dictionary<string, BuildNode> Children = new Dictionary<string, BuildNode>(StringComparer.Ordinal);
+            internal string Command;
+        }
+
+        /**
+         * \brief   A completion of a path prefix.
+         */
+        internal struct PathCompletion
+        {
+            internal string Path;       //!< The complete path, e.g. /P1/UInt8.
+            internal string Command;    //!< Command of the element, e.g. Type.
+            internal bool HasChildren;  //!< Whether longer paths start with this path.
+        }
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates the tree of some paths.
+         *
+         * \param   paths   The qualified names, each with the command of its element. The first command of a path is kept.
+         */
+        internal PathTrie(IEnumerable<KeyValuePair<string, string>> paths)
+        {
+            var aRoot = new BuildNode();
+            foreach (var aPath in paths)
+            {
+                var aNode = aRoot;
+                foreach (var aSegment in Split(aPath.Key))
+                {
+                    BuildNode aChild = null;
+                    if (!aNode.Children.TryGetValue(aSegment, out aChild))
+                    {
+                        aChild = new BuildNode();
+                        aNode.Children.Add(aSegment, aChild);
+                    }
+                    aNode = aChild;
+                }
+                if (aNode != aRoot && aNode.Command == null)
+                {
+                    aNode.Command = aPath.Value ?? String.Empty;
+                    ++_count;
+                }
+            }
+            _root = Freeze(new List<string>(), aRoot);
+        }
+
+        /**
+         * \brief   Gets the number of distinct paths.
+         */
+        internal int Count
+        {
+            get
+            {
+                return _count;
+            }
+        }
+
+        /**
+         * \brief   Completes a path prefix segment by segment, e.g. /P/U completes to /P1/UInt8 and /P2/Uber.
+         *
+         *          Every segment of the prefix has to be a prefix of the respective segment of a path, ignoring case. Only
+         *          paths with as many segments as the prefix are returned, so /P1/ completes to the children of /P1.
+         *
+         * \param   prefix      The path prefix, starting with '/'.
+         * \param   maxResults  The maximum number of completions.
+         *
+         * \return  The completions ordered by path ignoring case, empty if the prefix isn't an absolute path.
+         */
+        internal List<PathCompletion> Complete(string prefix, int maxResults)
+        {
+            var aCompletions = new List<PathCompletion>();
+            if (string.IsNullOrEmpty(prefix) || prefix[0] != '/')
+            {
+                return aCompletions;
+            }
+            Collect(_root, prefix.Substring(1).Split('/'), 0, new List<string>(), aCompletions, maxResults);
+            return aCompletions;
+        }
+        #endregion
+
+        #region [Helpers]
+        private static IEnumerable<string> Split(string path)
+        {
+            return path.Split(new[] { '/' }, StringSplitOptions.RemoveEmptyEntries);
+        }
+
+        private static Node Freeze(List<string> label, BuildNode node)
+        {
+            //unnamed prefixes with a single continuation are merged into the edge of their child
+            while (node.Command == null && node.Children.Count == 1 && label.Count > 0)
+            {
+                var aOnly = node.Children.First();
+                label.Add(aOnly.Key);
+                node = aOnly.Value;
+            }
+            var aChildren = (node.Children.Count == 0) ? NO_CHILDREN : node.Children.OrderBy(x => x.Key, StringComparer.OrdinalIgnoreCase).Select(x => Freeze(new List<string> { x.Key }, x.Value)).ToArray();
+            return new Node { Label = label.ToArray(), Children = aChildren, Command = node.Command };
+        }
+
+        private static bool Collect(Node node, string[] segments, int depth, List<string> path, List<PathCompletion> completions, int maxResults)
+        {
+            int aAdded = 0;
+            for (; aAdded < node.Label.Length; ++aAdded)
+            {
+                string aSegment = node.Label[aAdded];
+                if (!aSegment.StartsWith(segments[depth + aAdded], StringComparison.OrdinalIgnoreCase))
+                {
+                    path.RemoveRange(path.Count - aAdded, aAdded);
+                    return true;
+                }
+                path.Add(aSegment);
+                if (depth + aAdded + 1 == segments.Length)
+                {
+                    //the prefix ends within this edge, only its last segment can be an element
+                    if (aAdded + 1 == node.Label.Length && node.Command != null)
+                    {
+                        completions.Add(new PathCompletion { Path = "/" + string.Join("/", path), Command = node.Command, HasChildren = node.Children.Length > 0 });
+                    }
+                    path.RemoveRange(path.Count - aAdded - 1, aAdded + 1);
+                    return completions.Count < maxResults;
+                }
+            }
+            depth += node.Label.Length;
+            string aNext = segments[depth];
+            bool aGoOn   = true;
+            for (int i = LowerBound(node.Children, aNext); aGoOn && i < node.Children.Length && node.Children[i].Label[0].StartsWith(aNext, StringComparison.OrdinalIgnoreCase); ++i)
+            {
+                aGoOn = Collect(node.Children[i], segments, depth, path, completions, maxResults);
+            }
+            path.RemoveRange(path.Count - aAdded, aAdded);
+            return aGoOn;
+        }
+
+        private static int LowerBound(Node[] nodes, string segment)
+        {
+            int aLow  = 0;
+            int aHigh = nodes.Length;
+            while (aLow < aHigh)
+            {
+                int aMiddle = aLow + (aHigh - aLow) / 2;
+                if (StringComparer.OrdinalIgnoreCase.Compare(nodes[aMiddle].Label[0], segment) < 0)
+                {
+                    aLow = aMiddle + 1;
+                }
+                else
+                {
+                    aHigh = aMiddle;
+                }
+            }
+            return aLow;
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,296 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace RTextNppPlugin.RText.Indexing
+{
+    /**
+     * \brief   Immutable inverted index of the references of all workspace files, i.e. for every referenced path the
+     *          list of places it is referenced from.
+     *
+     *          Every file gets a stable id. A posting list holds the (file id, reference index) pairs of a path in
+     *          ascending order, delta encoded as variable length integers, so most postings take two bytes. Updating a
+     *          file only re-encodes the posting lists of the paths which its old or new content references. The ids of
+     *          removed files are reused for new files, so the file table doesn't grow when files are renamed or
+     *          deleted and created again.
+     */
+    internal sealed class ReferenceIndex
+    {
+        #region [Data Members]
+        private readonly FileSymbols[] _files                 = null; //!< Indexed files by id, null for removed files.
+        private readonly int[] _freeIds                       = null; //!< Ids of removed files, which new files get first.
+        private readonly Dictionary<string, int> _fileIds     = null; //!< File ids by full path.
+        private readonly Dictionary<string, byte[]> _postings = null; //!< Encoded posting lists by normalized path.
+
+        /**
+         * \brief   A place a path is referenced from.
+         */
+        internal struct Posting
+        {
+            internal FileSymbols File;  //!< The referencing file.
+            internal int Reference;     //!< Index of the reference, see FileSymbols.References.
+        }
+        #endregion
+
+        #region [Interface]
+        internal ReferenceIndex(IEnumerable<FileSymbols> files)
+        {
+            _files    = files.ToArray();
+            _freeIds  = new int[0];
+            _fileIds  = new Dictionary<string, int>(StringComparer.OrdinalIgnoreCase);
+            _postings = new Dictionary<string, byte[]>(StringComparer.Ordinal);
+            for (int i = 0; i < _files.Length; ++i)
+            {
+                _fileIds[_files[i].File] = i;
+            }
+            foreach (var aPaths in CollectPostings(Enumerable.Range(0, _files.Length), _files))
+            {
+                _postings.Add(aPaths.Key, Encode(aPaths.Value));
+            }
+        }
+
+        /**
+         * \brief   Creates a new index with some files replaced or removed. This index is not modified.
+         *
+         * \param   updated The new or changed files.
+         * \param   removed The full paths of removed files.
+         *
+         * \return  The new index.
+         */
+        internal ReferenceIndex Update(IList<FileSymbols> updated, IEnumerable<string> removed)
+        {
+            var aFiles      = new List<FileSymbols>(_files);
+            var aFreeIds    = new List<int>(_freeIds);
+            var aFileIds    = new Dictionary<string, int>(_fileIds, StringComparer.OrdinalIgnoreCase);
+            var aPostings   = new Dictionary<string, byte[]>(_postings, StringComparer.Ordinal);
+            var aChangedIds = new HashSet<int>();
+            var aAffected   = new HashSet<string>(StringComparer.Ordinal);
+            int aId         = 0;
+            foreach (var aFile in removed)
+            {
+                if (aFileIds.TryGetValue(aFile, out aId))
+                {
+                    aAffected.UnionWith(aFiles[aId].References.Select(x => Normalize(x.Path)));
+                    aChangedIds.Add(aId);
+                    aFiles[aId] = null;
+                    aFileIds.Remove(aFile);
+                    aFreeIds.Add(aId);
+                }
+            }
+            var aUpdatedIds = new List<int>();
+            foreach (var aFile in updated)
+            {
+                if (aFileIds.TryGetValue(aFile.File, out aId))
+                {
+                    aAffected.UnionWith(aFiles[aId].References.Select(x => Normalize(x.Path)));
+                    aFiles[aId] = aFile;
+                }
+                else if (aFreeIds.Count > 0)
+                {
+                    //postings of the removed file were dropped already, or are dropped below since the id is changed
+                    aId = aFreeIds[aFreeIds.Count - 1];
+                    aFreeIds.RemoveAt(aFreeIds.Count - 1);
+                    aFiles[aId] = aFile;
+                    aFileIds.Add(aFile.File, aId);
+                }
+                else
+                {
+                    aId = aFiles.Count;
+                    aFiles.Add(aFile);
+                    aFileIds.Add(aFile.File, aId);
+                }
+                aChangedIds.Add(aId);
+                aUpdatedIds.Add(aId);
+            }
+            var aNewPostings = CollectPostings(aUpdatedIds, aFiles);
+            aAffected.UnionWith(aNewPostings.Keys);
+            foreach (var aPath in aAffected)
+            {
+                byte[] aEncoded = null;
+                var aList       = aPostings.TryGetValue(aPath, out aEncoded) ? Decode(aEncoded).Where(x => !aChangedIds.Contains(FileIdOf(x))).ToList() : new List<long>();
+                List<long> aAdded = null;
+                if (aNewPostings.TryGetValue(aPath, out aAdded))
+                {
+                    aList.AddRange(aAdded);
+                    aList.Sort();
+                }
+                if (aList.Count == 0)
+                {
+                    aPostings.Remove(aPath);
+                }
+                else
+                {
+                    aPostings[aPath] = Encode(aList);
+                }
+            }
+            return new ReferenceIndex(aFiles.ToArray(), aFreeIds.ToArray(), aFileIds, aPostings);
+        }
+
+        /**
+         * \brief   Gets the number of file ids, i.e. of indexed files and of the free ids of removed files.
+         */
+        internal int FileIdCount
+        {
+            get
+            {
+                return _files.Length;
+            }
+        }
+
+        /**
+         * \brief   Gets the number of distinct referenced paths.
+         */
+        internal int PathCount
+        {
+            get
+            {
+                return _postings.Count;
+            }
+        }
+
+        /**
+         * \brief   Finds all places a path is referenced from.
+         *
+         * \param   path    The referenced path, see Normalize.
+         *
+         * \return  The postings, ordered by file id and position.
+         */
+        internal List<Posting> Find(string path)
+        {
+            var aPostings   = new List<Posting>();
+            byte[] aEncoded = null;
+            if (path != null && _postings.TryGetValue(Normalize(path), out aEncoded))
+            {
+                foreach (var aPosting in Decode(aEncoded))
+                {
+                    aPostings.Add(new Posting { File = _files[FileIdOf(aPosting)], Reference = (int)(aPosting & 0xFFFFFFFF) });
+                }
+            }
+            return aPostings;
+        }
+
+        /**
+         * \brief   Normalizes a reference, so that different spellings of the same path share a posting list, e.g.
+         *          /P1//UInt8/ and /P1/UInt8.
+         *
+         * \param   path    The reference.
+         */
+        internal static string Normalize(string path)
+        {
+            path = path.Trim();
+            if (path.IndexOf("//", StringComparison.Ordinal) < 0 && (path.Length <= 1 || path[path.Length - 1] != '/'))
+            {
+                return path;
+            }
+            var aBuilder = new StringBuilder(path.Length);
+            foreach (var c in path)
+            {
+                if (c != '/' || aBuilder.Length == 0 || aBuilder[aBuilder.Length - 1] != '/')
+                {
+                    aBuilder.Append(c);
+                }
+            }
+            if (aBuilder.Length > 1 && aBuilder[aBuilder.Length - 1] == '/')
+            {
+                --aBuilder.Length;
+            }
+            return aBuilder.ToString();
+        }
+        #endregion
+
+        #region [Helpers]
+        private ReferenceIndex(FileSymbols[] files, int[] freeIds, Dictionary<string, int> fileIds, Dictionary<string, byte[]> postings)
+        {
+            _files    = files;
+            _freeIds  = freeIds;
+            _fileIds  = fileIds;
+            _postings = postings;
+        }
+
+        private static Dictionary<string, List<long>> CollectPostings(IEnumerable<int> fileIds, IList<FileSymbols> files)
+        {
+            var aPostings = new Dictionary<string, List<long>>(StringComparer.Ordinal);
+            foreach (var aId in fileIds.OrderBy(x => x))
+            {
+                var aReferences = files[aId].References;
+                for (int i = 0; i < aReferences.Count; ++i)
+                {
+                    string aPath     = Normalize(aReferences[i].Path);
+                    List<long> aList = null;
+                    if (!aPostings.TryGetValue(aPath, out aList))
+                    {
+                        aList = new List<long>();
+                        aPostings.Add(aPath, aList);
+                    }
+                    aList.Add(((long)aId << 32) | (uint)i);
+                }
+            }
+            return aPostings;
+        }
+
+        private static int FileIdOf(long posting)
+        {
+            return (int)(posting >> 32);
+        }
+
+        private static byte[] Encode(List<long> postings)
+        {
+            var aBytes     = new List<byte>(postings.Count * 2);
+            int aLastFile  = 0;
+            int aLastIndex = 0;
+            foreach (var aPosting in postings)
+            {
+                int aFile  = FileIdOf(aPosting);
+                int aIndex = (int)(aPosting & 0xFFFFFFFF);
+                WriteVarInt(aBytes, (uint)(aFile - aLastFile));
+                //reference indexes restart with every file
+                WriteVarInt(aBytes, (uint)((aFile == aLastFile) ? aIndex - aLastIndex : aIndex));
+                aLastFile  = aFile;
+                aLastIndex = aIndex;
+            }
+            return aBytes.ToArray();
+        }
+
+        private static IEnumerable<long> Decode(byte[] encoded)
+        {
+            int aPosition = 0;
+            int aFile     = 0;
+            int aIndex    = 0;
+            while (aPosition < encoded.Length)
+            {
+                int aFileDelta  = (int)ReadVarInt(encoded, ref aPosition);
+                int aIndexDelta = (int)ReadVarInt(encoded, ref aPosition);
+                aIndex          = (aFileDelta == 0) ? aIndex + aIndexDelta : aIndexDelta;
+                aFile          += aFileDelta;
+                yield return ((long)aFile << 32) | (uint)aIndex;
+            }
+        }
+
+        private static void WriteVarInt(List<byte> bytes, uint value)
+        {
+            while (value >= 0x80)
+            {
+                bytes.Add((byte)(value | 0x80));
+                value >>= 7;
+            }
+            bytes.Add((byte)value);
+        }
+
+        private static uint ReadVarInt(byte[] bytes, ref int position)
+        {
+            uint aValue = 0;
+            int aShift  = 0;
+            byte aByte  = 0;
+            do
+            {
+                aByte   = bytes[position++];
+                aValue |= (uint)(aByte & 0x7F) << aShift;
+                aShift += 7;
+            }
+            while ((aByte & 0x80) != 0);
+            return aValue;
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,30 @@
+﻿namespace RTextNppPlugin.RText.Indexing
+{
+    /**
+     * \brief   A reference of a workspace file, as found by the RText lexer.
+     */
+    internal sealed class ReferenceSymbol
+    {
+        internal ReferenceSymbol(string path, int line, int element)
+        {
+            Path    = path;
+            Line    = line;
+            Element = element;
+        }
+
+        /**
+         * \brief   Gets the reference as written, e.g. /P1/UInt8.
+         */
+        internal string Path { get; private set; }
+
+        /**
+         * \brief   Gets the zero based line of the reference.
+         */
+        internal int Line { get; private set; }
+
+        /**
+         * \brief   Gets the index of the innermost element containing the reference, -1 if there is none.
+         */
+        internal int Element { get; private set; }
+    }
+}
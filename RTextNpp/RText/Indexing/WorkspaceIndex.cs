@@ -0,0 +1,472 @@
+﻿using RTextNppPlugin.Logging;
+using RTextNppPlugin.RText.Protocol;
+using RTextNppPlugin.Utilities;
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace RTextNppPlugin.RText.Indexing
+{
+    /**
+     * \brief   Index of the elements of all files of a workspace, built by lexing the files locally.
+     *
+     *          Unlike the backend this is available right after the files are lexed, i.e. long before a large model is
+     *          loaded, and answers element searches without a round trip. The index is replaced as a whole by an
+     *          immutable IndexSnapshot, so it can be queried from any thread while it is being built.
+     *
+     *          The index is cached next to the .rtext file, see IndexCache. On startup only files which changed since
+     *          the cache was written are lexed again.
+     *
+     *          Files are read and lexed in parallel. Every worker collects its files in a partial list of its own,
+     *          the partial lists are only merged when all files are done, so workers never contend.
+     *
+     *          Afterwards the index is kept up to date incrementally: changed files are queued by Invalidate and
+     *          Update lexes only those, publishing a new snapshot which shares the entries of all other files.
+     */
+    internal sealed class WorkspaceIndex
+    {
+        #region [Data Members]
+        private const int MAX_COMPLETIONS                  = 1000;  //!< Maximum number of reference completions.
+        private readonly string _rTextFilePath             = null;  //!< The .rtext file defining the workspace.
+        private readonly string _workspaceRoot             = null;  //!< The directory of the .rtext file.
+        private readonly string _extension                 = null;  //!< The extension the workspace was opened for, e.g. .atm.
+        private readonly IList<string> _extensions         = null;  //!< The extensions of the indexed files, i.e. of the .rtext file pattern of _extension.
+        private readonly IOutlineProvider _outlineProvider = null;  //!< Extracts the elements of a file.
+        private readonly string _cacheFilePath             = null;  //!< The persistent cache of the index.
+        private volatile IndexSnapshot _snapshot           = null;  //!< The current state, null till the index is built.
+        private readonly object _updateLock                = new object();  //!< Serializes building and updating, readers never lock.
+        private readonly HashSet<string> _pendingFiles     = new HashSet<string>(StringComparer.OrdinalIgnoreCase);  //!< Files changed since the last update.
+        private readonly ConcurrentDictionary<string, string> _workspaceRoots = new ConcurrentDictionary<string, string>(StringComparer.OrdinalIgnoreCase);  //!< The .rtext file of the files of a directory with an extension.
+        #endregion
+
+        #region [Events]
+        /**
+         * \brief   Progress of building the index.
+         *
+         * \param   source      Source of the event.
+         * \param   progress    The progress, in the same form as the backend reports the progress of loading the model.
+         *
+         * \remarks Raised from worker threads.
+         */
+        internal delegate void ProgressUpdatedEvent(object source, ProgressResponse progress);
+
+        internal event ProgressUpdatedEvent OnProgressUpdated;  //!< Event queue for all listeners interested in the progress of building the index.
+
+        /**
+         * \brief   A new state of the index was published, after building or updating it.
+         *
+         * \param   source      Source of the event.
+         * \param   snapshot    The new state.
+         *
+         * \remarks Raised from worker threads.
+         */
+        internal delegate void IndexUpdatedEvent(object source, IndexSnapshot snapshot);
+
+        internal event IndexUpdatedEvent OnIndexUpdated;        //!< Event queue for all listeners interested in changes of the index, e.g. of unresolved references.
+        #endregion
+
+        #region [Interface]
+        internal WorkspaceIndex(string rTextFilePath, string extension, IOutlineProvider outlineProvider)
+        {
+            if (outlineProvider == null)
+            {
+                throw new ArgumentNullException("outlineProvider");
+            }
+            _rTextFilePath   = rTextFilePath;
+            _workspaceRoot   = Path.GetDirectoryName(rTextFilePath);
+            _extension       = extension;
+            _extensions      = FileUtilities.GetWorkspaceExtensions(rTextFilePath, extension);
+            _outlineProvider = outlineProvider;
+            _cacheFilePath   = IndexCache.GetCacheFilePath(rTextFilePath, extension);
+        }
+
+        /**
+         * \brief   Gets the .rtext file defining the workspace.
+         */
+        internal string RTextFilePath
+        {
+            get
+            {
+                return _rTextFilePath;
+            }
+        }
+
+        /**
+         * \brief   Gets a value indicating whether the index was built and can answer queries.
+         */
+        internal bool IsReady
+        {
+            get
+            {
+                return _snapshot != null;
+            }
+        }
+
+        /**
+         * \brief   Gets the current state of the index, null if the index isn't built yet.
+         */
+        internal IndexSnapshot Snapshot
+        {
+            get
+            {
+                return _snapshot;
+            }
+        }
+
+        /**
+         * \brief   Builds the index in the background.
+         *
+         * \param   token   Cancels building, the previous state of the index is kept then.
+         */
+        internal Task BuildAsync(CancellationToken token)
+        {
+            return Task.Run(() => Build(token), token);
+        }
+
+        /**
+         * \brief   Lexes all files of the workspace and publishes the new index.
+         *
+         * \param   token   Cancels building, the previous state of the index is kept then.
+         */
+        internal void Build(CancellationToken token)
+        {
+            lock (_updateLock)
+            {
+                BuildCore(token);
+                //files which changed while building
+                UpdatePendingFiles();
+            }
+            RaiseIndexUpdated();
+        }
+
+        /**
+         * \brief   Queues a file which was created, changed, renamed or deleted, for the next Update.
+         *
+         * \param   file    Full pathname of the file.
+         *
+         * \return  true if no other file was pending, i.e. an update has to be scheduled.
+         *
+         * \remarks Can be called from any thread.
+         */
+        internal bool Invalidate(string file)
+        {
+            if (String.IsNullOrEmpty(file))
+            {
+                return false;
+            }
+            lock (_pendingFiles)
+            {
+                bool aIsFirst = (_pendingFiles.Count == 0);
+                _pendingFiles.Add(file);
+                return aIsFirst;
+            }
+        }
+
+        /**
+         * \brief   Updates the index with the pending files in the background.
+         */
+        internal Task UpdateAsync()
+        {
+            return Task.Run(() => Update());
+        }
+
+        /**
+         * \brief   Lexes the pending files again and publishes the new index. Files which no longer exist are removed.
+         *
+         * \return  The number of changed or removed files.
+         */
+        internal int Update()
+        {
+            int aChangedFiles = 0;
+            lock (_updateLock)
+            {
+                aChangedFiles = UpdatePendingFiles();
+            }
+            if (aChangedFiles > 0)
+            {
+                RaiseIndexUpdated();
+            }
+            return aChangedFiles;
+        }
+
+        /**
+         * \brief   Finds all elements which names start with a pattern, ignoring case, like the find_elements command of the backend.
+         *
+         * \param   pattern The search pattern.
+         *
+         * \return  The response, null if the index isn't built yet.
+         */
+        internal FindRTextElementsResponse FindElements(string pattern)
+        {
+            var aSnapshot = _snapshot;
+            if (aSnapshot == null)
+            {
+                return null;
+            }
+            var aElements = aSnapshot.FindElements(pattern);
+            return new FindRTextElementsResponse
+            {
+                type           = Constants.Commands.FIND_ELEMENTS,
+                elements       = aElements,
+                total_elements = aElements.Count.ToString()
+            };
+        }
+
+        /**
+         * \brief   Merges the elements found by the backend with the elements found by the index. The elements of the
+         *          backend come first, elements of the index are added if the backend doesn't know an element at their
+         *          line, e.g. because the file was changed after the model was loaded.
+         *
+         * \param   backendResponse The find_elements response of the backend, may be null.
+         * \param   localResponse   The response of FindElements, may be null.
+         *
+         * \return  The merged response, null if both are null.
+         */
+        internal static FindRTextElementsResponse MergeElements(FindRTextElementsResponse backendResponse, FindRTextElementsResponse localResponse)
+        {
+            if (backendResponse == null || backendResponse.elements == null)
+            {
+                return localResponse;
+            }
+            if (localResponse == null || localResponse.elements.Count == 0)
+            {
+                return backendResponse;
+            }
+            var aKnown    = new HashSet<string>(backendResponse.elements.Select(x => x.file + ":" + x.line), StringComparer.OrdinalIgnoreCase);
+            var aElements = backendResponse.elements.Concat(localResponse.elements.Where(x => !aKnown.Contains(x.file + ":" + x.line))).ToList();
+            return new FindRTextElementsResponse
+            {
+                type           = backendResponse.type,
+                invocation_id  = backendResponse.invocation_id,
+                elements       = aElements,
+                total_elements = aElements.Count.ToString()
+            };
+        }
+
+        /**
+         * \brief   Resolves an absolute reference, e.g. /P1/UInt8, like the link_targets command of the backend.
+         *
+         * \param   reference   The reference.
+         *
+         * \return  The response, null if the index isn't built yet or the reference doesn't resolve to exactly one element.
+         *          The backend decides then, e.g. for duplicate names or references handled by a custom identifier provider.
+         */
+        internal LinkTargetsResponse ResolveReference(string reference)
+        {
+            var aSnapshot = _snapshot;
+            if (aSnapshot == null)
+            {
+                return null;
+            }
+            var aTargets = aSnapshot.ResolveReference(reference);
+            if (aTargets.Count != 1)
+            {
+                return null;
+            }
+            return new LinkTargetsResponse
+            {
+                type    = Constants.Commands.LINK_TARGETS,
+                targets = aTargets
+            };
+        }
+
+        /**
+         * \brief   Completes an absolute reference, e.g. /P1/U, with the qualified names of the indexed elements, like the
+         *          content_complete command of the backend does for references. Unlike the backend the index knows nothing
+         *          about the metamodel, so the completions aren't filtered by the type of the referencing feature.
+         *
+         * \param   prefix  The reference typed so far.
+         *
+         * \return  The response, null if the index isn't built yet.
+         */
+        internal AutoCompleteResponse CompleteReference(string prefix)
+        {
+            var aSnapshot = _snapshot;
+            if (aSnapshot == null)
+            {
+                return null;
+            }
+            return new AutoCompleteResponse
+            {
+                type    = Constants.Commands.CONTENT_COMPLETION,
+                options = aSnapshot.CompleteReference(prefix, MAX_COMPLETIONS)
+            };
+        }
+
+        /**
+         * \brief   Finds all places a path is referenced from, e.g. all usages of /P1/ICS1.
+         *
+         * \param   reference   The referenced path.
+         *
+         * \return  The referencing elements, null if the index isn't built yet.
+         */
+        internal List<Element> FindUsages(string reference)
+        {
+            var aSnapshot = _snapshot;
+            return (aSnapshot != null) ? aSnapshot.FindUsages(reference) : null;
+        }
+        #endregion
+
+        #region [Helpers]
+        private void BuildCore(CancellationToken token)
+        {
+            //.rtext files may have been added or removed since the last build
+            _workspaceRoots.Clear();
+            var aCachedFiles    = IndexCache.Load(_cacheFilePath, _workspaceRoot);
+            //largest files first, so that no worker is left with a huge file at the end
+            var aFiles          = EnumerateWorkspaceFiles().OrderByDescending(x => x.Length).ToList();
+            var aPartialIndexes = new ConcurrentBag<List<FileSymbols>>();
+            var aOptions        = new ParallelOptions { CancellationToken = token, MaxDegreeOfParallelism = Environment.ProcessorCount };
+            int aIndexedFiles   = 0;
+            int aLastPercentage = -1;
+            int aUpdatedFiles   = 0;
+            //load balancing partitioner hands out small chunks, idle workers steal from the thread pool queues of busy ones
+            Parallel.ForEach(Partitioner.Create(aFiles, true), aOptions, () => new List<FileSymbols>(), (file, state, partialIndex) =>
+            {
+                FileSymbols aCached = null;
+                aCachedFiles.TryGetValue(file.FullName, out aCached);
+                bool aIsUpdated = false;
+                var aSymbols    = IndexFile(file, aCached, out aIsUpdated);
+                if (aSymbols != null)
+                {
+                    partialIndex.Add(aSymbols);
+                }
+                if (aIsUpdated)
+                {
+                    Interlocked.Increment(ref aUpdatedFiles);
+                }
+                ReportProgress(Interlocked.Increment(ref aIndexedFiles), aFiles.Count, ref aLastPercentage);
+                return partialIndex;
+            },
+            partialIndex => aPartialIndexes.Add(partialIndex));
+            _snapshot = new IndexSnapshot(aPartialIndexes.SelectMany(x => x));
+            if (aUpdatedFiles > 0 || _snapshot.FileCount != aCachedFiles.Count)
+            {
+                IndexCache.Save(_cacheFilePath, _workspaceRoot, _snapshot.Files);
+            }
+            Logger.Instance.Append(Logger.MessageType.Info, Constants.GENERAL_CHANNEL, "Workspace index of {0} : {1} elements in {2} files, {3} files updated.", _rTextFilePath + _extension, _snapshot.ElementCount, _snapshot.FileCount, aUpdatedFiles);
+        }
+
+        private int UpdatePendingFiles()
+        {
+            var aSnapshot = _snapshot;
+            if (aSnapshot == null)
+            {
+                //not built yet, pending files are updated when building is done
+                return 0;
+            }
+            string[] aPendingFiles = null;
+            lock (_pendingFiles)
+            {
+                aPendingFiles = _pendingFiles.ToArray();
+                _pendingFiles.Clear();
+            }
+            var aUpdatedFiles = new List<FileSymbols>();
+            var aRemovedFiles = new List<string>();
+            foreach (var aPath in aPendingFiles)
+            {
+                var aFile = new FileInfo(aPath);
+                if (aFile.Exists && IsWorkspaceFile(aFile))
+                {
+                    bool aIsUpdated = false;
+                    var aSymbols    = IndexFile(aFile, aSnapshot.GetFile(aFile.FullName), out aIsUpdated);
+                    //a file which can't be read, e.g. because it is still written, keeps its entry till the next change event
+                    if (aSymbols != null && aIsUpdated)
+                    {
+                        aUpdatedFiles.Add(aSymbols);
+                    }
+                }
+                else if (aSnapshot.GetFile(aPath) != null)
+                {
+                    aRemovedFiles.Add(aPath);
+                }
+            }
+            if (aUpdatedFiles.Count == 0 && aRemovedFiles.Count == 0)
+            {
+                return 0;
+            }
+            _snapshot = aSnapshot.Update(aUpdatedFiles, aRemovedFiles);
+            IndexCache.Save(_cacheFilePath, _workspaceRoot, _snapshot.Files);
+            return aUpdatedFiles.Count + aRemovedFiles.Count;
+        }
+
+        private IEnumerable<FileInfo> EnumerateWorkspaceFiles()
+        {
+            //a search pattern like *.atm would also match .atm40 files, so the extensions are checked by IsWorkspaceFile
+            return new DirectoryInfo(_workspaceRoot).EnumerateFiles("*", SearchOption.AllDirectories).Where(IsWorkspaceFile);
+        }
+
+        /**
+         * \brief   Query if a file is loaded by the backend of this workspace. Its extension must match the .rtext file pattern
+         *          and the .rtext file must be the one which the plug-in finds for the file, i.e. files below a directory
+         *          with a .rtext file of its own for the extension belong to another workspace.
+         */
+        private bool IsWorkspaceFile(FileInfo file)
+        {
+            return _extensions.Contains(file.Extension) &&
+                   String.Equals(FindWorkspaceRoot(file), _rTextFilePath, StringComparison.OrdinalIgnoreCase);
+        }
+
+        private string FindWorkspaceRoot(FileInfo file)
+        {
+            //all files of a directory with the same extension share their .rtext file
+            return _workspaceRoots.GetOrAdd(Path.Combine(file.DirectoryName, file.Extension), x => FileUtilities.FindWorkspaceRoot(file.FullName));
+        }
+
+        private void RaiseIndexUpdated()
+        {
+            var aHandler = OnIndexUpdated;
+            if (aHandler != null)
+            {
+                aHandler(this, _snapshot);
+            }
+        }
+
+        private void ReportProgress(int indexedFiles, int totalFiles, ref int lastPercentage)
+        {
+            int aPercentage = (totalFiles > 0) ? (indexedFiles * 100) / totalFiles : 100;
+            int aPrevious   = Volatile.Read(ref lastPercentage);
+            //only one worker reports each percentage
+            if (aPercentage > aPrevious && Interlocked.CompareExchange(ref lastPercentage, aPercentage, aPrevious) == aPrevious && OnProgressUpdated != null)
+            {
+                OnProgressUpdated(this, new ProgressResponse { percentage = aPercentage, message = String.Format("Indexed {0} of {1} files", indexedFiles, totalFiles) });
+            }
+        }
+
+        private FileSymbols IndexFile(FileInfo file, FileSymbols cached, out bool isUpdated)
+        {
+            isUpdated = false;
+            try
+            {
+                long aLastWriteTime = file.LastWriteTimeUtc.Ticks;
+                if (cached != null && cached.LastWriteTime == aLastWriteTime && cached.Length == file.Length)
+                {
+                    return cached;
+                }
+                var aContent = File.ReadAllBytes(file.FullName);
+                ulong aHash  = FileSymbols.ComputeHash(aContent);
+                if (cached != null && cached.ContentHash == aHash && cached.Length == aContent.Length)
+                {
+                    //touched, e.g. by a build tool, but not changed
+                    isUpdated = true;
+                    return cached.WithLastWriteTime(aLastWriteTime);
+                }
+                isUpdated = true;
+                IList<ReferenceSymbol> aReferences = null;
+                var aElements                      = _outlineProvider.GetElements(aContent, out aReferences);
+                return new FileSymbols(file.FullName, aElements, aReferences, aLastWriteTime, aContent.Length, aHash);
+            }
+            catch (Exception ex)
+            {
+                //file may be locked or deleted meanwhile
+                Logger.Instance.Append(Logger.MessageType.Error, Constants.GENERAL_CHANNEL, "WorkspaceIndex.IndexFile({0}) - Exception : {1}", file.FullName, ex.Message);
+                return null;
+            }
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,15 @@
+﻿
+namespace RTextNppPlugin.RText.Protocol
+{
+    /**
+     * \brief   Asks the back-end to encode the messages following its response with another encoding. Back-ends which
+     *          don't know the command answer with an unknown command error and keep using JSON.
+     */
+    class EncodingRequest : RequestBase
+    {
+        public const string JSON         = "json";      //!< Name of the JSON encoding.
+        public const string MESSAGE_PACK = "msgpack";   //!< Name of the MessagePack encoding.
+
+        public string encoding { get; set; }
+    }
+}
@@ -0,0 +1,12 @@
+﻿
+namespace RTextNppPlugin.RText.Protocol
+{
+    class EncodingResponse : IResponseBase
+    {
+        public string encoding { get; set; }
+        #region IResponseBase Members
+        public string type { get; set; }
+        public int invocation_id { get; set; }
+        #endregion
+    }
+}
@@ -0,0 +1,25 @@
+﻿namespace RTextNppPlugin.RText.Protocol
+{
+    /**
+     * \brief   Receives the JSON tokens found by a JsonPushParser, in document order.
+     */
+    internal interface IJsonHandler
+    {
+        void OnStartObject();
+        void OnEndObject();
+        void OnStartArray();
+        void OnEndArray();
+        /**
+         * \brief   Called for the name of every object member, before its value.
+         */
+        void OnProperty(string name);
+        /**
+         * \brief   Called for every string value, escapes are already resolved.
+         */
+        void OnString(string value);
+        /**
+         * \brief   Called for every number, true, false and null, with the literal as it appears in the document.
+         */
+        void OnLiteral(string literal);
+    }
+}
@@ -0,0 +1,19 @@
+﻿namespace RTextNppPlugin.RText.Protocol
+{
+    /**
+     * \brief   Parses a response whose bytes are fed as they arrive, handing its tokens to an IJsonHandler.
+     */
+    internal interface IResponseParser
+    {
+        /**
+         * \brief   Gets a value indicating whether the top level value is complete.
+         */
+        bool IsComplete { get; }
+        /**
+         * \brief   Parses the next bytes of the response.
+         *
+         * \exception   System.IO.InvalidDataException  The response is malformed.
+         */
+        void Feed(byte[] bytes, int offset, int count);
+    }
+}
@@ -0,0 +1,359 @@
+﻿using System;
+using System.IO;
+using System.Text;
+
+namespace RTextNppPlugin.RText.Protocol
+{
+    /**
+     * \brief   Event based JSON parser which is fed with the bytes of a UTF-8 document as they arrive.
+     *
+     *          The document may be split anywhere, even within a token or a multi byte character; the parser keeps its
+     *          state between calls of Feed. Only the token being parsed is buffered, so memory doesn't grow with the size
+     *          of the document. The top level value has to be an object or an array.
+     */
+    internal sealed class JsonPushParser : IResponseParser
+    {
+        #region [Data Members]
+        private enum State
+        {
+            Value,              //!< Expects a value.
+            FirstValueOrEnd,    //!< Expects the first value of an array or its end.
+            FirstKeyOrEnd,      //!< Expects the first key of an object or its end.
+            Key,                //!< Expects a key after a ','.
+            Colon,              //!< Expects the ':' after a key.
+            AfterValue,         //!< Expects a ',' or the end of the enclosing container.
+            String,             //!< Within a string.
+            Escape,             //!< After a '\' within a string.
+            Unicode,            //!< Within a \u escape of a string.
+            Literal,            //!< Within a number, true, false or null.
+            Done                //!< After the top level value.
+        }
+
+        private readonly IJsonHandler _handler    = null;
+        private bool[] _containers                = new bool[16];               //!< Open containers, true for objects.
+        private int _depth                        = 0;                          //!< Number of open containers.
+        private readonly StringBuilder _token     = new StringBuilder();        //!< The string or literal parsed so far.
+        private readonly Decoder _decoder         = Encoding.UTF8.GetDecoder(); //!< Keeps characters split between two chunks.
+        private char[] _chars                     = new char[256];              //!< Decoded characters of a run of string bytes.
+        private State _state                      = State.Value;
+        private bool _isKey                       = false;                      //!< Whether the string being parsed is a key.
+        private bool _isBuffered                  = false;                      //!< Whether a part of the string being parsed is in _token or _decoder.
+        private int _unicode                      = 0;                          //!< Value of the \u escape parsed so far.
+        private int _unicodeDigits                = 0;                          //!< Number of digits of the \u escape parsed so far.
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates a parser.
+         *
+         * \param   handler The handler which receives the tokens.
+         */
+        internal JsonPushParser(IJsonHandler handler)
+        {
+            _handler = handler;
+        }
+
+        /**
+         * \brief   Gets a value indicating whether the top level value is complete.
+         */
+        public bool IsComplete
+        {
+            get
+            {
+                return _state == State.Done;
+            }
+        }
+
+        /**
+         * \brief   Parses the next bytes of the document.
+         *
+         * \exception   InvalidDataException    The document is no valid JSON.
+         */
+        public void Feed(byte[] bytes, int offset, int count)
+        {
+            int aEnd = offset + count;
+            for (int i = offset; i < aEnd; ++i)
+            {
+                byte aByte = bytes[i];
+                switch (_state)
+                {
+                    case State.String:
+                        int aRun = i;
+                        while (i < aEnd && bytes[i] != (byte)'"' && bytes[i] != (byte)'\\')
+                        {
+                            ++i;
+                        }
+                        if (i < aEnd && bytes[i] == (byte)'"' && !_isBuffered)
+                        {
+                            //most strings are received at once and have no escapes, they are decoded in place
+                            EndString(Encoding.UTF8.GetString(bytes, aRun, i - aRun));
+                            break;
+                        }
+                        AppendUtf8(bytes, aRun, i - aRun);
+                        if (i == aEnd)
+                        {
+                            return;
+                        }
+                        if (bytes[i] == (byte)'\\')
+                        {
+                            _state = State.Escape;
+                        }
+                        else
+                        {
+                            EndString(_token.ToString());
+                        }
+                        break;
+                    case State.Escape:
+                        ParseEscape(aByte);
+                        break;
+                    case State.Unicode:
+                        ParseUnicode(aByte);
+                        break;
+                    case State.Literal:
+                        if (IsLiteral(aByte))
+                        {
+                            _token.Append((char)aByte);
+                        }
+                        else
+                        {
+                            EndLiteral();
+                            //the delimiter belongs to the enclosing container
+                            --i;
+                        }
+                        break;
+                    default:
+                        if (aByte != (byte)' ' && aByte != (byte)'\t' && aByte != (byte)'\r' && aByte != (byte)'\n')
+                        {
+                            ParseStructure(aByte);
+                        }
+                        break;
+                }
+            }
+        }
+        #endregion
+
+        #region [Helpers]
+        private static bool IsLiteral(byte value)
+        {
+            return (value >= (byte)'0' && value <= (byte)'9') || (value >= (byte)'a' && value <= (byte)'z') || value == (byte)'-' || value == (byte)'+' || value == (byte)'.' || value == (byte)'E';
+        }
+
+        private static InvalidDataException Unexpected(byte value)
+        {
+            return new InvalidDataException(String.Format("Unexpected byte 0x{0:X2} in JSON document.", value));
+        }
+
+        private void ParseStructure(byte value)
+        {
+            switch (_state)
+            {
+                case State.FirstValueOrEnd:
+                    if (value == (byte)']')
+                    {
+                        EndContainer();
+                        return;
+                    }
+                    ParseValue(value);
+                    break;
+                case State.Value:
+                    ParseValue(value);
+                    break;
+                case State.FirstKeyOrEnd:
+                case State.Key:
+                    if (value == (byte)'}' && _state == State.FirstKeyOrEnd)
+                    {
+                        EndContainer();
+                    }
+                    else if (value == (byte)'"')
+                    {
+                        _isKey = true;
+                        _state = State.String;
+                    }
+                    else
+                    {
+                        throw Unexpected(value);
+                    }
+                    break;
+                case State.Colon:
+                    if (value != (byte)':')
+                    {
+                        throw Unexpected(value);
+                    }
+                    _state = State.Value;
+                    break;
+                case State.AfterValue:
+                    bool aIsObject = _containers[_depth - 1];
+                    if (value == (byte)',')
+                    {
+                        _state = aIsObject ? State.Key : State.Value;
+                    }
+                    else if (value == (aIsObject ? (byte)'}' : (byte)']'))
+                    {
+                        EndContainer();
+                    }
+                    else
+                    {
+                        throw Unexpected(value);
+                    }
+                    break;
+                default:
+                    throw Unexpected(value);
+            }
+        }
+
+        private void ParseValue(byte value)
+        {
+            switch (value)
+            {
+                case (byte)'{':
+                    Push(true);
+                    _state = State.FirstKeyOrEnd;
+                    _handler.OnStartObject();
+                    break;
+                case (byte)'[':
+                    Push(false);
+                    _state = State.FirstValueOrEnd;
+                    _handler.OnStartArray();
+                    break;
+                case (byte)'"':
+                    _isKey = false;
+                    _state = State.String;
+                    break;
+                default:
+                    if (_depth == 0 || !IsLiteral(value))
+                    {
+                        throw Unexpected(value);
+                    }
+                    _token.Append((char)value);
+                    _state = State.Literal;
+                    break;
+            }
+        }
+
+        private void ParseEscape(byte value)
+        {
+            _state      = State.String;
+            _isBuffered = true;
+            switch (value)
+            {
+                case (byte)'"':
+                case (byte)'\\':
+                case (byte)'/':
+                    _token.Append((char)value);
+                    break;
+                case (byte)'b':
+                    _token.Append('\b');
+                    break;
+                case (byte)'f':
+                    _token.Append('\f');
+                    break;
+                case (byte)'n':
+                    _token.Append('\n');
+                    break;
+                case (byte)'r':
+                    _token.Append('\r');
+                    break;
+                case (byte)'t':
+                    _token.Append('\t');
+                    break;
+                case (byte)'u':
+                    _unicode       = 0;
+                    _unicodeDigits = 0;
+                    _state         = State.Unicode;
+                    break;
+                default:
+                    throw Unexpected(value);
+            }
+        }
+
+        private void ParseUnicode(byte value)
+        {
+            int aDigit = (value >= (byte)'0' && value <= (byte)'9') ? value - '0' :
+                         (value >= (byte)'a' && value <= (byte)'f') ? value - 'a' + 10 :
+                         (value >= (byte)'A' && value <= (byte)'F') ? value - 'A' + 10 : -1;
+            if (aDigit < 0)
+            {
+                throw Unexpected(value);
+            }
+            _unicode = _unicode * 16 + aDigit;
+            if (++_unicodeDigits == 4)
+            {
+                //surrogate pairs are escaped as two code units, which combine in the token
+                _token.Append((char)_unicode);
+                _state = State.String;
+            }
+        }
+
+        private void AppendUtf8(byte[] bytes, int offset, int count)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+            _isBuffered = true;
+            if (_chars.Length < count + 1)
+            {
+                _chars = new char[Math.Max(count + 1, _chars.Length * 2)];
+            }
+            int aChars = _decoder.GetChars(bytes, offset, count, _chars, 0, false);
+            _token.Append(_chars, 0, aChars);
+        }
+
+        private void EndString(string value)
+        {
+            if (_isBuffered)
+            {
+                _decoder.Reset();
+                _token.Clear();
+                _isBuffered = false;
+            }
+            if (_isKey)
+            {
+                _state = State.Colon;
+                _handler.OnProperty(value);
+            }
+            else
+            {
+                EndValue();
+                _handler.OnString(value);
+            }
+        }
+
+        private void EndLiteral()
+        {
+            string aLiteral = _token.ToString();
+            _token.Clear();
+            EndValue();
+            _handler.OnLiteral(aLiteral);
+        }
+
+        private void EndContainer()
+        {
+            bool aIsObject = _containers[--_depth];
+            EndValue();
+            if (aIsObject)
+            {
+                _handler.OnEndObject();
+            }
+            else
+            {
+                _handler.OnEndArray();
+            }
+        }
+
+        private void EndValue()
+        {
+            _state = (_depth == 0) ? State.Done : State.AfterValue;
+        }
+
+        private void Push(bool isObject)
+        {
+            if (_depth == _containers.Length)
+            {
+                Array.Resize(ref _containers, _depth * 2);
+            }
+            _containers[_depth++] = isObject;
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,180 @@
+﻿using System;
+using System.Globalization;
+using System.IO;
+using System.Text;
+using Newtonsoft.Json;
+using Newtonsoft.Json.Linq;
+
+namespace RTextNppPlugin.RText.Protocol
+{
+    /**
+     * \brief   Encodes JSON values as MessagePack, the compact binary encoding of the protocol.
+     *
+     *          Objects become maps with string keys, so a MessagePackPushParser hands out the same tokens as a
+     *          JsonPushParser does for the JSON text. Integers and strings use their shortest representation, which
+     *          mostly saves the quotes, separators and the decimal digits of the JSON text.
+     */
+    internal static class MessagePackEncoder
+    {
+        #region [Interface]
+        /**
+         * \brief   Encodes an object as it would be serialized to JSON, e.g. a request.
+         */
+        internal static byte[] Encode(object value)
+        {
+            return Encode(JToken.FromObject(value));
+        }
+
+        /**
+         * \brief   Encodes a JSON document.
+         *
+         * \exception   JsonReaderException The text is no valid JSON.
+         */
+        internal static byte[] EncodeJson(string json)
+        {
+            //strings are kept as they are, JToken.Parse would turn some of them into dates
+            using (var aReader = new JsonTextReader(new StringReader(json)) { DateParseHandling = DateParseHandling.None })
+            {
+                return Encode(JToken.ReadFrom(aReader));
+            }
+        }
+
+        /**
+         * \brief   Encodes a JSON value.
+         */
+        internal static byte[] Encode(JToken token)
+        {
+            using (var aStream = new MemoryStream(256))
+            {
+                Write(aStream, token);
+                return aStream.ToArray();
+            }
+        }
+        #endregion
+
+        #region [Helpers]
+        private static void Write(Stream stream, JToken token)
+        {
+            switch (token.Type)
+            {
+                case JTokenType.Object:
+                    var aObject = (JObject)token;
+                    WriteHeader(stream, aObject.Count, 0x80, 0x0f, 0xde);
+                    foreach (var aProperty in aObject.Properties())
+                    {
+                        WriteString(stream, aProperty.Name);
+                        Write(stream, aProperty.Value);
+                    }
+                    break;
+                case JTokenType.Array:
+                    var aArray = (JArray)token;
+                    WriteHeader(stream, aArray.Count, 0x90, 0x0f, 0xdc);
+                    foreach (var aItem in aArray)
+                    {
+                        Write(stream, aItem);
+                    }
+                    break;
+                case JTokenType.Integer:
+                    WriteInteger(stream, token.Value<long>());
+                    break;
+                case JTokenType.Float:
+                    stream.WriteByte(0xcb);
+                    WriteBigEndian(stream, (ulong)BitConverter.DoubleToInt64Bits(token.Value<double>()), 8);
+                    break;
+                case JTokenType.Boolean:
+                    stream.WriteByte(token.Value<bool>() ? (byte)0xc3 : (byte)0xc2);
+                    break;
+                case JTokenType.Null:
+                case JTokenType.Undefined:
+                    stream.WriteByte(0xc0);
+                    break;
+                default:
+                    //strings, and whatever JSON.NET writes as strings, e.g. dates
+                    WriteString(stream, Convert.ToString(((JValue)token).Value, CultureInfo.InvariantCulture));
+                    break;
+            }
+        }
+
+        /**
+         * \brief   Writes the header of a map, an array or a string.
+         *
+         * \param   count       The number of members, items or bytes.
+         * \param   fixType     The type byte of the short form, the count is added to it.
+         * \param   fixMax      The highest count of the short form.
+         * \param   type16      The type byte of the form with a 16 bit count, the one with a 32 bit count follows it.
+         */
+        private static void WriteHeader(Stream stream, int count, byte fixType, int fixMax, byte type16)
+        {
+            if (count <= fixMax)
+            {
+                stream.WriteByte((byte)(fixType | count));
+            }
+            else if (count <= UInt16.MaxValue)
+            {
+                stream.WriteByte(type16);
+                WriteBigEndian(stream, (ulong)count, 2);
+            }
+            else
+            {
+                stream.WriteByte((byte)(type16 + 1));
+                WriteBigEndian(stream, (ulong)count, 4);
+            }
+        }
+
+        private static void WriteString(Stream stream, string value)
+        {
+            byte[] aBytes = Encoding.UTF8.GetBytes(value);
+            if (aBytes.Length > 0x1f && aBytes.Length <= Byte.MaxValue)
+            {
+                stream.WriteByte(0xd9);
+                stream.WriteByte((byte)aBytes.Length);
+            }
+            else
+            {
+                WriteHeader(stream, aBytes.Length, 0xa0, 0x1f, 0xda);
+            }
+            stream.Write(aBytes, 0, aBytes.Length);
+        }
+
+        private static void WriteInteger(Stream stream, long value)
+        {
+            if (value >= 0 && value <= 0x7f)
+            {
+                stream.WriteByte((byte)value);
+            }
+            else if (value < 0 && value >= -32)
+            {
+                stream.WriteByte((byte)(sbyte)value);
+            }
+            else if (value >= SByte.MinValue && value <= SByte.MaxValue)
+            {
+                stream.WriteByte(0xd0);
+                stream.WriteByte((byte)(sbyte)value);
+            }
+            else if (value >= Int16.MinValue && value <= Int16.MaxValue)
+            {
+                stream.WriteByte(0xd1);
+                WriteBigEndian(stream, (ulong)value, 2);
+            }
+            else if (value >= Int32.MinValue && value <= Int32.MaxValue)
+            {
+                stream.WriteByte(0xd2);
+                WriteBigEndian(stream, (ulong)value, 4);
+            }
+            else
+            {
+                stream.WriteByte(0xd3);
+                WriteBigEndian(stream, (ulong)value, 8);
+            }
+        }
+
+        private static void WriteBigEndian(Stream stream, ulong value, int bytes)
+        {
+            for (int i = bytes - 1; i >= 0; --i)
+            {
+                stream.WriteByte((byte)(value >> (8 * i)));
+            }
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,386 @@
+using System;
+using System.Globalization;
+using System.IO;
+using System.Text;
+
+namespace RTextNppPlugin.RText.Protocol
+{
+    /**
+     * \brief   Event based MessagePack parser which is fed with the bytes of a document as they arrive.
+     *
+     *          The tokens are handed to an IJsonHandler like those of a JsonPushParser, so the same response builders
+     *          handle both encodings: maps are objects, their keys have to be strings, and integers, floats, booleans and
+     *          nil are passed as the literals JSON would use. Binary and extension types have no JSON counterpart and are
+     *          rejected. The document may be split anywhere; only the header or string being parsed is buffered. The top
+     *          level value has to be a map or an array.
+     */
+    internal sealed class MessagePackPushParser : IResponseParser
+    {
+        #region [Data Members]
+        private enum State
+        {
+            Type,       //!< Expects the type byte of a value.
+            Header,     //!< Within the length or value bytes following the type byte.
+            String,     //!< Within the bytes of a string.
+            Done        //!< After the top level value.
+        }
+
+        private struct Container
+        {
+            internal bool IsMap;
+            internal long Remaining;    //!< Number of values left, keys included.
+        }
+
+        private readonly IJsonHandler _handler  = null;
+        private Container[] _containers         = new Container[16];    //!< Open containers.
+        private int _depth                      = 0;                    //!< Number of open containers.
+        private State _state                    = State.Type;
+        private byte _type                      = 0;                    //!< Type byte of the value being parsed.
+        private readonly byte[] _header         = new byte[8];          //!< Length or value bytes of the value being parsed.
+        private int _headerLength               = 0;
+        private int _headerFilled               = 0;
+        private byte[] _string                  = new byte[256];        //!< Bytes of a string split between two chunks.
+        private int _stringLength               = 0;
+        private int _stringFilled               = 0;
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates a parser.
+         *
+         * \param   handler The handler which receives the tokens.
+         */
+        internal MessagePackPushParser(IJsonHandler handler)
+        {
+            _handler = handler;
+        }
+
+        /**
+         * \brief   Gets a value indicating whether the top level value is complete.
+         */
+        public bool IsComplete
+        {
+            get
+            {
+                return _state == State.Done;
+            }
+        }
+
+        /**
+         * \brief   Parses the next bytes of the document.
+         *
+         * \exception   InvalidDataException    The document is no valid MessagePack or has no JSON counterpart.
+         */
+        public void Feed(byte[] bytes, int offset, int count)
+        {
+            int aEnd = offset + count;
+            int i    = offset;
+            while (i < aEnd)
+            {
+                switch (_state)
+                {
+                    case State.Type:
+                        _type         = bytes[i++];
+                        _headerLength = GetHeaderLength(_type);
+                        _headerFilled = 0;
+                        if (_headerLength == 0)
+                        {
+                            OnType();
+                        }
+                        else
+                        {
+                            _state = State.Header;
+                        }
+                        break;
+                    case State.Header:
+                        int aHeaderBytes = Math.Min(_headerLength - _headerFilled, aEnd - i);
+                        Buffer.BlockCopy(bytes, i, _header, _headerFilled, aHeaderBytes);
+                        _headerFilled += aHeaderBytes;
+                        i             += aHeaderBytes;
+                        if (_headerFilled == _headerLength)
+                        {
+                            OnType();
+                        }
+                        break;
+                    case State.String:
+                        int aStringBytes = Math.Min(_stringLength - _stringFilled, aEnd - i);
+                        if (_stringFilled == 0 && aStringBytes == _stringLength)
+                        {
+                            //most strings are received at once, they are decoded in place
+                            i += aStringBytes;
+                            EndString(Encoding.UTF8.GetString(bytes, i - aStringBytes, aStringBytes));
+                            break;
+                        }
+                        if (_string.Length < _stringLength)
+                        {
+                            Array.Resize(ref _string, _stringLength);
+                        }
+                        Buffer.BlockCopy(bytes, i, _string, _stringFilled, aStringBytes);
+                        _stringFilled += aStringBytes;
+                        i             += aStringBytes;
+                        if (_stringFilled == _stringLength)
+                        {
+                            EndString(Encoding.UTF8.GetString(_string, 0, _stringLength));
+                        }
+                        break;
+                    default:
+                        throw new InvalidDataException("Unexpected bytes after the end of the document.");
+                }
+            }
+        }
+        #endregion
+
+        #region [Helpers]
+        /**
+         * \brief   Gets the number of bytes following a type byte, which hold the length or the value.
+         */
+        private static int GetHeaderLength(byte type)
+        {
+            switch (type)
+            {
+                case 0xcc:
+                case 0xd0:
+                case 0xd9:
+                    return 1;
+                case 0xcd:
+                case 0xd1:
+                case 0xda:
+                case 0xdc:
+                case 0xde:
+                    return 2;
+                case 0xca:
+                case 0xce:
+                case 0xd2:
+                case 0xdb:
+                case 0xdd:
+                case 0xdf:
+                    return 4;
+                case 0xcb:
+                case 0xcf:
+                case 0xd3:
+                    return 8;
+                default:
+                    return 0;
+            }
+        }
+
+        /**
+         * \brief   Handles a type byte, together with its header bytes.
+         */
+        private void OnType()
+        {
+            _state = State.Type;
+            if (_type <= 0x7f)
+            {
+                OnLiteral(_type.ToString(CultureInfo.InvariantCulture));
+            }
+            else if (_type <= 0x8f)
+            {
+                StartContainer(true, _type & 0x0f);
+            }
+            else if (_type <= 0x9f)
+            {
+                StartContainer(false, _type & 0x0f);
+            }
+            else if (_type <= 0xbf)
+            {
+                StartString(_type & 0x1f);
+            }
+            else if (_type >= 0xe0)
+            {
+                OnLiteral(((sbyte)_type).ToString(CultureInfo.InvariantCulture));
+            }
+            else
+            {
+                switch (_type)
+                {
+                    case 0xc0:
+                        OnLiteral("null");
+                        break;
+                    case 0xc2:
+                        OnLiteral("false");
+                        break;
+                    case 0xc3:
+                        OnLiteral("true");
+                        break;
+                    case 0xca:
+                        OnLiteral(BitConverter.ToSingle(BitConverter.GetBytes((int)ReadHeader()), 0).ToString("R", CultureInfo.InvariantCulture));
+                        break;
+                    case 0xcb:
+                        OnLiteral(BitConverter.Int64BitsToDouble((long)ReadHeader()).ToString("R", CultureInfo.InvariantCulture));
+                        break;
+                    case 0xcc:
+                    case 0xcd:
+                    case 0xce:
+                    case 0xcf:
+                        OnLiteral(ReadHeader().ToString(CultureInfo.InvariantCulture));
+                        break;
+                    case 0xd0:
+                        OnLiteral(((sbyte)ReadHeader()).ToString(CultureInfo.InvariantCulture));
+                        break;
+                    case 0xd1:
+                        OnLiteral(((short)ReadHeader()).ToString(CultureInfo.InvariantCulture));
+                        break;
+                    case 0xd2:
+                        OnLiteral(((int)ReadHeader()).ToString(CultureInfo.InvariantCulture));
+                        break;
+                    case 0xd3:
+                        OnLiteral(((long)ReadHeader()).ToString(CultureInfo.InvariantCulture));
+                        break;
+                    case 0xd9:
+                    case 0xda:
+                    case 0xdb:
+                        StartString(ReadLength());
+                        break;
+                    case 0xdc:
+                    case 0xdd:
+                        StartContainer(false, ReadLength());
+                        break;
+                    case 0xde:
+                    case 0xdf:
+                        StartContainer(true, ReadLength());
+                        break;
+                    default:
+                        throw new InvalidDataException(String.Format("Unsupported MessagePack type 0x{0:X2}.", _type));
+                }
+            }
+        }
+
+        /**
+         * \brief   Gets the header bytes as big endian unsigned number.
+         */
+        private ulong ReadHeader()
+        {
+            ulong aValue = 0;
+            for (int i = 0; i < _headerLength; ++i)
+            {
+                aValue = (aValue << 8) | _header[i];
+            }
+            return aValue;
+        }
+
+        private int ReadLength()
+        {
+            ulong aLength = ReadHeader();
+            if (aLength > Int32.MaxValue)
+            {
+                throw new InvalidDataException("MessagePack length is too large.");
+            }
+            return (int)aLength;
+        }
+
+        /**
+         * \brief   Query if the value being parsed is the key of a map member.
+         */
+        private bool IsKey
+        {
+            get
+            {
+                return _depth > 0 && _containers[_depth - 1].IsMap && _containers[_depth - 1].Remaining % 2 == 0;
+            }
+        }
+
+        private void StartContainer(bool isMap, int count)
+        {
+            if (IsKey)
+            {
+                throw new InvalidDataException("MessagePack map keys have to be strings.");
+            }
+            if (isMap)
+            {
+                _handler.OnStartObject();
+            }
+            else
+            {
+                _handler.OnStartArray();
+            }
+            if (count == 0)
+            {
+                EndContainer(isMap);
+                EndValue();
+                return;
+            }
+            if (_depth == _containers.Length)
+            {
+                Array.Resize(ref _containers, _depth * 2);
+            }
+            _containers[_depth++] = new Container { IsMap = isMap, Remaining = isMap ? 2L * count : count };
+        }
+
+        private void EndContainer(bool isMap)
+        {
+            if (isMap)
+            {
+                _handler.OnEndObject();
+            }
+            else
+            {
+                _handler.OnEndArray();
+            }
+        }
+
+        private void StartString(int length)
+        {
+            if (_depth == 0)
+            {
+                throw new InvalidDataException("MessagePack document has to be a map or an array.");
+            }
+            _stringLength = length;
+            _stringFilled = 0;
+            if (length == 0)
+            {
+                EndString(String.Empty);
+            }
+            else
+            {
+                _state = State.String;
+            }
+        }
+
+        private void EndString(string value)
+        {
+            _state = State.Type;
+            if (IsKey)
+            {
+                _handler.OnProperty(value);
+            }
+            else
+            {
+                _handler.OnString(value);
+            }
+            EndValue();
+        }
+
+        private void OnLiteral(string literal)
+        {
+            if (_depth == 0)
+            {
+                throw new InvalidDataException("MessagePack document has to be a map or an array.");
+            }
+            if (IsKey)
+            {
+                throw new InvalidDataException("MessagePack map keys have to be strings.");
+            }
+            _handler.OnLiteral(literal);
+            EndValue();
+        }
+
+        /**
+         * \brief   Counts a complete value and closes the containers it completes.
+         */
+        private void EndValue()
+        {
+            while (_depth > 0)
+            {
+                if (--_containers[_depth - 1].Remaining > 0)
+                {
+                    return;
+                }
+                --_depth;
+                EndContainer(_containers[_depth].IsMap);
+            }
+            _state = State.Done;
+        }
+        #endregion
+    }
+}
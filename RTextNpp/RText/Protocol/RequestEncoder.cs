@@ -0,0 +1,65 @@
+﻿using System;
+using System.Globalization;
+using System.Text;
+using Newtonsoft.Json;
+
+namespace RTextNppPlugin.RText.Protocol
+{
+    /**
+     * \brief   Encodings of the messages exchanged with the back-end.
+     */
+    internal enum ProtocolEncoding
+    {
+        Json,           //!< JSON text, understood by every back-end.
+        MessagePack     //!< MessagePack, used once the back-end accepted it.
+    }
+
+    /**
+     * \brief   Frames requests for the back-end, i.e. serializes them prefixed with their length.
+     */
+    internal static class RequestEncoder
+    {
+        #region [Interface]
+        /**
+         * \brief   Encodes a request as JSON.
+         *
+         * \param   request The request, its invocation id has to be assigned already.
+         *
+         * \return  The bytes to send.
+         */
+        internal static byte[] Encode(RequestBase request)
+        {
+            string aSerializedCommand     = JsonConvert.SerializeObject(request, Formatting.None);
+            StringBuilder aExtendedString = new StringBuilder(aSerializedCommand.Length + 10);
+            aExtendedString.Append(aSerializedCommand.Length);
+            aExtendedString.Append(aSerializedCommand);
+            return Encoding.ASCII.GetBytes(aExtendedString.ToString());
+        }
+
+        /**
+         * \brief   Encodes a request.
+         *
+         * \param   request     The request, its invocation id has to be assigned already.
+         * \param   encoding    The encoding negotiated with the back-end.
+         *
+         * \return  The bytes to send.
+         */
+        internal static byte[] Encode(RequestBase request, ProtocolEncoding encoding)
+        {
+            return (encoding == ProtocolEncoding.MessagePack) ? Frame(MessagePackEncoder.Encode(request)) : Encode(request);
+        }
+
+        /**
+         * \brief   Prefixes the body of a message with its length.
+         */
+        internal static byte[] Frame(byte[] body)
+        {
+            byte[] aPrefix = Encoding.ASCII.GetBytes(body.Length.ToString(CultureInfo.InvariantCulture));
+            byte[] aFrame  = new byte[aPrefix.Length + body.Length];
+            Buffer.BlockCopy(aPrefix, 0, aFrame, 0, aPrefix.Length);
+            Buffer.BlockCopy(body, 0, aFrame, aPrefix.Length, body.Length);
+            return aFrame;
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,629 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Globalization;
+
+namespace RTextNppPlugin.RText.Protocol
+{
+    /**
+     * \brief   Builds a response from the tokens of a JsonPushParser or MessagePackPushParser, so that large responses are
+     *          never held as text.
+     *
+     *          Derived builders only look at the members they know, anything else, e.g. members added by newer back-ends,
+     *          is skipped.
+     */
+    internal abstract class ResponseBuilder : IJsonHandler
+    {
+        #region [Data Members]
+        private readonly List<string> _keys = new List<string>();   //!< Key of every open container, null for the root and for array elements.
+        private readonly List<bool> _arrays = new List<bool>();     //!< Whether an open container is an array.
+        private string _key                 = null;                 //!< Key of the current member of the innermost object.
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Gets the response built so far.
+         */
+        internal abstract IResponseBase Response { get; }
+
+        public void OnStartObject()
+        {
+            Push(false);
+            OnContainerStarted(false);
+        }
+
+        public void OnEndObject()
+        {
+            OnContainerEnded(false);
+            Pop();
+        }
+
+        public void OnStartArray()
+        {
+            Push(true);
+            OnContainerStarted(true);
+        }
+
+        public void OnEndArray()
+        {
+            OnContainerEnded(true);
+            Pop();
+        }
+
+        public void OnProperty(string name)
+        {
+            _key = name;
+        }
+
+        public void OnString(string value)
+        {
+            OnValue(value);
+        }
+
+        public void OnLiteral(string literal)
+        {
+            OnValue((literal == "null") ? null : literal);
+        }
+        #endregion
+
+        #region [Helpers]
+        /**
+         * \brief   Gets the number of open containers, 1 within the root object.
+         */
+        protected int Depth
+        {
+            get
+            {
+                return _keys.Count;
+            }
+        }
+
+        /**
+         * \brief   Gets the key of the value being parsed, null within arrays.
+         */
+        protected string Key
+        {
+            get
+            {
+                return (_arrays.Count == 0 || _arrays[_arrays.Count - 1]) ? null : _key;
+            }
+        }
+
+        /**
+         * \brief   Gets the key an open container was opened with, e.g. KeyAt(1) is the member of the root object which
+         *          contains the current value.
+         */
+        protected string KeyAt(int depth)
+        {
+            return (depth < _keys.Count) ? _keys[depth] : null;
+        }
+
+        /**
+         * \brief   Called after an object or array was opened, Depth includes it.
+         */
+        protected abstract void OnContainerStarted(bool isArray);
+
+        /**
+         * \brief   Called before an object or array is closed, Depth includes it.
+         */
+        protected abstract void OnContainerEnded(bool isArray);
+
+        /**
+         * \brief   Called for every value which is no container, null for null.
+         */
+        protected abstract void OnValue(string value);
+
+        protected static int ToInt(string value)
+        {
+            int aValue = 0;
+            Int32.TryParse(value, NumberStyles.Integer, CultureInfo.InvariantCulture, out aValue);
+            return aValue;
+        }
+
+        private void Push(bool isArray)
+        {
+            _keys.Add(Key);
+            _arrays.Add(isArray);
+            _key = null;
+        }
+
+        private void Pop()
+        {
+            _keys.RemoveAt(_keys.Count - 1);
+            _arrays.RemoveAt(_arrays.Count - 1);
+        }
+        #endregion
+    }
+
+    /**
+     * \brief   Builds a LoadResponse, handing out the problems of every file as soon as they are complete.
+     */
+    internal sealed class LoadResponseBuilder : ResponseBuilder
+    {
+        #region [Data Members]
+        private readonly LoadResponse _response         = new LoadResponse();
+        private readonly Action<Error> _onError         = null;                                             //!< Called for every complete file.
+        private readonly Dictionary<string, string> _strings = new Dictionary<string, string>(StringComparer.Ordinal); //!< Messages and severities repeat a lot, they are stored once.
+        private Error _error                            = null;                                             //!< The file being parsed.
+        private SpecificError _problem                  = null;                                             //!< The problem being parsed.
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates a builder.
+         *
+         * \param   onError Called for the problems of every file as soon as they are parsed, may be null.
+         */
+        internal LoadResponseBuilder(Action<Error> onError)
+        {
+            _onError = onError;
+        }
+
+        internal override IResponseBase Response { get { return _response; } }
+        #endregion
+
+        #region [Helpers]
+        protected override void OnContainerStarted(bool isArray)
+        {
+            if (Depth == 2 && isArray && KeyAt(1) == "problems")
+            {
+                _response.problems = new List<Error>();
+            }
+            else if (Depth == 3 && !isArray && _response.problems != null && KeyAt(1) == "problems")
+            {
+                _error = new Error { problems = new List<SpecificError>() };
+            }
+            else if (Depth == 5 && !isArray && _error != null && KeyAt(3) == "problems")
+            {
+                _problem = new SpecificError();
+            }
+        }
+
+        protected override void OnContainerEnded(bool isArray)
+        {
+            if (Depth == 5 && _problem != null)
+            {
+                _error.problems.Add(_problem);
+                _problem = null;
+            }
+            else if (Depth == 3 && _error != null)
+            {
+                _response.problems.Add(_error);
+                if (_onError != null)
+                {
+                    _onError(_error);
+                }
+                _error = null;
+            }
+        }
+
+        protected override void OnValue(string value)
+        {
+            if (Depth == 1)
+            {
+                switch (Key)
+                {
+                    case "type":
+                        _response.type = value;
+                        break;
+                    case "invocation_id":
+                        _response.invocation_id = ToInt(value);
+                        break;
+                    case "total_problems":
+                        _response.total_problems = ToInt(value);
+                        break;
+                    case "percentage":
+                        _response.percentage = ToInt(value);
+                        break;
+                    case "message":
+                        _response.message = value;
+                        break;
+                }
+            }
+            else if (Depth == 3 && _error != null && Key == "file")
+            {
+                _error.file = value;
+            }
+            else if (Depth == 5 && _problem != null)
+            {
+                switch (Key)
+                {
+                    case "message":
+                        _problem.message = Pool(value);
+                        break;
+                    case "severity":
+                        _problem.severity = Pool(value);
+                        break;
+                    case "line":
+                        _problem.line = ToInt(value);
+                        break;
+                }
+            }
+        }
+
+        private string Pool(string value)
+        {
+            if (value == null)
+            {
+                return null;
+            }
+            string aPooled = null;
+            if (!_strings.TryGetValue(value, out aPooled))
+            {
+                _strings.Add(value, value);
+                aPooled = value;
+            }
+            return aPooled;
+        }
+        #endregion
+    }
+
+    /**
+     * \brief   Builds a LinkTargetsResponse.
+     */
+    internal sealed class LinkTargetsResponseBuilder : ResponseBuilder
+    {
+        #region [Data Members]
+        private readonly LinkTargetsResponse _response = new LinkTargetsResponse();
+        private Target _target                         = null; //!< The target being parsed.
+        #endregion
+
+        #region [Interface]
+        internal override IResponseBase Response { get { return _response; } }
+        #endregion
+
+        #region [Helpers]
+        protected override void OnContainerStarted(bool isArray)
+        {
+            if (Depth == 2 && isArray && KeyAt(1) == "targets")
+            {
+                _response.targets = new List<Target>();
+            }
+            else if (Depth == 3 && !isArray && _response.targets != null && KeyAt(1) == "targets")
+            {
+                _target = new Target();
+            }
+        }
+
+        protected override void OnContainerEnded(bool isArray)
+        {
+            if (Depth == 3 && _target != null)
+            {
+                _response.targets.Add(_target);
+                _target = null;
+            }
+        }
+
+        protected override void OnValue(string value)
+        {
+            if (Depth == 1)
+            {
+                switch (Key)
+                {
+                    case "type":
+                        _response.type = value;
+                        break;
+                    case "invocation_id":
+                        _response.invocation_id = ToInt(value);
+                        break;
+                    case "begin_column":
+                        _response.begin_column = value;
+                        break;
+                    case "end_column":
+                        _response.end_column = value;
+                        break;
+                    case "percentage":
+                        _response.percentage = ToInt(value);
+                        break;
+                    case "message":
+                        _response.message = value;
+                        break;
+                }
+            }
+            else if (Depth == 3 && _target != null)
+            {
+                switch (Key)
+                {
+                    case "display":
+                        _target.display = value;
+                        break;
+                    case "file":
+                        _target.file = value;
+                        break;
+                    case "line":
+                        _target.line = value;
+                        break;
+                    case "desc":
+                        _target.desc = value;
+                        break;
+                }
+            }
+        }
+        #endregion
+    }
+
+    /**
+     * \brief   Builds an AutoCompleteResponse.
+     */
+    internal sealed class AutoCompleteResponseBuilder : ResponseBuilder
+    {
+        #region [Data Members]
+        private readonly AutoCompleteResponse _response = new AutoCompleteResponse();
+        private Option _option                          = null; //!< The option being parsed.
+        #endregion
+
+        #region [Interface]
+        internal override IResponseBase Response { get { return _response; } }
+        #endregion
+
+        #region [Helpers]
+        protected override void OnContainerStarted(bool isArray)
+        {
+            if (Depth == 2 && isArray && KeyAt(1) == "options")
+            {
+                _response.options = new List<Option>();
+            }
+            else if (Depth == 3 && !isArray && _response.options != null && KeyAt(1) == "options")
+            {
+                _option = new Option();
+            }
+        }
+
+        protected override void OnContainerEnded(bool isArray)
+        {
+            if (Depth == 3 && _option != null)
+            {
+                _response.options.Add(_option);
+                _option = null;
+            }
+        }
+
+        protected override void OnValue(string value)
+        {
+            if (Depth == 1)
+            {
+                switch (Key)
+                {
+                    case "type":
+                        _response.type = value;
+                        break;
+                    case "invocation_id":
+                        _response.invocation_id = ToInt(value);
+                        break;
+                    case "percentage":
+                        _response.percentage = ToInt(value);
+                        break;
+                    case "message":
+                        _response.message = value;
+                        break;
+                }
+            }
+            else if (Depth == 3 && _option != null)
+            {
+                switch (Key)
+                {
+                    case "display":
+                        _option.display = value;
+                        break;
+                    case "insert":
+                        _option.insert = value;
+                        break;
+                    case "desc":
+                        _option.desc = value;
+                        break;
+                }
+            }
+        }
+        #endregion
+    }
+
+    /**
+     * \brief   Builds a FindRTextElementsResponse.
+     */
+    internal sealed class FindElementsResponseBuilder : ResponseBuilder
+    {
+        #region [Data Members]
+        private readonly FindRTextElementsResponse _response = new FindRTextElementsResponse();
+        private Element _element                             = null; //!< The element being parsed.
+        #endregion
+
+        #region [Interface]
+        internal override IResponseBase Response { get { return _response; } }
+        #endregion
+
+        #region [Helpers]
+        protected override void OnContainerStarted(bool isArray)
+        {
+            if (Depth == 2 && isArray && KeyAt(1) == "elements")
+            {
+                _response.elements = new List<Element>();
+            }
+            else if (Depth == 3 && !isArray && _response.elements != null && KeyAt(1) == "elements")
+            {
+                _element = new Element();
+            }
+        }
+
+        protected override void OnContainerEnded(bool isArray)
+        {
+            if (Depth == 3 && _element != null)
+            {
+                _response.elements.Add(_element);
+                _element = null;
+            }
+        }
+
+        protected override void OnValue(string value)
+        {
+            if (Depth == 1)
+            {
+                switch (Key)
+                {
+                    case "type":
+                        _response.type = value;
+                        break;
+                    case "invocation_id":
+                        _response.invocation_id = ToInt(value);
+                        break;
+                    case "total_elements":
+                        _response.total_elements = value;
+                        break;
+                    case "percentage":
+                        _response.percentage = ToInt(value);
+                        break;
+                    case "message":
+                        _response.message = value;
+                        break;
+                }
+            }
+            else if (Depth == 3 && _element != null)
+            {
+                switch (Key)
+                {
+                    case "display":
+                        _element.display = value;
+                        break;
+                    case "file":
+                        _element.file = value;
+                        break;
+                    case "line":
+                        _element.line = ToInt(value);
+                        break;
+                    case "desc":
+                        _element.desc = value;
+                        break;
+                }
+            }
+        }
+        #endregion
+    }
+
+    /**
+     * \brief   Builds a ContextInfoResponse.
+     */
+    internal sealed class ContextInfoResponseBuilder : ResponseBuilder
+    {
+        #region [Data Members]
+        private readonly ContextInfoResponse _response = new ContextInfoResponse();
+        #endregion
+
+        #region [Interface]
+        internal override IResponseBase Response { get { return _response; } }
+        #endregion
+
+        #region [Helpers]
+        protected override void OnContainerStarted(bool isArray)
+        {
+        }
+
+        protected override void OnContainerEnded(bool isArray)
+        {
+        }
+
+        protected override void OnValue(string value)
+        {
+            if (Depth != 1)
+            {
+                return;
+            }
+            switch (Key)
+            {
+                case "type":
+                    _response.type = value;
+                    break;
+                case "invocation_id":
+                    _response.invocation_id = ToInt(value);
+                    break;
+                case "desc":
+                    _response.desc = value;
+                    break;
+                case "percentage":
+                    _response.percentage = ToInt(value);
+                    break;
+                case "message":
+                    _response.message = value;
+                    break;
+            }
+        }
+        #endregion
+    }
+
+    /**
+     * \brief   Builds an EncodingResponse.
+     */
+    internal sealed class EncodingResponseBuilder : ResponseBuilder
+    {
+        #region [Data Members]
+        private readonly EncodingResponse _response = new EncodingResponse();
+        #endregion
+
+        #region [Interface]
+        internal override IResponseBase Response { get { return _response; } }
+        #endregion
+
+        #region [Helpers]
+        protected override void OnContainerStarted(bool isArray)
+        {
+        }
+
+        protected override void OnContainerEnded(bool isArray)
+        {
+        }
+
+        protected override void OnValue(string value)
+        {
+            if (Depth != 1)
+            {
+                return;
+            }
+            switch (Key)
+            {
+                case "type":
+                    _response.type = value;
+                    break;
+                case "invocation_id":
+                    _response.invocation_id = ToInt(value);
+                    break;
+                case "encoding":
+                    _response.encoding = value;
+                    break;
+            }
+        }
+        #endregion
+    }
+
+    /**
+     * \brief   Builds a ResponseBase, e.g. the acknowledgement of the stop command.
+     */
+    internal sealed class ResponseBaseBuilder : ResponseBuilder
+    {
+        #region [Data Members]
+        private readonly ResponseBase _response = new ResponseBase();
+        #endregion
+
+        #region [Interface]
+        internal override IResponseBase Response { get { return _response; } }
+        #endregion
+
+        #region [Helpers]
+        protected override void OnContainerStarted(bool isArray)
+        {
+        }
+
+        protected override void OnContainerEnded(bool isArray)
+        {
+        }
+
+        protected override void OnValue(string value)
+        {
+            if (Depth == 1 && Key == "type")
+            {
+                _response.type = value;
+            }
+            else if (Depth == 1 && Key == "invocation_id")
+            {
+                _response.invocation_id = ToInt(value);
+            }
+        }
+        #endregion
+    }
+}
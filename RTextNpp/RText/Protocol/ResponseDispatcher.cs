@@ -0,0 +1,188 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Globalization;
+
+namespace RTextNppPlugin.RText.Protocol
+{
+    /**
+     * \brief   Routes the tokens of a response to the builder of the request it answers.
+     *
+     *          The request is only known once the invocation_id of the response was parsed. The back-end sends it right
+     *          after the type, so only a few tokens are kept until then; they are replayed to the builder.
+     */
+    internal sealed class ResponseDispatcher : IJsonHandler
+    {
+        #region [Data Members]
+        private enum TokenKind
+        {
+            StartObject,
+            EndObject,
+            StartArray,
+            EndArray,
+            Property,
+            String,
+            Literal
+        }
+
+        private struct Token
+        {
+            internal TokenKind Kind;
+            internal string Text;
+        }
+
+        private readonly Func<int, ResponseBuilder> _createBuilder = null;                  //!< Creates the builder of an invocation id, null if no request waits for it.
+        private readonly List<Token> _tokens                       = new List<Token>();     //!< Tokens received before the invocation id.
+        private ResponseBuilder _builder                           = null;                  //!< The builder, once the invocation id is known.
+        private bool _isDispatched                                 = false;                 //!< Whether the invocation id is known.
+        private bool _hasInvocationId                              = false;                 //!< Whether the response has a valid invocation id.
+        private int _depth                                         = 0;                     //!< Number of open containers.
+        private string _key                                        = null;                  //!< Key of the current member of the root object.
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates a dispatcher for one response.
+         *
+         * \param   createBuilder   Creates the builder for an invocation id, returns null if no request waits for it.
+         */
+        internal ResponseDispatcher(Func<int, ResponseBuilder> createBuilder)
+        {
+            _createBuilder = createBuilder;
+        }
+
+        /**
+         * \brief   Gets the response, null if no request waits for it or it has no valid invocation id.
+         */
+        internal IResponseBase Response
+        {
+            get
+            {
+                if (!_isDispatched)
+                {
+                    //responses without invocation id are answered by nobody
+                    Dispatch(null);
+                }
+                return (_builder != null) ? _builder.Response : null;
+            }
+        }
+
+        /**
+         * \brief   Gets whether the response has a valid invocation id. Responses without one are dropped, the builders are
+         *          not asked for them.
+         */
+        internal bool HasInvocationId
+        {
+            get
+            {
+                return _hasInvocationId;
+            }
+        }
+
+        public void OnStartObject()
+        {
+            ++_depth;
+            Forward(TokenKind.StartObject, null);
+        }
+
+        public void OnEndObject()
+        {
+            --_depth;
+            Forward(TokenKind.EndObject, null);
+        }
+
+        public void OnStartArray()
+        {
+            ++_depth;
+            Forward(TokenKind.StartArray, null);
+        }
+
+        public void OnEndArray()
+        {
+            --_depth;
+            Forward(TokenKind.EndArray, null);
+        }
+
+        public void OnProperty(string name)
+        {
+            if (_depth == 1)
+            {
+                _key = name;
+            }
+            Forward(TokenKind.Property, name);
+        }
+
+        public void OnString(string value)
+        {
+            Forward(TokenKind.String, value);
+        }
+
+        public void OnLiteral(string literal)
+        {
+            Forward(TokenKind.Literal, literal);
+            if (!_isDispatched && _depth == 1 && _key == "invocation_id")
+            {
+                int aInvocationId = 0;
+                bool aIsValid     = Int32.TryParse(literal, NumberStyles.Integer, CultureInfo.InvariantCulture, out aInvocationId) && aInvocationId >= 0;
+                Dispatch(aIsValid ? aInvocationId : (int?)null);
+            }
+        }
+        #endregion
+
+        #region [Helpers]
+        private void Forward(TokenKind kind, string text)
+        {
+            if (_builder != null)
+            {
+                Replay(kind, text);
+            }
+            else if (!_isDispatched)
+            {
+                _tokens.Add(new Token { Kind = kind, Text = text });
+            }
+        }
+
+        private void Replay(TokenKind kind, string text)
+        {
+            switch (kind)
+            {
+                case TokenKind.StartObject:
+                    _builder.OnStartObject();
+                    break;
+                case TokenKind.EndObject:
+                    _builder.OnEndObject();
+                    break;
+                case TokenKind.StartArray:
+                    _builder.OnStartArray();
+                    break;
+                case TokenKind.EndArray:
+                    _builder.OnEndArray();
+                    break;
+                case TokenKind.Property:
+                    _builder.OnProperty(text);
+                    break;
+                case TokenKind.String:
+                    _builder.OnString(text);
+                    break;
+                case TokenKind.Literal:
+                    _builder.OnLiteral(text);
+                    break;
+            }
+        }
+
+        private void Dispatch(int? invocationId)
+        {
+            _isDispatched    = true;
+            _hasInvocationId = invocationId.HasValue;
+            _builder         = invocationId.HasValue ? _createBuilder(invocationId.Value) : null;
+            if (_builder != null)
+            {
+                foreach (var aToken in _tokens)
+                {
+                    Replay(aToken.Kind, aToken.Text);
+                }
+            }
+            _tokens.Clear();
+        }
+        #endregion
+    }
+}
@@ -16,6 +16,7 @@ namespace RTextNppPlugin.RText
     using RTextNppPlugin.Utilities.Settings;
     using RTextNppPlugin.Utilities.Threading;
     using RTextNppPlugin.RText.Protocol;
+    using RTextNppPlugin.RText.Indexing;
 
     /**
      * \class   RTextBackendProcess
@@ -34,6 +35,8 @@ namespace RTextNppPlugin.RText
         private CancellationTokenSource _cancellationSource = null;
         private Task _stdOutReaderTask = null;
         private Task _stdErrReaderTask = null;
+        private Task _outputDrainTask = null;                                                                                            //!< Passes the captured output of the back-end on to the console.
+        private readonly BackendOutput _output = new BackendOutput(Constants.OUTPUT_BUFFER_CAPACITY, Constants.OUTPUT_LINES_PER_DRAIN); //!< Captured output of the back-end, bounded so that a chatty back-end can't flood the console.
         private Connector _connector = null;
         private readonly Regex _backendInitResponseRegex = new Regex(@"^RText service, listening on port (\d+)$", RegexOptions.Compiled);
         private DispatcherTimer _timer;
@@ -42,6 +45,11 @@ namespace RTextNppPlugin.RText
         private string _autoRunKey = String.Empty;                                                                                       //!< The autorun registry value.
         private readonly VoidDelayedEventHandler _workspaceFileWatcherDebouncer = null;                                                  //!< Debounces workspace file (.rtext) changes events.
         private bool _isShutingDown = false;
+        private readonly WorkspaceIndex _workspaceIndex = null;                                                                          //!< Local index of the elements of the workspace, available while the backend is still loading.
+        private readonly VoidDelayedEventHandler _workspaceIndexDebouncer = null;                                                        //!< Collects changes of workspace files before the index is updated.
+        private readonly CompletionUsage _completionUsage = null;                                                                        //!< Committed completions of the workspace, used to rank completion options.
+        private readonly ResponseCache _responseCache = new ResponseCache(RESPONSE_CACHE_CAPACITY);                                     //!< Responses of the back-end which stay valid until the workspace is modified.
+        private const int RESPONSE_CACHE_CAPACITY = 256;                                                                                 //!< Maximum number of cached responses.
         #endregion
         
         #region [Interface]
@@ -207,6 +215,10 @@ namespace RTextNppPlugin.RText
             _settings                      = settings;
             _connector                     = new Connector(this);
             _workspaceFileWatcherDebouncer = new VoidDelayedEventHandler(new Action(RestartProcess), 1000);
+            _workspaceIndex                = new WorkspaceIndex(rTextFilePath, ext, new NativeOutlineProvider());
+            _workspaceIndexDebouncer       = new VoidDelayedEventHandler(new Action(UpdateWorkspaceIndex), 500);
+            _completionUsage               = new CompletionUsage(CompletionUsage.GetFilePath(rTextFilePath, ext));
+            BuildWorkspaceIndex();
         }
 
         internal async void Disconnect()
@@ -232,6 +244,7 @@ namespace RTextNppPlugin.RText
 
         internal void OnFileSaved(string file)
         {
+            InvalidateWorkspaceIndex(file);
             OnWorkspaceModified(file);
         }
         
@@ -281,6 +294,34 @@ namespace RTextNppPlugin.RText
         }        
         
         internal Connector Connector { get { return _connector; } }
+
+        internal WorkspaceIndex WorkspaceIndex { get { return _workspaceIndex; } }
+
+        internal CompletionUsage CompletionUsage { get { return _completionUsage; } }
+
+        internal ResponseCache ResponseCache { get { return _responseCache; } }
+
+        /**
+         * \brief   Finds elements which names start with a pattern.
+         *
+         * \param   pattern The search pattern.
+         *
+         * \return  The found elements. While the model is loading these come from the local workspace index only. Once
+         *          it is loaded the backend is asked as well, since it also finds elements which are identified by a custom
+         *          identifier provider, and its elements are merged with the local ones. Null if neither could answer.
+         */
+        internal async Task<FindRTextElementsResponse> FindElementsAsync(string pattern)
+        {
+            var aLocalResponse = (_workspaceIndex != null) ? _workspaceIndex.FindElements(pattern) : null;
+            if (aLocalResponse != null && !IsModelLoaded)
+            {
+                return aLocalResponse;
+            }
+            //also starts the backend and loads the model, if it isn't running yet
+            var aRequest         = new FindElementRequest { command = Constants.Commands.FIND_ELEMENTS, search_pattern = pattern };
+            var aBackendResponse = await _connector.ExecuteAsync<FindElementRequest>(aRequest, Constants.SYNCHRONOUS_COMMANDS_TIMEOUT, StateEngine.Command.Execute) as FindRTextElementsResponse;
+            return WorkspaceIndex.MergeElements(aBackendResponse, aLocalResponse);
+        }
         
         /**
          *
@@ -310,6 +351,51 @@ namespace RTextNppPlugin.RText
         
         #region [Helpers]
 
+        /**
+         * \brief   Gets a value indicating whether the backend loaded the model, i.e. answers commands.
+         */
+        private bool IsModelLoaded
+        {
+            get
+            {
+                var aState = _connector.CurrentState.State;
+                return aState == RText.StateEngine.ConnectorStates.Idle || aState == RText.StateEngine.ConnectorStates.Busy;
+            }
+        }
+
+        private async void BuildWorkspaceIndex()
+        {
+            try
+            {
+                await _workspaceIndex.BuildAsync(CancellationToken.None);
+            }
+            catch (Exception ex)
+            {
+                Logging.Logger.Instance.Append(Logging.Logger.MessageType.Error, _pInfo.ProcKey, "RTextBackendProcess.BuildWorkspaceIndex() - Exception : {0}", ex.Message);
+            }
+        }
+
+        private void InvalidateWorkspaceIndex(string file)
+        {
+            //the timer is only started by the first change, so a steady stream of changes, e.g. from a build tool, can't postpone the update forever
+            if (_workspaceIndex != null && _workspaceIndex.Invalidate(file))
+            {
+                _workspaceIndexDebouncer.TriggerHandler();
+            }
+        }
+
+        private async void UpdateWorkspaceIndex()
+        {
+            try
+            {
+                await _workspaceIndex.UpdateAsync();
+            }
+            catch (Exception ex)
+            {
+                Logging.Logger.Instance.Append(Logging.Logger.MessageType.Error, _pInfo.ProcKey, "RTextBackendProcess.UpdateWorkspaceIndex() - Exception : {0}", ex.Message);
+            }
+        }
+
         private async Task CreateNewProcessAsync()
         {
             OnProcessExited(null, EventArgs.Empty);
@@ -370,8 +456,9 @@ namespace RTextNppPlugin.RText
                 _process.Start();
                 //start reading asynchronously with tasks
                 _cancellationSource = new CancellationTokenSource();
-                _stdOutReaderTask = new Task(() => ReadStream(_process.StandardOutput, _cancellationSource.Token), _cancellationSource.Token);
-                _stdErrReaderTask = Task.Factory.StartNew(() => ReadStream(_process.StandardError, _cancellationSource.Token), _cancellationSource.Token);
+                _stdOutReaderTask = new Task(() => ReadStream(_process.StandardOutput, _output.StandardOutput, _cancellationSource.Token), _cancellationSource.Token);
+                _stdErrReaderTask = Task.Factory.StartNew(() => ReadStream(_process.StandardError, _output.StandardError, _cancellationSource.Token), _cancellationSource.Token);
+                _outputDrainTask  = Task.Factory.StartNew(() => DrainOutput(_cancellationSource.Token), _cancellationSource.Token, TaskCreationOptions.LongRunning, TaskScheduler.Default);
                 _pInfo.Port = -1; //initialize port every time this function is called
                 var aPortTask = new Task<bool>(() =>
                 {
@@ -420,14 +507,14 @@ namespace RTextNppPlugin.RText
                     {
                         while (!stream.EndOfStream)
                         {
-                            Logging.Logger.Instance.Append(Logging.Logger.MessageType.Info, _pInfo.ProcKey, stream.ReadLine());
+                            _output.StandardOutput.Enqueue(stream.ReadLine());
                         }
                         return -1;
                     }
                     if (!stream.EndOfStream)
                     {
                         var aLine = stream.ReadLine();
-                        Logging.Logger.Instance.Append(Logging.Logger.MessageType.Info, _pInfo.ProcKey, aLine);
+                        _output.StandardOutput.Enqueue(aLine);
                         if (_backendInitResponseRegex.IsMatch(aLine))
                         {
                             return Int32.Parse(_backendInitResponseRegex.Match(aLine).Groups[1].Value);
@@ -447,21 +534,43 @@ namespace RTextNppPlugin.RText
          *
          * \brief   Reads a synchronous stream asynchronously. .NET bug workaround.
          *
+         *          Lines are only buffered, so that the back-end isn't slowed down by the console. The stream is read
+         *          as long as it has lines, the thread sleeps only while it has none.
+         *
          * \param   stream  The stream.
+         * \param   buffer  Receives the lines, this thread is its only producer.
          * \param   token   The cancellation token.
          */
-        private void ReadStream(System.IO.StreamReader stream, CancellationToken token)
+        private void ReadStream(System.IO.StreamReader stream, RingBuffer<string> buffer, CancellationToken token)
         {
             while (!token.IsCancellationRequested)
             {
-                System.Threading.Thread.Sleep(Constants.OUTPUT_POLL_PERIOD);
                 if (!stream.EndOfStream)
                 {
-                    string aLine = stream.ReadLine();
-                    Logging.Logger.Instance.Append(Logging.Logger.MessageType.Info, _pInfo.ProcKey, aLine);
+                    buffer.Enqueue(stream.ReadLine());
+                }
+                else
+                {
+                    System.Threading.Thread.Sleep(Constants.OUTPUT_POLL_PERIOD);
                 }
             }
         }
+
+        /**
+         *
+         * \brief   Passes the captured output on to the console periodically, until the back-end is stopped.
+         *
+         * \param   token   The cancellation token.
+         */
+        private void DrainOutput(CancellationToken token)
+        {
+            while (!token.WaitHandle.WaitOne(Constants.OUTPUT_DRAIN_PERIOD))
+            {
+                _output.Drain(x => Logging.Logger.Instance.Append(Logging.Logger.MessageType.Info, _pInfo.ProcKey, x));
+            }
+            //last words of the back-end
+            _output.Drain(x => Logging.Logger.Instance.Append(Logging.Logger.MessageType.Info, _pInfo.ProcKey, x));
+        }
         
         /**
          *
@@ -655,6 +764,8 @@ namespace RTextNppPlugin.RText
          */
         private void OnRTextFileRenamed(object sender, System.IO.RenamedEventArgs e)
         {
+            InvalidateWorkspaceIndex(e.OldFullPath);
+            InvalidateWorkspaceIndex(e.FullPath);
             OnWorkspaceModified(e.OldFullPath);
         }
         
@@ -669,6 +780,7 @@ namespace RTextNppPlugin.RText
          */
         private void OnRTextFileCreatedOrDeletedOrModified(object sender, System.IO.FileSystemEventArgs e)
         {
+            InvalidateWorkspaceIndex(e.FullPath);
             OnWorkspaceModified(e.FullPath);
         }
         
@@ -679,6 +791,8 @@ namespace RTextNppPlugin.RText
          */
         private void OnWorkspaceModified(string pathOfModifiedFile)
         {
+            //any saved file may change the targets of references in other files
+            _responseCache.Invalidate();
             if (_settings.Get<bool>(Settings.RTextNppSettings.AutoSaveFiles))
             {
                 //find .rtext file of this document
@@ -742,6 +856,10 @@ namespace RTextNppPlugin.RText
                 {
                     _stdOutReaderTask.Wait();
                 }
+                if (!(_outputDrainTask.IsCanceled || _outputDrainTask.IsCompleted || _outputDrainTask.IsFaulted))
+                {
+                    _outputDrainTask.Wait();
+                }
             }
             catch (OperationCanceledException ex)
             {
@@ -0,0 +1,173 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading.Tasks;
+using RTextNppPlugin.RText.Protocol;
+
+namespace RTextNppPlugin.RText
+{
+    /**
+     * \brief   Schedules requests which are issued per keystroke or mouse move, e.g. content_complete, link_targets and
+     *          context_info.
+     *
+     *          Only the latest request of each command is of interest, and at most one request of each command is sent
+     *          at a time. A request issued while another one of its command is in flight waits for the response of that
+     *          one and is replaced by any later request; only the latest waiting request is sent. A request for the same
+     *          context as the pending one shares its response; any other request supersedes the pending one, which is
+     *          answered with null right away. The back-end protocol can't cancel a command, so a superseded request which
+     *          was sent already keeps its command busy till its response arrives, which is dropped. The scheduler is used
+     *          from the UI thread only.
+     */
+    internal sealed class RequestScheduler
+    {
+        #region [Data Members]
+        private class Slot
+        {
+            internal AutoCompleteAndReferenceRequest Latest;                //!< The request issued last.
+            internal AutoCompleteAndReferenceRequest Executed;              //!< The request in flight, null if none.
+            internal TaskCompletionSource<IResponseBase> ExecutedResult;    //!< Answers the callers of Executed.
+            internal AutoCompleteAndReferenceRequest Waiting;               //!< The request to send once Executed is answered, null if none.
+            internal RequestPriority WaitingPriority;                       //!< The priority of Waiting.
+            internal TaskCompletionSource<IResponseBase> WaitingResult;     //!< Answers the callers of Waiting.
+        }
+
+        private readonly Func<AutoCompleteAndReferenceRequest, RequestPriority, Task<IResponseBase>> _execute = null;    //!< Executes a request on the connector.
+        private readonly Action<RequestBase> _abandon                                                        = null;    //!< Answers a pending request of the connector with null.
+        private readonly Dictionary<string, Slot> _slots                                                     = new Dictionary<string, Slot>(); //!< The pending requests of each command.
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates a scheduler.
+         *
+         * \param   execute Executes a request and returns its response.
+         * \param   abandon Answers a pending request with null, its response is ignored.
+         */
+        internal RequestScheduler(Func<AutoCompleteAndReferenceRequest, RequestPriority, Task<IResponseBase>> execute, Action<RequestBase> abandon)
+        {
+            _execute = execute;
+            _abandon = abandon;
+        }
+
+        /**
+         * \brief   Executes a request unless a pending one of the same command has the same context, and supersedes any
+         *          other pending request of the command. The request waits while another one of its command is in flight.
+         *
+         * \param   request     The request.
+         * \param   priority    The priority of the request.
+         *
+         * \return  The response, null if it failed or the request was superseded. Check IsLatest before using it.
+         */
+        internal Task<IResponseBase> ExecuteLatestAsync(AutoCompleteAndReferenceRequest request, RequestPriority priority)
+        {
+            Slot aSlot = null;
+            if (!_slots.TryGetValue(request.command, out aSlot))
+            {
+                aSlot = new Slot();
+                _slots.Add(request.command, aSlot);
+            }
+            if (aSlot.Waiting != null && IsSameContext(aSlot.Waiting, request))
+            {
+                aSlot.Latest = request;
+                return aSlot.WaitingResult.Task;
+            }
+            if (aSlot.Waiting == null && aSlot.Executed != null && !aSlot.ExecutedResult.Task.IsCompleted && IsSameContext(aSlot.Executed, request))
+            {
+                aSlot.Latest = request;
+                return aSlot.ExecutedResult.Task;
+            }
+            //the response of a superseded request which was sent already is dropped when it arrives
+            if (aSlot.ExecutedResult != null)
+            {
+                aSlot.ExecutedResult.TrySetResult(null);
+            }
+            if (aSlot.WaitingResult != null)
+            {
+                aSlot.WaitingResult.TrySetResult(null);
+            }
+            var aResult  = new TaskCompletionSource<IResponseBase>();
+            aSlot.Latest = request;
+            if (aSlot.Executed == null)
+            {
+                Execute(aSlot, request, priority, aResult);
+            }
+            else
+            {
+                aSlot.Waiting         = request;
+                aSlot.WaitingPriority = priority;
+                aSlot.WaitingResult   = aResult;
+            }
+            return aResult.Task;
+        }
+
+        /**
+         * \brief   Query if a request is the latest one of its command, i.e. if its response is still of interest.
+         */
+        internal bool IsLatest(AutoCompleteAndReferenceRequest request)
+        {
+            Slot aSlot = null;
+            return _slots.TryGetValue(request.command, out aSlot) && aSlot.Latest == request;
+        }
+
+        /**
+         * \brief   Cancels the pending requests of a command, e.g. because the window showing its response was closed.
+         */
+        internal void Cancel(string command)
+        {
+            Slot aSlot = null;
+            if (_slots.TryGetValue(command, out aSlot))
+            {
+                _slots.Remove(command);
+                if (aSlot.WaitingResult != null)
+                {
+                    aSlot.WaitingResult.TrySetResult(null);
+                    aSlot.Waiting       = null;
+                    aSlot.WaitingResult = null;
+                }
+                if (aSlot.Executed != null && !aSlot.ExecutedResult.Task.IsCompleted)
+                {
+                    aSlot.ExecutedResult.TrySetResult(null);
+                    _abandon(aSlot.Executed);
+                }
+            }
+        }
+        #endregion
+
+        #region [Helpers]
+        private void Execute(Slot slot, AutoCompleteAndReferenceRequest request, RequestPriority priority, TaskCompletionSource<IResponseBase> result)
+        {
+            slot.Executed       = request;
+            slot.ExecutedResult = result;
+            slot.Waiting        = null;
+            slot.WaitingResult  = null;
+            OnResponse(slot, request, _execute(request, priority));
+        }
+
+        /**
+         * \brief   Answers the callers of an executed request, unless it was superseded meanwhile, and sends the request
+         *          which waited for it.
+         */
+        private async void OnResponse(Slot slot, AutoCompleteAndReferenceRequest request, Task<IResponseBase> response)
+        {
+            var aResult   = slot.ExecutedResult;
+            var aResponse = await response;
+            aResult.TrySetResult(aResponse);
+            if (slot.Executed != request)
+            {
+                return;
+            }
+            slot.Executed       = null;
+            slot.ExecutedResult = null;
+            if (slot.Waiting != null)
+            {
+                Execute(slot, slot.Waiting, slot.WaitingPriority, slot.WaitingResult);
+            }
+        }
+
+        private static bool IsSameContext(AutoCompleteAndReferenceRequest lhs, AutoCompleteAndReferenceRequest rhs)
+        {
+            return lhs.column == rhs.column && (lhs.context == rhs.context || (lhs.context != null && rhs.context != null && lhs.context.SequenceEqual(rhs.context)));
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,121 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Diagnostics;
+using System.Globalization;
+using System.Linq;
+using System.Text;
+using RTextNppPlugin.Utilities;
+
+namespace RTextNppPlugin.RText
+{
+    /**
+     * \brief   Timestamps and sizes of one request while its responses are received.
+     */
+    internal sealed class RequestTiming
+    {
+        internal long SentAt;           //!< Stopwatch timestamp when the request was sent.
+        internal long FirstByteAt;      //!< Stopwatch timestamp when the first byte of its first response was received, 0 before.
+        internal long DeserializeTicks; //!< Stopwatch ticks spent parsing its responses.
+        internal long Bytes;            //!< Bytes of its responses, including progress responses.
+    }
+
+    /**
+     * \brief   Latencies of the requests of a connector by command, so that a slow command can be attributed to the
+     *          back-end or to the plug-in.
+     *
+     *          For each command the time from sending a request to the first byte of its response (back-end), from the
+     *          first byte to the complete response (transfer), the time spent parsing the response (plug-in) and its size
+     *          are recorded. Recording doesn't lock, so the statistics are always on.
+     */
+    internal sealed class RequestStatistics
+    {
+        #region [Data Members]
+        /**
+         * \brief   Measurements of one command, times in microseconds.
+         */
+        internal sealed class CommandStatistics
+        {
+            internal readonly LatencyHistogram FirstByte    = new LatencyHistogram();   //!< From sending a request to the first byte of its response.
+            internal readonly LatencyHistogram Transfer     = new LatencyHistogram();   //!< From the first byte to the complete response.
+            internal readonly LatencyHistogram Deserialize  = new LatencyHistogram();   //!< Parsing the responses.
+            internal readonly LatencyHistogram Bytes        = new LatencyHistogram();   //!< Bytes of the responses.
+        }
+
+        private readonly ConcurrentDictionary<string, CommandStatistics> _commands = new ConcurrentDictionary<string, CommandStatistics>(StringComparer.Ordinal); //!< Measurements by command.
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Gets the measurements of a command.
+         */
+        internal CommandStatistics this[string command]
+        {
+            get
+            {
+                return _commands.GetOrAdd(command, x => new CommandStatistics());
+            }
+        }
+
+        /**
+         * \brief   Records a request which received its response.
+         *
+         * \param   command     The command of the request.
+         * \param   timing      The timing of the request.
+         * \param   completedAt Stopwatch timestamp when the response was complete.
+         */
+        internal void Record(string command, RequestTiming timing, long completedAt)
+        {
+            var aStatistics   = this[command];
+            long aFirstByteAt = (timing.FirstByteAt == 0) ? completedAt : timing.FirstByteAt;
+            aStatistics.FirstByte.Record(ToMicroseconds(aFirstByteAt - timing.SentAt));
+            aStatistics.Transfer.Record(ToMicroseconds(completedAt - aFirstByteAt));
+            aStatistics.Deserialize.Record(ToMicroseconds(timing.DeserializeTicks));
+            aStatistics.Bytes.Record(timing.Bytes);
+        }
+
+        /**
+         * \brief   Formats the percentiles of all commands, times in milliseconds and sizes in KiB.
+         */
+        internal string Report()
+        {
+            var aReport = new StringBuilder();
+            foreach (var aCommand in _commands.OrderBy(x => x.Key, StringComparer.Ordinal))
+            {
+                var aStatistics = aCommand.Value;
+                long aCount     = aStatistics.Bytes.Count;
+                if (aCount == 0)
+                {
+                    continue;
+                }
+                aReport.AppendFormat(CultureInfo.InvariantCulture, "{0}: {1} requests, {2:F1} KiB received\n", aCommand.Key, aCount, aStatistics.Bytes.Sum / 1024.0);
+                AppendPercentiles(aReport, "send to first byte [ms]", aStatistics.FirstByte, 1000.0);
+                AppendPercentiles(aReport, "first byte to end [ms]", aStatistics.Transfer, 1000.0);
+                AppendPercentiles(aReport, "deserialize [ms]", aStatistics.Deserialize, 1000.0);
+                AppendPercentiles(aReport, "response size [KiB]", aStatistics.Bytes, 1024.0);
+            }
+            return (aReport.Length == 0) ? "No requests were answered yet.\n" : aReport.ToString();
+        }
+
+        /**
+         * \brief   Converts Stopwatch ticks to microseconds.
+         */
+        internal static long ToMicroseconds(long ticks)
+        {
+            return (long)(ticks * (1000000.0 / Stopwatch.Frequency));
+        }
+        #endregion
+
+        #region [Helpers]
+        private static void AppendPercentiles(StringBuilder report, string name, LatencyHistogram histogram, double unit)
+        {
+            report.AppendFormat(CultureInfo.InvariantCulture,
+                                "    {0,-24} p50 {1,9:F2}  p90 {2,9:F2}  p99 {3,9:F2}  max {4,9:F2}\n",
+                                name,
+                                histogram.GetValueAtPercentile(50) / unit,
+                                histogram.GetValueAtPercentile(90) / unit,
+                                histogram.GetValueAtPercentile(99) / unit,
+                                histogram.Max / unit);
+        }
+        #endregion
+    }
+}
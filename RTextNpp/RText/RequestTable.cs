@@ -0,0 +1,203 @@
+﻿using System.Collections.Generic;
+using System.Threading;
+using System.Threading.Tasks;
+using RTextNppPlugin.RText.Protocol;
+
+namespace RTextNppPlugin.RText
+{
+    /**
+     * \brief   Priority of a request, requests with a higher priority are sent first when too many are in flight.
+     */
+    internal enum RequestPriority
+    {
+        Low,
+        Normal,
+        High
+    }
+
+    /**
+     * \brief   A request which waits for its response.
+     */
+    internal sealed class PendingRequest
+    {
+        #region [Interface]
+        internal PendingRequest(RequestBase request, RequestPriority priority)
+        {
+            Request    = request;
+            Priority   = priority;
+            Completion = new TaskCompletionSource<IResponseBase>();
+            Timing     = new RequestTiming();
+        }
+
+        internal RequestBase Request { get; private set; }
+        internal RequestPriority Priority { get; private set; }
+        internal TaskCompletionSource<IResponseBase> Completion { get; private set; }
+        internal bool IsSent { get; set; }                          //!< Whether the request was sent, its invocation id is valid then.
+        internal bool IsAbandoned { get; set; }                     //!< Whether the request was answered with null while in flight, its response is dropped silently then.
+        internal int WaitingSince { get; set; }                     //!< Environment.TickCount when the request was sent, or last found waiting for a busy back-end.
+        internal CancellationTokenSource Timeout { get; set; }      //!< Completes the request when it takes too long, may be null.
+        internal RequestTiming Timing { get; private set; }         //!< Timestamps and sizes for the request statistics.
+        #endregion
+    }
+
+    /**
+     * \brief   The requests of a connector which wait for their response.
+     *
+     *          At most a fixed number of requests are sent to the back-end at a time, so that a burst of requests can't
+     *          delay a more important one for long. Further requests are queued by priority and sent as responses arrive.
+     *          Sent requests are found by their invocation id, so responses may arrive in any order. A sent request keeps
+     *          its slot until its response arrives, even if it was answered with null already. The table isn't thread safe.
+     */
+    internal sealed class RequestTable
+    {
+        #region [Data Members]
+        private readonly int _maxInFlight                       = 0;                                        //!< Maximum number of sent requests without response.
+        private readonly Dictionary<int, PendingRequest> _sent  = new Dictionary<int, PendingRequest>();     //!< Sent requests by invocation id.
+        private readonly List<PendingRequest> _queued           = new List<PendingRequest>();               //!< Requests to send, highest priority first, then oldest first.
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates a table.
+         *
+         * \param   maxInFlight The maximum number of sent requests without response.
+         */
+        internal RequestTable(int maxInFlight)
+        {
+            _maxInFlight = maxInFlight;
+        }
+
+        /**
+         * \brief   Gets the number of sent and queued requests.
+         */
+        internal int Count
+        {
+            get
+            {
+                return _sent.Count + _queued.Count;
+            }
+        }
+
+        /**
+         * \brief   Adds a request to the queue.
+         */
+        internal void Enqueue(PendingRequest request)
+        {
+            int aIndex = _queued.Count;
+            while (aIndex > 0 && _queued[aIndex - 1].Priority < request.Priority)
+            {
+                --aIndex;
+            }
+            _queued.Insert(aIndex, request);
+        }
+
+        /**
+         * \brief   Takes the next request to send from the queue, if fewer than the maximum number of requests are in flight.
+         *          Call Sent once its invocation id is assigned.
+         *
+         * \return  The request, null if none may be sent now.
+         */
+        internal PendingRequest Dequeue()
+        {
+            if (_queued.Count == 0 || _sent.Count >= _maxInFlight)
+            {
+                return null;
+            }
+            var aRequest = _queued[0];
+            _queued.RemoveAt(0);
+            return aRequest;
+        }
+
+        /**
+         * \brief   Marks a dequeued request as sent.
+         */
+        internal void Sent(PendingRequest request)
+        {
+            request.IsSent = true;
+            _sent[request.Request.invocation_id] = request;
+        }
+
+        /**
+         * \brief   Finds a sent request by its invocation id.
+         *
+         * \return  The request, null if it isn't pending.
+         */
+        internal PendingRequest Find(int invocationId)
+        {
+            PendingRequest aRequest = null;
+            _sent.TryGetValue(invocationId, out aRequest);
+            return aRequest;
+        }
+
+        /**
+         * \brief   Finds a sent or queued request by the command it was created for.
+         *
+         * \return  The request, null if it isn't pending.
+         */
+        internal PendingRequest Find(RequestBase request)
+        {
+            foreach (var aRequest in _queued)
+            {
+                if (aRequest.Request == request)
+                {
+                    return aRequest;
+                }
+            }
+            foreach (var aRequest in _sent.Values)
+            {
+                if (aRequest.Request == request)
+                {
+                    return aRequest;
+                }
+            }
+            return null;
+        }
+
+        /**
+         * \brief   Query if a request is sent or queued.
+         */
+        internal bool Contains(PendingRequest request)
+        {
+            if (request.IsSent)
+            {
+                PendingRequest aSent = null;
+                return _sent.TryGetValue(request.Request.invocation_id, out aSent) && aSent == request;
+            }
+            return _queued.Contains(request);
+        }
+
+        /**
+         * \brief   Removes a request, e.g. because its response arrived.
+         *
+         * \return  true if the request was pending, false if it was removed already.
+         */
+        internal bool Remove(PendingRequest request)
+        {
+            if (request.IsSent)
+            {
+                PendingRequest aSent = null;
+                if (!_sent.TryGetValue(request.Request.invocation_id, out aSent) || aSent != request)
+                {
+                    return false;
+                }
+                return _sent.Remove(request.Request.invocation_id);
+            }
+            return _queued.Remove(request);
+        }
+
+        /**
+         * \brief   Removes all requests, e.g. because the connection was closed.
+         *
+         * \return  The removed requests.
+         */
+        internal List<PendingRequest> RemoveAll()
+        {
+            var aRequests = new List<PendingRequest>(_sent.Values);
+            aRequests.AddRange(_queued);
+            _sent.Clear();
+            _queued.Clear();
+            return aRequests;
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,158 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.Text;
+using RTextNppPlugin.RText.Protocol;
+
+namespace RTextNppPlugin.RText
+{
+    /**
+     * \brief   Caches the responses of the back-end to link target and context info requests.
+     *
+     *          A response is found by the command, the file and the context of the request, i.e. the lines up to the token
+     *          and its column. The back-end answers from the saved model, so a response stays valid until a workspace file
+     *          is saved or the model is reloaded; Invalidate then drops all responses and starts a new version. At most a
+     *          fixed number of responses are kept, the least recently used one is evicted first.
+     */
+    internal sealed class ResponseCache
+    {
+        #region [Data Members]
+        private readonly int _capacity                                                                      = 0;                    //!< Maximum number of cached responses.
+        private readonly Dictionary<string, LinkedListNode<KeyValuePair<string, IResponseBase>>> _entries  = null;                 //!< Cached responses by key.
+        private readonly LinkedList<KeyValuePair<string, IResponseBase>> _recentlyUsed                     = null;                 //!< Cached responses, most recently used first.
+        private readonly object _lock                                                                       = new object();         //!< Guards the cache, it is invalidated from file watcher threads.
+        private int _version                                                                                = 0;                    //!< Incremented whenever the cache is invalidated.
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates a cache.
+         *
+         * \param   capacity    The maximum number of cached responses.
+         */
+        internal ResponseCache(int capacity)
+        {
+            _capacity     = capacity;
+            _entries      = new Dictionary<string, LinkedListNode<KeyValuePair<string, IResponseBase>>>(capacity, StringComparer.Ordinal);
+            _recentlyUsed = new LinkedList<KeyValuePair<string, IResponseBase>>();
+        }
+
+        /**
+         * \brief   Gets the number of cached responses.
+         */
+        internal int Count
+        {
+            get
+            {
+                lock (_lock)
+                {
+                    return _entries.Count;
+                }
+            }
+        }
+
+        /**
+         * \brief   Gets the version of the cache. Read it before a request is sent and pass it to Add, so that a response
+         *          which was outdated while it was received isn't cached.
+         */
+        internal int Version
+        {
+            get
+            {
+                lock (_lock)
+                {
+                    return _version;
+                }
+            }
+        }
+
+        /**
+         * \brief   Looks up the response to a request.
+         *
+         * \param   file        The file the request was issued in.
+         * \param   request     The request.
+         * \param   response    The cached response, null if there is none.
+         *
+         * \return  true if the response was cached.
+         */
+        internal bool TryGet(string file, AutoCompleteAndReferenceRequest request, out IResponseBase response)
+        {
+            string aKey = GetKey(file, request);
+            lock (_lock)
+            {
+                LinkedListNode<KeyValuePair<string, IResponseBase>> aNode = null;
+                if (!_entries.TryGetValue(aKey, out aNode))
+                {
+                    response = null;
+                    return false;
+                }
+                _recentlyUsed.Remove(aNode);
+                _recentlyUsed.AddFirst(aNode);
+                response = aNode.Value.Value;
+                return true;
+            }
+        }
+
+        /**
+         * \brief   Caches the response to a request.
+         *
+         * \param   file        The file the request was issued in.
+         * \param   request     The request.
+         * \param   version     The version of the cache when the request was sent.
+         * \param   response    The response, it mustn't be modified afterwards.
+         */
+        internal void Add(string file, AutoCompleteAndReferenceRequest request, int version, IResponseBase response)
+        {
+            string aKey = GetKey(file, request);
+            lock (_lock)
+            {
+                if (version != _version)
+                {
+                    return;
+                }
+                LinkedListNode<KeyValuePair<string, IResponseBase>> aNode = null;
+                if (_entries.TryGetValue(aKey, out aNode))
+                {
+                    _recentlyUsed.Remove(aNode);
+                }
+                else if (_entries.Count == _capacity)
+                {
+                    _entries.Remove(_recentlyUsed.Last.Value.Key);
+                    _recentlyUsed.RemoveLast();
+                }
+                aNode          = _recentlyUsed.AddFirst(new KeyValuePair<string, IResponseBase>(aKey, response));
+                _entries[aKey] = aNode;
+            }
+        }
+
+        /**
+         * \brief   Drops all responses, e.g. because a workspace file was saved or the model was reloaded.
+         */
+        internal void Invalidate()
+        {
+            lock (_lock)
+            {
+                ++_version;
+                _entries.Clear();
+                _recentlyUsed.Clear();
+            }
+        }
+        #endregion
+
+        #region [Helpers]
+        private static string GetKey(string file, AutoCompleteAndReferenceRequest request)
+        {
+            var aKey = new StringBuilder(256);
+            aKey.Append(request.command).Append('\0').Append(file).Append('\0').Append(request.column.ToString(CultureInfo.InvariantCulture));
+            if (request.context != null)
+            {
+                foreach (var aLine in request.context)
+                {
+                    aKey.Append('\0').Append(aLine);
+                }
+            }
+            return aKey.ToString();
+        }
+        #endregion
+    }
+}
@@ -1,21 +1,19 @@
 ﻿using System;
 using System.Net.Sockets;
-using System.Text;
 namespace RTextNppPlugin.RText
 {
     public class SocketConnection
     {
         #region [Data Members]
-        private byte[] mBuffer                 = new byte[Constants.BUFFER_SIZE];
-        private StringBuilder mReceivedMessage = new StringBuilder(Constants.BUFFER_SIZE);
-        private Socket mSocket                 = new Socket(AddressFamily.InterNetwork, SocketType.Stream, ProtocolType.Tcp);
+        private readonly FrameDecoder mFrames = new FrameDecoder(Constants.BUFFER_SIZE);
+        private Socket mSocket                = new Socket(AddressFamily.InterNetwork, SocketType.Stream, ProtocolType.Tcp);
         #endregion
         
         #region [Interface]
-        public StringBuilder ReceivedMessage { get { return mReceivedMessage; } set { mReceivedMessage = value; } }
-        public bool LengthMatched { get; set; }
-        public int RequiredLength { get; set; }
-        public int JSONLength { get; set; }
+        /**
+         * \brief   Gets the decoder holding the received bytes. Received messages are read from it.
+         */
+        internal FrameDecoder Frames { get { return mFrames; } }
         public int BytesToRead { get; private set; }
         /**
          * \brief   Sends a request synchronously.
@@ -48,17 +46,17 @@ namespace RTextNppPlugin.RText
                 mSocket.Dispose();
             }
             mSocket = new Socket(AddressFamily.InterNetwork, SocketType.Stream, ProtocolType.Tcp);
+            mFrames.Reset();
         }
         /**
-         * \brief   Ends asynchronous receiving.
+         * \brief   Ends asynchronous receiving. The received bytes are added to Frames.
          *
          * \param   asyncResult The asynchronous result.
-         *
-         * \return  An int.
          */
         public void EndReceive(IAsyncResult asyncResult)
         {
             BytesToRead = mSocket.EndReceive(asyncResult);
+            mFrames.Commit(BytesToRead);
         }
         /**
          * \brief   Begins socket connection.
@@ -74,23 +72,16 @@ namespace RTextNppPlugin.RText
             return mSocket.BeginConnect(host, port, requestCallback, this);
         }
         /**
-         * \brief   Begins asynchronous receiving.
+         * \brief   Begins asynchronous receiving straight into the buffer of Frames.
          *
-         * \param   buffer      The buffer.
-         * \param   offset      The offset.
-         * \param   size        The size.
-         * \param   socketFlags The socket flags.
          * \param   callback    The callback.
          *
          * \return  An IAsyncResult.
          */
         public IAsyncResult BeginReceive(AsyncCallback callback)
         {
-            return mSocket.BeginReceive(mBuffer, 0, Constants.BUFFER_SIZE, SocketFlags.None, callback, this);
-        }
-        public void Append()
-        {
-            mReceivedMessage.Append(Encoding.ASCII.GetString(mBuffer, 0, BytesToRead));
+            var aBuffer = mFrames.GetWriteBuffer(Constants.BUFFER_SIZE);
+            return mSocket.BeginReceive(aBuffer.Array, aBuffer.Offset, aBuffer.Count, SocketFlags.None, callback, this);
         }
         #endregion
         internal void EndConnect(IAsyncResult ar)
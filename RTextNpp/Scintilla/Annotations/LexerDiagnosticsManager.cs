@@ -0,0 +1,196 @@
+﻿using RTextNppPlugin.DllExport;
+using RTextNppPlugin.Utilities;
+using RTextNppPlugin.Utilities.Settings;
+using System;
+using System.Collections.Generic;
+using System.Drawing;
+using System.Linq;
+
+namespace RTextNppPlugin.Scintilla.Annotations
+{
+    /**
+     * \brief   Displays the local syntax diagnostics of the RText lexer as squiggle lines.
+     *          Unlike the IndicatorManager these do not depend on the backend. They are updated on UI updates of
+     *          scintilla which follow a change of the content or the lexing of more text, and only from the first
+     *          diagnostic which changed onwards. Caret moves and scrolling over styled text leave them alone.
+     */
+    internal sealed class LexerDiagnosticsManager : IDisposable
+    {
+        #region [Data Members]
+        private const Settings.RTextNppSettings SETTING = Settings.RTextNppSettings.EnableErrorSquiggleLines;
+        private const int INDICATOR_INDEX               = 9;     //!< Indicator index for local syntax diagnostics, backend errors use 8.
+        private readonly ISettings _settings            = null;
+        private readonly INpp _nppHelper                = null;
+        private readonly Plugin _plugin                 = null;
+        private bool _areDiagnosticsEnabled             = false;
+        private bool _isRTextFileMain                   = false; //!< Whether the main scintilla shows an RText file, i.e. a document lexed by the RText lexer.
+        private bool _isRTextFileSub                    = false; //!< Whether the secondary scintilla shows an RText file.
+        private bool _disposed                          = false;
+        private PlacedDiagnostics _placedMain           = null;  //!< Diagnostics currently displayed in the main scintilla.
+        private PlacedDiagnostics _placedSub            = null;  //!< Diagnostics currently displayed in the secondary scintilla.
+
+        private class PlacedDiagnostics
+        {
+            public IList<LexerDiagnostic> Diagnostics { get; set; }
+            public int EndStyled { get; set; }  //!< Position up to which the document was styled, i.e. lexed.
+        }
+        #endregion
+
+        #region [Interface]
+        internal LexerDiagnosticsManager(ISettings settings, INpp nppHelper, Plugin plugin)
+        {
+            _settings                  = settings;
+            _nppHelper                 = nppHelper;
+            _plugin                    = plugin;
+            _areDiagnosticsEnabled     = _settings.Get<bool>(SETTING);
+            _settings.OnSettingChanged += OnSettingChanged;
+            _plugin.ScintillaUiUpdated += OnScintillaUiUpdated;
+            _plugin.BufferActivated    += OnBufferActivated;
+        }
+
+        public void Dispose()
+        {
+            if (!_disposed)
+            {
+                _settings.OnSettingChanged -= OnSettingChanged;
+                _plugin.ScintillaUiUpdated -= OnScintillaUiUpdated;
+                _plugin.BufferActivated    -= OnBufferActivated;
+                _disposed                  = true;
+            }
+        }
+        #endregion
+
+        #region [Event Handlers]
+        void OnSettingChanged(object source, Utilities.Settings.Settings.SettingChangedEventArgs e)
+        {
+            if (e.Setting == SETTING)
+            {
+                _areDiagnosticsEnabled = _settings.Get<bool>(SETTING);
+                Update(_nppHelper.MainScintilla);
+                Update(_nppHelper.SecondaryScintilla);
+            }
+        }
+
+        void OnScintillaUiUpdated(SCNotification notification)
+        {
+            var aSciPtr = notification.nmhdr.hwndFrom;
+            var aPlaced = GetPlaced(aSciPtr);
+            if ((notification.updated & (int)SciMsg.SC_UPDATE_CONTENT) != 0 || aPlaced == null || aPlaced.EndStyled != GetEndStyled(aSciPtr))
+            {
+                Update(aSciPtr);
+            }
+        }
+
+        void OnBufferActivated(object source, string file, View view)
+        {
+            //new document, new diagnostics
+            var aSciPtr       = _nppHelper.ScintillaFromView(view);
+            bool aIsRTextFile = FileUtilities.IsRTextFile(file, _settings, _nppHelper);
+            if (aSciPtr == _nppHelper.MainScintilla)
+            {
+                _isRTextFileMain = aIsRTextFile;
+            }
+            else
+            {
+                _isRTextFileSub = aIsRTextFile;
+            }
+            SetPlaced(aSciPtr, null);
+            _nppHelper.ClearAllIndicators(aSciPtr, INDICATOR_INDEX);
+            Update(aSciPtr);
+        }
+        #endregion
+
+        #region [Helpers]
+        private void Update(IntPtr sciPtr)
+        {
+            var aPlaced       = GetPlaced(sciPtr);
+            bool aIsRTextFile = (sciPtr == _nppHelper.MainScintilla) ? _isRTextFileMain : _isRTextFileSub;
+            if (!_areDiagnosticsEnabled || !aIsRTextFile)
+            {
+                if (aPlaced != null)
+                {
+                    _nppHelper.ClearAllIndicators(sciPtr, INDICATOR_INDEX);
+                    SetPlaced(sciPtr, null);
+                }
+                return;
+            }
+            var aCurrent = new PlacedDiagnostics
+            {
+                Diagnostics = _nppHelper.GetLexerDiagnostics(sciPtr),
+                EndStyled   = GetEndStyled(sciPtr)
+            };
+            SetPlaced(sciPtr, aCurrent);
+            int aChangedFrom = (aPlaced != null) ? FindFirstChange(aPlaced.Diagnostics, aCurrent.Diagnostics) : 0;
+            if (aChangedFrom == Int32.MaxValue)
+            {
+                //nothing changed since last update
+                return;
+            }
+            //scintilla moves the indicators placed so far along with edits, so those before the first change are still right
+            int aLength = _nppHelper.SendMessage(sciPtr, SciMsg.SCI_GETLENGTH).ToInt32();
+            if (aChangedFrom < aLength)
+            {
+                _nppHelper.ClearIndicator(sciPtr, INDICATOR_INDEX, aChangedFrom, aLength - aChangedFrom);
+            }
+            if (!aCurrent.Diagnostics.Any(x => x.Position + Math.Max(1, x.Length) > aChangedFrom))
+            {
+                return;
+            }
+            _nppHelper.SetIndicatorStyle(sciPtr, INDICATOR_INDEX, SciMsg.INDIC_SQUIGGLE, Color.OrangeRed);
+            _nppHelper.SetCurrentIndicator(sciPtr, INDICATOR_INDEX);
+            foreach (var d in aCurrent.Diagnostics.Where(x => x.Position + Math.Max(1, x.Length) > aChangedFrom))
+            {
+                _nppHelper.PlaceIndicator(sciPtr, d.Position, Math.Max(1, d.Length));
+            }
+        }
+
+        /**
+         * \brief   Finds the position from which two lists of diagnostics, both ordered by position, differ.
+         *
+         * \return  The position, Int32.MaxValue if the lists are equal.
+         */
+        private static int FindFirstChange(IList<LexerDiagnostic> placed, IList<LexerDiagnostic> current)
+        {
+            int aCount = Math.Min(placed.Count, current.Count);
+            for (int i = 0; i < aCount; ++i)
+            {
+                if (!placed[i].Equals(current[i]))
+                {
+                    return Math.Min(placed[i].Position, current[i].Position);
+                }
+            }
+            if (placed.Count > aCount)
+            {
+                return placed[aCount].Position;
+            }
+            if (current.Count > aCount)
+            {
+                return current[aCount].Position;
+            }
+            return Int32.MaxValue;
+        }
+
+        private int GetEndStyled(IntPtr sciPtr)
+        {
+            return _nppHelper.SendMessage(sciPtr, SciMsg.SCI_GETENDSTYLED).ToInt32();
+        }
+
+        private PlacedDiagnostics GetPlaced(IntPtr sciPtr)
+        {
+            return (sciPtr == _nppHelper.MainScintilla) ? _placedMain : _placedSub;
+        }
+
+        private void SetPlaced(IntPtr sciPtr, PlacedDiagnostics placed)
+        {
+            if (sciPtr == _nppHelper.MainScintilla)
+            {
+                _placedMain = placed;
+            }
+            else
+            {
+                _placedSub = placed;
+            }
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,32 @@
+﻿using System;
+
+namespace RTextNppPlugin.Scintilla
+{
+    /**
+     * \brief   Brace matching on the structural brackets which the RText lexer indexes, i.e. brackets inside strings,
+     *          comments and templates are skipped.
+     */
+    internal static class BracketNavigation
+    {
+        /**
+         * \brief   Finds the position to go to from the caret. Like the brace matching of notepad++ a bracket before the
+         *          caret takes precedence over a bracket after it. If the caret is not next to a matched bracket, the
+         *          innermost opening bracket enclosing the caret is the target.
+         *
+         * \param   position        The caret position.
+         * \param   findMatching    Finds the bracket matching the bracket at a position, see INpp.FindMatchingBracket.
+         * \param   findEnclosing   Finds the opening bracket enclosing a position, see INpp.FindEnclosingBracket.
+         *
+         * \return  The position of the target bracket, -1 if the caret is at top level.
+         */
+        internal static int FindTarget(int position, Func<int, int> findMatching, Func<int, int> findEnclosing)
+        {
+            int aTarget = (position > 0) ? findMatching(position - 1) : -1;
+            if (aTarget < 0)
+            {
+                aTarget = findMatching(position);
+            }
+            return (aTarget < 0) ? findEnclosing(position) : aTarget;
+        }
+    }
+}
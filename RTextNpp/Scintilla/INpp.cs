@@ -219,6 +219,120 @@ namespace RTextNppPlugin.Scintilla
 
         int IndicatorEnd(IntPtr sciPtr, int indicator, int testPosition);
 
+        #region [Lexer]
+
+        /**
+         * \brief   Gets the local syntax diagnostics which the RText lexer collected for the document of the given scintilla.
+         *
+         * \param   sciPtr  The scintilla handle. The document must be lexed by the RText lexer.
+         *
+         * \return  The diagnostics ordered by position.
+         */
+        IList<LexerDiagnostic> GetLexerDiagnostics(IntPtr sciPtr);
+
+        /**
+         * \brief   Gets the number of nodes of the syntax tree which the RText lexer built for the document of the given scintilla.
+         *
+         * \param   sciPtr  The scintilla handle. The document must be lexed by the RText lexer.
+         */
+        int GetSyntaxNodeCount(IntPtr sciPtr);
+
+        /**
+         * \brief   Gets a range of syntax tree nodes.
+         *
+         * \param   sciPtr  The scintilla handle. The document must be lexed by the RText lexer.
+         * \param   first   Index of the first node.
+         * \param   count   The number of nodes.
+         *
+         * \return  The nodes, in preorder.
+         */
+        IList<SyntaxNode> GetSyntaxNodes(IntPtr sciPtr, int first, int count);
+
+        /**
+         * \brief   Finds the innermost syntax tree node containing a position.
+         *
+         * \param   sciPtr      The scintilla handle. The document must be lexed by the RText lexer.
+         * \param   position    The document position.
+         *
+         * \return  The index of the node, -1 if the document has no syntax tree.
+         */
+        int FindSyntaxNode(IntPtr sciPtr, int position);
+
+        /**
+         * \brief   Finds the top level syntax tree node, i.e. a child of the document node, which starts last at or before a position.
+         *
+         * \param   sciPtr      The scintilla handle. The document must be lexed by the RText lexer.
+         * \param   position    The document position.
+         *
+         * \return  The index of the node, -1 if there is none.
+         */
+        int FindTopLevelSyntaxNode(IntPtr sciPtr, int position);
+
+        /**
+         * \brief   Styles the document till a position, unless scintilla styled it already. Scintilla styles lazily, i.e.
+         *          only what has been shown, so the syntax tree, the outline and the bracket index of the RText lexer
+         *          cover the styled part of the document only.
+         *
+         * \param   sciPtr      The scintilla handle.
+         * \param   position    The document position.
+         */
+        void EnsureStyled(IntPtr sciPtr, int position);
+
+        /**
+         * \brief   Gets the position from which on the text is needed to extract the context of a position, i.e. the start of
+         *          the line of the top level element containing or preceding it. The document is styled till position, so
+         *          that the syntax tree covers it.
+         *
+         * \param   sciPtr      The scintilla handle. The document must be lexed by the RText lexer.
+         * \param   position    The document position.
+         *
+         * \return  The start position, 0 if position doesn't follow any top level element.
+         */
+        int GetContextStart(IntPtr sciPtr, int position);
+
+        /**
+         * \brief   Gets the element outline which the RText lexer built for the document of the given scintilla.
+         *          The outline is maintained while lexing, so it is available without the backend. It only holds the
+         *          elements of the styled part of the document, see EnsureStyled.
+         *
+         * \param   sciPtr  The scintilla handle. The document must be lexed by the RText lexer.
+         *
+         * \return  The outline entries in document order.
+         */
+        IList<OutlineEntry> GetOutline(IntPtr sciPtr);
+
+        /**
+         * \brief   Finds the outline entry of the innermost element containing a position.
+         *
+         * \param   sciPtr      The scintilla handle. The document must be lexed by the RText lexer.
+         * \param   position    The document position.
+         *
+         * \return  The index of the entry, -1 if the position is not inside any element.
+         */
+        int FindOutlineEntry(IntPtr sciPtr, int position);
+
+        /**
+         * \brief   Finds the bracket matching a structural bracket, i.e. a bracket outside of strings, comments and templates.
+         *
+         * \param   sciPtr      The scintilla handle. The document must be lexed by the RText lexer.
+         * \param   position    The position of a bracket.
+         *
+         * \return  The position of the matching bracket, -1 if there is no structural bracket at position or it is unmatched.
+         */
+        int FindMatchingBracket(IntPtr sciPtr, int position);
+
+        /**
+         * \brief   Finds the innermost structural opening bracket enclosing a position.
+         *
+         * \param   sciPtr      The scintilla handle. The document must be lexed by the RText lexer.
+         * \param   position    The document position.
+         *
+         * \return  The position of the opening bracket, -1 if position is at top level.
+         */
+        int FindEnclosingBracket(IntPtr sciPtr, int position);
+
+        #endregion
+
         #region [Markers]
 
         void DeleteMarkers(IntPtr sciPtr, int markerNumber);
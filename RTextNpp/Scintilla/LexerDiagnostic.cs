@@ -0,0 +1,29 @@
+﻿using System.Runtime.InteropServices;
+
+namespace RTextNppPlugin.Scintilla
+{
+    /**
+     * \brief   Kinds of local syntax problems detected by the RText lexer.
+     *
+     * \remarks Must be kept in sync with RText::DiagnosticKind.
+     */
+    internal enum LexerDiagnosticKind : int
+    {
+        InvalidCharacter,
+        UnterminatedString,
+        UnterminatedTemplate,
+        UnmatchedBracket,
+        UnclosedBracket
+    }
+
+    /**
+     * \brief   A local syntax diagnostic as reported by the RText lexer. Layout matches RText::Diagnostic.
+     */
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct LexerDiagnostic
+    {
+        public int Position;                //!< Document position of the first offending character.
+        public int Length;                  //!< Length of the offending range.
+        public LexerDiagnosticKind Kind;    //!< The kind of the diagnostic.
+    }
+}
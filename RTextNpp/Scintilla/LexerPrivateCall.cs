@@ -0,0 +1,22 @@
+﻿namespace RTextNppPlugin.Scintilla
+{
+    /**
+     * \brief   Operations supported by the RText lexer through SCI_PRIVATELEXERCALL.
+     *
+     * \remarks Must be kept in sync with RText::RTextLexer::PrivateCallOperation.
+     */
+    internal enum LexerPrivateCall : int
+    {
+        GetDiagnosticsCount    = 0,    //!< Returns the number of local syntax diagnostics of the document.
+        GetDiagnostics         = 1,    //!< Copies the local syntax diagnostics to a caller supplied buffer.
+        GetSyntaxNodeCount     = 2,    //!< Returns the number of syntax tree nodes.
+        GetSyntaxNodes         = 3,    //!< Copies a range of syntax tree nodes, described by a SyntaxNodeRange, to a caller supplied buffer.
+        FindSyntaxNode         = 4,    //!< Returns the index of the innermost syntax tree node containing a position.
+        GetOutlineCount        = 5,    //!< Returns the number of elements in the document outline.
+        GetOutline             = 6,    //!< Copies a range of outline entries, described by an OutlineRange, to a caller supplied buffer.
+        FindOutlineEntry       = 7,    //!< Returns the index of the outline entry of the innermost element containing a position.
+        FindMatchingBracket    = 8,    //!< Returns the position of the bracket matching the bracket at a position.
+        FindEnclosingBracket   = 9,    //!< Returns the position of the innermost opening bracket enclosing a position.
+        FindTopLevelSyntaxNode = 10    //!< Returns the index of the top level syntax tree node starting last at or before a position.
+    }
+}
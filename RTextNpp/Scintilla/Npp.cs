@@ -395,6 +395,117 @@ namespace RTextNppPlugin.Scintilla
             //return _directFunction(aNativePtr, (int)SciMsg.SCI_INDICATOREND, new IntPtr(indicator), new IntPtr(testPosition)).ToInt32();
             return SendMessage(sciPtr, SciMsg.SCI_INDICATOREND, new IntPtr(indicator), new IntPtr(testPosition)).ToInt32();
         }
+
+        public unsafe IList<LexerDiagnostic> GetLexerDiagnostics(IntPtr sciPtr)
+        {
+            int aCount = SendMessage(sciPtr, SciMsg.SCI_PRIVATELEXERCALL, new IntPtr((int)LexerPrivateCall.GetDiagnosticsCount)).ToInt32();
+            if (aCount <= 0)
+            {
+                return new LexerDiagnostic[0];
+            }
+            var aDiagnostics = new LexerDiagnostic[aCount];
+            fixed (LexerDiagnostic* ptr = aDiagnostics)
+            {
+                aCount = SendMessage(sciPtr, SciMsg.SCI_PRIVATELEXERCALL, new IntPtr((int)LexerPrivateCall.GetDiagnostics), new IntPtr(ptr)).ToInt32();
+            }
+            if (aCount < aDiagnostics.Length)
+            {
+                Array.Resize(ref aDiagnostics, aCount);
+            }
+            return aDiagnostics;
+        }
+
+        public int GetSyntaxNodeCount(IntPtr sciPtr)
+        {
+            return SendMessage(sciPtr, SciMsg.SCI_PRIVATELEXERCALL, new IntPtr((int)LexerPrivateCall.GetSyntaxNodeCount)).ToInt32();
+        }
+
+        public unsafe IList<SyntaxNode> GetSyntaxNodes(IntPtr sciPtr, int first, int count)
+        {
+            if (count <= 0)
+            {
+                return new SyntaxNode[0];
+            }
+            var aNodes = new SyntaxNode[count];
+            int aCount = 0;
+            fixed (SyntaxNode* ptr = aNodes)
+            {
+                var aRange = new SyntaxNodeRange { First = first, Count = count, Buffer = new IntPtr(ptr) };
+                aCount = SendMessage(sciPtr, SciMsg.SCI_PRIVATELEXERCALL, new IntPtr((int)LexerPrivateCall.GetSyntaxNodes), new IntPtr(&aRange)).ToInt32();
+            }
+            if (aCount < aNodes.Length)
+            {
+                Array.Resize(ref aNodes, aCount);
+            }
+            return aNodes;
+        }
+
+        public int FindSyntaxNode(IntPtr sciPtr, int position)
+        {
+            return SendMessage(sciPtr, SciMsg.SCI_PRIVATELEXERCALL, new IntPtr((int)LexerPrivateCall.FindSyntaxNode), new IntPtr(position)).ToInt32();
+        }
+
+        public int FindTopLevelSyntaxNode(IntPtr sciPtr, int position)
+        {
+            return SendMessage(sciPtr, SciMsg.SCI_PRIVATELEXERCALL, new IntPtr((int)LexerPrivateCall.FindTopLevelSyntaxNode), new IntPtr(position)).ToInt32();
+        }
+
+        public void EnsureStyled(IntPtr sciPtr, int position)
+        {
+            int aEndStyled = SendMessage(sciPtr, SciMsg.SCI_GETENDSTYLED).ToInt32();
+            if (aEndStyled < position)
+            {
+                SendMessage(sciPtr, SciMsg.SCI_COLOURISE, new IntPtr(aEndStyled), new IntPtr(position));
+            }
+        }
+
+        public int GetContextStart(IntPtr sciPtr, int position)
+        {
+            EnsureStyled(sciPtr, position);
+            //text before the top level element holds complete elements only, which don't contribute to the context
+            int aNode = FindTopLevelSyntaxNode(sciPtr, position);
+            if (aNode <= 0)
+            {
+                return 0;
+            }
+            var aNodes = GetSyntaxNodes(sciPtr, aNode, 1);
+            return (aNodes.Count == 1) ? GetLineStart(GetLineNumber(aNodes[0].Position, sciPtr), sciPtr) : 0;
+        }
+
+        public unsafe IList<OutlineEntry> GetOutline(IntPtr sciPtr)
+        {
+            int aCount = SendMessage(sciPtr, SciMsg.SCI_PRIVATELEXERCALL, new IntPtr((int)LexerPrivateCall.GetOutlineCount)).ToInt32();
+            if (aCount <= 0)
+            {
+                return new OutlineEntry[0];
+            }
+            var aEntries = new OutlineEntry[aCount];
+            fixed (OutlineEntry* ptr = aEntries)
+            {
+                var aRange = new OutlineRange { First = 0, Count = aCount, Buffer = new IntPtr(ptr) };
+                aCount = SendMessage(sciPtr, SciMsg.SCI_PRIVATELEXERCALL, new IntPtr((int)LexerPrivateCall.GetOutline), new IntPtr(&aRange)).ToInt32();
+            }
+            if (aCount < aEntries.Length)
+            {
+                Array.Resize(ref aEntries, aCount);
+            }
+            return aEntries;
+        }
+
+        public int FindOutlineEntry(IntPtr sciPtr, int position)
+        {
+            return SendMessage(sciPtr, SciMsg.SCI_PRIVATELEXERCALL, new IntPtr((int)LexerPrivateCall.FindOutlineEntry), new IntPtr(position)).ToInt32();
+        }
+
+        public int FindMatchingBracket(IntPtr sciPtr, int position)
+        {
+            return SendMessage(sciPtr, SciMsg.SCI_PRIVATELEXERCALL, new IntPtr((int)LexerPrivateCall.FindMatchingBracket), new IntPtr(position)).ToInt32();
+        }
+
+        public int FindEnclosingBracket(IntPtr sciPtr, int position)
+        {
+            return SendMessage(sciPtr, SciMsg.SCI_PRIVATELEXERCALL, new IntPtr((int)LexerPrivateCall.FindEnclosingBracket), new IntPtr(position)).ToInt32();
+        }
         
         public unsafe string GetLine(int line, IntPtr sciPtr)
         {
@@ -0,0 +1,41 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace RTextNppPlugin.Scintilla
+{
+    /**
+     * \brief   An element of the document outline built by the RText lexer. Layout matches RText::OutlineEntry.
+     */
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct OutlineEntry
+    {
+        public int Position;        //!< Document position of the element, i.e. of its command.
+        public int Length;          //!< Length of the element including its child block, -1 if the element is not closed yet.
+        public int CommandLength;   //!< Length of the command.
+        public int NamePosition;    //!< Document position of the element name, -1 if the element has no name.
+        public int NameLength;      //!< Length of the element name, including quotes for quoted names.
+        public int Line;            //!< Zero based line of the element.
+        public int Depth;           //!< Nesting depth, 0 for top level elements.
+        public int Parent;          //!< Index of the enclosing outline entry, -1 for top level elements.
+        public int Node;            //!< Index of the element in the syntax tree.
+
+        public bool HasName
+        {
+            get
+            {
+                return NamePosition >= 0;
+            }
+        }
+    }
+
+    /**
+     * \brief   Arguments of an outline range query. Layout matches RText::OutlineRange.
+     */
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct OutlineRange
+    {
+        public int First;       //!< Index of the first requested entry.
+        public int Count;       //!< Number of requested entries.
+        public IntPtr Buffer;   //!< Buffer receiving the entries.
+    }
+}
@@ -0,0 +1,58 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+
+namespace RTextNppPlugin.Scintilla
+{
+    /**
+     * \brief   Navigation within the outline which the RText lexer maintains.
+     */
+    internal static class OutlineNavigation
+    {
+        /**
+         * \brief   Finds the element to go to from a caret inside an element. This is the element itself, unless the caret
+         *          is already on the line of the element, in which case it is the enclosing element.
+         *
+         * \param   outline The outline.
+         * \param   entry   The index of the innermost element containing the caret, see INpp.FindOutlineEntry.
+         * \param   line    The zero based line of the caret.
+         *
+         * \return  The index of the entry, -1 if there is none.
+         */
+        internal static int FindEnclosingEntry(IList<OutlineEntry> outline, int entry, int line)
+        {
+            if (entry < 0 || entry >= outline.Count)
+            {
+                return -1;
+            }
+            return (outline[entry].Line == line) ? outline[entry].Parent : entry;
+        }
+
+        /**
+         * \brief   Gets the qualified name of an element, e.g. /P1/UInt8, as it is written by references to the element.
+         *
+         * \param   outline The outline.
+         * \param   entry   The index of the element.
+         * \param   getText Gets the text of the document between two positions.
+         *
+         * \return  The qualified name, null if the element or one of its enclosing elements has no name.
+         */
+        internal static string GetQualifiedName(IList<OutlineEntry> outline, int entry, Func<int, int, string> getText)
+        {
+            if (entry < 0 || entry >= outline.Count)
+            {
+                return null;
+            }
+            var aNames = new Stack<string>();
+            for (; entry >= 0; entry = outline[entry].Parent)
+            {
+                if (!outline[entry].HasName)
+                {
+                    return null;
+                }
+                aNames.Push(getText(outline[entry].NamePosition, outline[entry].NamePosition + outline[entry].NameLength).Trim('"'));
+            }
+            return "/" + String.Join("/", aNames);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace RTextNppPlugin.Scintilla
+{
+    /**
+     * \brief   Kinds of syntax tree nodes built by the RText lexer.
+     *
+     * \remarks Must be kept in sync with RText::SyntaxNodeKind.
+     */
+    internal enum SyntaxNodeKind : int
+    {
+        Document,
+        Element,
+        Command,
+        Name,
+        Feature,
+        Label,
+        Value,
+        Reference,
+        ValueList,
+        ChildRole,
+        ChildRoleList,
+        Error
+    }
+
+    /**
+     * \brief   A node of the syntax tree built by the RText lexer. Layout matches RText::SyntaxNode.
+     *          Nodes are delivered in preorder, the subtree of node i is the index range [i, End).
+     */
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct SyntaxNode
+    {
+        public SyntaxNodeKind Kind; //!< The kind of the node.
+        public int Parent;          //!< Index of the parent node, -1 for the document node.
+        public int Position;        //!< Document position of the first token of the node.
+        public int Length;          //!< Length of the node, -1 if the node is not closed yet.
+        public int End;             //!< Index after the last descendant of the node, -1 if the node is not closed yet.
+
+        public bool IsClosed
+        {
+            get
+            {
+                return Length >= 0;
+            }
+        }
+    }
+
+    /**
+     * \brief   Arguments of a syntax node range query. Layout matches RText::SyntaxNodeRange.
+     */
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct SyntaxNodeRange
+    {
+        public int First;       //!< Index of the first requested node.
+        public int Count;       //!< Number of requested nodes.
+        public IntPtr Buffer;   //!< Buffer receiving the nodes.
+    }
+}
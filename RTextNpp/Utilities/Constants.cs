@@ -30,6 +30,10 @@ namespace RTextNppPlugin
         public const int MAX_CONSUME_PROBLEMS = 100;                            //!< Max number of continuous error tokens than can occur in a single file.
         public const int INITIAL_RESPONSE_TIMEOUT = 20000;                      //!< Compensate for when a pc is under heavy load - the back-end process may take a while to start. 20s timeout.
         public const int OUTPUT_POLL_PERIOD = 10;                               //!< Polling period for output stream threads
+        public const int OUTPUT_DRAIN_PERIOD = 250;                             //!< Period in ms in which the captured back-end output is passed on to the console.
+        public const int OUTPUT_LINES_PER_DRAIN = 200;                          //!< Max number of lines of each back-end stream passed on per drain period, older ones are summarised.
+        public const int OUTPUT_BUFFER_CAPACITY = 4096;                         //!< Max number of captured lines of each back-end stream.
+        public const int MAX_CONSOLE_LINES = 5000;                              //!< Max number of lines kept by each console channel, older ones are removed.
         public const string GENERAL_CHANNEL = "General";                        //!< General output channel.
         public const string DEBUG_CHANNEL = "Debug";                            //!< Debug channel - disabled on release mode.
         public const string NPP_BACKUP_DIR = "\\Notepad++\\backup";             //!< Notepad ++ back up directory.
@@ -119,11 +123,14 @@ namespace RTextNppPlugin
 
         public enum NppMenuCommands : int
         {
-            ConsoleWindow  = 0,
-            Options        = 1,
-            AutoCompletion = 2,
-            Outline        = 3,
-            About          = 4
+            ConsoleWindow   = 0,
+            Options         = 1,
+            AutoCompletion  = 2,
+            Outline         = 3,
+            About           = 4,
+            MatchingBracket = 5,
+            FindUsages      = 6,
+            Dependencies    = 7
         }
         
         #endregion
@@ -141,6 +148,7 @@ namespace RTextNppPlugin
             public const string ERROR              = "unknown_command_error"; //!< Erroneous command.
             public const string REQUEST            = "request";               //!< Request command.
             public const string STOP               = "stop";                  //!< Stops back-end.
+            public const string SET_ENCODING       = "set_encoding";          //!< Switches the encoding of the messages.
         }
        
         #endregion
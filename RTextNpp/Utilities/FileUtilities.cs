@@ -85,6 +85,34 @@ namespace RTextNppPlugin.Utilities
             }
             return String.Empty;
         }
+        /**
+         * \brief   Gets the extensions of the files which the backend of an extension loads, i.e. all extensions of the file
+         *          pattern of the .rtext file which contains the extension, e.g. .atm and .meta for *.atm, *.meta:
+         *
+         * \param   rTextFilePath   Full pathname of the .rtext file.
+         * \param   extension       The extension, e.g. .atm.
+         *
+         * \return  The extensions, only extension itself if the .rtext file can't be read or has no pattern for it.
+         */
+        internal static IList<string> GetWorkspaceExtensions(string rTextFilePath, string extension)
+        {
+            try
+            {
+                foreach (var aLine in File.ReadAllLines(rTextFilePath))
+                {
+                    var aExtensions = FileExtensionRegex.Matches(aLine).Cast<Match>().Select(x => x.Value).ToList();
+                    if (aExtensions.Contains(extension))
+                    {
+                        return aExtensions;
+                    }
+                }
+            }
+            catch (Exception ex)
+            {
+                Logging.Logger.Instance.Append(Logging.Logger.MessageType.Error, Constants.GENERAL_CHANNEL, "FileUtilities.GetWorkspaceExtensions({0}, {1}) - Exception : {2}", rTextFilePath, extension, ex.Message);
+            }
+            return new List<string> { extension };
+        }
         /**
          * \brief   Query if 'settings' is r text file.
          *
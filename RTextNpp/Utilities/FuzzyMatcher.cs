@@ -0,0 +1,348 @@
+﻿using System;
+using System.Collections.Generic;
+
+namespace RTextNppPlugin.Utilities
+{
+    /**
+     * \brief   Ranks a fixed set of candidates, e.g. auto completion options, by how well they match a query.
+     *
+     *          A candidate matches if the query is a subsequence of it, ignoring case. Matches at the start of a word, i.e.
+     *          after '_', '/' or '.' and at camel case humps, and runs of consecutive characters score higher, so "tfe"
+     *          ranks "TheFirstElement" before "transfer".
+     *
+     *          Candidates are packed into a single lower case character buffer. Every candidate also has a 64 bit mask of
+     *          the character classes it contains, so most candidates are rejected by one AND of the masks before their
+     *          characters are looked at.
+     */
+    internal sealed class FuzzyMatcher
+    {
+        #region [Data Members]
+        private const int SCORE_MATCH       = 16;   //!< Score of every matched character.
+        private const int BONUS_BOUNDARY    = 24;   //!< Bonus for a character at the start of a word.
+        private const int BONUS_CONSECUTIVE = 16;   //!< Bonus for a character right after the previous matched character.
+        private const int BONUS_PREFIX      = 32;   //!< Bonus for a match starting at the first character.
+        private const int BONUS_CASE        = 1;    //!< Bonus for a character matching the case of the query.
+        private const int BONUS_EXACT       = 64;   //!< Bonus for a candidate equal to the query ignoring case.
+        private const int MAX_BONUS         = 32;   //!< Upper bound of a per candidate bonus, which therefore never outweighs an exact match.
+        private const int PENALTY_GAP       = 1;    //!< Penalty for every skipped character between two matched characters.
+        private const int MAX_GAP_PENALTY   = 8;    //!< Maximum penalty of a single gap.
+        private const int MAX_STARTS        = 16;   //!< Maximum number of start positions tried for a candidate.
+
+        private readonly string[] _candidates = null;   //!< The candidates as given.
+        private readonly char[] _lower        = null;   //!< Lower case characters of all candidates.
+        private readonly bool[] _boundary     = null;   //!< Whether a character of _lower starts a word.
+        private readonly int[] _offsets       = null;   //!< Start of every candidate in _lower, followed by the end of the last one.
+        private readonly ulong[] _masks       = null;   //!< Character classes of every candidate, see ClassOf.
+
+        private struct Match
+        {
+            internal int Index;
+            internal int Score;
+            internal int Length;
+
+            internal bool IsBetterThan(Match other)
+            {
+                if (Score != other.Score)
+                {
+                    return Score > other.Score;
+                }
+                return (Length != other.Length) ? Length < other.Length : Index < other.Index;
+            }
+        }
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates a matcher for some candidates.
+         *
+         * \param   candidates  The candidates.
+         */
+        internal FuzzyMatcher(IList<string> candidates)
+        {
+            int aLength = 0;
+            foreach (var aCandidate in candidates)
+            {
+                aLength += aCandidate.Length;
+            }
+            _candidates = new string[candidates.Count];
+            _lower      = new char[aLength];
+            _boundary   = new bool[aLength];
+            _offsets    = new int[candidates.Count + 1];
+            _masks      = new ulong[candidates.Count];
+            int aOffset = 0;
+            for (int i = 0; i < candidates.Count; ++i)
+            {
+                string aCandidate = candidates[i];
+                _candidates[i]    = aCandidate;
+                _offsets[i]       = aOffset;
+                for (int j = 0; j < aCandidate.Length; ++j, ++aOffset)
+                {
+                    _lower[aOffset]    = Char.ToLowerInvariant(aCandidate[j]);
+                    _boundary[aOffset] = IsBoundary(aCandidate, j);
+                    _masks[i]         |= ClassOf(_lower[aOffset]);
+                }
+            }
+            _offsets[candidates.Count] = aOffset;
+        }
+
+        /**
+         * \brief   Gets the number of candidates.
+         */
+        internal int Count
+        {
+            get
+            {
+                return _candidates.Length;
+            }
+        }
+
+        /**
+         * \brief   Finds the candidates which match a query best.
+         *
+         * \param   query       The query. An empty query matches all candidates equally.
+         * \param   maxResults  The maximum number of results.
+         *
+         * \return  The indexes of the matching candidates, best match first. Equal scores are ordered by length and index.
+         */
+        internal int[] Rank(string query, int maxResults)
+        {
+            return Rank(query, maxResults, null);
+        }
+
+        /**
+         * \brief   Finds the candidates which match a query best, taking a per candidate bonus into account, e.g. how often a
+         *          candidate was chosen before.
+         *
+         * \param   query       The query. An empty query matches all candidates, which are then ordered by their bonus.
+         * \param   maxResults  The maximum number of results.
+         * \param   bonus       Bonus of every candidate which matches the query, null for none. Bonuses above MAX_BONUS
+         *                      count as MAX_BONUS.
+         *
+         * \return  The indexes of the matching candidates, best match first. Equal scores are ordered by length and index.
+         */
+        internal int[] Rank(string query, int maxResults, int[] bonus)
+        {
+            if (maxResults <= 0)
+            {
+                return new int[0];
+            }
+            if (string.IsNullOrEmpty(query))
+            {
+                var aAll = new int[_candidates.Length];
+                for (int i = 0; i < aAll.Length; ++i)
+                {
+                    aAll[i] = i;
+                }
+                if (bonus != null)
+                {
+                    Array.Sort(aAll, (x, y) =>
+                    {
+                        int aBonusX = Math.Min(bonus[x], MAX_BONUS);
+                        int aBonusY = Math.Min(bonus[y], MAX_BONUS);
+                        return (aBonusX != aBonusY) ? aBonusY.CompareTo(aBonusX) : x.CompareTo(y);
+                    });
+                }
+                if (aAll.Length > maxResults)
+                {
+                    Array.Resize(ref aAll, maxResults);
+                }
+                return aAll;
+            }
+            var aQuery  = query.ToLowerInvariant().ToCharArray();
+            ulong aMask = 0;
+            foreach (var c in aQuery)
+            {
+                aMask |= ClassOf(c);
+            }
+            //min heap of the best matches found so far, its root is the worst of them
+            var aHeap  = new Match[Math.Min(maxResults, _candidates.Length)];
+            int aCount = 0;
+            for (int i = 0; i < _masks.Length; ++i)
+            {
+                if ((_masks[i] & aMask) != aMask || _offsets[i + 1] - _offsets[i] < aQuery.Length)
+                {
+                    continue;
+                }
+                int aScore = Score(i, query, aQuery);
+                if (aScore == Int32.MinValue)
+                {
+                    continue;
+                }
+                if (bonus != null)
+                {
+                    aScore += Math.Min(bonus[i], MAX_BONUS);
+                }
+                var aMatch = new Match { Index = i, Score = aScore, Length = _offsets[i + 1] - _offsets[i] };
+                if (aCount < aHeap.Length)
+                {
+                    aHeap[aCount] = aMatch;
+                    SiftUp(aHeap, aCount++);
+                }
+                else if (aMatch.IsBetterThan(aHeap[0]))
+                {
+                    aHeap[0] = aMatch;
+                    SiftDown(aHeap, aCount, 0);
+                }
+            }
+            var aResult = new int[aCount];
+            while (aCount > 0)
+            {
+                aResult[--aCount] = aHeap[0].Index;
+                aHeap[0]          = aHeap[aCount];
+                SiftDown(aHeap, aCount, 0);
+            }
+            return aResult;
+        }
+        #endregion
+
+        #region [Helpers]
+        private static ulong ClassOf(char lower)
+        {
+            if (lower >= 'a' && lower <= 'z')
+            {
+                return 1UL << (lower - 'a');
+            }
+            if (lower >= '0' && lower <= '9')
+            {
+                return 1UL << (26 + lower - '0');
+            }
+            switch (lower)
+            {
+                case '_':
+                    return 1UL << 36;
+                case '/':
+                    return 1UL << 37;
+                case '.':
+                    return 1UL << 38;
+                default:
+                    return 1UL << (39 + lower % 25);
+            }
+        }
+
+        private static bool IsBoundary(string text, int index)
+        {
+            if (index == 0)
+            {
+                return true;
+            }
+            char aPrevious = text[index - 1];
+            char aCurrent  = text[index];
+            return aPrevious == '_' || aPrevious == '/' || aPrevious == '.' || aPrevious == ' ' || (Char.IsUpper(aCurrent) && !Char.IsUpper(aPrevious)) || (Char.IsDigit(aCurrent) && !Char.IsDigit(aPrevious));
+        }
+
+        /**
+         * \brief   Scores a candidate, trying the first occurrences of the first query character as start of the match.
+         *
+         * \return  The best score, Int32.MinValue if the query is no subsequence of the candidate.
+         */
+        private int Score(int candidate, string query, char[] lowerQuery)
+        {
+            int aStart  = _offsets[candidate];
+            int aEnd    = _offsets[candidate + 1];
+            int aBest   = Int32.MinValue;
+            int aStarts = 0;
+            for (int p = aStart; p <= aEnd - lowerQuery.Length && aStarts < MAX_STARTS; ++p)
+            {
+                if (_lower[p] != lowerQuery[0])
+                {
+                    continue;
+                }
+                ++aStarts;
+                int aScore = ScoreFrom(candidate, p, query, lowerQuery);
+                if (aScore == Int32.MinValue)
+                {
+                    //no match from here, so none from any later start either
+                    break;
+                }
+                aBest = Math.Max(aBest, aScore);
+            }
+            return aBest;
+        }
+
+        private int ScoreFrom(int candidate, int start, string query, char[] lowerQuery)
+        {
+            int aStart    = _offsets[candidate];
+            int aEnd      = _offsets[candidate + 1];
+            string aText  = _candidates[candidate];
+            int aScore    = (start == aStart) ? BONUS_PREFIX : 0;
+            int aPrevious = start - 1;
+            int aPosition = start;
+            for (int k = 0; k < lowerQuery.Length; ++k, ++aPosition)
+            {
+                while (aPosition < aEnd && _lower[aPosition] != lowerQuery[k])
+                {
+                    ++aPosition;
+                }
+                if (aPosition == aEnd)
+                {
+                    return Int32.MinValue;
+                }
+                aScore += SCORE_MATCH;
+                if (_boundary[aPosition])
+                {
+                    aScore += BONUS_BOUNDARY;
+                }
+                if (k > 0 && aPosition == aPrevious + 1)
+                {
+                    aScore += BONUS_CONSECUTIVE;
+                }
+                else if (k > 0)
+                {
+                    aScore -= Math.Min(MAX_GAP_PENALTY, (aPosition - aPrevious - 1) * PENALTY_GAP);
+                }
+                if (aText[aPosition - aStart] == query[k])
+                {
+                    aScore += BONUS_CASE;
+                }
+                aPrevious = aPosition;
+            }
+            return (start == aStart && aEnd - aStart == lowerQuery.Length) ? aScore + BONUS_EXACT : aScore;
+        }
+
+        private static void SiftUp(Match[] heap, int index)
+        {
+            while (index > 0)
+            {
+                int aParent = (index - 1) / 2;
+                if (!heap[aParent].IsBetterThan(heap[index]))
+                {
+                    break;
+                }
+                Swap(heap, aParent, index);
+                index = aParent;
+            }
+        }
+
+        private static void SiftDown(Match[] heap, int count, int index)
+        {
+            while (true)
+            {
+                int aWorst = index;
+                int aLeft  = 2 * index + 1;
+                int aRight = aLeft + 1;
+                if (aLeft < count && heap[aWorst].IsBetterThan(heap[aLeft]))
+                {
+                    aWorst = aLeft;
+                }
+                if (aRight < count && heap[aWorst].IsBetterThan(heap[aRight]))
+                {
+                    aWorst = aRight;
+                }
+                if (aWorst == index)
+                {
+                    return;
+                }
+                Swap(heap, aWorst, index);
+                index = aWorst;
+            }
+        }
+
+        private static void Swap(Match[] heap, int first, int second)
+        {
+            var aMatch   = heap[first];
+            heap[first]  = heap[second];
+            heap[second] = aMatch;
+        }
+        #endregion
+    }
+}
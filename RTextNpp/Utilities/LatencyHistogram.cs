@@ -0,0 +1,182 @@
+﻿using System;
+using System.Threading;
+
+namespace RTextNppPlugin.Utilities
+{
+    /**
+     * \brief   Histogram of latencies in the style of an HDR histogram, which records values from many threads without
+     *          locks.
+     *
+     *          Values are counted in buckets whose width doubles with each power of two, every power of two being split
+     *          into 128 sub buckets. Percentiles are therefore accurate to less than 1% of the value, over the whole range
+     *          from a microsecond to more than an hour, with a fixed memory footprint. Values are usually microseconds,
+     *          but any non negative quantity may be recorded.
+     */
+    internal sealed class LatencyHistogram
+    {
+        #region [Data Members]
+        private const int SUB_BUCKET_BITS  = 7;                                         //!< Each power of two is split into 2^SUB_BUCKET_BITS buckets.
+        private const int SUB_BUCKETS      = 1 << SUB_BUCKET_BITS;
+        private const int MAX_SHIFT        = 26;                                        //!< Values above 2^(MAX_SHIFT + SUB_BUCKET_BITS + 1) are recorded as the highest value.
+        private const long HIGHEST_VALUE   = (1L << (MAX_SHIFT + SUB_BUCKET_BITS + 1)) - 1;
+        private readonly long[] _counts    = new long[2 * SUB_BUCKETS + MAX_SHIFT * SUB_BUCKETS];
+        private long _totalCount           = 0;
+        private long _sum                  = 0;
+        private long _max                  = 0;
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Gets the number of recorded values.
+         */
+        internal long Count { get { return Interlocked.Read(ref _totalCount); } }
+
+        /**
+         * \brief   Gets the highest recorded value.
+         */
+        internal long Max { get { return Interlocked.Read(ref _max); } }
+
+        /**
+         * \brief   Gets the sum of all recorded values, e.g. the bytes transferred.
+         */
+        internal long Sum { get { return Interlocked.Read(ref _sum); } }
+
+        /**
+         * \brief   Gets the mean of the recorded values, 0 if there are none.
+         */
+        internal double Mean
+        {
+            get
+            {
+                long aCount = Count;
+                return (aCount == 0) ? 0.0 : (double)Sum / aCount;
+            }
+        }
+
+        /**
+         * \brief   Records a value. Negative values are recorded as 0.
+         */
+        internal void Record(long value)
+        {
+            value = Math.Max(0, Math.Min(value, HIGHEST_VALUE));
+            Interlocked.Increment(ref _counts[GetIndex(value)]);
+            Interlocked.Add(ref _sum, value);
+            long aMax = Interlocked.Read(ref _max);
+            while (value > aMax)
+            {
+                long aPrevious = Interlocked.CompareExchange(ref _max, value, aMax);
+                if (aPrevious == aMax)
+                {
+                    break;
+                }
+                aMax = aPrevious;
+            }
+            //counted last, so that a reader never sees more values than are in the buckets
+            Interlocked.Increment(ref _totalCount);
+        }
+
+        /**
+         * \brief   Gets the value at a percentile, i.e. the highest value which is equivalent to the recorded value below
+         *          which the given percentage of all values lie.
+         *
+         * \param   percentile  The percentile, between 0 and 100.
+         *
+         * \return  The value, 0 if nothing was recorded.
+         */
+        internal long GetValueAtPercentile(double percentile)
+        {
+            long aCount = Count;
+            if (aCount == 0)
+            {
+                return 0;
+            }
+            long aRank  = Math.Max(1, (long)Math.Ceiling(Math.Min(100.0, Math.Max(0.0, percentile)) / 100.0 * aCount));
+            long aSeen  = 0;
+            for (int i = 0; i < _counts.Length; ++i)
+            {
+                aSeen += Interlocked.Read(ref _counts[i]);
+                if (aSeen >= aRank)
+                {
+                    return Math.Min(GetHighestEquivalentValue(i), Max);
+                }
+            }
+            return Max;
+        }
+
+        /**
+         * \brief   Adds the values recorded by another histogram, e.g. to summarize several commands.
+         */
+        internal void Add(LatencyHistogram other)
+        {
+            for (int i = 0; i < _counts.Length; ++i)
+            {
+                long aCount = Interlocked.Read(ref other._counts[i]);
+                if (aCount != 0)
+                {
+                    Interlocked.Add(ref _counts[i], aCount);
+                }
+            }
+            Interlocked.Add(ref _sum, other.Sum);
+            long aOtherMax = other.Max;
+            long aMax      = Interlocked.Read(ref _max);
+            while (aOtherMax > aMax)
+            {
+                long aPrevious = Interlocked.CompareExchange(ref _max, aOtherMax, aMax);
+                if (aPrevious == aMax)
+                {
+                    break;
+                }
+                aMax = aPrevious;
+            }
+            Interlocked.Add(ref _totalCount, other.Count);
+        }
+
+        /**
+         * \brief   Removes all recorded values. Values recorded at the same time may be partially lost.
+         */
+        internal void Reset()
+        {
+            Interlocked.Exchange(ref _totalCount, 0);
+            for (int i = 0; i < _counts.Length; ++i)
+            {
+                Interlocked.Exchange(ref _counts[i], 0);
+            }
+            Interlocked.Exchange(ref _sum, 0);
+            Interlocked.Exchange(ref _max, 0);
+        }
+        #endregion
+
+        #region [Helpers]
+        private static int GetIndex(long value)
+        {
+            if (value < 2 * SUB_BUCKETS)
+            {
+                return (int)value;
+            }
+            int aShift = HighestBit(value) - SUB_BUCKET_BITS;
+            return SUB_BUCKETS + aShift * SUB_BUCKETS + (int)(value >> aShift) - SUB_BUCKETS;
+        }
+
+        private static long GetHighestEquivalentValue(int index)
+        {
+            if (index < 2 * SUB_BUCKETS)
+            {
+                return index;
+            }
+            int aShift  = (index - SUB_BUCKETS) / SUB_BUCKETS;
+            long aTop   = (index - SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+            return ((aTop + 1) << aShift) - 1;
+        }
+
+        private static int HighestBit(long value)
+        {
+            int aBit = 0;
+            while ((value >>= 1) != 0)
+            {
+                ++aBit;
+            }
+            return aBit;
+        }
+        #endregion
+    }
+}
@@ -0,0 +1,128 @@
+﻿using System;
+using System.Threading;
+
+namespace RTextNppPlugin.Utilities.Threading
+{
+    /**
+     * \brief   Bounded ring buffer for one producer and one consumer thread, which doesn't lock.
+     *
+     *          When the buffer is full the producer overwrites the oldest item, so the buffer always holds the most recent
+     *          items and a producer which outpaces its consumer is never blocked. Overwritten items are counted, so that
+     *          the consumer can tell how many it missed. The consumer claims an item by advancing the head with a compare
+     *          and exchange; if the producer advanced it first, the item is dropped and the next one is tried.
+     */
+    internal sealed class RingBuffer<T> where T : class
+    {
+        #region [Data Members]
+        private readonly T[] _slots     = null;
+        private long _head              = 0;    //!< Index of the oldest item, advanced by the consumer and by an overwriting producer.
+        private long _tail              = 0;    //!< Index of the next item to be written, advanced by the producer only.
+        private long _overwritten       = 0;    //!< Number of items overwritten since it was last taken.
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates an empty buffer.
+         *
+         * \param   capacity    The maximum number of items held.
+         */
+        internal RingBuffer(int capacity)
+        {
+            if (capacity <= 0)
+            {
+                throw new ArgumentOutOfRangeException("capacity");
+            }
+            _slots = new T[capacity];
+        }
+
+        /**
+         * \brief   Gets the maximum number of items held.
+         */
+        internal int Capacity { get { return _slots.Length; } }
+
+        /**
+         * \brief   Gets the number of items held at the moment.
+         */
+        internal int Count
+        {
+            get
+            {
+                long aHead = Interlocked.Read(ref _head);
+                long aTail = Interlocked.Read(ref _tail);
+                return (int)Math.Min(Math.Max(aTail - aHead, 0), _slots.Length);
+            }
+        }
+
+        /**
+         * \brief   Adds an item, overwriting the oldest one if the buffer is full. Must only be called by the producer.
+         */
+        internal void Enqueue(T item)
+        {
+            long aTail = _tail;
+            long aHead = Interlocked.Read(ref _head);
+            if (aTail - aHead >= _slots.Length && Interlocked.CompareExchange(ref _head, aHead + 1, aHead) == aHead)
+            {
+                //if the exchange fails the consumer took the oldest item and there is room anyway
+                Interlocked.Increment(ref _overwritten);
+            }
+            Volatile.Write(ref _slots[aTail % _slots.Length], item);
+            Interlocked.Exchange(ref _tail, aTail + 1);
+        }
+
+        /**
+         * \brief   Removes the oldest item. Must only be called by the consumer.
+         *
+         * \return  false if the buffer is empty.
+         */
+        internal bool TryDequeue(out T item)
+        {
+            while (true)
+            {
+                long aHead = Interlocked.Read(ref _head);
+                if (aHead == Interlocked.Read(ref _tail))
+                {
+                    item = null;
+                    return false;
+                }
+                item = Volatile.Read(ref _slots[aHead % _slots.Length]);
+                if (Interlocked.CompareExchange(ref _head, aHead + 1, aHead) == aHead)
+                {
+                    return true;
+                }
+            }
+        }
+
+        /**
+         * \brief   Removes the oldest items without reading them. Must only be called by the consumer.
+         *
+         * \param   count   The maximum number of items to remove.
+         *
+         * \return  The number of items removed.
+         */
+        internal int Discard(int count)
+        {
+            while (true)
+            {
+                long aHead      = Interlocked.Read(ref _head);
+                long aDiscarded = Math.Min(count, Interlocked.Read(ref _tail) - aHead);
+                if (aDiscarded <= 0)
+                {
+                    return 0;
+                }
+                if (Interlocked.CompareExchange(ref _head, aHead + aDiscarded, aHead) == aHead)
+                {
+                    return (int)aDiscarded;
+                }
+            }
+        }
+
+        /**
+         * \brief   Gets the number of items overwritten since the last call and resets it.
+         */
+        internal long TakeOverwritten()
+        {
+            return Interlocked.Exchange(ref _overwritten, 0);
+        }
+        #endregion
+    }
+}
@@ -3,7 +3,6 @@ using System.Collections.Generic;
 using System.Drawing;
 using System.Linq;
 using System.Threading.Tasks;
-using FuzzyString;
 using Microsoft.VisualStudio.Language.Intellisense;
 using RTextNppPlugin.Logging;
 using RTextNppPlugin.RText;
@@ -173,6 +172,7 @@ namespace RTextNppPlugin.ViewModels
         {
             _cManager          = cmanager;
             _filteredList      = new FilteredObservableCollection<Completion>(_completionList);
+            _completionList.CollectionChanged += (sender, e) => _matcher = null;
             FilteredCount      = 0;
             CharProcessAction  = CharProcessResult.NoAction;
             SelectedCompletion = null;
@@ -192,7 +192,7 @@ namespace RTextNppPlugin.ViewModels
             }
             if (_connector != null)
             {
-                _connector.CancelCommand();
+                _connector.Scheduler.Cancel(Constants.Commands.CONTENT_COMPLETION);
             }
         }
         
@@ -277,6 +277,7 @@ namespace RTextNppPlugin.ViewModels
                 return;
             }
             TriggerPoint = tokenizer.TriggerToken;
+            SetUsageContext(tokenizer);
             bool areContextEquals = false;
             //get all tokens before the trigger token - if all previous tokens and all context lines match do not request new auto completion options
             if (_cachedOptions != null && _cachedContext != null && !_isWarningCompletionActive)
@@ -319,26 +320,39 @@ namespace RTextNppPlugin.ViewModels
                 switch (_connector.CurrentState.State)
                 {
                     case ConnectorStates.Disconnected:
-                        _completionList.Add(CreateWarningCompletion(Properties.Resources.ERR_BACKEND_CONNECTING, Properties.Resources.ERR_BACKEND_CONNECTING_DESC));
-                        _isWarningCompletionActive = true;
+                        if (!AddLocalReferenceCompletions(isAutoCompletionShortCutActive))
+                        {
+                            _completionList.Add(CreateWarningCompletion(Properties.Resources.ERR_BACKEND_CONNECTING, Properties.Resources.ERR_BACKEND_CONNECTING_DESC));
+                            _isWarningCompletionActive = true;
+                        }
                         await _connector.ExecuteAsync<AutoCompleteAndReferenceRequest>(aRequest, Constants.SYNCHRONOUS_COMMANDS_TIMEOUT, Command.Execute);
                         break;
-                    case ConnectorStates.Busy:
                     case ConnectorStates.Loading:
                     case ConnectorStates.Connecting:
-                        _completionList.Add(CreateWarningCompletion(Properties.Resources.ERR_BACKEND_BUSY, Properties.Resources.ERR_BACKEND_BUSY_DESC));
-                        _isWarningCompletionActive = true;
+                        //references can be completed from the workspace index while the backend is loading the model
+                        if (!AddLocalReferenceCompletions(isAutoCompletionShortCutActive))
+                        {
+                            _completionList.Add(CreateWarningCompletion(Properties.Resources.ERR_BACKEND_BUSY, Properties.Resources.ERR_BACKEND_BUSY_DESC));
+                            _isWarningCompletionActive = true;
+                        }
                         break;
+                    case ConnectorStates.Busy:
                     case ConnectorStates.Idle:
+                        //completion is typed against, so it overtakes other pending requests
                         Pending = true;
-                        AutoCompleteResponse aResponse = await _connector.ExecuteAsync<AutoCompleteAndReferenceRequest>(aRequest, Constants.SYNCHRONOUS_COMMANDS_TIMEOUT, Command.Execute) as AutoCompleteResponse;
+                        AutoCompleteResponse aResponse = await _connector.Scheduler.ExecuteLatestAsync(aRequest, RequestPriority.High) as AutoCompleteResponse;
+                        if (!_connector.Scheduler.IsLatest(aRequest))
+                        {
+                            //superseded by a later keystroke or cancelled, which handles the completion list
+                            return;
+                        }
                         if (aResponse == null)
                         {
                             if (_connector.IsCommandCancelled)
                             {
                                 CharProcessAction = CharProcessResult.ForceClose;
                             }
-                            else
+                            else if (!AddLocalReferenceCompletions(isAutoCompletionShortCutActive))
                             {
                                 _completionList.Add(CreateWarningCompletion(Properties.Resources.ERR_AUTO_COMPLETION_NULL_RESP, Properties.Resources.ERR_AUTO_COMPLETION_NULL_DESC));
                                 _isWarningCompletionActive = true;
@@ -351,39 +365,7 @@ namespace RTextNppPlugin.ViewModels
                                 _completionList.Clear();
                                 _isWarningCompletionActive = false;
                             }
-                            //add pics
-                            var labeledList = aResponse.options.AsParallel().Select(x => new Completion(
-                                x.display,
-                                x.insert,
-                                string.IsNullOrEmpty(x.desc) ? "No description available." : x.desc,
-                                DetermineCompletionImage(x.display)));
-                            if (labeledList.Count() != 0)
-                            {
-                                if (labeledList.Count() == 1)
-                                {
-                                    //auto insert
-                                    SelectedCompletion = labeledList.First();
-                                    SelectedCompletion.IsSelected = true;
-                                    _completionList.Add(labeledList.First());
-                                    if (isAutoCompletionShortCutActive)
-                                    {
-                                        CharProcessAction = CharProcessResult.ForceCommit;
-                                    }
-                                }
-                                else
-                                {
-                                    _completionList.AddRange(labeledList.OrderBy(x => x.InsertionText));
-                                    Pending = false;
-                                    Filter();
-                                }
-                                //_cachedOptions = new List<Completion>(_completionList);
-                            }
-                            else
-                            {
-                                _cachedOptions = null;
-                                CharProcessAction = CharProcessResult.ForceClose;
-                            }
-                            _isWarningCompletionActive = false;
+                            AddCompletions(aResponse, isAutoCompletionShortCutActive);
                         }
                         break;
                     default:
@@ -425,29 +407,12 @@ namespace RTextNppPlugin.ViewModels
             }
             if(TriggerPoint.HasValue && !String.IsNullOrWhiteSpace(TriggerPoint.Value.Context))
             {
-                _previousHint       = TriggerPoint.Value.Context;
-                int aprefixCount    = 0;
-                int aContainedCount = 0;
-                int aFuzzyCount     = 0;
-                _filteredList.Filter((x) =>
-                {
-                    if (x.InsertionText.StartsWith(_previousHint, StringComparison.OrdinalIgnoreCase))
-                    {
-                        ++aprefixCount;
-                        return true;
-                    }
-                    else if (x.InsertionText.Contains(_previousHint, StringComparison.OrdinalIgnoreCase))
-                    {
-                        ++aContainedCount;
-                        return true;
-                    }
-                    else if ((_completionList.Count() < 2000) && x.InsertionText.ApproximatelyEquals(_previousHint, FuzzyStringComparisonTolerance.Strong, APPROXIMATION_CRITERIA))
-                    {
-                        ++aFuzzyCount;
-                        return true;
-                    }
-                    return false;
-                });
+                _previousHint = TriggerPoint.Value.Context;
+                CreateMatcher();
+                //rank once per keystroke, the filter predicate is a mere lookup
+                var aRanked  = _matcher.Rank(_previousHint, MAX_FILTERED_COMPLETIONS, _usageBonus);
+                var aMatches = new HashSet<Completion>(aRanked.Select(x => _completionList[x]));
+                _filteredList.Filter(x => aMatches.Contains(x));
                 if ((FilteredCount = _filteredList.Count) == 0)
                 {
                     _filteredList.StopFiltering();
@@ -480,19 +445,8 @@ namespace RTextNppPlugin.ViewModels
                 }
                 else
                 {
-                    //select with priority to prefix
-                    if(aprefixCount > 0)
-                    {
-                        SelectedCompletion = _filteredList.Where(x => x.InsertionText.StartsWith(_previousHint, StringComparison.OrdinalIgnoreCase)).OrderBy(x => x.InsertionText.Length).First();
-                    }
-                    else if(aContainedCount > 0)
-                    {
-                        SelectedCompletion = _filteredList.Where(x => x.InsertionText.Contains(_previousHint, StringComparison.OrdinalIgnoreCase)).OrderBy(x => x.InsertionText.Length).First();
-                    }
-                    else
-                    {
-                        SelectedCompletion = _filteredList.OrderBy(x => x.InsertionText.Length).First();
-                    }
+                    //select the best match, the list itself stays in alphabetical order
+                    SelectedCompletion = _completionList[aRanked[0]];
                     SelectedIndex = _filteredList.IndexOf(SelectedCompletion);
                     SelectedCompletion.IsSelected = SelectedCompletion.IsFuzzy = true;
                 }
@@ -502,7 +456,9 @@ namespace RTextNppPlugin.ViewModels
                 _filteredList.StopFiltering();
                 if (_filteredList.Count > 0)
                 {
-                    SelectedCompletion            = _filteredList.First();
+                    //without a hint the most often committed option is proposed, the first one if there is none
+                    CreateMatcher();
+                    SelectedCompletion            = _completionList[_matcher.Rank(String.Empty, 1, _usageBonus)[0]];
                     SelectedCompletion.IsFuzzy    = true;
                     SelectedCompletion.IsSelected = false;
                 }
@@ -512,10 +468,113 @@ namespace RTextNppPlugin.ViewModels
             _isFiltering = false;
         }
         
+        /**
+         * \brief   Records the selected completion as committed, so that it ranks higher in the same context next time.
+         */
+        public void OnCompletionCommitted()
+        {
+            if (SelectedCompletion != null && !String.IsNullOrEmpty(SelectedCompletion.InsertionText) && _connector != null)
+            {
+                _connector.CompletionUsage.Record(_usageCommand, _usageLabel, SelectedCompletion.InsertionText);
+            }
+        }
+        
         #endregion
         
         #region [Helpers]
         
+        private void SetUsageContext(AutoCompletionTokenizer tokenizer)
+        {
+            //the trigger token is the last one of the line tokens
+            var aTokens   = tokenizer.LineTokens.Take(Math.Max(0, tokenizer.LineTokens.Count() - 1));
+            var aCommand  = aTokens.Where(x => x.Type == RTextTokenTypes.Command).Select(x => x.Context).FirstOrDefault();
+            var aLabel    = aTokens.Where(x => x.Type == RTextTokenTypes.Label).Select(x => x.Context).LastOrDefault();
+            _usageCommand = aCommand ?? String.Empty;
+            _usageLabel   = aLabel ?? String.Empty;
+        }
+        
+        /**
+         * \brief   Creates the matcher and the usage bonus of the options of the underlying list, unless they exist.
+         */
+        private void CreateMatcher()
+        {
+            if (_matcher == null)
+            {
+                _matcher    = new FuzzyMatcher(_completionList.Select(x => x.InsertionText).ToList());
+                _usageBonus = GetUsageBonus();
+            }
+        }
+        
+        private int[] GetUsageBonus()
+        {
+            if (_connector == null)
+            {
+                return null;
+            }
+            var aUsage = _connector.CompletionUsage;
+            return _completionList.Select(x => aUsage.Score(_usageCommand, _usageLabel, x.InsertionText)).ToArray();
+        }
+        
+        private void AddCompletions(AutoCompleteResponse response, bool isAutoCompletionShortCutActive)
+        {
+            //add pics
+            var labeledList = response.options.AsParallel().Select(x => new Completion(
+                x.display,
+                x.insert,
+                string.IsNullOrEmpty(x.desc) ? "No description available." : x.desc,
+                DetermineCompletionImage(x.display)));
+            if (labeledList.Count() != 0)
+            {
+                if (labeledList.Count() == 1)
+                {
+                    //auto insert
+                    SelectedCompletion = labeledList.First();
+                    SelectedCompletion.IsSelected = true;
+                    _completionList.Add(labeledList.First());
+                    if (isAutoCompletionShortCutActive)
+                    {
+                        CharProcessAction = CharProcessResult.ForceCommit;
+                    }
+                }
+                else
+                {
+                    _completionList.AddRange(labeledList.OrderBy(x => x.InsertionText));
+                    Pending = false;
+                    Filter();
+                }
+                //_cachedOptions = new List<Completion>(_completionList);
+            }
+            else
+            {
+                _cachedOptions = null;
+                CharProcessAction = CharProcessResult.ForceClose;
+            }
+            _isWarningCompletionActive = false;
+        }
+        
+        /**
+         * \brief   Completes an absolute reference from the workspace index, when the backend can't.
+         *
+         * \param   isAutoCompletionShortCutActive  Whether a single completion is inserted right away.
+         *
+         * \return  True if the trigger token is an absolute reference and the index has completions for it.
+         */
+        private bool AddLocalReferenceCompletions(bool isAutoCompletionShortCutActive)
+        {
+            string aContext = TriggerPoint.Value.Context;
+            if (String.IsNullOrEmpty(aContext) || aContext[0] != '/')
+            {
+                return false;
+            }
+            var aResponse = _connector.WorkspaceIndex.CompleteReference(aContext);
+            if (aResponse == null || aResponse.options.Count == 0)
+            {
+                return false;
+            }
+            AddCompletions(aResponse, isAutoCompletionShortCutActive);
+            return true;
+        }
+        
         Completion CreateWarningCompletion(string warning, string desc)
         {
             return new Completion(warning, String.Empty, desc, Completion.AutoCompletionType.Warning);
@@ -606,14 +665,11 @@ namespace RTextNppPlugin.ViewModels
         private IEnumerable<string> _cachedContext                                 = null;                                       //!< Holds the last context used for an auto completion request.
         private Connector _connector                                               = null;                                       //!< Connector for this auto completion session.
         private TokenEqualityComparer _equalityComparer                            = new TokenEqualityComparer();                //!< Compares two tokens list for similarity.
-        private readonly FuzzyStringComparisonOptions[] APPROXIMATION_CRITERIA     = new FuzzyStringComparisonOptions[]          //!< Used for fuzzy matching of auto completion options.
-        {
-            FuzzyStringComparisonOptions.UseHammingDistance,
-            FuzzyStringComparisonOptions.UseJaccardDistance,
-            FuzzyStringComparisonOptions.UseOverlapCoefficient,
-            FuzzyStringComparisonOptions.UseSorensenDiceDistance,
-            FuzzyStringComparisonOptions.UseLongestCommonSubstring
-        };
+        private FuzzyMatcher _matcher                                              = null;                                       //!< Ranks the options of the underlying list, built on first use.
+        private int[] _usageBonus                                                  = null;                                       //!< Ranking bonus of every option of the underlying list, from its past commits.
+        private string _usageCommand                                               = String.Empty;                               //!< Command of the element the options are requested for.
+        private string _usageLabel                                                 = String.Empty;                               //!< Label of the feature the options are requested for.
+        private const int MAX_FILTERED_COMPLETIONS                                 = 1000;                                       //!< Maximum number of options shown while filtering.
         #endregion
     }
 }
\ No newline at end of file
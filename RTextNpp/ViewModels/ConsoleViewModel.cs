@@ -420,6 +420,20 @@ namespace RTextNppPlugin.ViewModels
             ZoomSliderPosition = _settings.Get<int>(Settings.RTextNppSettings.ZoomSliderPosition);
             _isSliderLoaded    = true;
         }
+
+        /**
+         * \brief   Prints the latency percentiles of the requests of the selected workspace to its console.
+         */
+        internal void OnShowRequestStatistics()
+        {
+            var aWorkspaceModel = _workspaceCollection[_index] as WorkspaceViewModel;
+            if (aWorkspaceModel == null)
+            {
+                Logging.Logger.Instance.Append(Logging.Logger.MessageType.Info, Workspace, "Request statistics are kept for workspaces only.");
+                return;
+            }
+            Logging.Logger.Instance.Append(Logging.Logger.MessageType.Info, Workspace, "Request statistics:\n{0}", aWorkspaceModel.RequestStatistics.Report().TrimEnd());
+        }
         #endregion
 
 
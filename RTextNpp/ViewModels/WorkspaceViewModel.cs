@@ -4,6 +4,7 @@ namespace RTextNppPlugin.ViewModels
 {
     using RTextNppPlugin.DllExport;
     using RTextNppPlugin.RText;
+    using RTextNppPlugin.RText.Indexing;
     using RTextNppPlugin.RText.Protocol;
     using RTextNppPlugin.RText.StateEngine;
     using RTextNppPlugin.Scintilla;
@@ -23,12 +24,21 @@ namespace RTextNppPlugin.ViewModels
             _mainModel                   = mainViewModel;
             _connector.OnStateChanged    += OnConnectorStateChanged;
             _connector.OnProgressUpdated += OnConnectorProgressUpdated;
+            _connector.OnProblemsReceived += OnConnectorProblemsReceived;
             _nppHelper                   = nppHelper;
             _dispatcher                  = dispatcher;
             _annotationsManagers         = new List<IError>(3);
             _annotationsManagers.Add(new AnnotationManager(settings, nppHelper, Plugin.Instance, _connector.Workspace, lineVisibilityObserver));
             _annotationsManagers.Add(new MarginManager(settings, nppHelper, Plugin.Instance, _connector.Workspace, lineVisibilityObserver));
             _annotationsManagers.Add(new IndicatorManager(settings, nppHelper, Plugin.Instance, _connector.Workspace, lineVisibilityObserver, mouseDwellObserver));
+            if (_connector.WorkspaceIndex != null)
+            {
+                _connector.WorkspaceIndex.OnIndexUpdated += OnWorkspaceIndexUpdated;
+                if (_connector.WorkspaceIndex.IsReady)
+                {
+                    OnWorkspaceIndexUpdated(this, _connector.WorkspaceIndex.Snapshot);
+                }
+            }
         }
         /**
          * \brief   Gets a value indicating whether this workspace is currently loading.
@@ -60,7 +70,7 @@ namespace RTextNppPlugin.ViewModels
         {
             get
             {
-                return (_connector != null) ? _connector.ErrorList != null ? _connector.ErrorList.total_problems : 0 : 0;
+                return ((_connector != null) ? _connector.ErrorList != null ? _connector.ErrorList.total_problems : _receivedProblemCount : 0) + _localErrorCount;
             }
         }
         public void AddConnector(Connector connector)
@@ -89,6 +99,17 @@ namespace RTextNppPlugin.ViewModels
                 return _connector.ActiveCommand;
             }
         }
+
+        /**
+         * \brief   Gets the latencies of the requests of this workspace.
+         */
+        internal RequestStatistics RequestStatistics
+        {
+            get
+            {
+                return _connector.Statistics;
+            }
+        }
         #endregion
         
         #region [Event Handlers]
@@ -110,10 +131,47 @@ namespace RTextNppPlugin.ViewModels
             }
         }
         
+        /**
+         * \brief   Shows the problems of a model while it is still being loaded. They are kept until the complete, sorted
+         *          list replaces them once loading finished, so that an index update in between merges with them.
+         */
+        private void OnConnectorProblemsReceived(object source, Connector.ProblemsReceivedEventArgs e)
+        {
+            if (e.Workspace != _mainModel.Workspace)
+            {
+                return;
+            }
+            var aErrors = e.Problems.Select(x => new ErrorListViewModel(x.file, x.problems.OrderBy(y => y.line).Select(y => new ErrorItemViewModel(y, x.file)), false, _nppHelper)).ToList();
+            int aCount  = e.Problems.Sum(x => x.problems.Count);
+            _dispatcher.BeginInvoke(new Action(() =>
+            {
+                //the complete list may have been shown already
+                if (_isReceivingProblems)
+                {
+                    lock (_receivedProblems)
+                    {
+                        _receivedProblems.AddRange(e.Problems);
+                        _receivedProblemCount += aCount;
+                    }
+                    _mainModel.Errors.AddRange(aErrors);
+                    _mainModel.ErrorCount += aCount;
+                }
+            }));
+        }
+        
         private void OnConnectorStateChanged(object source, Connector.StateChangedEventArgs e)
         {
             lock (_lock)
             {
+                _isReceivingProblems = (e.StateEntered == ConnectorStates.Loading);
+                if (e.StateEntered == ConnectorStates.Loading || e.StateLeft == ConnectorStates.Loading)
+                {
+                    lock (_receivedProblems)
+                    {
+                        _receivedProblems.Clear();
+                        _receivedProblemCount = 0;
+                    }
+                }
                 switch (e.StateEntered)
                 {
                     case ConnectorStates.Loading:
@@ -166,7 +224,7 @@ namespace RTextNppPlugin.ViewModels
                         {
                             _dispatcher.Invoke(new Action(() =>
                             {
-                                _mainModel.ErrorCount = _connector.ErrorList.total_problems;
+                                _mainModel.ErrorCount = ErrorCount;
                                 _mainModel.AddErrors(_errorList);
                             }));
                         }
@@ -192,6 +250,11 @@ namespace RTextNppPlugin.ViewModels
         {
             _connector.OnStateChanged    -= OnConnectorStateChanged;
             _connector.OnProgressUpdated -= OnConnectorProgressUpdated;
+            _connector.OnProblemsReceived -= OnConnectorProblemsReceived;
+            if (_connector.WorkspaceIndex != null)
+            {
+                _connector.WorkspaceIndex.OnIndexUpdated -= OnWorkspaceIndexUpdated;
+            }
         }
         #endregion
        
@@ -200,14 +263,23 @@ namespace RTextNppPlugin.ViewModels
         void AddErrors()
         {
             _errorList.Clear();
-            if (_connector.ErrorList.total_problems > 0)
+            IEnumerable<Error> aBackendErrors = null;
+            if (_connector.ErrorList != null)
+            {
+                aBackendErrors = (_connector.ErrorList.total_problems > 0) ? _connector.ErrorList.problems : new List<Error>();
+            }
+            else
             {
-                foreach (var errors in _connector.ErrorList.problems.OrderBy(x => x.file))
+                //the model is still loading, merge with the problems received so far
+                lock (_receivedProblems)
                 {
-                    _errorList.Add(new ErrorListViewModel(errors.file, errors.problems.OrderBy(x => x.line).Select(x => new ErrorItemViewModel(x, errors.file)), false, _nppHelper));
-
+                    aBackendErrors = _receivedProblems.ToList();
                 }
             }
+            foreach (var errors in AddUnresolvedReferences(aBackendErrors).OrderBy(x => x.file))
+            {
+                _errorList.Add(new ErrorListViewModel(errors.file, errors.problems.OrderBy(x => x.line).Select(x => new ErrorItemViewModel(x, errors.file)), false, _nppHelper));
+            }
 
             foreach(var manager in _annotationsManagers)
             {
@@ -216,6 +288,60 @@ namespace RTextNppPlugin.ViewModels
             }
         }
 
+        /**
+         * \brief   Adds the unresolved references found by the local workspace index to the errors reported by the backend.
+         *          These are known as soon as a file is saved, the backend reports them only after the model is reloaded.
+         *
+         * \param   backendErrors   The errors reported by the backend, these are not modified.
+         *
+         * \return  The errors per file, lines which already have a backend error get no additional local error.
+         */
+        private IEnumerable<Error> AddUnresolvedReferences(IEnumerable<Error> backendErrors)
+        {
+            var aErrors      = new Dictionary<string, Error>(StringComparer.OrdinalIgnoreCase);
+            _localErrorCount = 0;
+            foreach (var aError in backendErrors)
+            {
+                aErrors[aError.file] = new Error { file = aError.file, problems = new List<SpecificError>(aError.problems) };
+            }
+            var aSnapshot = (_connector.WorkspaceIndex != null) ? _connector.WorkspaceIndex.Snapshot : null;
+            if (aSnapshot == null)
+            {
+                return aErrors.Values;
+            }
+            foreach (var aUnresolved in aSnapshot.UnresolvedReferences)
+            {
+                //the backend reports files with forward slashes
+                string aFile = aUnresolved.Key.Replace('\\', '/');
+                Error aError = null;
+                if (!aErrors.TryGetValue(aFile, out aError))
+                {
+                    aError = new Error { file = aFile, problems = new List<SpecificError>() };
+                    aErrors.Add(aFile, aError);
+                }
+                var aErrorLines = new HashSet<int>(aError.problems.Select(x => x.line));
+                foreach (var aReference in aUnresolved.Value.Where(x => !aErrorLines.Contains(x.Line + 1)))
+                {
+                    aError.problems.Add(new SpecificError { message = String.Format(UNRESOLVED_REFERENCE, aReference.Path), severity = Constants.SEVERITY_ERROR, line = aReference.Line + 1 });
+                    ++_localErrorCount;
+                }
+            }
+            return aErrors.Values;
+        }
+
+        void OnWorkspaceIndexUpdated(object source, IndexSnapshot snapshot)
+        {
+            _dispatcher.BeginInvoke(new Action(() =>
+            {
+                AddErrors();
+                if (Workspace == _mainModel.Workspace)
+                {
+                    _mainModel.ErrorCount = ErrorCount;
+                    _mainModel.AddErrors(_errorList);
+                }
+            }));
+        }
+
         #endregion
 
         #region [Data Members]
@@ -231,6 +357,11 @@ namespace RTextNppPlugin.ViewModels
         private static readonly object _lock            = new object();         //!< Mutex.
         private readonly Dispatcher _dispatcher         = null;                 //!< UI Dispatcher.
         private IList<IError> _annotationsManagers      = null;                 //!< Manages annotations display.
+        private int _localErrorCount                    = 0;                    //!< Number of unresolved references found by the local workspace index.
+        private volatile bool _isReceivingProblems      = false;                //!< Whether problems of a model being loaded are shown as they arrive.
+        private readonly List<Error> _receivedProblems  = new List<Error>();    //!< Problems received while the model is being loaded.
+        private int _receivedProblemCount               = 0;                    //!< Number of problems received while the model is being loaded.
+        private const string UNRESOLVED_REFERENCE       = "unresolved reference {0}"; //!< Message of an unresolved reference found by the local workspace index.
         #endregion
     }
 }
\ No newline at end of file
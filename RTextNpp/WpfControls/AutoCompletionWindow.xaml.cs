@@ -108,6 +108,11 @@ namespace RTextNppPlugin.WpfControls
         
         internal AutoCompletionViewModel.Completion Completion { get { return GetModel().SelectedCompletion; } }
         
+        internal void OnCompletionCommitted()
+        {
+            GetModel().OnCompletionCommitted();
+        }
+        
         #endregion
         
         #region [Helpers]
@@ -281,6 +286,7 @@ namespace RTextNppPlugin.WpfControls
             {
                 //use current selected item to replace token
                 _nppHelper.ReplaceWordFromToken(TriggerPoint, Completion.InsertionText, _nppHelper.CurrentScintilla);
+                OnCompletionCommitted();
             }
             Hide();
         }
@@ -101,6 +101,7 @@ namespace RTextNppPlugin.WpfControls
                         run.Style = (Style)(Resources["Information"]);
                     }
                     _logOutput[channel].Add(run);
+                    TrimOutput(_logOutput[channel], null);
                 }
                 else
                 {
@@ -114,6 +115,7 @@ namespace RTextNppPlugin.WpfControls
                     }
                     ((Paragraph)Blocks.LastBlock).Inlines.Add(run);
                     _logOutput[_currentChannel].Add(run);
+                    TrimOutput(_logOutput[_currentChannel], (Paragraph)Blocks.LastBlock);
                     ScrollParent(this);
                 }
             }
@@ -122,6 +124,28 @@ namespace RTextNppPlugin.WpfControls
                 Dispatcher.BeginInvoke(new Action<string, string, string>(Append), msg, style, channel);
             }
         }
+        /**
+         * Removes the oldest entries of a channel, so that a flooded channel keeps only its tail and stays responsive.
+         *
+         * \param   output      The entries of the channel.
+         * \param   paragraph   The paragraph showing the entries, null if the channel isn't shown.
+         */
+        private static void TrimOutput(List<Run> output, Paragraph paragraph)
+        {
+            int aExcess = output.Count - Constants.MAX_CONSOLE_LINES;
+            if (aExcess <= 0)
+            {
+                return;
+            }
+            if (paragraph != null)
+            {
+                for (int i = 0; i < aExcess; ++i)
+                {
+                    paragraph.Inlines.Remove(output[i]);
+                }
+            }
+            output.RemoveRange(0, aExcess);
+        }
         private static void ScrollParent(FrameworkContentElement element)
         {
             if (element != null)
@@ -98,5 +98,10 @@ namespace RTextNppPlugin.WpfControls
         {
             ((ConsoleViewModel)DataContext).OnSliderLoaded();
         }
+
+        private void OnShowRequestStatisticsClick(object sender, RoutedEventArgs e)
+        {
+            ((ConsoleViewModel)DataContext).OnShowRequestStatistics();
+        }
     }
 }
\ No newline at end of file
@@ -103,6 +103,28 @@ namespace RTextNppPlugin.WpfControls
         {
             _referenceRequestDispatcher.Cancel();
         }
+
+        /**
+         * \brief   Shows the usages of an element, e.g. found by the find usages command, below a token. A single usage is
+         *          jumped to right away.
+         *
+         * \param   token   The token the window is placed at.
+         * \param   usages  The usages, see WorkspaceIndex.FindUsages.
+         */
+        internal void ShowUsages(Tokenizer.TokenTag token, IList<Element> usages)
+        {
+            Hide();
+            _connector = _cManager.Connector;
+            if (usages.Count == 1)
+            {
+                _nppHelper.JumpToLine(usages[0].file, usages[0].line, _nppHelper.CurrentScintilla);
+                return;
+            }
+            _cachedContext                            = null;
+            _cachedReferenceLinks                     = new LinkTargetsResponse { targets = usages.Select(x => new Target { display = x.display, file = x.file, line = x.line.ToString(), desc = x.desc }).ToList() };
+            _referenceRequestObserver.UnderlinedToken = token;
+            Show();
+        }
         
         /**
          * Asynchronous call when keyboard shortcut for reference link changes.
@@ -373,7 +395,7 @@ namespace RTextNppPlugin.WpfControls
             {
                 Task<Tuple<bool, ContextExtractor>> contextEqualityTask = new Task<Tuple<bool, ContextExtractor>>(new Func<Tuple<bool, ContextExtractor>>(() =>
                 {
-                    string aContextBlock = _nppHelper.GetTextBetween(0, Npp.Instance.GetLineEnd(aTokenUnderCursor.BufferPosition, aTokenUnderCursor.Line, _nppHelper.CurrentScintilla));
+                    string aContextBlock = _nppHelper.GetTextBetween(_nppHelper.GetContextStart(_nppHelper.CurrentScintilla, aTokenUnderCursor.BufferPosition), Npp.Instance.GetLineEnd(aTokenUnderCursor.BufferPosition, aTokenUnderCursor.Line, _nppHelper.CurrentScintilla));
                     ContextExtractor aExtractor = new ContextExtractor(aContextBlock, Npp.Instance.GetLengthToEndOfLine(aTokenUnderCursor.Line, aTokenUnderCursor.BufferPosition));
                     bool aAreContextEquals = false;
                     //get all tokens before the trigger token - if all previous tokens and all context lines match do not request new auto completion options
@@ -398,9 +420,10 @@ namespace RTextNppPlugin.WpfControls
                 }
                 contextEqualityTask.Start();
                 Task.WaitAll(contextEqualityTask);
-                if (!contextEqualityTask.Result.Item1 && _cachedReferenceLinks != null)
+                if (!contextEqualityTask.Result.Item1)
                 {
-                    _cachedReferenceLinks.targets.Clear();
+                    //responses are shared with the response cache, so they are dropped instead of cleared
+                    _cachedReferenceLinks = null;
                 }
                 //store cache
                 _cachedContext = contextEqualityTask.Result.Item2.ContextList;
@@ -419,7 +442,8 @@ namespace RTextNppPlugin.WpfControls
                 }
                 if (!contextEqualityTask.Result.Item1 || _cachedReferenceLinks == null || _cachedReferenceLinks.targets.Count == 0)
                 {
-                    _cachedReferenceLinks = await RequestReferenceLinksAsync(aRequest);
+                    //the backend is only asked if the local workspace index doesn't know a unique target
+                    _cachedReferenceLinks = ResolveReferenceLocally(aTokenUnderCursor) ?? await RequestReferenceLinksAsync(aRequest);
                 }
                 //maybe shortcut released during link fetching...
                 if (_referenceRequestObserver.IsKeyboardShortCutActive)
@@ -449,27 +473,53 @@ namespace RTextNppPlugin.WpfControls
             return ((ReferenceLinkViewModel)DataContext);
         }
         
+        private LinkTargetsResponse ResolveReferenceLocally(Tokenizer.TokenTag aTokenUnderCursor)
+        {
+            _connector = _cManager.Connector;
+            if (aTokenUnderCursor.Type != RTextTokenTypes.Reference || _connector == null || _connector.WorkspaceIndex == null)
+            {
+                return null;
+            }
+            var aResponse = _connector.WorkspaceIndex.ResolveReference(aTokenUnderCursor.Context);
+            if (aResponse != null)
+            {
+                GetModel().Clear();
+                GetModel().RemoveWarning();
+            }
+            return aResponse;
+        }
+
         private async Task<LinkTargetsResponse> RequestReferenceLinksAsync(AutoCompleteAndReferenceRequest request)
         {
             _connector = _cManager.Connector;
             if (_connector != null)
             {
+                //hovering the same reference again is answered without the back-end
+                IResponseBase aCachedResponse = null;
+                string aFile                  = _nppHelper.GetCurrentFilePath();
+                int aCacheVersion             = _connector.ResponseCache.Version;
+                if (_connector.ResponseCache.TryGet(aFile, request, out aCachedResponse))
+                {
+                    GetModel().Clear();
+                    GetModel().RemoveWarning();
+                    return aCachedResponse as LinkTargetsResponse;
+                }
                 switch (_connector.CurrentState.State)
                 {
                     case ConnectorStates.Disconnected:
                         GetModel().CreateWarning(Properties.Resources.ERR_BACKEND_CONNECTING, Properties.Resources.ERR_BACKEND_CONNECTING_DESC);
                         await _connector.ExecuteAsync<AutoCompleteAndReferenceRequest>(request, Constants.SYNCHRONOUS_COMMANDS_TIMEOUT, Command.Execute);
                         break;
-                    case ConnectorStates.Busy:
                     case ConnectorStates.Loading:
                     case ConnectorStates.Connecting:
                         GetModel().CreateWarning(Properties.Resources.ERR_BACKEND_BUSY, Properties.Resources.ERR_BACKEND_BUSY_DESC);
                         break;
+                    case ConnectorStates.Busy:
                     case ConnectorStates.Idle:
-                        var aResponse = await _connector.ExecuteAsync<AutoCompleteAndReferenceRequest>(request, Constants.SYNCHRONOUS_COMMANDS_TIMEOUT, Command.Execute) as LinkTargetsResponse;
+                        var aResponse = await _connector.Scheduler.ExecuteLatestAsync(request, RequestPriority.Normal) as LinkTargetsResponse;
                         if (aResponse == null)
                         {
-                            if (_connector.IsCommandCancelled)
+                            if (_connector.IsCommandCancelled || !_connector.Scheduler.IsLatest(request))
                             {
                                 return null;
                             }
@@ -480,6 +530,7 @@ namespace RTextNppPlugin.WpfControls
                         }
                         else
                         {
+                            _connector.ResponseCache.Add(aFile, request, aCacheVersion, aResponse);
                             GetModel().Clear();
                             GetModel().RemoveWarning();
                             return aResponse;
@@ -0,0 +1,40 @@
+﻿using System.Collections.Generic;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin.RText;
+    [TestFixture]
+    class BackendOutputTests
+    {
+        [Test]
+        public void DrainTest()
+        {
+            var aOutput = new BackendOutput(100, 10);
+            var aLines  = new List<string>();
+            aOutput.StandardOutput.Enqueue("Loading model");
+            aOutput.StandardError.Enqueue("Warning");
+            Assert.AreEqual(0, aOutput.Drain(aLines.Add));
+            CollectionAssert.AreEqual(new[] { "Loading model", "Warning" }, aLines);
+            aLines.Clear();
+            Assert.AreEqual(0, aOutput.Drain(aLines.Add));
+            Assert.AreEqual(0, aLines.Count);
+        }
+
+        [Test]
+        public void FloodTest()
+        {
+            var aOutput = new BackendOutput(100, 10);
+            var aLines  = new List<string>();
+            for (int i = 0; i < 1000; ++i)
+            {
+                aOutput.StandardOutput.Enqueue(i.ToString());
+            }
+            //the buffer keeps the last 100 lines, of which the last 10 are passed on
+            Assert.AreEqual(990, aOutput.Drain(aLines.Add));
+            Assert.AreEqual(11, aLines.Count);
+            Assert.AreEqual(BackendOutput.Summarize(990), aLines[0]);
+            Assert.AreEqual("990", aLines[1]);
+            Assert.AreEqual("999", aLines[10]);
+        }
+    }
+}
@@ -0,0 +1,112 @@
+﻿using System.Linq;
+using System.Text;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin;
+    using RTextNppPlugin.Scintilla;
+    [TestFixture]
+    class BracketIndexTests
+    {
+        private static RTextDocumentCliWrapper Lex(string content)
+        {
+            var aDocument = new RTextDocumentCliWrapper(Encoding.UTF8.GetBytes(content));
+            aDocument.Lex(0, content.Length);
+            return aDocument;
+        }
+
+        private static int[] Matches(RTextDocumentCliWrapper document, string content)
+        {
+            return Enumerable.Range(0, content.Length).Select(x => document.FindMatchingBracket(x)).ToArray();
+        }
+
+        private static int[] Enclosing(RTextDocumentCliWrapper document, string content)
+        {
+            return Enumerable.Range(0, content.Length + 1).Select(x => document.FindEnclosingBracket(x)).ToArray();
+        }
+
+        [Test]
+        public void NestedBracketsTest()
+        {
+            const string aContent = "A {\n  B b, l: [1, \"]\", 2]\n  C {\n  }\n}\n";
+            using (var aDocument = Lex(aContent))
+            {
+                Assert.AreEqual(36, aDocument.FindMatchingBracket(2));
+                Assert.AreEqual(2, aDocument.FindMatchingBracket(36));
+                Assert.AreEqual(24, aDocument.FindMatchingBracket(14));
+                Assert.AreEqual(30, aDocument.FindMatchingBracket(34));
+                //bracket inside a string is not structural
+                Assert.AreEqual(-1, aDocument.FindMatchingBracket(19));
+                Assert.AreEqual(-1, aDocument.FindMatchingBracket(0));
+                Assert.AreEqual(14, aDocument.FindEnclosingBracket(19));
+                Assert.AreEqual(30, aDocument.FindEnclosingBracket(32));
+                Assert.AreEqual(2, aDocument.FindEnclosingBracket(28));
+                Assert.AreEqual(-1, aDocument.FindEnclosingBracket(aContent.Length));
+            }
+        }
+
+        [Test]
+        public void UnbalancedBracketsTest()
+        {
+            using (var aDocument = Lex("A {\n  B b, l: [1, 2}\n"))
+            {
+                Assert.AreEqual(-1, aDocument.FindMatchingBracket(2));
+                Assert.AreEqual(-1, aDocument.FindMatchingBracket(14));
+                Assert.AreEqual(-1, aDocument.FindMatchingBracket(19));
+                Assert.AreEqual(14, aDocument.FindEnclosingBracket(19));
+            }
+            using (var aDocument = Lex("A {\n  B b, l: [1, 2\n}\n]\n"))
+            {
+                Assert.AreEqual(-1, aDocument.FindMatchingBracket(2));
+                Assert.AreEqual(-1, aDocument.FindMatchingBracket(20));
+                Assert.AreEqual(22, aDocument.FindMatchingBracket(14));
+                Assert.AreEqual(14, aDocument.FindMatchingBracket(22));
+            }
+            using (var aDocument = Lex("A {\n  C {\n  }\n"))
+            {
+                Assert.AreEqual(-1, aDocument.FindMatchingBracket(2));
+                Assert.AreEqual(12, aDocument.FindMatchingBracket(8));
+                Assert.AreEqual(2, aDocument.FindEnclosingBracket(14));
+            }
+        }
+
+        [Test]
+        public void EditAfterIndexTest()
+        {
+            const string aContent = "A {\n  B b, l: [1, 2]\n  C {\n    D d\n  }\n}\nE {\n}\n";
+            var aEdits = new[]
+            {
+                new { Position = aContent.IndexOf("    D d"), Edited = aContent.Insert(aContent.IndexOf("    D d"), "    F {\n") },
+                new { Position = aContent.IndexOf("  }"),     Edited = aContent.Remove(aContent.IndexOf("  }"), "  }\n".Length) },
+                new { Position = aContent.IndexOf("2]"),      Edited = aContent.Insert(aContent.IndexOf("2]"), "[3, ") },
+                new { Position = aContent.IndexOf("E {"),     Edited = aContent.Insert(aContent.IndexOf("E {"), "]\n") }
+            };
+            foreach (var aEdit in aEdits)
+            {
+                using (var aDocument = Lex(aContent))
+                using (var aFull = Lex(aEdit.Edited))
+                {
+                    aDocument.Edit(Encoding.UTF8.GetBytes(aEdit.Edited), aEdit.Position);
+                    aDocument.Lex(aEdit.Position, aEdit.Edited.Length);
+                    CollectionAssert.AreEqual(Matches(aFull, aEdit.Edited), Matches(aDocument, aEdit.Edited), aEdit.Edited);
+                    CollectionAssert.AreEqual(Enclosing(aFull, aEdit.Edited), Enclosing(aDocument, aEdit.Edited), aEdit.Edited);
+                }
+            }
+        }
+
+        [Test]
+        public void GoToMatchingBracketTest()
+        {
+            const string aContent = "A {\n  B b, l: [1, \"]\", 2]\n  C {\n  }\n}\n";
+            using (var aDocument = Lex(aContent))
+            {
+                //bracket before the caret takes precedence, else the bracket after it, else the enclosing bracket
+                Assert.AreEqual(36, BracketNavigation.FindTarget(3, aDocument.FindMatchingBracket, aDocument.FindEnclosingBracket));
+                Assert.AreEqual(24, BracketNavigation.FindTarget(14, aDocument.FindMatchingBracket, aDocument.FindEnclosingBracket));
+                Assert.AreEqual(14, BracketNavigation.FindTarget(20, aDocument.FindMatchingBracket, aDocument.FindEnclosingBracket));
+                Assert.AreEqual(2, BracketNavigation.FindTarget(28, aDocument.FindMatchingBracket, aDocument.FindEnclosingBracket));
+                Assert.AreEqual(-1, BracketNavigation.FindTarget(0, aDocument.FindMatchingBracket, aDocument.FindEnclosingBracket));
+            }
+        }
+    }
+}
@@ -0,0 +1,97 @@
+﻿using System;
+using System.IO;
+using System.Linq;
+using System.Threading;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin.RText.Indexing;
+    [TestFixture]
+    class CompletionUsageTests
+    {
+        #region [DataMembers]
+        private string _usageFile = null;
+        #endregion
+
+        [SetUp]
+        public void Init()
+        {
+            _usageFile = Path.Combine(Path.GetTempPath(), "CompletionUsageTests.usage");
+            File.Delete(_usageFile);
+        }
+
+        [TearDown]
+        public void CleanUp()
+        {
+            File.Delete(_usageFile);
+        }
+
+        [Test]
+        public void ScoreDependsOnContextTest()
+        {
+            var aUsage = new CompletionUsage(null);
+            Assert.AreEqual(0, aUsage.Score("Port", "kind:", "In"));
+            aUsage.Record("Port", "kind:", "In");
+            Assert.IsTrue(aUsage.Score("Port", "kind:", "In") > 0);
+            Assert.AreEqual(0, aUsage.Score("Port", "kind:", "Out"));
+            Assert.AreEqual(0, aUsage.Score("Port", "mode:", "In"));
+            Assert.AreEqual(0, aUsage.Score("Signal", "kind:", "In"));
+        }
+
+        [Test]
+        public void FrequentAndRecentRankHigherTest()
+        {
+            var aUsage = new CompletionUsage(null);
+            for (int i = 0; i < 3; ++i)
+            {
+                aUsage.Record("Port", "kind:", "In");
+            }
+            aUsage.Record("Port", "kind:", "Out");
+            Assert.IsTrue(aUsage.Score("Port", "kind:", "In") > aUsage.Score("Port", "kind:", "Out"));
+            int aScore = aUsage.Score("Port", "kind:", "In");
+            for (int i = 0; i < 200; ++i)
+            {
+                aUsage.Record("Port", "kind:", "Out");
+            }
+            Assert.IsTrue(aUsage.Score("Port", "kind:", "In") < aScore);
+            Assert.IsTrue(aUsage.Score("Port", "kind:", "In") < aUsage.Score("Port", "kind:", "Out"));
+        }
+
+        [Test]
+        public void FullTableKeepsRecentCompletionsTest()
+        {
+            var aUsage = new CompletionUsage(null);
+            for (int i = 0; i < 20000; ++i)
+            {
+                aUsage.Record("Type", String.Empty, "T" + i);
+            }
+            Assert.IsTrue(Enumerable.Range(19990, 10).All(x => aUsage.Score("Type", String.Empty, "T" + x) > 0));
+            Assert.IsTrue(Enumerable.Range(0, 20000).Count(x => aUsage.Score("Type", String.Empty, "T" + x) > 0) <= 4096);
+        }
+
+        [Test]
+        public void PersistenceTest()
+        {
+            var aUsage = new CompletionUsage(_usageFile);
+            aUsage.Record("Port", "kind:", "In");
+            aUsage.Record("Port", "kind:", "In");
+            int aScore = aUsage.Score("Port", "kind:", "In");
+            //saving happens in the background
+            int aLoaded = 0;
+            for (int i = 0; i < 100 && aLoaded != aScore; ++i)
+            {
+                Thread.Sleep(50);
+                aLoaded = new CompletionUsage(_usageFile).Score("Port", "kind:", "In");
+            }
+            Assert.AreEqual(aScore, aLoaded);
+        }
+
+        [Test]
+        public void InvalidFileIsIgnoredTest()
+        {
+            File.WriteAllText(_usageFile, "garbage");
+            var aUsage = new CompletionUsage(_usageFile);
+            Assert.AreEqual(0, aUsage.Score("Port", "kind:", "In"));
+        }
+    }
+}
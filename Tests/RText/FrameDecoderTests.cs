@@ -0,0 +1,122 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Text;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin.RText;
+    [TestFixture]
+    class FrameDecoderTests
+    {
+        private static string Frame(string json)
+        {
+            return json.Length + json;
+        }
+
+        private static List<string> ReadAll(FrameDecoder decoder)
+        {
+            var aMessages = new List<string>();
+            ArraySegment<byte> aMessage;
+            while (decoder.TryRead(out aMessage))
+            {
+                aMessages.Add(Encoding.ASCII.GetString(aMessage.Array, aMessage.Offset, aMessage.Count));
+            }
+            return aMessages;
+        }
+
+        private static void Append(FrameDecoder decoder, string text)
+        {
+            var aBytes = Encoding.ASCII.GetBytes(text);
+            decoder.Append(aBytes, 0, aBytes.Length);
+        }
+
+        [Test]
+        public void SeveralMessagesInOneChunkTest()
+        {
+            var aDecoder = new FrameDecoder(16);
+            Append(aDecoder, Frame("{\"a\":1}") + Frame("{}") + "11{\"b\"");
+            Assert.AreEqual(new[] { "{\"a\":1}", "{}" }, ReadAll(aDecoder));
+            Assert.AreEqual(6, aDecoder.Pending);
+            Append(aDecoder, ":\"xyz\"}");
+            Assert.AreEqual(new[] { "{\"b\":\"xyz\"}" }, ReadAll(aDecoder));
+            Assert.AreEqual(0, aDecoder.Pending);
+        }
+
+        [Test]
+        public void SplitAtEveryByteTest()
+        {
+            var aJson    = new[] { "{\"type\":\"response\",\"invocation_id\":1}", "{\"x\":[" + string.Join(",", Enumerable.Range(0, 500)) + "]}", "{}" };
+            var aStream  = Encoding.ASCII.GetBytes(string.Concat(aJson.Select(Frame)));
+            var aDecoder = new FrameDecoder(4);
+            var aRead    = new List<string>();
+            foreach (var aByte in aStream)
+            {
+                aDecoder.Append(new[] { aByte }, 0, 1);
+                aRead.AddRange(ReadAll(aDecoder));
+            }
+            Assert.AreEqual(aJson, aRead);
+            Assert.AreEqual(0, aDecoder.Pending);
+        }
+
+        [Test]
+        public void ReceiveInPlaceTest()
+        {
+            var aJson    = "{\"problems\":\"" + new string('x', 100000) + "\"}";
+            var aStream  = Encoding.ASCII.GetBytes(Frame(aJson));
+            var aDecoder = new FrameDecoder(16384);
+            int aOffset  = 0;
+            var aRead    = new List<string>();
+            while (aOffset < aStream.Length)
+            {
+                var aBuffer = aDecoder.GetWriteBuffer(16384);
+                int aCount  = Math.Min(Math.Min(aBuffer.Count, 16384), aStream.Length - aOffset);
+                Buffer.BlockCopy(aStream, aOffset, aBuffer.Array, aBuffer.Offset, aCount);
+                aDecoder.Commit(aCount);
+                aOffset += aCount;
+                aRead.AddRange(ReadAll(aDecoder));
+            }
+            Assert.AreEqual(new[] { aJson }, aRead);
+        }
+
+        [Test]
+        public void ReadInPartsTest()
+        {
+            var aDecoder = new FrameDecoder(16);
+            var aParts   = new List<string>();
+            var aLast    = new List<bool>();
+            Append(aDecoder, "7{\"a\":");
+            ArraySegment<byte> aPart;
+            bool aIsLast = false;
+            Assert.IsTrue(aDecoder.TryReadPart(out aPart, out aIsLast));
+            aParts.Add(Encoding.ASCII.GetString(aPart.Array, aPart.Offset, aPart.Count));
+            aLast.Add(aIsLast);
+            Assert.IsFalse(aDecoder.TryReadPart(out aPart, out aIsLast));
+            Append(aDecoder, "1}" + Frame("{}"));
+            while (aDecoder.TryReadPart(out aPart, out aIsLast))
+            {
+                aParts.Add(Encoding.ASCII.GetString(aPart.Array, aPart.Offset, aPart.Count));
+                aLast.Add(aIsLast);
+            }
+            Assert.AreEqual(new[] { "{\"a\":", "1}", "{}" }, aParts);
+            Assert.AreEqual(new[] { false, true, true }, aLast);
+            Assert.AreEqual(0, aDecoder.Pending);
+        }
+
+        [Test]
+        public void InvalidPrefixTest()
+        {
+            var aDecoder = new FrameDecoder(16);
+            Append(aDecoder, "{}");
+            ArraySegment<byte> aMessage;
+            Assert.Throws<InvalidDataException>(() => aDecoder.TryRead(out aMessage));
+            aDecoder.Reset();
+            Append(aDecoder, "12345678901{");
+            Assert.Throws<InvalidDataException>(() => aDecoder.TryRead(out aMessage));
+            aDecoder.Reset();
+            Append(aDecoder, Frame("{}"));
+            Assert.AreEqual(new[] { "{}" }, ReadAll(aDecoder));
+        }
+    }
+}
@@ -0,0 +1,173 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Text;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin.RText.Protocol;
+    [TestFixture]
+    class JsonPushParserTests
+    {
+        private class TokenRecorder : IJsonHandler
+        {
+            internal readonly List<string> Tokens = new List<string>();
+
+            public void OnStartObject() { Tokens.Add("{"); }
+            public void OnEndObject() { Tokens.Add("}"); }
+            public void OnStartArray() { Tokens.Add("["); }
+            public void OnEndArray() { Tokens.Add("]"); }
+            public void OnProperty(string name) { Tokens.Add(name + ":"); }
+            public void OnString(string value) { Tokens.Add("'" + value + "'"); }
+            public void OnLiteral(string literal) { Tokens.Add(literal); }
+        }
+
+        private const string LOAD_RESPONSE = "{\"type\":\"response\",\"invocation_id\":3,\"problems\":[" +
+                                             "{\"file\":\"c:/a.atm\",\"problems\":[{\"message\":\"unresolved reference\",\"severity\":\"error\",\"line\":12}," +
+                                             "{\"message\":\"unresolved reference\",\"severity\":\"error\",\"line\":2}]}," +
+                                             "{\"file\":\"c:/b.atm\",\"extra\":{\"problems\":[{\"line\":1}]},\"problems\":[]}]," +
+                                             "\"total_problems\":2}";
+
+        private static void Feed(JsonPushParser parser, byte[] bytes, int chunkSize)
+        {
+            for (int i = 0; i < bytes.Length; i += chunkSize)
+            {
+                parser.Feed(bytes, i, Math.Min(chunkSize, bytes.Length - i));
+            }
+        }
+
+        [Test]
+        public void TokensTest()
+        {
+            var aJson     = Encoding.UTF8.GetBytes("{ \"a\" : [1, -2.5e3, true, null, \"x\\\"\\u00e4\\n\"], \"b\":{}, \"c\":[], \"\u00fc\":\"\u20ac\" }");
+            var aExpected = new[] { "{", "a:", "[", "1", "-2.5e3", "true", "null", "'x\"\u00e4\n'", "]", "b:", "{", "}", "c:", "[", "]", "\u00fc:", "'\u20ac'", "}" };
+            for (int aChunk = 1; aChunk <= aJson.Length; ++aChunk)
+            {
+                var aRecorder = new TokenRecorder();
+                var aParser   = new JsonPushParser(aRecorder);
+                Feed(aParser, aJson, aChunk);
+                Assert.IsTrue(aParser.IsComplete);
+                Assert.AreEqual(aExpected, aRecorder.Tokens);
+            }
+        }
+
+        [Test]
+        public void InvalidDocumentTest()
+        {
+            foreach (var aJson in new[] { "{\"a\" 1}", "{\"a\":1,}", "[1 2]", "{\"a\":\"\\q\"}", "{}}", "1", "{a:1}" })
+            {
+                var aBytes  = Encoding.UTF8.GetBytes(aJson);
+                var aParser = new JsonPushParser(new TokenRecorder());
+                Assert.Throws<InvalidDataException>(() => aParser.Feed(aBytes, 0, aBytes.Length));
+            }
+            var aIncomplete = new JsonPushParser(new TokenRecorder());
+            aIncomplete.Feed(Encoding.UTF8.GetBytes("{\"a\":[1"), 0, 7);
+            Assert.IsFalse(aIncomplete.IsComplete);
+        }
+
+        [Test]
+        public void LoadResponseTest()
+        {
+            var aFiles    = new List<string>();
+            var aBuilder  = new LoadResponseBuilder(x => aFiles.Add(x.file));
+            var aParser   = new JsonPushParser(aBuilder);
+            var aBytes    = Encoding.UTF8.GetBytes(LOAD_RESPONSE);
+            //the problems of a file are handed out as soon as they are complete
+            int aFirstEnd = LOAD_RESPONSE.IndexOf("]}") + 2;
+            aParser.Feed(aBytes, 0, aFirstEnd);
+            Assert.AreEqual(new[] { "c:/a.atm" }, aFiles);
+            aParser.Feed(aBytes, aFirstEnd, aBytes.Length - aFirstEnd);
+            Assert.IsTrue(aParser.IsComplete);
+            var aResponse = (LoadResponse)aBuilder.Response;
+            Assert.AreEqual("response", aResponse.type);
+            Assert.AreEqual(3, aResponse.invocation_id);
+            Assert.AreEqual(2, aResponse.total_problems);
+            Assert.AreEqual(new[] { "c:/a.atm", "c:/b.atm" }, aResponse.problems.Select(x => x.file).ToArray());
+            Assert.AreEqual(new[] { 12, 2 }, aResponse.problems[0].problems.Select(x => x.line).ToArray());
+            Assert.AreEqual(0, aResponse.problems[1].problems.Count);
+            Assert.AreSame(aResponse.problems[0].problems[0].message, aResponse.problems[0].problems[1].message);
+            Assert.AreEqual("error", aResponse.problems[0].problems[1].severity);
+        }
+
+        [Test]
+        public void ProgressResponseTest()
+        {
+            var aBuilder = new LoadResponseBuilder(null);
+            var aBytes   = Encoding.UTF8.GetBytes("{\"type\":\"progress\",\"invocation_id\":4,\"percentage\":50,\"message\":null}");
+            new JsonPushParser(aBuilder).Feed(aBytes, 0, aBytes.Length);
+            var aResponse = (LoadResponse)aBuilder.Response;
+            Assert.AreEqual("progress", aResponse.type);
+            Assert.AreEqual(50, aResponse.percentage);
+            Assert.IsNull(aResponse.message);
+            Assert.IsNull(aResponse.problems);
+        }
+
+        [Test]
+        public void CompletionAndLinkTargetsTest()
+        {
+            var aOptions = new AutoCompleteResponseBuilder();
+            var aBytes   = Encoding.UTF8.GetBytes("{\"type\":\"response\",\"invocation_id\":1,\"options\":[{\"display\":\"In\",\"insert\":\"In\",\"desc\":\"kind\"},{\"display\":\"Out\",\"insert\":\"Out\"}]}");
+            Feed(new JsonPushParser(aOptions), aBytes, 7);
+            var aCompletion = (AutoCompleteResponse)aOptions.Response;
+            Assert.AreEqual(new[] { "In", "Out" }, aCompletion.options.Select(x => x.insert).ToArray());
+            Assert.AreEqual("kind", aCompletion.options[0].desc);
+            Assert.IsNull(aCompletion.options[1].desc);
+
+            var aTargets = new LinkTargetsResponseBuilder();
+            aBytes       = Encoding.UTF8.GetBytes("{\"type\":\"response\",\"invocation_id\":2,\"begin_column\":3,\"end_column\":9,\"targets\":[{\"display\":\"/P1/UInt8\",\"file\":\"c:/a.atm\",\"line\":7,\"desc\":\"Type\"}]}");
+            Feed(new JsonPushParser(aTargets), aBytes, 5);
+            var aLinks = (LinkTargetsResponse)aTargets.Response;
+            Assert.AreEqual("3", aLinks.begin_column);
+            Assert.AreEqual("9", aLinks.end_column);
+            Assert.AreEqual(1, aLinks.targets.Count);
+            Assert.AreEqual("7", aLinks.targets[0].line);
+            Assert.AreEqual("/P1/UInt8", aLinks.targets[0].display);
+        }
+
+        [Test]
+        public void DispatchByInvocationIdTest()
+        {
+            var aIds        = new List<int>();
+            var aBuilders   = new Dictionary<int, ResponseBuilder> { { 5, new AutoCompleteResponseBuilder() }, { 6, new ContextInfoResponseBuilder() } };
+            var aBytes      = Encoding.UTF8.GetBytes("{\"type\":\"response\",\"invocation_id\":6,\"desc\":\"Port\"}");
+            var aDispatcher = new ResponseDispatcher(x => { aIds.Add(x); return aBuilders.ContainsKey(x) ? aBuilders[x] : null; });
+            Feed(new JsonPushParser(aDispatcher), aBytes, 3);
+            var aInfo = (ContextInfoResponse)aDispatcher.Response;
+            Assert.AreEqual(new[] { 6 }, aIds.ToArray());
+            Assert.AreEqual("response", aInfo.type);
+            Assert.AreEqual(6, aInfo.invocation_id);
+            Assert.AreEqual("Port", aInfo.desc);
+
+            //responses nobody waits for are parsed but not built
+            aBytes      = Encoding.UTF8.GetBytes("{\"type\":\"response\",\"invocation_id\":9,\"options\":[]}");
+            aDispatcher = new ResponseDispatcher(x => { aIds.Add(x); return aBuilders.ContainsKey(x) ? aBuilders[x] : null; });
+            new JsonPushParser(aDispatcher).Feed(aBytes, 0, aBytes.Length);
+            Assert.IsNull(aDispatcher.Response);
+            Assert.AreEqual(new[] { 6, 9 }, aIds.ToArray());
+        }
+
+        [Test]
+        public void DropResponseWithoutInvocationIdTest()
+        {
+            var aIds                           = new List<int>();
+            Func<int, ResponseBuilder> aCreate = x => { aIds.Add(x); return new LoadResponseBuilder(y => { }); };
+            //no invocation id at all
+            var aBytes      = Encoding.UTF8.GetBytes("{\"type\":\"response\",\"total_problems\":0,\"problems\":[]}");
+            var aDispatcher = new ResponseDispatcher(aCreate);
+            new JsonPushParser(aDispatcher).Feed(aBytes, 0, aBytes.Length);
+            Assert.IsNull(aDispatcher.Response);
+            Assert.IsFalse(aDispatcher.HasInvocationId);
+            //invalid invocation ids
+            foreach (var aId in new[] { "-1", "\"1\"", "null", "1.5" })
+            {
+                aBytes      = Encoding.UTF8.GetBytes("{\"type\":\"response\",\"invocation_id\":" + aId + ",\"total_problems\":0}");
+                aDispatcher = new ResponseDispatcher(aCreate);
+                new JsonPushParser(aDispatcher).Feed(aBytes, 0, aBytes.Length);
+                Assert.IsNull(aDispatcher.Response);
+                Assert.IsFalse(aDispatcher.HasInvocationId);
+            }
+            Assert.AreEqual(0, aIds.Count);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+﻿using System.Text;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin;
+    using RTextNppPlugin.Scintilla;
+    [TestFixture]
+    class LexerDiagnosticsTests
+    {
+        private static RTextLexerDiagnostic[] Lex(string content, int[] relexFrom, int[] relexTo)
+        {
+            return RTextDiagnosticsCliWrapper.GetDiagnostics(Encoding.UTF8.GetBytes(content), relexFrom, relexTo);
+        }
+
+        [Test]
+        public void UnterminatedTemplateRelexTest()
+        {
+            const string CONTENT = "A <template\nB b\nC c\n";
+            var aFull            = Lex(CONTENT, new int[0], new int[0]);
+            Assert.AreEqual(1, aFull.Length);
+            Assert.AreEqual((int)LexerDiagnosticKind.UnterminatedTemplate, aFull[0].Kind);
+            //edits inside the template relex from a later line, the template is still reported once
+            var aRelexed = Lex(CONTENT, new[] { 12, 16 }, new[] { CONTENT.Length, CONTENT.Length });
+            Assert.AreEqual(1, aRelexed.Length);
+            Assert.AreEqual(aFull[0], aRelexed[0]);
+        }
+
+        [Test]
+        public void UnterminatedTemplateAtDocumentEndRelexTest()
+        {
+            const string CONTENT = "A <template\nB b\n";
+            var aFull            = Lex(CONTENT, new int[0], new int[0]);
+            Assert.AreEqual(1, aFull.Length);
+            //typing at the end of the document relexes an empty range after the last line break
+            var aRelexed = Lex(CONTENT, new[] { CONTENT.Length }, new[] { CONTENT.Length });
+            CollectionAssert.AreEqual(aFull, aRelexed);
+        }
+
+        [Test]
+        public void UnclosedBracketPartialRelexTest()
+        {
+            const string CONTENT = "A {\nB\nC\nD\n";
+            var aFull            = Lex(CONTENT, new int[0], new int[0]);
+            Assert.AreEqual(1, aFull.Length);
+            Assert.AreEqual((int)LexerDiagnosticKind.UnclosedBracket, aFull[0].Kind);
+            //scintilla lexes only the visible lines after an edit
+            var aRelexed = Lex(CONTENT, new[] { 4 }, new[] { 8 });
+            CollectionAssert.AreEqual(aFull, aRelexed);
+            //and the remaining lines later on
+            aRelexed = Lex(CONTENT, new[] { 4, 8 }, new[] { 8, CONTENT.Length });
+            CollectionAssert.AreEqual(aFull, aRelexed);
+        }
+    }
+}
@@ -0,0 +1,120 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Text;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin;
+    using RTextNppPlugin.RText;
+    using RTextNppPlugin.RText.Protocol;
+    [TestFixture]
+    class MessagePackTests
+    {
+        private class TokenRecorder : IJsonHandler
+        {
+            internal readonly List<string> Tokens = new List<string>();
+
+            public void OnStartObject() { Tokens.Add("{"); }
+            public void OnEndObject() { Tokens.Add("}"); }
+            public void OnStartArray() { Tokens.Add("["); }
+            public void OnEndArray() { Tokens.Add("]"); }
+            public void OnProperty(string name) { Tokens.Add(name + ":"); }
+            public void OnString(string value) { Tokens.Add("'" + value + "'"); }
+            public void OnLiteral(string literal) { Tokens.Add(literal); }
+        }
+
+        private static List<string> ParseJson(string json)
+        {
+            var aRecorder = new TokenRecorder();
+            var aBytes    = Encoding.UTF8.GetBytes(json);
+            new JsonPushParser(aRecorder).Feed(aBytes, 0, aBytes.Length);
+            return aRecorder.Tokens;
+        }
+
+        private static List<string> Parse(byte[] bytes, int chunkSize)
+        {
+            var aRecorder = new TokenRecorder();
+            var aParser   = new MessagePackPushParser(aRecorder);
+            for (int i = 0; i < bytes.Length; i += chunkSize)
+            {
+                Assert.IsFalse(aParser.IsComplete);
+                aParser.Feed(bytes, i, Math.Min(chunkSize, bytes.Length - i));
+            }
+            Assert.IsTrue(aParser.IsComplete);
+            return aRecorder.Tokens;
+        }
+
+        [Test]
+        public void TokensTest()
+        {
+            //same tokens as the JSON text, for every size of the containers, strings and integers
+            string aJson = "{\"a\":[0,127,128,255,256,65535,65536,4294967296,-1,-32,-33,-128,-129,-32768,-32769,-2147483649,2.5,true,false,null]," +
+                           "\"s\":[\"\",\"ä€\",\"" + new string('x', 31) + "\",\"" + new string('y', 32) + "\",\"" + new string('z', 300) + "\"]," +
+                           "\"b\":{},\"c\":[],\"d\":[" + String.Join(",", Enumerable.Range(0, 20)) + "]," +
+                           "\"e\":{" + String.Join(",", Enumerable.Range(0, 20).Select(x => "\"k" + x + "\":" + x)) + "}}";
+            var aExpected = ParseJson(aJson);
+            var aBytes    = MessagePackEncoder.EncodeJson(aJson);
+            Assert.AreEqual(aExpected, Parse(aBytes, aBytes.Length));
+            for (int aChunk = 1; aChunk < 16; ++aChunk)
+            {
+                Assert.AreEqual(aExpected, Parse(aBytes, aChunk));
+            }
+        }
+
+        [Test]
+        public void RequestTest()
+        {
+            var aRequest = new AutoCompleteAndReferenceRequest
+            {
+                command       = Constants.Commands.LINK_TARGETS,
+                invocation_id = 300,
+                column        = 7,
+                context       = new[] { "Package P {", "  Port p: /P/T" }
+            };
+            var aTokens = Parse(MessagePackEncoder.Encode(aRequest), 3);
+            CollectionAssert.IsSubsetOf(new[] { "type:", "'request'", "command:", "'link_targets'", "invocation_id:", "300", "column:", "7", "'  Port p: /P/T'" }, aTokens);
+            //the frame has the length of the body as prefix, like for JSON
+            byte[] aFrame = RequestEncoder.Encode(aRequest, ProtocolEncoding.MessagePack);
+            var aDecoder  = new FrameDecoder(16);
+            aDecoder.Append(aFrame, 0, aFrame.Length);
+            ArraySegment<byte> aBody;
+            Assert.IsTrue(aDecoder.TryRead(out aBody));
+            Assert.AreEqual(aTokens, Parse(aBody.Array.Skip(aBody.Offset).Take(aBody.Count).ToArray(), aBody.Count));
+        }
+
+        [Test]
+        public void ResponseSizeTest()
+        {
+            string aJson = MockRTextService.Problems(1, 50, 20);
+            Assert.Less(MessagePackEncoder.EncodeJson(aJson).Length, Encoding.UTF8.GetByteCount(aJson));
+            var aBuilder = new LinkTargetsResponseBuilder();
+            var aBytes   = MessagePackEncoder.EncodeJson(MockRTextService.LinkTargets(4, 10));
+            new MessagePackPushParser(aBuilder).Feed(aBytes, 0, aBytes.Length);
+            var aResponse = (LinkTargetsResponse)aBuilder.Response;
+            Assert.AreEqual(4, aResponse.invocation_id);
+            Assert.AreEqual(10, aResponse.targets.Count);
+            Assert.AreEqual("/Package9/Type9", aResponse.targets[9].display);
+            Assert.AreEqual("9", aResponse.targets[9].line);
+        }
+
+        [Test]
+        public void InvalidDocumentTest()
+        {
+            var aDocuments = new[]
+            {
+                new byte[] { 0x01 },                        //no container
+                new byte[] { 0x81, 0x01, 0x02 },            //integer key
+                new byte[] { 0x91, 0xc4, 0x01, 0x00 },      //binary
+                new byte[] { 0x91, 0xd4, 0x01, 0x00 },      //extension
+                new byte[] { 0x90, 0x90 }                   //bytes after the document
+            };
+            foreach (var aDocument in aDocuments)
+            {
+                var aParser = new MessagePackPushParser(new TokenRecorder());
+                Assert.Throws<InvalidDataException>(() => aParser.Feed(aDocument, 0, aDocument.Length));
+            }
+        }
+    }
+}
@@ -0,0 +1,353 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Net;
+using System.Net.Sockets;
+using System.Text;
+using System.Text.RegularExpressions;
+using System.Threading;
+using System.Threading.Tasks;
+namespace Tests.RText
+{
+    using RTextNppPlugin;
+    using RTextNppPlugin.RText;
+    using RTextNppPlugin.RText.Protocol;
+    /**
+     * \brief   Stand-in for the RText service, so that the protocol stack of the plug-in can be exercised and measured
+     *          without the ruby back-end.
+     *
+     *          The service listens on a free port of localhost and speaks the length prefixed JSON protocol. Each request is
+     *          answered with the responses scripted for its command, e.g. a few progress messages followed by the
+     *          response. Recorded responses are replayed with the invocation id of the request. Latency delays each
+     *          response and ChunkSize splits it into several writes, like a busy back-end on a slow socket would.
+     *          Requests of a connection are answered one after the other, like the back-end does. A connection may switch
+     *          to MessagePack with a set_encoding request, unless AcceptsMessagePack is false.
+     */
+    internal sealed class MockRTextService : IDisposable
+    {
+        #region [Data Members]
+        private class RequestReader : IJsonHandler
+        {
+            private int _depth = 0;
+            private string _key = null;
+
+            internal string Command = null;
+            internal string Encoding = null;
+            internal int InvocationId = -1;
+
+            public void OnStartObject() { ++_depth; }
+            public void OnEndObject() { --_depth; }
+            public void OnStartArray() { ++_depth; }
+            public void OnEndArray() { --_depth; }
+            public void OnProperty(string name) { _key = (_depth == 1) ? name : null; }
+            public void OnString(string value)
+            {
+                if (_depth == 1 && _key == "command")
+                {
+                    Command = value;
+                }
+                else if (_depth == 1 && _key == "encoding")
+                {
+                    Encoding = value;
+                }
+            }
+            public void OnLiteral(string literal)
+            {
+                if (_depth == 1 && _key == "invocation_id")
+                {
+                    InvocationId = Int32.Parse(literal, CultureInfo.InvariantCulture);
+                }
+            }
+        }
+
+        private static readonly Regex INVOCATION_ID_REGEX                       = new Regex("\"invocation_id\"\\s*:\\s*-?\\d+", RegexOptions.Compiled);
+        private readonly TcpListener _listener                                   = new TcpListener(IPAddress.Loopback, 0);
+        private readonly Dictionary<string, Func<int, string>[]> _scripts        = new Dictionary<string, Func<int, string>[]>();
+        private readonly List<TcpClient> _clients                                = new List<TcpClient>();
+        private int _requestCount                                                = 0;
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Starts the service.
+         */
+        internal MockRTextService()
+        {
+            Latency            = 0;
+            ChunkSize          = 0;
+            AcceptsMessagePack = true;
+            _listener.Start();
+            Task.Factory.StartNew(Accept, TaskCreationOptions.LongRunning);
+        }
+
+        /**
+         * \brief   Gets the port the service listens on.
+         */
+        internal int Port { get { return ((IPEndPoint)_listener.LocalEndpoint).Port; } }
+
+        /**
+         * \brief   Gets or sets the time in milliseconds to wait before each response is sent.
+         */
+        internal int Latency { get; set; }
+
+        /**
+         * \brief   Gets or sets the number of bytes written at once, 0 writes each response at once.
+         */
+        internal int ChunkSize { get; set; }
+
+        /**
+         * \brief   Gets or sets whether a connection may switch to MessagePack, otherwise set_encoding is an unknown command
+         *          like for the ruby back-end.
+         */
+        internal bool AcceptsMessagePack { get; set; }
+
+        /**
+         * \brief   Gets the number of requests received so far.
+         */
+        internal int RequestCount { get { return Volatile.Read(ref _requestCount); } }
+
+        /**
+         * \brief   Scripts the responses to a command.
+         *
+         * \param   command     The command.
+         * \param   responses   Create the JSON bodies of the responses, in the order they are sent, from the invocation id
+         *                      of the request.
+         */
+        internal void Script(string command, params Func<int, string>[] responses)
+        {
+            lock (_scripts)
+            {
+                _scripts[command] = responses;
+            }
+        }
+
+        /**
+         * \brief   Replays recorded responses to a command, with the invocation id of the request.
+         */
+        internal void Replay(string command, params string[] responses)
+        {
+            var aResponses = new Func<int, string>[responses.Length];
+            for (int i = 0; i < responses.Length; ++i)
+            {
+                string aResponse = responses[i];
+                aResponses[i]    = x => INVOCATION_ID_REGEX.Replace(aResponse, "\"invocation_id\":" + x.ToString(CultureInfo.InvariantCulture));
+            }
+            Script(command, aResponses);
+        }
+
+        /**
+         * \brief   Replays the responses of a recorded session. Each line of the file holds a command and the JSON body of
+         *          one of its responses, separated by a tab.
+         */
+        internal void ReplayFile(string path)
+        {
+            var aResponses = new Dictionary<string, List<string>>();
+            foreach (var aLine in File.ReadAllLines(path, Encoding.UTF8))
+            {
+                int aTab = aLine.IndexOf('\t');
+                if (aTab > 0)
+                {
+                    string aCommand = aLine.Substring(0, aTab);
+                    if (!aResponses.ContainsKey(aCommand))
+                    {
+                        aResponses[aCommand] = new List<string>();
+                    }
+                    aResponses[aCommand].Add(aLine.Substring(aTab + 1));
+                }
+            }
+            foreach (var aResponse in aResponses)
+            {
+                Replay(aResponse.Key, aResponse.Value.ToArray());
+            }
+        }
+
+        /**
+         * \brief   Creates the body of a link_targets response with a number of targets, to script responses of any size.
+         */
+        internal static string LinkTargets(int invocationId, int targets)
+        {
+            var aBody = new StringBuilder(64 + targets * 96);
+            aBody.AppendFormat(CultureInfo.InvariantCulture, "{{\"type\":\"response\",\"invocation_id\":{0},\"begin_column\":4,\"end_column\":20,\"targets\":[", invocationId);
+            for (int i = 0; i < targets; ++i)
+            {
+                aBody.AppendFormat(CultureInfo.InvariantCulture, "{0}{{\"display\":\"/Package{1}/Type{1}\",\"file\":\"c:/workspace/file{2}.atm\",\"line\":{1},\"desc\":\"Type\"}}", (i == 0) ? "" : ",", i, i % 16);
+            }
+            return aBody.Append("]}").ToString();
+        }
+
+        /**
+         * \brief   Creates the body of a content_complete response with a number of options.
+         */
+        internal static string CompletionOptions(int invocationId, int options)
+        {
+            var aBody = new StringBuilder(64 + options * 64);
+            aBody.AppendFormat(CultureInfo.InvariantCulture, "{{\"type\":\"response\",\"invocation_id\":{0},\"options\":[", invocationId);
+            for (int i = 0; i < options; ++i)
+            {
+                aBody.AppendFormat(CultureInfo.InvariantCulture, "{0}{{\"display\":\"Option{1} <Type>\",\"insert\":\"Option{1}\",\"desc\":\"Feature\"}}", (i == 0) ? "" : ",", i);
+            }
+            return aBody.Append("]}").ToString();
+        }
+
+        /**
+         * \brief   Creates the body of a find_elements response with a number of elements.
+         */
+        internal static string Elements(int invocationId, int elements)
+        {
+            var aBody = new StringBuilder(64 + elements * 96);
+            aBody.AppendFormat(CultureInfo.InvariantCulture, "{{\"type\":\"response\",\"invocation_id\":{0},\"total_elements\":{1},\"elements\":[", invocationId, elements);
+            for (int i = 0; i < elements; ++i)
+            {
+                aBody.AppendFormat(CultureInfo.InvariantCulture, "{0}{{\"display\":\"Element{1} [Type]\",\"file\":\"c:/workspace/file{2}.atm\",\"line\":{1},\"desc\":\"Type\"}}", (i == 0) ? "" : ",", i, i % 16);
+            }
+            return aBody.Append("]}").ToString();
+        }
+
+        /**
+         * \brief   Creates the body of a load_model response with a number of files, each with a number of problems.
+         */
+        internal static string Problems(int invocationId, int files, int problemsPerFile)
+        {
+            var aBody = new StringBuilder(64 + files * (64 + problemsPerFile * 80));
+            aBody.AppendFormat(CultureInfo.InvariantCulture, "{{\"type\":\"response\",\"invocation_id\":{0},\"total_problems\":{1},\"problems\":[", invocationId, files * problemsPerFile);
+            for (int i = 0; i < files; ++i)
+            {
+                aBody.AppendFormat(CultureInfo.InvariantCulture, "{0}{{\"file\":\"c:/workspace/file{1}.atm\",\"problems\":[", (i == 0) ? "" : ",", i);
+                for (int j = 0; j < problemsPerFile; ++j)
+                {
+                    aBody.AppendFormat(CultureInfo.InvariantCulture, "{0}{{\"message\":\"unresolved reference /Package/Type{1}\",\"severity\":\"error\",\"line\":{1}}}", (j == 0) ? "" : ",", j);
+                }
+                aBody.Append("]}");
+            }
+            return aBody.Append("]}").ToString();
+        }
+
+        /**
+         * \brief   Frames a JSON body like the back-end does, i.e. prefixes it with its length in bytes.
+         */
+        internal static byte[] Frame(string json)
+        {
+            byte[] aBody   = Encoding.UTF8.GetBytes(json);
+            byte[] aPrefix = Encoding.ASCII.GetBytes(aBody.Length.ToString(CultureInfo.InvariantCulture));
+            byte[] aFrame  = new byte[aPrefix.Length + aBody.Length];
+            Buffer.BlockCopy(aPrefix, 0, aFrame, 0, aPrefix.Length);
+            Buffer.BlockCopy(aBody, 0, aFrame, aPrefix.Length, aBody.Length);
+            return aFrame;
+        }
+
+        public void Dispose()
+        {
+            _listener.Stop();
+            lock (_clients)
+            {
+                foreach (var aClient in _clients)
+                {
+                    aClient.Close();
+                }
+                _clients.Clear();
+            }
+        }
+        #endregion
+
+        #region [Helpers]
+        private void Accept()
+        {
+            try
+            {
+                while (true)
+                {
+                    var aClient = _listener.AcceptTcpClient();
+                    lock (_clients)
+                    {
+                        _clients.Add(aClient);
+                    }
+                    Task.Factory.StartNew(() => Serve(aClient), TaskCreationOptions.LongRunning);
+                }
+            }
+            catch (SocketException)
+            {
+                //stopped
+            }
+            catch (ObjectDisposedException)
+            {
+            }
+        }
+
+        private void Serve(TcpClient client)
+        {
+            var aFrames         = new FrameDecoder(4096);
+            bool aIsMessagePack = false;
+            try
+            {
+                var aStream = client.GetStream();
+                while (true)
+                {
+                    var aBuffer = aFrames.GetWriteBuffer(4096);
+                    int aRead   = aStream.Read(aBuffer.Array, aBuffer.Offset, aBuffer.Count);
+                    if (aRead == 0)
+                    {
+                        return;
+                    }
+                    aFrames.Commit(aRead);
+                    ArraySegment<byte> aRequest;
+                    while (aFrames.TryRead(out aRequest))
+                    {
+                        Answer(aStream, aRequest, ref aIsMessagePack);
+                    }
+                }
+            }
+            catch (IOException)
+            {
+                //connection closed
+            }
+            catch (ObjectDisposedException)
+            {
+            }
+        }
+
+        private void Answer(NetworkStream stream, ArraySegment<byte> request, ref bool isMessagePack)
+        {
+            var aReader = new RequestReader();
+            IResponseParser aParser = isMessagePack ? (IResponseParser)new MessagePackPushParser(aReader) : new JsonPushParser(aReader);
+            aParser.Feed(request.Array, request.Offset, request.Count);
+            Interlocked.Increment(ref _requestCount);
+            if (aReader.Command == Constants.Commands.SET_ENCODING && AcceptsMessagePack && aReader.Encoding == EncodingRequest.MESSAGE_PACK)
+            {
+                //the response is encoded like the request, the following messages with MessagePack
+                Send(stream, String.Format(CultureInfo.InvariantCulture, "{{\"type\":\"response\",\"invocation_id\":{0},\"encoding\":\"{1}\"}}", aReader.InvocationId, aReader.Encoding), isMessagePack);
+                isMessagePack = true;
+                return;
+            }
+            Func<int, string>[] aResponses = null;
+            lock (_scripts)
+            {
+                if (aReader.Command == null || !_scripts.TryGetValue(aReader.Command, out aResponses))
+                {
+                    //the back-end answers unknown commands with an error
+                    aResponses = new Func<int, string>[] { x => String.Format(CultureInfo.InvariantCulture, "{{\"type\":\"unknown_command_error\",\"invocation_id\":{0},\"command\":\"{1}\"}}", x, aReader.Command) };
+                }
+            }
+            foreach (var aResponse in aResponses)
+            {
+                if (Latency > 0)
+                {
+                    Thread.Sleep(Latency);
+                }
+                Send(stream, aResponse(aReader.InvocationId), isMessagePack);
+            }
+        }
+
+        private void Send(NetworkStream stream, string json, bool isMessagePack)
+        {
+            byte[] aFrame = isMessagePack ? RequestEncoder.Frame(MessagePackEncoder.EncodeJson(json)) : Frame(json);
+            int aChunk    = (ChunkSize > 0) ? ChunkSize : aFrame.Length;
+            for (int i = 0; i < aFrame.Length; i += aChunk)
+            {
+                stream.Write(aFrame, i, Math.Min(aChunk, aFrame.Length - i));
+                stream.Flush();
+            }
+        }
+        #endregion
+    }
+}
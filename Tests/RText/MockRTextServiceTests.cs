@@ -0,0 +1,192 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Threading.Tasks;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin;
+    using RTextNppPlugin.RText;
+    using RTextNppPlugin.RText.Protocol;
+    [TestFixture]
+    class MockRTextServiceTests
+    {
+        private static byte[] Request(string command, int invocationId)
+        {
+            return MockRTextService.Frame(String.Format("{{\"type\":\"request\",\"command\":\"{0}\",\"invocation_id\":{1},\"context\":[\"Port p: /A\"],\"column\":10}}", command, invocationId));
+        }
+
+        /**
+         * \brief   Receives responses with the protocol stack of the connector, i.e. straight into the frame decoder and
+         *          parsed while they arrive.
+         */
+        private static List<IResponseBase> Receive(SocketConnection connection, int count, ProtocolEncoding encoding = ProtocolEncoding.Json)
+        {
+            var aResponses                 = new List<IResponseBase>();
+            IResponseParser aParser        = null;
+            ResponseDispatcher aDispatcher = null;
+            while (aResponses.Count < count)
+            {
+                var aResult = connection.BeginReceive(null);
+                Assert.IsTrue(aResult.AsyncWaitHandle.WaitOne(5000));
+                connection.EndReceive(aResult);
+                Assert.IsTrue(connection.BytesToRead > 0);
+                ArraySegment<byte> aPart;
+                bool aIsLast = false;
+                while (true)
+                {
+                    if (aParser == null)
+                    {
+                        aDispatcher = new ResponseDispatcher(x => (x % 2 == 0) ? (ResponseBuilder)new LinkTargetsResponseBuilder() : new ResponseBaseBuilder());
+                        aParser     = (encoding == ProtocolEncoding.MessagePack) ? (IResponseParser)new MessagePackPushParser(aDispatcher) : new JsonPushParser(aDispatcher);
+                    }
+                    if (!connection.Frames.TryReadPart(out aPart, out aIsLast))
+                    {
+                        break;
+                    }
+                    aParser.Feed(aPart.Array, aPart.Offset, aPart.Count);
+                    if (aIsLast)
+                    {
+                        Assert.IsTrue(aParser.IsComplete);
+                        aResponses.Add(aDispatcher.Response);
+                        aParser = null;
+                    }
+                }
+            }
+            return aResponses;
+        }
+
+        private static SocketConnection Connect(MockRTextService service)
+        {
+            var aConnection = new SocketConnection();
+            var aResult     = aConnection.BeginConnect("localhost", service.Port, null);
+            Assert.IsTrue(aResult.AsyncWaitHandle.WaitOne(5000));
+            aConnection.EndConnect(aResult);
+            return aConnection;
+        }
+
+        [Test]
+        public void PipelinedRequestsTest()
+        {
+            using (var aService = new MockRTextService())
+            {
+                aService.ChunkSize = 5;
+                aService.Latency   = 1;
+                aService.Script(Constants.Commands.LINK_TARGETS,
+                                x => "{\"type\":\"progress\",\"invocation_id\":" + x + ",\"percentage\":50}",
+                                x => MockRTextService.LinkTargets(x, 100 + x));
+                var aConnection = Connect(aService);
+                var aRequests   = new List<byte>();
+                for (int i = 0; i < 3; ++i)
+                {
+                    aRequests.AddRange(Request(Constants.Commands.LINK_TARGETS, i * 2));
+                }
+                Assert.AreEqual(aRequests.Count, aConnection.SendRequest(aRequests.ToArray()));
+                var aResponses = Receive(aConnection, 6);
+                Assert.AreEqual(new[] { "progress", "response", "progress", "response", "progress", "response" }, aResponses.Select(x => x.type).ToArray());
+                Assert.AreEqual(new[] { 0, 0, 2, 2, 4, 4 }, aResponses.Select(x => x.invocation_id).ToArray());
+                Assert.AreEqual(new[] { 100, 102, 104 }, aResponses.Where(x => x.type == "response").Select(x => ((LinkTargetsResponse)x).targets.Count).ToArray());
+                Assert.AreEqual(3, aService.RequestCount);
+                aConnection.CleanUpSocket();
+            }
+        }
+
+        [Test]
+        public void LatestRequestOnlyTest()
+        {
+            using (var aService = new MockRTextService())
+            {
+                aService.Latency = 20;
+                aService.Script(Constants.Commands.LINK_TARGETS, x => MockRTextService.LinkTargets(x, 10 + x));
+                var aConnection   = Connect(aService);
+                var aPending      = new Dictionary<int, TaskCompletionSource<IResponseBase>>();
+                int aInvocationId = 0;
+                var aScheduler    = new RequestScheduler((request, priority) =>
+                {
+                    //even invocation ids are built as link targets by Receive
+                    request.invocation_id = aInvocationId;
+                    aInvocationId        += 2;
+                    var aResponse         = new TaskCompletionSource<IResponseBase>();
+                    aPending.Add(request.invocation_id, aResponse);
+                    aConnection.SendRequest(RequestEncoder.Encode(request, ProtocolEncoding.Json));
+                    return aResponse.Task;
+                }, request => Assert.Fail("Nothing is cancelled."));
+                //like typing while the first request is answered
+                var aTasks = new List<Task<IResponseBase>>();
+                for (int i = 0; i < 10; ++i)
+                {
+                    var aRequest = new AutoCompleteAndReferenceRequest { command = Constants.Commands.LINK_TARGETS, column = i, context = new[] { "Port p: /A" } };
+                    aTasks.Add(aScheduler.ExecuteLatestAsync(aRequest, RequestPriority.Normal));
+                }
+                for (int i = 0; i < 2; ++i)
+                {
+                    var aResponse = Receive(aConnection, 1)[0];
+                    aPending[aResponse.invocation_id].SetResult(aResponse);
+                }
+                Assert.AreEqual(2, aService.RequestCount);
+                Assert.AreEqual(new[] { 0, 2 }, aPending.Keys.OrderBy(x => x).ToArray());
+                Assert.IsTrue(aTasks.Take(9).All(x => x.IsCompleted && x.Result == null));
+                var aLast = (LinkTargetsResponse)aTasks[9].Result;
+                Assert.AreEqual(2, aLast.invocation_id);
+                Assert.AreEqual(12, aLast.targets.Count);
+                aConnection.CleanUpSocket();
+            }
+        }
+
+        [Test]
+        public void ReplayAndUnknownCommandTest()
+        {
+            using (var aService = new MockRTextService())
+            {
+                aService.Replay(Constants.Commands.CONTEXT_INFO, "{\"type\":\"response\", \"invocation_id\" : 77, \"desc\":\"Port\"}");
+                var aConnection = Connect(aService);
+                aConnection.SendRequest(Request(Constants.Commands.CONTEXT_INFO, 3));
+                var aResponse = Receive(aConnection, 1)[0];
+                Assert.AreEqual("response", aResponse.type);
+                Assert.AreEqual(3, aResponse.invocation_id);
+                aConnection.SendRequest(Request(Constants.Commands.FIND_ELEMENTS, 5));
+                aResponse = Receive(aConnection, 1)[0];
+                Assert.AreEqual(Constants.Commands.ERROR, aResponse.type);
+                Assert.AreEqual(5, aResponse.invocation_id);
+                aConnection.CleanUpSocket();
+            }
+        }
+
+        [Test]
+        public void MessagePackEncodingTest()
+        {
+            using (var aService = new MockRTextService())
+            {
+                aService.ChunkSize = 7;
+                aService.Script(Constants.Commands.LINK_TARGETS, x => MockRTextService.LinkTargets(x, 20));
+                var aConnection = Connect(aService);
+                Assert.AreEqual(ProtocolEncoding.MessagePack, EncodingNegotiator.Negotiate(aConnection, ProtocolEncoding.MessagePack, 1, 5000));
+                var aRequest = new AutoCompleteAndReferenceRequest { command = Constants.Commands.LINK_TARGETS, invocation_id = 2, column = 3, context = new[] { "a" } };
+                aConnection.SendRequest(RequestEncoder.Encode(aRequest, ProtocolEncoding.MessagePack));
+                var aResponse = (LinkTargetsResponse)Receive(aConnection, 1, ProtocolEncoding.MessagePack)[0];
+                Assert.AreEqual(2, aResponse.invocation_id);
+                Assert.AreEqual(20, aResponse.targets.Count);
+                Assert.AreEqual(2, aService.RequestCount);
+                aConnection.CleanUpSocket();
+            }
+        }
+
+        [Test]
+        public void JsonFallbackTest()
+        {
+            using (var aService = new MockRTextService())
+            {
+                //like the ruby back-end, which doesn't know the command
+                aService.AcceptsMessagePack = false;
+                var aConnection = Connect(aService);
+                Assert.AreEqual(ProtocolEncoding.Json, EncodingNegotiator.Negotiate(aConnection, ProtocolEncoding.MessagePack, 1, 5000));
+                aConnection.SendRequest(Request(Constants.Commands.CONTEXT_INFO, 2));
+                var aResponse = Receive(aConnection, 1)[0];
+                Assert.AreEqual(Constants.Commands.ERROR, aResponse.type);
+                Assert.AreEqual(2, aResponse.invocation_id);
+                aConnection.CleanUpSocket();
+            }
+        }
+    }
+}
@@ -0,0 +1,106 @@
+﻿using System.Linq;
+using System.Text;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin;
+    using RTextNppPlugin.Scintilla;
+    [TestFixture]
+    class OutlineTests
+    {
+        private const string CONTENT = "Container c {\n  Child a, f: 1,\n    g: [1, 2]\n  role:\n    Child b\n  roles: [\n    Child c {\n      Child d\n    }\n  ]\n}\nOther o,\n  x: 1\n";
+
+        private static RTextDocumentCliWrapper Lex(string content, int endPos)
+        {
+            var aDocument = new RTextDocumentCliWrapper(Encoding.UTF8.GetBytes(content));
+            aDocument.Lex(0, endPos);
+            return aDocument;
+        }
+
+        private static OutlineEntry[] ToOutline(RTextLexerOutlineEntry[] entries)
+        {
+            return entries.Select(x => new OutlineEntry { Position = x.Position, Length = x.Length, NamePosition = x.NamePosition, NameLength = x.NameLength, Line = x.Line, Depth = x.Depth, Parent = x.Parent }).ToArray();
+        }
+
+        [Test]
+        public void NestedElementsTest()
+        {
+            using (var aDocument = Lex(CONTENT, CONTENT.Length))
+            {
+                var aOutline = aDocument.GetOutline();
+                CollectionAssert.AreEqual(new[] { 0, 1, 4, 6, 7, 11 }, aOutline.Select(x => x.Line));
+                CollectionAssert.AreEqual(new[] { 0, 1, 1, 1, 2, 0 }, aOutline.Select(x => x.Depth));
+                CollectionAssert.AreEqual(new[] { -1, 0, 0, 0, 3, -1 }, aOutline.Select(x => x.Parent));
+                Assert.AreEqual(4, aDocument.FindOutlineEntry(CONTENT.IndexOf("Child d")));
+                Assert.AreEqual(1, aDocument.FindOutlineEntry(CONTENT.IndexOf("g: [")));
+                Assert.AreEqual(0, aDocument.FindOutlineEntry(CONTENT.IndexOf("}\nOther")));
+                Assert.AreEqual(5, aDocument.FindOutlineEntry(CONTENT.IndexOf("x: 1")));
+            }
+        }
+
+        [Test]
+        public void PartiallyStyledTest()
+        {
+            //scintilla styles lazily, only the styled part of the document is outlined
+            int aEndStyled = CONTENT.IndexOf("  roles");
+            using (var aDocument = Lex(CONTENT, aEndStyled))
+            using (var aFull = Lex(CONTENT, CONTENT.Length))
+            {
+                var aOutline = aDocument.GetOutline();
+                CollectionAssert.AreEqual(new[] { 0, 1, 4 }, aOutline.Select(x => x.Line));
+                Assert.AreEqual(-1, aOutline[0].Length);
+                Assert.AreEqual(2, aDocument.FindOutlineEntry(CONTENT.IndexOf("Child d")));
+                aDocument.Lex(aEndStyled, CONTENT.Length);
+                CollectionAssert.AreEqual(aFull.GetOutline(), aDocument.GetOutline());
+            }
+        }
+
+        [Test]
+        public void EditRelexTest()
+        {
+            int aPosition = CONTENT.IndexOf("      Child d");
+            string aEdited = CONTENT.Insert(aPosition, "      Child e {\n        Child f\n      }\n");
+            using (var aDocument = Lex(CONTENT, CONTENT.Length))
+            using (var aFull = Lex(aEdited, aEdited.Length))
+            {
+                aDocument.Edit(Encoding.UTF8.GetBytes(aEdited), aPosition);
+                aDocument.Lex(aPosition, aEdited.Length);
+                CollectionAssert.AreEqual(aFull.GetOutline(), aDocument.GetOutline());
+                Assert.AreEqual(5, aDocument.FindOutlineEntry(aEdited.IndexOf("Child f")));
+                Assert.AreEqual(4, aDocument.GetOutline()[5].Parent);
+            }
+        }
+
+        [Test]
+        public void GoToEnclosingElementTest()
+        {
+            using (var aDocument = Lex(CONTENT, CONTENT.Length))
+            {
+                var aOutline = ToOutline(aDocument.GetOutline());
+                //caret inside an element goes to the element, caret on the line of an element to the enclosing one
+                Assert.AreEqual(1, OutlineNavigation.FindEnclosingEntry(aOutline, aDocument.FindOutlineEntry(CONTENT.IndexOf("g: [")), 2));
+                Assert.AreEqual(3, OutlineNavigation.FindEnclosingEntry(aOutline, aDocument.FindOutlineEntry(CONTENT.IndexOf("Child d")), 7));
+                Assert.AreEqual(-1, OutlineNavigation.FindEnclosingEntry(aOutline, aDocument.FindOutlineEntry(CONTENT.IndexOf("Other")), 11));
+                Assert.AreEqual(-1, OutlineNavigation.FindEnclosingEntry(aOutline, -1, 0));
+            }
+        }
+
+        [Test]
+        public void QualifiedNameTest()
+        {
+            const string aContent = "Package \"P 1\" {\n  Type UInt8\n  Type\n}\n";
+            using (var aNested = Lex(CONTENT, CONTENT.Length))
+            using (var aDocument = Lex(aContent, aContent.Length))
+            {
+                var aNestedOutline = ToOutline(aNested.GetOutline());
+                var aOutline       = ToOutline(aDocument.GetOutline());
+                Assert.AreEqual("/c/c/d", OutlineNavigation.GetQualifiedName(aNestedOutline, 4, (x, y) => CONTENT.Substring(x, y - x)));
+                Assert.AreEqual("/o", OutlineNavigation.GetQualifiedName(aNestedOutline, 5, (x, y) => CONTENT.Substring(x, y - x)));
+                //quotes are not part of the name, unnamed elements can't be referenced
+                Assert.AreEqual("/P 1/UInt8", OutlineNavigation.GetQualifiedName(aOutline, 1, (x, y) => aContent.Substring(x, y - x)));
+                Assert.IsNull(OutlineNavigation.GetQualifiedName(aOutline, 2, (x, y) => aContent.Substring(x, y - x)));
+                Assert.IsNull(OutlineNavigation.GetQualifiedName(aOutline, -1, (x, y) => aContent.Substring(x, y - x)));
+            }
+        }
+    }
+}
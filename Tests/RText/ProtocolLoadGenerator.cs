@@ -0,0 +1,338 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+namespace Tests.RText
+{
+    using RTextNppPlugin;
+    using RTextNppPlugin.RText;
+    using RTextNppPlugin.RText.Protocol;
+    using RTextNppPlugin.Utilities;
+    /**
+     * \brief   Sends a mix of requests to an RText service and measures how long each command takes.
+     *
+     *          Requests are encoded and responses are received and parsed with the code of the connector, i.e.
+     *          RequestEncoder, SocketConnection, FrameDecoder, JsonPushParser and the response builders. Up to Concurrency
+     *          requests are in flight at a time, optionally paced to RequestsPerSecond. For each command the latency from
+     *          sending a request to its complete response is recorded in microseconds, along with the size of the
+     *          responses, so that changes of the client stack can be compared against a MockRTextService. The encoding of
+     *          the messages is negotiated like the connector does, so both encodings can be compared as well.
+     */
+    internal sealed class ProtocolLoadGenerator
+    {
+        #region [Data Members]
+        /**
+         * \brief   Measurements of one command.
+         */
+        internal sealed class CommandStatistics
+        {
+            internal readonly LatencyHistogram Latency = new LatencyHistogram();   //!< Microseconds from sending a request to its complete response.
+            internal readonly LatencyHistogram Bytes   = new LatencyHistogram();   //!< Bytes received per request, including progress responses.
+        }
+
+        private class PendingRequest
+        {
+            internal string Command;
+            internal long SentAt;       //!< Stopwatch timestamp.
+            internal long Bytes;
+        }
+
+        private readonly int _port                                                  = 0;
+        private readonly List<KeyValuePair<string, int>> _mix                       = new List<KeyValuePair<string, int>>();
+        private readonly Dictionary<string, CommandStatistics> _statistics          = new Dictionary<string, CommandStatistics>();
+        private readonly Dictionary<int, PendingRequest> _pending                   = new Dictionary<int, PendingRequest>();
+        private TimeSpan _elapsed                                                   = TimeSpan.Zero;
+        private ProtocolEncoding _negotiatedEncoding                                = ProtocolEncoding.Json;
+        private const int RECEIVE_TIMEOUT                                           = 10000;
+        #endregion
+
+        #region [Interface]
+        /**
+         * \brief   Creates a generator for the service listening on a port of localhost.
+         */
+        internal ProtocolLoadGenerator(int port)
+        {
+            _port             = port;
+            Concurrency       = 1;
+            RequestsPerSecond = 0;
+            Encoding          = ProtocolEncoding.Json;
+        }
+
+        /**
+         * \brief   Gets or sets the maximum number of requests without response.
+         */
+        internal int Concurrency { get; set; }
+
+        /**
+         * \brief   Gets or sets the rate at which requests are sent, 0 sends them as fast as responses arrive.
+         */
+        internal int RequestsPerSecond { get; set; }
+
+        /**
+         * \brief   Gets or sets the encoding asked for when connecting.
+         */
+        internal ProtocolEncoding Encoding { get; set; }
+
+        /**
+         * \brief   Gets the encoding the service agreed on in the last run.
+         */
+        internal ProtocolEncoding NegotiatedEncoding { get { return _negotiatedEncoding; } }
+
+        /**
+         * \brief   Gets the measurements by command.
+         */
+        internal IDictionary<string, CommandStatistics> Statistics { get { return _statistics; } }
+
+        /**
+         * \brief   Gets the duration of the last run.
+         */
+        internal TimeSpan Elapsed { get { return _elapsed; } }
+
+        /**
+         * \brief   Adds a command to the request mix.
+         *
+         * \param   command The command.
+         * \param   weight  The share of the command, relative to the weights of the other commands.
+         */
+        internal void AddCommand(string command, int weight)
+        {
+            _mix.Add(new KeyValuePair<string, int>(command, weight));
+            _statistics[command] = new CommandStatistics();
+        }
+
+        /**
+         * \brief   Adds the mix of an editing session: mostly completion and link targets, some context info and element
+         *          searches and the occasional model load.
+         */
+        internal void AddEditingMix()
+        {
+            AddCommand(Constants.Commands.CONTENT_COMPLETION, 40);
+            AddCommand(Constants.Commands.LINK_TARGETS, 30);
+            AddCommand(Constants.Commands.CONTEXT_INFO, 20);
+            AddCommand(Constants.Commands.FIND_ELEMENTS, 9);
+            AddCommand(Constants.Commands.LOAD_MODEL, 1);
+        }
+
+        /**
+         * \brief   Sends requests and waits for all responses.
+         *
+         * \param   requests    The number of requests.
+         * \param   seed        Seed of the random choice of commands, so that runs can be repeated.
+         *
+         * \exception   TimeoutException    The service stopped responding.
+         */
+        internal void Run(int requests, int seed)
+        {
+            var aRandom      = new Random(seed);
+            int aTotalWeight = _mix.Sum(x => x.Value);
+            var aConnection  = new SocketConnection();
+            var aConnected   = aConnection.BeginConnect("localhost", _port, null);
+            if (!aConnected.AsyncWaitHandle.WaitOne(RECEIVE_TIMEOUT))
+            {
+                throw new TimeoutException("Could not connect to the service.");
+            }
+            aConnection.EndConnect(aConnected);
+            _negotiatedEncoding = EncodingNegotiator.Negotiate(aConnection, Encoding, requests, RECEIVE_TIMEOUT);
+            using (var aSlots = new SemaphoreSlim(Concurrency))
+            {
+                var aStopwatch = Stopwatch.StartNew();
+                var aReceiver  = Task.Factory.StartNew(() => Receive(aConnection, requests, aSlots), TaskCreationOptions.LongRunning);
+                for (int i = 0; i < requests; ++i)
+                {
+                    if (!aSlots.Wait(RECEIVE_TIMEOUT))
+                    {
+                        throw new TimeoutException("The service didn't respond.");
+                    }
+                    if (RequestsPerSecond > 0)
+                    {
+                        //paced against the start, so that a slow response doesn't lower the rate
+                        long aDue = (long)i * 1000 / RequestsPerSecond - aStopwatch.ElapsedMilliseconds;
+                        if (aDue > 0)
+                        {
+                            Thread.Sleep((int)aDue);
+                        }
+                    }
+                    var aRequest  = CreateRequest(Choose(aRandom, aTotalWeight), i);
+                    byte[] aBytes = RequestEncoder.Encode(aRequest, _negotiatedEncoding);
+                    lock (_pending)
+                    {
+                        _pending[i] = new PendingRequest { Command = aRequest.command, SentAt = Stopwatch.GetTimestamp() };
+                    }
+                    aConnection.SendRequest(aBytes);
+                }
+                if (!aReceiver.Wait(RECEIVE_TIMEOUT))
+                {
+                    throw new TimeoutException("The service didn't respond.");
+                }
+                _elapsed = aStopwatch.Elapsed;
+            }
+            aConnection.CleanUpSocket();
+        }
+
+        /**
+         * \brief   Formats the measurements as a table with one line per command, latencies in milliseconds.
+         */
+        internal string Report()
+        {
+            var aReport     = new StringBuilder();
+            double aSeconds = Math.Max(_elapsed.TotalSeconds, 1e-6);
+            aReport.AppendFormat(CultureInfo.InvariantCulture, "{0,-18}{1,8}{2,10}{3,9}{4,9}{5,9}{6,9}{7,12}\n", "command", "count", "req/s", "p50", "p90", "p99", "max", "KiB/s");
+            foreach (var aCommand in _statistics)
+            {
+                var aLatency = aCommand.Value.Latency;
+                aReport.AppendFormat(CultureInfo.InvariantCulture, "{0,-18}{1,8}{2,10:F1}{3,9:F2}{4,9:F2}{5,9:F2}{6,9:F2}{7,12:F1}\n",
+                                     aCommand.Key,
+                                     aLatency.Count,
+                                     aLatency.Count / aSeconds,
+                                     aLatency.GetValueAtPercentile(50) / 1000.0,
+                                     aLatency.GetValueAtPercentile(90) / 1000.0,
+                                     aLatency.GetValueAtPercentile(99) / 1000.0,
+                                     aLatency.Max / 1000.0,
+                                     aCommand.Value.Bytes.Sum / 1024.0 / aSeconds);
+            }
+            return aReport.ToString();
+        }
+        #endregion
+
+        #region [Helpers]
+        private string Choose(Random random, int totalWeight)
+        {
+            int aValue = random.Next(totalWeight);
+            foreach (var aCommand in _mix)
+            {
+                if (aValue < aCommand.Value)
+                {
+                    return aCommand.Key;
+                }
+                aValue -= aCommand.Value;
+            }
+            return _mix[_mix.Count - 1].Key;
+        }
+
+        private static RequestBase CreateRequest(string command, int invocationId)
+        {
+            switch (command)
+            {
+                case Constants.Commands.CONTENT_COMPLETION:
+                case Constants.Commands.LINK_TARGETS:
+                case Constants.Commands.CONTEXT_INFO:
+                    return new AutoCompleteAndReferenceRequest
+                    {
+                        command       = command,
+                        invocation_id = invocationId,
+                        column        = 18,
+                        context       = new[] { "Package P1 {", "  Type T1 {", "    Port p: /P1/UInt" }
+                    };
+                case Constants.Commands.FIND_ELEMENTS:
+                    return new FindElementRequest { command = command, invocation_id = invocationId, search_pattern = "Type" };
+                default:
+                    return new RequestBase { command = command, invocation_id = invocationId };
+            }
+        }
+
+        private static ResponseBuilder CreateBuilder(string command)
+        {
+            switch (command)
+            {
+                case Constants.Commands.LOAD_MODEL:
+                    return new LoadResponseBuilder(null);
+                case Constants.Commands.LINK_TARGETS:
+                    return new LinkTargetsResponseBuilder();
+                case Constants.Commands.CONTENT_COMPLETION:
+                    return new AutoCompleteResponseBuilder();
+                case Constants.Commands.FIND_ELEMENTS:
+                    return new FindElementsResponseBuilder();
+                case Constants.Commands.CONTEXT_INFO:
+                    return new ContextInfoResponseBuilder();
+                default:
+                    return new ResponseBaseBuilder();
+            }
+        }
+
+        private ResponseBuilder CreateBuilder(int invocationId)
+        {
+            lock (_pending)
+            {
+                PendingRequest aRequest = null;
+                return _pending.TryGetValue(invocationId, out aRequest) ? CreateBuilder(aRequest.Command) : null;
+            }
+        }
+
+        private void Receive(SocketConnection connection, int requests, SemaphoreSlim slots)
+        {
+            int aCompleted                 = 0;
+            long aBytes                    = 0;
+            IResponseParser aParser        = null;
+            ResponseDispatcher aDispatcher = null;
+            while (aCompleted < requests)
+            {
+                var aReceived = connection.BeginReceive(null);
+                if (!aReceived.AsyncWaitHandle.WaitOne(RECEIVE_TIMEOUT))
+                {
+                    throw new TimeoutException("The service didn't respond.");
+                }
+                connection.EndReceive(aReceived);
+                if (connection.BytesToRead == 0)
+                {
+                    throw new IOException("The service closed the connection.");
+                }
+                ArraySegment<byte> aPart;
+                bool aIsLast = false;
+                while (true)
+                {
+                    if (aParser == null)
+                    {
+                        aDispatcher = new ResponseDispatcher(CreateBuilder);
+                        aParser     = (_negotiatedEncoding == ProtocolEncoding.MessagePack) ? (IResponseParser)new MessagePackPushParser(aDispatcher) : new JsonPushParser(aDispatcher);
+                    }
+                    if (!connection.Frames.TryReadPart(out aPart, out aIsLast))
+                    {
+                        break;
+                    }
+                    aParser.Feed(aPart.Array, aPart.Offset, aPart.Count);
+                    aBytes += aPart.Count;
+                    if (aIsLast)
+                    {
+                        var aResponse = aDispatcher.Response;
+                        aParser       = null;
+                        if (aResponse != null && Complete(aResponse, aBytes))
+                        {
+                            ++aCompleted;
+                            slots.Release();
+                        }
+                        aBytes = 0;
+                    }
+                }
+            }
+        }
+
+        private bool Complete(IResponseBase response, long bytes)
+        {
+            long aNow               = Stopwatch.GetTimestamp();
+            PendingRequest aRequest = null;
+            lock (_pending)
+            {
+                if (!_pending.TryGetValue(response.invocation_id, out aRequest))
+                {
+                    return false;
+                }
+                aRequest.Bytes += bytes;
+                if (response.type == Constants.Commands.PROGRESS)
+                {
+                    return false;
+                }
+                _pending.Remove(response.invocation_id);
+            }
+            var aStatistics = _statistics[aRequest.Command];
+            aStatistics.Latency.Record((aNow - aRequest.SentAt) * 1000000 / Stopwatch.Frequency);
+            aStatistics.Bytes.Record(aRequest.Bytes);
+            return true;
+        }
+        #endregion
+    }
+}
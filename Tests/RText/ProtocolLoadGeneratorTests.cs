@@ -0,0 +1,80 @@
+﻿using System;
+using System.Linq;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin;
+    using RTextNppPlugin.RText.Protocol;
+    [TestFixture]
+    class ProtocolLoadGeneratorTests
+    {
+        private static MockRTextService CreateService()
+        {
+            var aService = new MockRTextService();
+            aService.Script(Constants.Commands.CONTENT_COMPLETION, x => MockRTextService.CompletionOptions(x, 50));
+            aService.Script(Constants.Commands.LINK_TARGETS, x => MockRTextService.LinkTargets(x, 5));
+            aService.Script(Constants.Commands.CONTEXT_INFO, x => "{\"type\":\"response\",\"invocation_id\":" + x + ",\"desc\":\"Port\"}");
+            aService.Script(Constants.Commands.FIND_ELEMENTS, x => MockRTextService.Elements(x, 200));
+            aService.Script(Constants.Commands.LOAD_MODEL,
+                            x => "{\"type\":\"progress\",\"invocation_id\":" + x + ",\"percentage\":50}",
+                            x => MockRTextService.Problems(x, 20, 10));
+            return aService;
+        }
+
+        [Test]
+        public void EditingMixTest()
+        {
+            using (var aService = CreateService())
+            {
+                aService.ChunkSize = 1024;
+                var aGenerator     = new ProtocolLoadGenerator(aService.Port);
+                aGenerator.Concurrency = 4;
+                aGenerator.AddEditingMix();
+                aGenerator.Run(300, 1);
+                Assert.AreEqual(300, aService.RequestCount);
+                Assert.AreEqual(300, aGenerator.Statistics.Values.Sum(x => x.Latency.Count));
+                foreach (var aCommand in aGenerator.Statistics)
+                {
+                    Assert.AreEqual(aCommand.Value.Latency.Count, aCommand.Value.Bytes.Count);
+                }
+                var aCompletion = aGenerator.Statistics[Constants.Commands.CONTENT_COMPLETION];
+                Assert.Greater(aCompletion.Latency.Count, aGenerator.Statistics[Constants.Commands.CONTEXT_INFO].Latency.Count);
+                Assert.AreEqual(MockRTextService.CompletionOptions(0, 50).Length, aCompletion.Bytes.GetValueAtPercentile(0), 2.0);
+                Assert.AreEqual(6, aGenerator.Report().Split(new[] { '\n' }, StringSplitOptions.RemoveEmptyEntries).Length);
+            }
+        }
+
+        [Test]
+        public void MessagePackTest()
+        {
+            using (var aService = CreateService())
+            {
+                var aGenerator = new ProtocolLoadGenerator(aService.Port);
+                aGenerator.Concurrency = 4;
+                aGenerator.Encoding    = ProtocolEncoding.MessagePack;
+                aGenerator.AddEditingMix();
+                aGenerator.Run(100, 1);
+                Assert.AreEqual(ProtocolEncoding.MessagePack, aGenerator.NegotiatedEncoding);
+                Assert.AreEqual(100, aGenerator.Statistics.Values.Sum(x => x.Latency.Count));
+                var aCompletion = aGenerator.Statistics[Constants.Commands.CONTENT_COMPLETION];
+                Assert.Less(aCompletion.Bytes.GetValueAtPercentile(100), MockRTextService.CompletionOptions(0, 50).Length);
+            }
+        }
+
+        [Test]
+        public void RateTest()
+        {
+            using (var aService = CreateService())
+            {
+                var aGenerator = new ProtocolLoadGenerator(aService.Port);
+                aGenerator.RequestsPerSecond = 500;
+                aGenerator.Concurrency       = 8;
+                aGenerator.AddCommand(Constants.Commands.CONTEXT_INFO, 1);
+                aGenerator.Run(51, 1);
+                //the last of 51 requests is due after 100 ms
+                Assert.Greater(aGenerator.Elapsed.TotalMilliseconds, 95.0);
+                Assert.AreEqual(51, aGenerator.Statistics[Constants.Commands.CONTEXT_INFO].Latency.Count);
+            }
+        }
+    }
+}
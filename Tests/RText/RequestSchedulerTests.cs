@@ -0,0 +1,136 @@
+﻿using System.Collections.Generic;
+using System.Linq;
+using System.Threading.Tasks;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin.RText;
+    using RTextNppPlugin.RText.Protocol;
+    using RTextNppPlugin;
+    [TestFixture]
+    class RequestSchedulerTests
+    {
+        private readonly List<AutoCompleteAndReferenceRequest> _executed        = new List<AutoCompleteAndReferenceRequest>();
+        private readonly List<RequestBase> _abandoned                           = new List<RequestBase>();
+        private readonly List<TaskCompletionSource<IResponseBase>> _responses   = new List<TaskCompletionSource<IResponseBase>>();
+
+        private RequestScheduler CreateScheduler()
+        {
+            _executed.Clear();
+            _abandoned.Clear();
+            _responses.Clear();
+            return new RequestScheduler((request, priority) =>
+            {
+                var aResponse = new TaskCompletionSource<IResponseBase>();
+                _executed.Add(request);
+                _responses.Add(aResponse);
+                return aResponse.Task;
+            },
+            request =>
+            {
+                _abandoned.Add(request);
+                _responses[_executed.IndexOf((AutoCompleteAndReferenceRequest)request)].TrySetResult(null);
+            });
+        }
+
+        private static AutoCompleteAndReferenceRequest Request(string command, int column, params string[] context)
+        {
+            return new AutoCompleteAndReferenceRequest { command = command, column = column, context = context };
+        }
+
+        [Test]
+        public void SupersedeTest()
+        {
+            var aScheduler = CreateScheduler();
+            var aFirst     = Request(Constants.Commands.CONTENT_COMPLETION, 3, "Type ");
+            var aSecond    = Request(Constants.Commands.CONTENT_COMPLETION, 4, "Type I");
+            var aFirstTask = aScheduler.ExecuteLatestAsync(aFirst, RequestPriority.High);
+            var aLastTask  = aScheduler.ExecuteLatestAsync(aSecond, RequestPriority.High);
+            Assert.IsTrue(aFirstTask.IsCompleted);
+            Assert.IsNull(aFirstTask.Result);
+            Assert.IsFalse(aScheduler.IsLatest(aFirst));
+            Assert.IsTrue(aScheduler.IsLatest(aSecond));
+            //the first request is still in flight, so the second one waits for its response
+            Assert.AreEqual(new[] { aFirst }, _executed.ToArray());
+            _responses[0].SetResult(new AutoCompleteResponse());
+            Assert.AreEqual(new[] { aFirst, aSecond }, _executed.ToArray());
+            Assert.IsNull(aFirstTask.Result);
+            var aResponse = new AutoCompleteResponse();
+            _responses[1].SetResult(aResponse);
+            Assert.AreSame(aResponse, aLastTask.Result);
+            //a completed request isn't abandoned when the next one is issued, which is sent right away
+            aScheduler.ExecuteLatestAsync(Request(Constants.Commands.CONTENT_COMPLETION, 5, "Type In"), RequestPriority.High);
+            Assert.AreEqual(3, _executed.Count);
+            Assert.AreEqual(0, _abandoned.Count);
+        }
+
+        [Test]
+        public void ReplaceWaitingTest()
+        {
+            var aScheduler = CreateScheduler();
+            var aTasks     = new List<Task<IResponseBase>>();
+            for (int i = 0; i < 4; ++i)
+            {
+                aTasks.Add(aScheduler.ExecuteLatestAsync(Request(Constants.Commands.LINK_TARGETS, i, "Port p: /A"), RequestPriority.Normal));
+            }
+            //a waiting request with the same context shares the response
+            var aSame = Request(Constants.Commands.LINK_TARGETS, 3, "Port p: /A");
+            Assert.AreSame(aTasks[3], aScheduler.ExecuteLatestAsync(aSame, RequestPriority.Normal));
+            Assert.AreEqual(1, _executed.Count);
+            Assert.IsTrue(aTasks.Take(3).All(x => x.IsCompleted && x.Result == null));
+            Assert.IsFalse(aTasks[3].IsCompleted);
+            _responses[0].SetResult(null);
+            Assert.AreEqual(new[] { 0, 3 }, _executed.Select(x => x.column).ToArray());
+            var aResponse = new LinkTargetsResponse();
+            _responses[1].SetResult(aResponse);
+            Assert.AreSame(aResponse, aTasks[3].Result);
+            Assert.IsTrue(aScheduler.IsLatest(aSame));
+        }
+
+        [Test]
+        public void CancelWaitingTest()
+        {
+            var aScheduler = CreateScheduler();
+            var aFirst     = aScheduler.ExecuteLatestAsync(Request(Constants.Commands.CONTEXT_INFO, 1, "A"), RequestPriority.Normal);
+            var aSecond    = aScheduler.ExecuteLatestAsync(Request(Constants.Commands.CONTEXT_INFO, 2, "A"), RequestPriority.Normal);
+            aScheduler.Cancel(Constants.Commands.CONTEXT_INFO);
+            Assert.IsTrue(aSecond.IsCompleted);
+            Assert.IsNull(aSecond.Result);
+            //the superseded request was answered already, so there is nothing to abandon
+            Assert.AreEqual(0, _abandoned.Count);
+            Assert.IsNull(aFirst.Result);
+            _responses[0].TrySetResult(new ContextInfoResponse());
+            Assert.AreEqual(1, _executed.Count);
+        }
+
+        [Test]
+        public void CoalesceTest()
+        {
+            var aScheduler = CreateScheduler();
+            var aFirst     = Request(Constants.Commands.LINK_TARGETS, 7, "Port p: /A/B");
+            var aSame      = Request(Constants.Commands.LINK_TARGETS, 7, "Port p: /A/B");
+            var aFirstTask = aScheduler.ExecuteLatestAsync(aFirst, RequestPriority.Normal);
+            Assert.AreSame(aFirstTask, aScheduler.ExecuteLatestAsync(aSame, RequestPriority.Normal));
+            Assert.AreEqual(1, _executed.Count);
+            Assert.IsTrue(aScheduler.IsLatest(aSame));
+            //other commands are scheduled independently
+            aScheduler.ExecuteLatestAsync(Request(Constants.Commands.CONTENT_COMPLETION, 7, "Port p: /A/B"), RequestPriority.High);
+            Assert.AreEqual(2, _executed.Count);
+            Assert.AreEqual(0, _abandoned.Count);
+            Assert.IsFalse(aFirstTask.IsCompleted);
+        }
+
+        [Test]
+        public void CancelTest()
+        {
+            var aScheduler = CreateScheduler();
+            var aRequest   = Request(Constants.Commands.CONTENT_COMPLETION, 1, "P");
+            var aTask      = aScheduler.ExecuteLatestAsync(aRequest, RequestPriority.High);
+            aScheduler.Cancel(Constants.Commands.CONTENT_COMPLETION);
+            Assert.IsTrue(aTask.IsCompleted);
+            Assert.IsFalse(aScheduler.IsLatest(aRequest));
+            aScheduler.Cancel(Constants.Commands.CONTENT_COMPLETION);
+            Assert.AreEqual(1, _abandoned.Count);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+﻿using System.Diagnostics;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin;
+    using RTextNppPlugin.RText;
+    [TestFixture]
+    class RequestStatisticsTests
+    {
+        private static long Ticks(long milliseconds)
+        {
+            return milliseconds * Stopwatch.Frequency / 1000;
+        }
+
+        [Test]
+        public void RecordTest()
+        {
+            var aStatistics = new RequestStatistics();
+            var aTiming     = new RequestTiming
+            {
+                SentAt           = Ticks(1000),
+                FirstByteAt      = Ticks(1040),
+                DeserializeTicks = Ticks(3),
+                Bytes            = 2048
+            };
+            aStatistics.Record(Constants.Commands.LINK_TARGETS, aTiming, Ticks(1050));
+            var aCommand = aStatistics[Constants.Commands.LINK_TARGETS];
+            Assert.AreEqual(1, aCommand.FirstByte.Count);
+            Assert.AreEqual(40000, aCommand.FirstByte.Max, 400);
+            Assert.AreEqual(10000, aCommand.Transfer.Max, 100);
+            Assert.AreEqual(3000, aCommand.Deserialize.Max, 30);
+            Assert.AreEqual(2048, aCommand.Bytes.Sum);
+            Assert.AreEqual(0, aStatistics[Constants.Commands.CONTENT_COMPLETION].Bytes.Count);
+        }
+
+        [Test]
+        public void ResponseWithoutFirstByteTest()
+        {
+            //a request answered before any byte was seen counts as waiting for the back-end only
+            var aStatistics = new RequestStatistics();
+            aStatistics.Record(Constants.Commands.CONTEXT_INFO, new RequestTiming { SentAt = Ticks(10) }, Ticks(30));
+            var aCommand = aStatistics[Constants.Commands.CONTEXT_INFO];
+            Assert.AreEqual(20000, aCommand.FirstByte.Max, 200);
+            Assert.AreEqual(0, aCommand.Transfer.Max);
+        }
+
+        [Test]
+        public void ReportTest()
+        {
+            var aStatistics = new RequestStatistics();
+            StringAssert.StartsWith("No requests", aStatistics.Report());
+            //commands without answered requests are left out
+            Assert.AreEqual(0, aStatistics[Constants.Commands.FIND_ELEMENTS].Bytes.Count);
+            for (int i = 1; i <= 100; ++i)
+            {
+                aStatistics.Record(Constants.Commands.CONTENT_COMPLETION, new RequestTiming { SentAt = 0, FirstByteAt = Ticks(i), Bytes = 1024 }, Ticks(i + 1));
+            }
+            string aReport = aStatistics.Report();
+            StringAssert.StartsWith(Constants.Commands.CONTENT_COMPLETION + ": 100 requests, 100.0 KiB received", aReport);
+            StringAssert.DoesNotContain(Constants.Commands.FIND_ELEMENTS, aReport);
+            StringAssert.Contains("send to first byte [ms]", aReport);
+            StringAssert.Contains("max    100.", aReport);
+            StringAssert.Contains("response size [KiB]", aReport);
+        }
+    }
+}
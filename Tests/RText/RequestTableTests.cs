@@ -0,0 +1,113 @@
+﻿using System.Collections.Generic;
+using System.Linq;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin.RText;
+    using RTextNppPlugin.RText.Protocol;
+    [TestFixture]
+    class RequestTableTests
+    {
+        private static PendingRequest Request(string command, RequestPriority priority)
+        {
+            return new PendingRequest(new RequestBase { command = command }, priority);
+        }
+
+        private static PendingRequest Send(RequestTable table, int invocationId)
+        {
+            var aRequest = table.Dequeue();
+            if (aRequest != null)
+            {
+                aRequest.Request.invocation_id = invocationId;
+                table.Sent(aRequest);
+            }
+            return aRequest;
+        }
+
+        [Test]
+        public void PriorityTest()
+        {
+            var aTable = new RequestTable(10);
+            aTable.Enqueue(Request("a", RequestPriority.Normal));
+            aTable.Enqueue(Request("b", RequestPriority.Low));
+            aTable.Enqueue(Request("c", RequestPriority.High));
+            aTable.Enqueue(Request("d", RequestPriority.Normal));
+            aTable.Enqueue(Request("e", RequestPriority.High));
+            var aOrder = new List<string>();
+            PendingRequest aRequest = null;
+            while ((aRequest = aTable.Dequeue()) != null)
+            {
+                aOrder.Add(aRequest.Request.command);
+            }
+            Assert.AreEqual(new[] { "c", "e", "a", "d", "b" }, aOrder.ToArray());
+            Assert.AreEqual(0, aTable.Count);
+        }
+
+        [Test]
+        public void InFlightLimitTest()
+        {
+            var aTable = new RequestTable(2);
+            for (int i = 0; i < 4; ++i)
+            {
+                aTable.Enqueue(Request("r" + i, RequestPriority.Normal));
+            }
+            var aFirst  = Send(aTable, 0);
+            var aSecond = Send(aTable, 1);
+            Assert.IsNull(aTable.Dequeue());
+            Assert.AreEqual(4, aTable.Count);
+            //responses may arrive in any order
+            Assert.AreSame(aSecond, aTable.Find(1));
+            Assert.IsTrue(aTable.Remove(aSecond));
+            Assert.IsFalse(aTable.Remove(aSecond));
+            Assert.IsNull(aTable.Find(1));
+            Assert.AreEqual("r2", Send(aTable, 2).Request.command);
+            Assert.IsNull(aTable.Dequeue());
+            Assert.AreSame(aFirst, aTable.Find(0));
+        }
+
+        [Test]
+        public void RemoveTest()
+        {
+            var aTable  = new RequestTable(1);
+            var aSent   = Request("a", RequestPriority.Normal);
+            var aQueued = Request("b", RequestPriority.Normal);
+            aTable.Enqueue(aSent);
+            aTable.Enqueue(aQueued);
+            Send(aTable, 7);
+            //a queued request is removed without ever being sent, e.g. on timeout
+            Assert.IsTrue(aTable.Remove(aQueued));
+            Assert.IsNull(aTable.Dequeue());
+            aTable.Enqueue(Request("c", RequestPriority.Normal));
+            var aRemoved = aTable.RemoveAll();
+            Assert.AreEqual(new[] { "a", "c" }, aRemoved.Select(x => x.Request.command).ToArray());
+            Assert.AreEqual(0, aTable.Count);
+            Assert.IsNull(aTable.Find(7));
+            Assert.IsTrue(aSent.IsSent);
+            Assert.IsFalse(aQueued.IsSent);
+        }
+
+        [Test]
+        public void AbandonedRequestKeepsSlotTest()
+        {
+            var aTable     = new RequestTable(1);
+            var aAbandoned = Request("a", RequestPriority.Normal);
+            var aNext      = Request("b", RequestPriority.Normal);
+            aTable.Enqueue(aAbandoned);
+            aTable.Enqueue(aNext);
+            Send(aTable, 3);
+            //answered with null, but the back-end still works on it
+            aAbandoned.IsAbandoned = true;
+            aAbandoned.Completion.TrySetResult(null);
+            Assert.IsTrue(aTable.Contains(aAbandoned));
+            Assert.IsNull(aTable.Dequeue());
+            Assert.AreEqual(2, aTable.Count);
+            //its response frees the slot
+            Assert.AreSame(aAbandoned, aTable.Find(3));
+            Assert.IsTrue(aTable.Remove(aAbandoned));
+            Assert.IsFalse(aTable.Contains(aAbandoned));
+            Assert.IsTrue(aTable.Contains(aNext));
+            Assert.AreSame(aNext, Send(aTable, 4));
+            Assert.IsTrue(aTable.Contains(aNext));
+        }
+    }
+}
@@ -0,0 +1,67 @@
+﻿using System.Collections.Generic;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin;
+    using RTextNppPlugin.RText;
+    using RTextNppPlugin.RText.Protocol;
+    [TestFixture]
+    class ResponseCacheTests
+    {
+        private static AutoCompleteAndReferenceRequest Request(int column, params string[] context)
+        {
+            return new AutoCompleteAndReferenceRequest { command = Constants.Commands.LINK_TARGETS, column = column, context = context };
+        }
+
+        [Test]
+        public void LookupTest()
+        {
+            var aCache            = new ResponseCache(4);
+            var aResponse         = new LinkTargetsResponse();
+            IResponseBase aCached = null;
+            aCache.Add("c:/a.atm", Request(5, "Port p: /A/B"), aCache.Version, aResponse);
+            Assert.IsTrue(aCache.TryGet("c:/a.atm", Request(5, "Port p: /A/B"), out aCached));
+            Assert.AreSame(aResponse, aCached);
+            Assert.IsFalse(aCache.TryGet("c:/b.atm", Request(5, "Port p: /A/B"), out aCached));
+            Assert.IsNull(aCached);
+            Assert.IsFalse(aCache.TryGet("c:/a.atm", Request(6, "Port p: /A/B"), out aCached));
+            Assert.IsFalse(aCache.TryGet("c:/a.atm", Request(5, "Port p: /A/C"), out aCached));
+            var aCompletion = Request(5, "Port p: /A/B");
+            aCompletion.command = Constants.Commands.CONTENT_COMPLETION;
+            Assert.IsFalse(aCache.TryGet("c:/a.atm", aCompletion, out aCached));
+        }
+
+        [Test]
+        public void EvictionTest()
+        {
+            var aCache            = new ResponseCache(2);
+            IResponseBase aCached = null;
+            aCache.Add("f", Request(1, "a"), 0, new LinkTargetsResponse());
+            aCache.Add("f", Request(2, "a"), 0, new LinkTargetsResponse());
+            //using the first response makes the second one the least recently used
+            Assert.IsTrue(aCache.TryGet("f", Request(1, "a"), out aCached));
+            aCache.Add("f", Request(3, "a"), 0, new LinkTargetsResponse());
+            Assert.AreEqual(2, aCache.Count);
+            Assert.IsTrue(aCache.TryGet("f", Request(1, "a"), out aCached));
+            Assert.IsFalse(aCache.TryGet("f", Request(2, "a"), out aCached));
+            Assert.IsTrue(aCache.TryGet("f", Request(3, "a"), out aCached));
+        }
+
+        [Test]
+        public void InvalidateTest()
+        {
+            var aCache            = new ResponseCache(2);
+            IResponseBase aCached = null;
+            int aVersion          = aCache.Version;
+            aCache.Add("f", Request(1, "a"), aVersion, new LinkTargetsResponse());
+            aCache.Invalidate();
+            Assert.AreEqual(0, aCache.Count);
+            Assert.IsFalse(aCache.TryGet("f", Request(1, "a"), out aCached));
+            //a response requested before the invalidation is outdated
+            aCache.Add("f", Request(2, "a"), aVersion, new LinkTargetsResponse());
+            Assert.AreEqual(0, aCache.Count);
+            aCache.Add("f", Request(2, "a"), aCache.Version, new LinkTargetsResponse());
+            Assert.AreEqual(1, aCache.Count);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+﻿using System.Linq;
+using System.Text;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin;
+    using RTextNppPlugin.RText.Parsing;
+    [TestFixture]
+    class SyntaxTreeTests
+    {
+        private const string CONTENT = "Container c {\n  Child a, f: 1,\n    g: [1, 2]\n  role:\n    Child b\n  roles: [\n    Child c {\n      Child d\n    }\n  ]\n}\nOther o,\n  x: 1\n";
+
+        private static RTextDocumentCliWrapper Lex(string content)
+        {
+            var aDocument = new RTextDocumentCliWrapper(Encoding.UTF8.GetBytes(content));
+            aDocument.Lex(0, content.Length);
+            return aDocument;
+        }
+
+        private static void AssertEditRelexedLikeFullLex(string edited, int position)
+        {
+            using (var aIncremental = Lex(CONTENT))
+            using (var aFull = Lex(edited))
+            {
+                aIncremental.Edit(Encoding.UTF8.GetBytes(edited), position);
+                aIncremental.Lex(position, edited.Length);
+                CollectionAssert.AreEqual(aFull.GetSyntaxNodes(), aIncremental.GetSyntaxNodes());
+            }
+        }
+
+        [Test]
+        public void DocumentTreeTest()
+        {
+            using (var aDocument = Lex(CONTENT))
+            {
+                var aNodes = aDocument.GetSyntaxNodes();
+                Assert.AreEqual(-1, aNodes[0].Parent);
+                var aTopLevel = aNodes.Where(x => x.Parent == 0).ToArray();
+                Assert.AreEqual(2, aTopLevel.Length);
+                Assert.AreEqual(0, aTopLevel[0].Position);
+                Assert.AreEqual(CONTENT.IndexOf("Other"), aTopLevel[1].Position);
+                int aChild = aDocument.FindSyntaxNode(CONTENT.IndexOf("Child d"));
+                Assert.AreEqual(CONTENT.IndexOf("Child d"), aNodes[aNodes[aChild].Parent].Position);
+            }
+        }
+
+        [Test]
+        public void InsertRelexTest()
+        {
+            int aPosition = CONTENT.IndexOf("      Child d");
+            AssertEditRelexedLikeFullLex(CONTENT.Insert(aPosition, "      Child e, y: /P/Q\n"), aPosition);
+        }
+
+        [Test]
+        public void DeleteClosingBracketRelexTest()
+        {
+            int aPosition = CONTENT.IndexOf("    }");
+            AssertEditRelexedLikeFullLex(CONTENT.Remove(aPosition, "    }\n".Length), aPosition);
+        }
+
+        [Test]
+        public void TypeAtEndRelexTest()
+        {
+            AssertEditRelexedLikeFullLex(CONTENT + "Last l {\n  Ch", CONTENT.Length);
+        }
+
+        [Test]
+        public void ContextFromTopLevelElementTest()
+        {
+            //completion extracts the context from the start of the top level element instead of the start of the document
+            using (var aDocument = Lex(CONTENT))
+            {
+                var aNodes = aDocument.GetSyntaxNodes();
+                for (int aPosition = 0; aPosition < CONTENT.Length; ++aPosition)
+                {
+                    int aLineEnd = CONTENT.IndexOf('\n', aPosition);
+                    int aNode    = aDocument.FindTopLevelSyntaxNode(aPosition);
+                    int aStart   = (aNode <= 0) ? 0 : CONTENT.LastIndexOf('\n', aNodes[aNode].Position) + 1;
+                    var aFull    = new ContextExtractor(CONTENT.Substring(0, aLineEnd), aLineEnd - aPosition);
+                    var aPartial = new ContextExtractor(CONTENT.Substring(aStart, aLineEnd - aStart), aLineEnd - aPosition);
+                    CollectionAssert.AreEqual(aFull.ContextList, aPartial.ContextList, "Position {0}", aPosition);
+                    Assert.AreEqual(aFull.ContextColumn, aPartial.ContextColumn, "Position {0}", aPosition);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,441 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Text;
+using System.Threading;
+namespace Tests.RText
+{
+    using NUnit.Framework;
+    using RTextNppPlugin.RText.Indexing;
+    using RTextNppPlugin.RText.Protocol;
+    [TestFixture]
+    class WorkspaceIndexTests
+    {
+        #region [DataMembers]
+        private string _workspaceDir = null;
+        #endregion
+
+        /**
+         * \brief   Outline provider which treats every non empty line as "Command Name", optionally followed by references
+         *          and '{'. References are all further words starting with '/'.
+         */
+        private class LineOutlineProvider : IOutlineProvider
+        {
+            private int _calls = 0;
+
+            public int Calls
+            {
+                get
+                {
+                    return _calls;
+                }
+            }
+
+            public IList<ElementSymbol> GetElements(byte[] content, out IList<ReferenceSymbol> references)
+            {
+                Interlocked.Increment(ref _calls);
+                var aElements   = new List<ElementSymbol>();
+                var aReferences = new List<ReferenceSymbol>();
+                var aParents    = new Stack<int>();
+                var aLines      = Encoding.UTF8.GetString(content).Split('\n');
+                for (int i = 0; i < aLines.Length; ++i)
+                {
+                    string aLine = aLines[i].Trim();
+                    if (aLine == "}")
+                    {
+                        aParents.Pop();
+                    }
+                    else if (aLine.Length > 0)
+                    {
+                        var aParts = aLine.TrimEnd('{', ' ').Split(' ');
+                        aElements.Add(new ElementSymbol(aParts.Length > 1 ? aParts[1] : String.Empty, aParts[0], i, aParents.Count > 0 ? aParents.Peek() : -1));
+                        aReferences.AddRange(aParts.Skip(2).Where(x => x.StartsWith("/")).Select(x => new ReferenceSymbol(x, i, aElements.Count - 1)));
+                        if (aLine.EndsWith("{"))
+                        {
+                            aParents.Push(aElements.Count - 1);
+                        }
+                    }
+                }
+                references = aReferences;
+                return aElements;
+            }
+        }
+
+        [SetUp]
+        public void Init()
+        {
+            _workspaceDir = Path.Combine(Path.GetTempPath(), "WorkspaceIndexTests");
+            if (Directory.Exists(_workspaceDir))
+            {
+                Directory.Delete(_workspaceDir, true);
+            }
+            Directory.CreateDirectory(Path.Combine(_workspaceDir, "sub"));
+            File.WriteAllText(Path.Combine(_workspaceDir, ".rtext"), "*.atm:\ncmd /c dummy\n");
+            File.WriteAllText(Path.Combine(_workspaceDir, "a.atm"), "Package P1 {\n  Type UInt8\n  Type uint16\n}\n");
+            File.WriteAllText(Path.Combine(_workspaceDir, "sub", "b.atm"), "Type Uber\nType\n");
+            File.WriteAllText(Path.Combine(_workspaceDir, "c.atm40"), "Type Unseen\n");
+        }
+
+        [TearDown]
+        public void CleanUp()
+        {
+            Directory.Delete(_workspaceDir, true);
+        }
+
+        [Test]
+        public void NotReadyBeforeBuildTest()
+        {
+            var aIndex = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            Assert.IsFalse(aIndex.IsReady);
+            Assert.IsNull(aIndex.FindElements("U"));
+        }
+
+        [Test]
+        public void BuildIndexesOnlyWorkspaceExtensionTest()
+        {
+            var aIndex = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            aIndex.BuildAsync(CancellationToken.None).Wait();
+            Assert.IsTrue(aIndex.IsReady);
+            Assert.AreEqual(2, aIndex.Snapshot.FileCount);
+            Assert.AreEqual(5, aIndex.Snapshot.ElementCount);
+            Assert.IsNull(aIndex.Snapshot.GetFile(Path.Combine(_workspaceDir, "c.atm40")));
+            Assert.IsNotNull(aIndex.Snapshot.GetFile(Path.Combine(_workspaceDir, "sub", "b.atm")));
+        }
+
+        [Test]
+        public void BuildIndexesAllExtensionsOfPatternTest()
+        {
+            File.WriteAllText(Path.Combine(_workspaceDir, ".rtext"), "*.atm, *.meta:\ncmd /c dummy\n*.atm40:\ncmd /c other\n");
+            File.WriteAllText(Path.Combine(_workspaceDir, "d.meta"), "Type Meta\n");
+            var aIndex = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            aIndex.Build(CancellationToken.None);
+            Assert.AreEqual(3, aIndex.Snapshot.FileCount);
+            Assert.IsNotNull(aIndex.Snapshot.GetFile(Path.Combine(_workspaceDir, "d.meta")));
+            Assert.IsNull(aIndex.Snapshot.GetFile(Path.Combine(_workspaceDir, "c.atm40")));
+        }
+
+        [Test]
+        public void BuildSkipsNestedWorkspaceTest()
+        {
+            Directory.CreateDirectory(Path.Combine(_workspaceDir, "nested", "deeper"));
+            File.WriteAllText(Path.Combine(_workspaceDir, "nested", ".rtext"), "*.atm:\ncmd /c nested\n");
+            File.WriteAllText(Path.Combine(_workspaceDir, "nested", "deeper", "e.atm"), "Type Nested\n");
+            //a .rtext file for other extensions doesn't start another workspace
+            File.WriteAllText(Path.Combine(_workspaceDir, "sub", ".rtext"), "*.other:\ncmd /c other\n");
+            var aIndex = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            aIndex.Build(CancellationToken.None);
+            Assert.AreEqual(2, aIndex.Snapshot.FileCount);
+            Assert.IsNull(aIndex.Snapshot.GetFile(Path.Combine(_workspaceDir, "nested", "deeper", "e.atm")));
+            Assert.IsNotNull(aIndex.Snapshot.GetFile(Path.Combine(_workspaceDir, "sub", "b.atm")));
+            //changes of files of the nested workspace are ignored as well
+            File.AppendAllText(Path.Combine(_workspaceDir, "nested", "deeper", "e.atm"), "Type Changed\n");
+            aIndex.Invalidate(Path.Combine(_workspaceDir, "nested", "deeper", "e.atm"));
+            Assert.AreEqual(0, aIndex.Update());
+        }
+
+        [Test]
+        public void MergeElementsTest()
+        {
+            var aIndex = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            aIndex.Build(CancellationToken.None);
+            var aLocal   = aIndex.FindElements("u");
+            var aBackend = new FindRTextElementsResponse
+            {
+                type           = "response",
+                invocation_id  = 7,
+                total_elements = "2",
+                elements       = new List<Element>
+                {
+                    new Element { display = "UInt8 [Type] - /P1", file = Path.Combine(_workspaceDir, "a.atm").ToUpperInvariant(), line = 2, desc = "/P1/UInt8" },
+                    new Element { display = "Custom [Type]", file = Path.Combine(_workspaceDir, "a.atm"), line = 9, desc = "/Custom" }
+                }
+            };
+            var aMerged = WorkspaceIndex.MergeElements(aBackend, aLocal);
+            Assert.AreEqual(7, aMerged.invocation_id);
+            Assert.AreEqual("4", aMerged.total_elements);
+            Assert.AreEqual(new[] { "UInt8 [Type] - /P1", "Custom [Type]", "Uber [Type]", "uint16 [Type] - /P1" }, aMerged.elements.Select(x => x.display).ToArray());
+            Assert.AreSame(aLocal, WorkspaceIndex.MergeElements(null, aLocal));
+            Assert.AreSame(aBackend, WorkspaceIndex.MergeElements(aBackend, null));
+        }
+
+        [Test]
+        public void FindElementsTest()
+        {
+            var aIndex = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            aIndex.Build(CancellationToken.None);
+            var aResponse = aIndex.FindElements("u");
+            Assert.AreEqual("3", aResponse.total_elements);
+            Assert.AreEqual(new[] { "Uber [Type]", "uint16 [Type] - /P1", "UInt8 [Type] - /P1" }, aResponse.elements.Select(x => x.display).ToArray());
+            var aUInt8 = aResponse.elements.Single(x => x.desc == "/P1/UInt8");
+            Assert.AreEqual(Path.Combine(_workspaceDir, "a.atm"), aUInt8.file);
+            Assert.AreEqual(2, aUInt8.line);
+            Assert.AreEqual(1, aIndex.FindElements("P1").elements.Count);
+            Assert.AreEqual(0, aIndex.FindElements("Unseen").elements.Count);
+            Assert.AreEqual(0, aIndex.FindElements(String.Empty).elements.Count);
+        }
+
+        [Test]
+        public void ParallelBuildReportsProgressTest()
+        {
+            for (int i = 0; i < 200; ++i)
+            {
+                File.WriteAllText(Path.Combine(_workspaceDir, "sub", String.Format("f{0}.atm", i)), String.Format("Type T{0}\n", i));
+            }
+            var aIndex       = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            var aPercentages = new List<int>();
+            aIndex.OnProgressUpdated += (source, progress) =>
+            {
+                lock (aPercentages)
+                {
+                    aPercentages.Add(progress.percentage);
+                }
+            };
+            aIndex.Build(CancellationToken.None);
+            Assert.AreEqual(202, aIndex.Snapshot.FileCount);
+            Assert.AreEqual(205, aIndex.Snapshot.ElementCount);
+            Assert.AreEqual(200, aIndex.FindElements("T").elements.Count);
+            Assert.AreEqual(100, aPercentages.Max());
+            Assert.AreEqual(aPercentages.Count, aPercentages.Distinct().Count());
+        }
+
+        [Test]
+        public void WarmBuildUsesCacheTest()
+        {
+            new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider()).Build(CancellationToken.None);
+            Assert.IsTrue(File.Exists(Path.Combine(_workspaceDir, ".rtext.atm.index")));
+            //nothing changed
+            var aProvider = new LineOutlineProvider();
+            var aIndex    = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", aProvider);
+            aIndex.Build(CancellationToken.None);
+            Assert.AreEqual(0, aProvider.Calls);
+            Assert.AreEqual(5, aIndex.Snapshot.ElementCount);
+            Assert.AreEqual("/P1/UInt8", aIndex.FindElements("UInt8").elements.Single().desc);
+            //touched without changes, changed and deleted files
+            File.SetLastWriteTimeUtc(Path.Combine(_workspaceDir, "a.atm"), DateTime.UtcNow.AddMinutes(1));
+            File.WriteAllText(Path.Combine(_workspaceDir, "sub", "b.atm"), "Type Changed\n");
+            aProvider = new LineOutlineProvider();
+            aIndex    = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", aProvider);
+            aIndex.Build(CancellationToken.None);
+            Assert.AreEqual(1, aProvider.Calls);
+            Assert.AreEqual(1, aIndex.FindElements("Changed").elements.Count);
+            Assert.AreEqual(0, aIndex.FindElements("Uber").elements.Count);
+        }
+
+        [Test]
+        public void InvalidCacheIsIgnoredTest()
+        {
+            File.WriteAllText(Path.Combine(_workspaceDir, ".rtext.atm.index"), "garbage");
+            var aProvider = new LineOutlineProvider();
+            var aIndex    = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", aProvider);
+            aIndex.Build(CancellationToken.None);
+            Assert.AreEqual(2, aProvider.Calls);
+            Assert.AreEqual(5, aIndex.Snapshot.ElementCount);
+        }
+
+        [Test]
+        public void UpdateLexesOnlyPendingFilesTest()
+        {
+            var aProvider = new LineOutlineProvider();
+            var aIndex    = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", aProvider);
+            aIndex.Build(CancellationToken.None);
+            var aUnchanged = aIndex.Snapshot.GetFile(Path.Combine(_workspaceDir, "a.atm"));
+            //changed, created, deleted and foreign files
+            File.WriteAllText(Path.Combine(_workspaceDir, "sub", "b.atm"), "Type Changed\nType Uber2\n");
+            File.WriteAllText(Path.Combine(_workspaceDir, "d.atm"), "Type Added\n");
+            File.WriteAllText(Path.Combine(_workspaceDir, "c.atm40"), "Type Foreign\n");
+            Assert.IsTrue(aIndex.Invalidate(Path.Combine(_workspaceDir, "sub", "b.atm")));
+            Assert.IsFalse(aIndex.Invalidate(Path.Combine(_workspaceDir, "d.atm")));
+            Assert.IsFalse(aIndex.Invalidate(Path.Combine(_workspaceDir, "c.atm40")));
+            Assert.AreEqual(2, aIndex.Update());
+            Assert.AreEqual(4, aProvider.Calls);
+            Assert.AreSame(aUnchanged, aIndex.Snapshot.GetFile(Path.Combine(_workspaceDir, "a.atm")));
+            Assert.AreEqual(3, aIndex.Snapshot.FileCount);
+            Assert.AreEqual(6, aIndex.Snapshot.ElementCount);
+            CollectionAssert.AreEqual(new[] { "Uber2" }, aIndex.FindElements("Uber").elements.Select(x => x.display.Split(' ')[0]));
+            Assert.AreEqual(1, aIndex.FindElements("Added").elements.Count);
+            Assert.AreEqual(0, aIndex.FindElements("Foreign").elements.Count);
+            //deleted file
+            File.Delete(Path.Combine(_workspaceDir, "d.atm"));
+            Assert.IsTrue(aIndex.Invalidate(Path.Combine(_workspaceDir, "d.atm")));
+            Assert.AreEqual(1, aIndex.Update());
+            Assert.AreEqual(0, aIndex.FindElements("Added").elements.Count);
+            Assert.AreEqual(2, aIndex.Snapshot.FileCount);
+            //nothing pending
+            Assert.AreEqual(0, aIndex.Update());
+            Assert.AreEqual(4, aProvider.Calls);
+        }
+
+        [Test]
+        public void ResolveReferenceTest()
+        {
+            File.WriteAllText(Path.Combine(_workspaceDir, "sub", "b.atm"), "Package P2 {\n  Group {\n    Type UInt8\n  }\n  Type Twice\n  Type Twice\n}\n");
+            var aIndex = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            Assert.IsNull(aIndex.ResolveReference("/P1/UInt8"));
+            aIndex.Build(CancellationToken.None);
+            var aResponse = aIndex.ResolveReference("/P1/UInt8");
+            Assert.AreEqual(Path.Combine(_workspaceDir, "a.atm"), aResponse.targets.Single().file);
+            Assert.AreEqual("2", aResponse.targets.Single().line);
+            Assert.AreEqual("/P1/UInt8", aResponse.targets.Single().desc);
+            //unnamed elements aren't part of qualified names
+            Assert.AreEqual("3", aIndex.ResolveReference("/P2/UInt8").targets.Single().line);
+            Assert.AreEqual("1", aIndex.ResolveReference("/P2").targets.Single().line);
+            //ambiguous, unknown, case mismatching, relative and malformed references are left to the backend
+            Assert.IsNull(aIndex.ResolveReference("/P2/Twice"));
+            Assert.IsNull(aIndex.ResolveReference("/P1/UInt32"));
+            Assert.IsNull(aIndex.ResolveReference("/P1/uint8"));
+            Assert.IsNull(aIndex.ResolveReference("/UInt8"));
+            Assert.IsNull(aIndex.ResolveReference("P1/UInt8"));
+            Assert.IsNull(aIndex.ResolveReference("/P1//UInt8"));
+            Assert.AreEqual(2, aIndex.Snapshot.ResolveReference("/P2/Twice").Count);
+        }
+
+        [Test]
+        public void FindUsagesTest()
+        {
+            File.WriteAllText(Path.Combine(_workspaceDir, "sub", "b.atm"), "Package P2 {\n  Port In /P1/UInt8 /P1//UInt8/\n  Port Out /P1/uint16\n}\n");
+            File.WriteAllText(Path.Combine(_workspaceDir, "d.atm"), "Port Other /P1/UInt8\n");
+            var aIndex = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            Assert.IsNull(aIndex.FindUsages("/P1/UInt8"));
+            aIndex.Build(CancellationToken.None);
+            var aUsages = aIndex.FindUsages("/P1/UInt8");
+            Assert.AreEqual(3, aUsages.Count);
+            Assert.AreEqual(2, aUsages.Count(x => x.file == Path.Combine(_workspaceDir, "sub", "b.atm") && x.line == 2 && x.display == "In [Port] - /P2"));
+            Assert.AreEqual(1, aUsages.Count(x => x.file == Path.Combine(_workspaceDir, "d.atm") && x.line == 1 && x.desc == "/P1/UInt8"));
+            Assert.AreEqual(1, aIndex.FindUsages("/P1/uint16/").Count);
+            Assert.AreEqual(0, aIndex.FindUsages("/P1/UInt16").Count);
+            //changed and deleted files
+            File.WriteAllText(Path.Combine(_workspaceDir, "sub", "b.atm"), "Port In /P1/uint16\n");
+            File.Delete(Path.Combine(_workspaceDir, "d.atm"));
+            aIndex.Invalidate(Path.Combine(_workspaceDir, "sub", "b.atm"));
+            aIndex.Invalidate(Path.Combine(_workspaceDir, "d.atm"));
+            aIndex.Update();
+            Assert.AreEqual(0, aIndex.FindUsages("/P1/UInt8").Count);
+            Assert.AreEqual("In [Port]", aIndex.FindUsages("/P1/uint16").Single().display);
+            //references are cached as well
+            var aWarm = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            aWarm.Build(CancellationToken.None);
+            Assert.AreEqual(1, aWarm.FindUsages("/P1/uint16").Count);
+        }
+
+        [Test]
+        public void ReferenceIndexReusesRemovedFileIdsTest()
+        {
+            Func<string, string, FileSymbols> aCreateFile = (file, reference) => new FileSymbols(file, new[] { new ElementSymbol("In", "Port", 0, -1) }, new[] { new ReferenceSymbol(reference, 0, 0) }, 0, 0, 0);
+            var aIndex = new ReferenceIndex(new[] { aCreateFile("a.atm", "/P1/UInt8"), aCreateFile("b.atm", "/P1/UInt8"), aCreateFile("c.atm", "/P1/uint16") });
+            //files which are renamed over and over again don't grow the file table
+            for (int i = 0; i < 10; ++i)
+            {
+                aIndex = aIndex.Update(new[] { aCreateFile("b" + (i + 1) + ".atm", "/P1/UInt8") }, new[] { (i == 0) ? "b.atm" : "b" + i + ".atm" });
+                Assert.AreEqual(3, aIndex.FileIdCount);
+            }
+            CollectionAssert.AreEqual(new[] { "a.atm", "b10.atm" }, aIndex.Find("/P1/UInt8").Select(x => x.File.File));
+            //a reused id doesn't keep the postings of the removed file
+            aIndex = aIndex.Update(new FileSymbols[0], new[] { "a.atm" });
+            aIndex = aIndex.Update(new[] { aCreateFile("d.atm", "/P1/uint16") }, new string[0]);
+            Assert.AreEqual(3, aIndex.FileIdCount);
+            CollectionAssert.AreEqual(new[] { "b10.atm" }, aIndex.Find("/P1/UInt8").Select(x => x.File.File));
+            CollectionAssert.AreEqual(new[] { "d.atm", "c.atm" }, aIndex.Find("/P1/uint16").Select(x => x.File.File));
+            aIndex = aIndex.Update(new[] { aCreateFile("e.atm", "/P1/uint16") }, new string[0]);
+            Assert.AreEqual(4, aIndex.FileIdCount);
+        }
+
+        [Test]
+        public void UnresolvedReferencesTest()
+        {
+            string aUser = Path.Combine(_workspaceDir, "sub", "b.atm");
+            File.WriteAllText(aUser, "Port In /P1/UInt8 /P1/UInt9 Relative/Ref\nPort Out /P1/uint16/\n");
+            var aIndex = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            aIndex.Build(CancellationToken.None);
+            Assert.AreEqual("/P1/UInt9", aIndex.Snapshot.GetUnresolvedReferences(aUser).Single().Path);
+            Assert.AreEqual(1, aIndex.Snapshot.UnresolvedReferences.Count());
+            //a new element resolves the reference, another file is not checked again
+            File.WriteAllText(Path.Combine(_workspaceDir, "d.atm"), "Package P1 {\n  Type UInt9\n}\n");
+            aIndex.Invalidate(Path.Combine(_workspaceDir, "d.atm"));
+            aIndex.Update();
+            Assert.AreEqual(0, aIndex.Snapshot.GetUnresolvedReferences(aUser).Count);
+            //a vanished element breaks references of unchanged files
+            File.WriteAllText(Path.Combine(_workspaceDir, "a.atm"), "Package P1 {\n  Type UInt8\n}\n");
+            aIndex.Invalidate(Path.Combine(_workspaceDir, "a.atm"));
+            aIndex.Update();
+            var aUnresolved = aIndex.Snapshot.GetUnresolvedReferences(aUser);
+            Assert.AreEqual("/P1/uint16/", aUnresolved.Single().Path);
+            Assert.AreEqual(1, aUnresolved.Single().Line);
+            //deleted files have no unresolved references
+            File.Delete(aUser);
+            aIndex.Invalidate(aUser);
+            aIndex.Update();
+            Assert.AreEqual(0, aIndex.Snapshot.UnresolvedReferences.Count());
+        }
+
+        [Test]
+        public void DependencyGraphTest()
+        {
+            string aA = Path.Combine(_workspaceDir, "a.atm");
+            string aB = Path.Combine(_workspaceDir, "sub", "b.atm");
+            string aD = Path.Combine(_workspaceDir, "d.atm");
+            File.WriteAllText(aB, "Package P2 {\n  Port In /P1/UInt8 /P2/Out\n  Port Out /P1/uint16\n}\n");
+            File.WriteAllText(aD, "Package P3 {\n  Port In /P2/Out\n}\n");
+            var aIndex = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            aIndex.Build(CancellationToken.None);
+            var aGraph = aIndex.Snapshot.Dependencies;
+            Assert.AreEqual(new[] { aA }, aGraph.GetDependencies(aB).ToArray());
+            Assert.AreEqual(new[] { aB }, aGraph.GetDependencies(aD).ToArray());
+            Assert.AreEqual(new[] { aB, aD }, aGraph.GetImpact(new[] { aA }).ToArray());
+            Assert.IsTrue(aGraph.IsReachable(aD, aA));
+            Assert.IsFalse(aGraph.IsReachable(aA, aD));
+            Assert.AreEqual(0, aGraph.Cycles.Count());
+            //edges to elements of the same file are element edges only
+            var aEdges = aGraph.GetElementEdges(aB);
+            Assert.AreEqual(3, aEdges.Count);
+            Assert.AreEqual(aB, aEdges[1].TargetFile);
+            Assert.AreEqual(2, aEdges[1].TargetElement);
+            //a new reference closes a cycle
+            File.WriteAllText(aA, "Package P1 {\n  Type UInt8 /P3\n  Type uint16\n}\n");
+            aIndex.Invalidate(aA);
+            aIndex.Update();
+            aGraph = aIndex.Snapshot.Dependencies;
+            Assert.AreEqual(new[] { aA, aB, aD }.OrderBy(x => x).ToArray(), aGraph.GetCycle(aB).OrderBy(x => x).ToArray());
+            Assert.IsTrue(aGraph.IsReachable(aA, aD));
+            //a vanished element breaks it again, although the referencing file is unchanged
+            File.WriteAllText(aD, "Package P4 {\n  Port In /P2/Out\n}\n");
+            aIndex.Invalidate(aD);
+            aIndex.Update();
+            aGraph = aIndex.Snapshot.Dependencies;
+            Assert.AreEqual(0, aGraph.Cycles.Count());
+            Assert.AreEqual(0, aGraph.GetDependencies(aA).Count);
+            Assert.AreEqual(new[] { aB }, aGraph.GetDependents(aA).ToArray());
+            var aWriter = new StringWriter();
+            aGraph.Export(aWriter, true);
+            Assert.IsTrue(aWriter.ToString().Contains(String.Format("\"{0}#/P2/In\" -> \"{1}#/P1/UInt8\";", aB, aA).Replace("\\", "\\\\")));
+        }
+
+        [Test]
+        public void CompleteReferenceTest()
+        {
+            File.WriteAllText(Path.Combine(_workspaceDir, "sub", "b.atm"), "Package P2 {\n  Type Uber\n  Package Inner {\n    Type UInt8\n  }\n}\nPackage P1 {\n  Type Ushort\n}\n");
+            var aIndex = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            Assert.IsNull(aIndex.CompleteReference("/P1/"));
+            aIndex.Build(CancellationToken.None);
+            Assert.AreEqual(new[] { "/P1/uint16", "/P1/UInt8", "/P1/Ushort" }, aIndex.CompleteReference("/P1/").options.Select(x => x.insert).ToArray());
+            Assert.AreEqual(new[] { "/P1/", "/P2/" }, aIndex.CompleteReference("/").options.Select(x => x.display).ToArray());
+            //every segment is matched as a prefix, ignoring case
+            Assert.AreEqual(new[] { "/P2/Inner/UInt8", "/P1/uint16", "/P1/UInt8" }, aIndex.CompleteReference("/p/i/").options.Concat(aIndex.CompleteReference("/p/ui").options).Select(x => x.insert).ToArray());
+            var aOption = aIndex.CompleteReference("/P2/U").options.Single();
+            Assert.AreEqual("/P2/Uber", aOption.insert);
+            Assert.AreEqual("Type", aOption.desc);
+            Assert.AreEqual(0, aIndex.CompleteReference("/P3").options.Count);
+            Assert.AreEqual(0, aIndex.CompleteReference("P1").options.Count);
+        }
+
+        [Test]
+        public void CancelledBuildKeepsIndexTest()
+        {
+            var aIndex = new WorkspaceIndex(Path.Combine(_workspaceDir, ".rtext"), ".atm", new LineOutlineProvider());
+            var aCancelled = new CancellationTokenSource();
+            aCancelled.Cancel();
+            Assert.Throws<OperationCanceledException>(() => aIndex.Build(aCancelled.Token));
+            Assert.IsFalse(aIndex.IsReady);
+        }
+    }
+}
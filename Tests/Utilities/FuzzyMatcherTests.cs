@@ -0,0 +1,73 @@
+﻿using System;
+using System.Linq;
+namespace Tests.Utilities
+{
+    using NUnit.Framework;
+    using RTextNppPlugin.Utilities;
+    [TestFixture]
+    class FuzzyMatcherTests
+    {
+        private static string[] Rank(FuzzyMatcher matcher, string[] candidates, string query)
+        {
+            return matcher.Rank(query, 100).Select(x => candidates[x]).ToArray();
+        }
+
+        [Test]
+        public void SubsequenceTest()
+        {
+            var aCandidates = new[] { "transfer", "TheFirstElement", "elements", "tf" };
+            var aMatcher    = new FuzzyMatcher(aCandidates);
+            Assert.AreEqual(new[] { "TheFirstElement", "transfer" }, Rank(aMatcher, aCandidates, "tfe"));
+            Assert.AreEqual(new[] { "tf", "TheFirstElement", "transfer" }, Rank(aMatcher, aCandidates, "TF"));
+            Assert.AreEqual(0, aMatcher.Rank("xyz", 100).Length);
+            Assert.AreEqual(0, aMatcher.Rank("fsr", 100).Length);
+        }
+
+        [Test]
+        public void BoundaryBonusTest()
+        {
+            var aCandidates = new[] { "portal_id", "port_id", "sport_identifier", "/P1/portId" };
+            var aMatcher    = new FuzzyMatcher(aCandidates);
+            //prefix first, then word starts, ties go to the shorter candidate
+            Assert.AreEqual(new[] { "port_id", "portal_id", "/P1/portId", "sport_identifier" }, Rank(aMatcher, aCandidates, "pid"));
+        }
+
+        [Test]
+        public void TopResultsTest()
+        {
+            var aCandidates = Enumerable.Range(0, 100).Select(x => "value" + x).ToArray();
+            var aMatcher    = new FuzzyMatcher(aCandidates);
+            Assert.AreEqual(new[] { "value0", "value1", "value2" }, aMatcher.Rank("val", 3).Select(x => aCandidates[x]).ToArray());
+            Assert.AreEqual(new[] { "value9", "value90", "value91" }, aMatcher.Rank("v9", 3).Select(x => aCandidates[x]).ToArray());
+            Assert.AreEqual(new[] { 0, 1 }, aMatcher.Rank(String.Empty, 2));
+            Assert.AreEqual(0, aMatcher.Rank("val", 0).Length);
+        }
+
+        [Test]
+        public void BonusTest()
+        {
+            var aCandidates = new[] { "portal", "port" };
+            var aMatcher    = new FuzzyMatcher(aCandidates);
+            Assert.AreEqual(new[] { "port", "portal" }, Rank(aMatcher, aCandidates, "po"));
+            Assert.AreEqual(new[] { "portal", "port" }, aMatcher.Rank("po", 10, new[] { 64, 0 }).Select(x => aCandidates[x]).ToArray());
+            //an exact match stays first however often the other candidate was chosen
+            Assert.AreEqual(new[] { "port", "portal" }, aMatcher.Rank("port", 10, new[] { 64, 0 }).Select(x => aCandidates[x]).ToArray());
+            //without a query the candidates are ordered by their bonus
+            Assert.AreEqual(new[] { 1, 0 }, aMatcher.Rank(String.Empty, 10, new[] { 0, 3 }));
+            Assert.AreEqual(new[] { 0, 1 }, aMatcher.Rank(String.Empty, 10, new[] { 0, 0 }));
+        }
+
+        [Test]
+        public void LargeCandidateSetTest()
+        {
+            var aRandom     = new Random(1);
+            var aCandidates = Enumerable.Range(0, 50000).Select(x => new string(Enumerable.Range(0, 4 + aRandom.Next(20)).Select(y => "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_/"[aRandom.Next(54)]).ToArray())).ToArray();
+            var aMatcher    = new FuzzyMatcher(aCandidates);
+            var aRanked     = aMatcher.Rank("aBc", 1000);
+            Assert.IsTrue(aRanked.Length > 0);
+            Assert.IsTrue(aRanked.All(x => aCandidates[x].IndexOf('a') >= 0 || aCandidates[x].IndexOf('A') >= 0));
+            //fewer results are the best of the longer list, in the same order
+            Assert.AreEqual(aRanked.Take(10).ToArray(), aMatcher.Rank("aBc", 10));
+        }
+    }
+}
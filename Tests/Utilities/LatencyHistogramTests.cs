@@ -0,0 +1,67 @@
+﻿using System.Threading.Tasks;
+namespace Tests.Utilities
+{
+    using NUnit.Framework;
+    using RTextNppPlugin.Utilities;
+    [TestFixture]
+    class LatencyHistogramTests
+    {
+        [Test]
+        public void PercentileTest()
+        {
+            var aHistogram = new LatencyHistogram();
+            Assert.AreEqual(0, aHistogram.GetValueAtPercentile(50));
+            for (long i = 1; i <= 10000; ++i)
+            {
+                aHistogram.Record(i * 100);
+            }
+            Assert.AreEqual(10000, aHistogram.Count);
+            Assert.AreEqual(1000000, aHistogram.Max);
+            Assert.AreEqual(500050.0, aHistogram.Mean, 0.001);
+            //values are accurate to less than 1%
+            Assert.AreEqual(500000.0, aHistogram.GetValueAtPercentile(50), 5000.0);
+            Assert.AreEqual(990000.0, aHistogram.GetValueAtPercentile(99), 9900.0);
+            Assert.AreEqual(1000000, aHistogram.GetValueAtPercentile(100));
+            Assert.AreEqual(100.0, aHistogram.GetValueAtPercentile(0), 1.0);
+        }
+
+        [Test]
+        public void RangeTest()
+        {
+            var aHistogram = new LatencyHistogram();
+            aHistogram.Record(-5);
+            aHistogram.Record(255);
+            aHistogram.Record(long.MaxValue);
+            Assert.AreEqual(0, aHistogram.GetValueAtPercentile(33));
+            Assert.AreEqual(255, aHistogram.GetValueAtPercentile(66));
+            //values beyond hours are clamped
+            Assert.Greater(aHistogram.Max, 3600L * 1000 * 1000);
+            Assert.AreEqual(aHistogram.Max, aHistogram.GetValueAtPercentile(100));
+        }
+
+        [Test]
+        public void ConcurrentRecordTest()
+        {
+            var aHistogram = new LatencyHistogram();
+            Parallel.For(0, 8, x =>
+            {
+                for (int i = 0; i < 10000; ++i)
+                {
+                    aHistogram.Record(i);
+                }
+            });
+            Assert.AreEqual(80000, aHistogram.Count);
+            Assert.AreEqual(9999, aHistogram.Max);
+            Assert.AreEqual(8L * 9999 * 10000 / 2, aHistogram.Sum);
+
+            var aTotal = new LatencyHistogram();
+            aTotal.Record(20000);
+            aTotal.Add(aHistogram);
+            Assert.AreEqual(80001, aTotal.Count);
+            Assert.AreEqual(20000, aTotal.Max);
+            aTotal.Reset();
+            Assert.AreEqual(0, aTotal.Count);
+            Assert.AreEqual(0, aTotal.GetValueAtPercentile(99));
+        }
+    }
+}
@@ -0,0 +1,79 @@
+﻿using System.Threading.Tasks;
+namespace Tests.Utilities
+{
+    using NUnit.Framework;
+    using RTextNppPlugin.Utilities.Threading;
+    [TestFixture]
+    class RingBufferTests
+    {
+        [Test]
+        public void FifoTest()
+        {
+            var aBuffer = new RingBuffer<string>(4);
+            string aItem;
+            Assert.IsFalse(aBuffer.TryDequeue(out aItem));
+            for (int i = 0; i < 10; ++i)
+            {
+                aBuffer.Enqueue(i.ToString());
+                aBuffer.Enqueue((i + 100).ToString());
+                Assert.IsTrue(aBuffer.TryDequeue(out aItem));
+                Assert.AreEqual(i.ToString(), aItem);
+                Assert.IsTrue(aBuffer.TryDequeue(out aItem));
+                Assert.AreEqual((i + 100).ToString(), aItem);
+            }
+            Assert.AreEqual(0, aBuffer.Count);
+            Assert.AreEqual(0, aBuffer.TakeOverwritten());
+        }
+
+        [Test]
+        public void OverwriteTest()
+        {
+            var aBuffer = new RingBuffer<string>(3);
+            for (int i = 0; i < 10; ++i)
+            {
+                aBuffer.Enqueue(i.ToString());
+            }
+            //the most recent items are kept
+            Assert.AreEqual(3, aBuffer.Count);
+            Assert.AreEqual(7, aBuffer.TakeOverwritten());
+            Assert.AreEqual(0, aBuffer.TakeOverwritten());
+            Assert.AreEqual(1, aBuffer.Discard(1));
+            string aItem;
+            Assert.IsTrue(aBuffer.TryDequeue(out aItem));
+            Assert.AreEqual("8", aItem);
+            Assert.AreEqual(1, aBuffer.Discard(5));
+            Assert.IsFalse(aBuffer.TryDequeue(out aItem));
+        }
+
+        [Test]
+        public void ConcurrentTest()
+        {
+            const int COUNT = 200000;
+            var aBuffer     = new RingBuffer<string>(64);
+            var aProducer   = Task.Factory.StartNew(() =>
+            {
+                for (int i = 0; i < COUNT; ++i)
+                {
+                    aBuffer.Enqueue(i.ToString());
+                }
+            });
+            long aReceived = 0;
+            int aLast      = -1;
+            string aItem;
+            while (!aProducer.IsCompleted || aBuffer.Count > 0)
+            {
+                while (aBuffer.TryDequeue(out aItem))
+                {
+                    //items arrive in order, none twice
+                    int aValue = int.Parse(aItem);
+                    Assert.Greater(aValue, aLast);
+                    aLast = aValue;
+                    ++aReceived;
+                }
+            }
+            aProducer.Wait();
+            Assert.AreEqual(COUNT - 1, aLast);
+            Assert.AreEqual(COUNT, aReceived + aBuffer.TakeOverwritten());
+        }
+    }
+}